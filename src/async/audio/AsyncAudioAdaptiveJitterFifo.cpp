@@ -0,0 +1,603 @@
+/**
+@file	 AsyncAudioAdaptiveJitterFifo.cpp
+@brief   A jitter buffer with adaptive depth and time scale modification
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-17
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <time.h>
+
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <cassert>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncAudioAdaptiveJitterFifo.h"
+#include "AsyncAudioBlockPool.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+static int64_t monotonicNs(void);
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+static const unsigned MAX_WRITE_SIZE        = 800;
+
+  // Number of packets used for the jitter estimate
+static const unsigned JITTER_WINDOW         = 100;
+
+  // Writes closer in time than this belong to the same packet
+static const int64_t  PACKET_GAP_NS         = 1000000LL;
+
+  // Extra delay added on top of the measured jitter
+static const unsigned JITTER_MARGIN_MS      = 10;
+
+  // The target depth decay by 1/TARGET_DECAY per packet
+static const unsigned TARGET_DECAY          = 64;
+
+  // WSOLA search range and crossfade length
+static const unsigned PERIOD_MIN_US         = 2500;
+static const unsigned PERIOD_MAX_US         = 12500;
+static const unsigned OVERLAP_US            = 5000;
+
+  // Minimum output, in pitch periods, between two time scale operations.
+  // This limit the playback speed change to about ten percent.
+static const unsigned STRETCH_INTERVAL      = 10;
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+
+AudioAdaptiveJitterFifo::AudioAdaptiveJitterFifo(int sample_rate)
+  : sample_rate(sample_rate), min_delay(0), max_delay(0), pmin(0), pmax(0),
+    overlap(0), headroom(0), buf(0), buf_size(0), rd(0), wr(0), prebuf(true),
+    is_flushing(false), output_stopped(false), stretch_enabled(true),
+    stream_active(false), stream_start(0), last_arrival(0),
+    stream_samples(0), jitter(0), target(0), stretch_interval(0),
+    since_stretch(0)
+{
+  assert(sample_rate > 0);
+  pmin = static_cast<uint64_t>(sample_rate) * PERIOD_MIN_US / 1000000;
+  pmax = static_cast<uint64_t>(sample_rate) * PERIOD_MAX_US / 1000000;
+  overlap = static_cast<uint64_t>(sample_rate) * OVERLAP_US / 1000000;
+  pmin = max(pmin, 1U);
+  pmax = max(pmax, pmin);
+  overlap = max(overlap, 1U);
+  headroom = pmax;
+  stretch_interval = STRETCH_INTERVAL * pmax;
+  resetStats();
+  setDelayLimits(20, 500);
+} /* AudioAdaptiveJitterFifo */
+
+
+AudioAdaptiveJitterFifo::~AudioAdaptiveJitterFifo(void)
+{
+  AudioBlockPool::freeSamples(buf, buf_size);
+} /* ~AudioAdaptiveJitterFifo */
+
+
+void AudioAdaptiveJitterFifo::setDelayLimits(unsigned min_delay_ms,
+                                             unsigned max_delay_ms)
+{
+  max_delay_ms = max(max_delay_ms, min_delay_ms);
+  min_delay = static_cast<uint64_t>(sample_rate) * min_delay_ms / 1000;
+  max_delay = static_cast<uint64_t>(sample_rate) * max_delay_ms / 1000;
+  target = min_delay;
+  allocBuffer();
+  clear();
+} /* AudioAdaptiveJitterFifo::setDelayLimits */
+
+
+void AudioAdaptiveJitterFifo::clear(void)
+{
+  bool was_empty = empty();
+
+  rd = wr = headroom;
+  prebuf = true;
+  output_stopped = false;
+  stream_active = false;
+  since_stretch = 0;
+
+  if (is_flushing)
+  {
+    is_flushing = false;
+    if (!was_empty)
+    {
+      sinkFlushSamples();
+    }
+  }
+} /* AudioAdaptiveJitterFifo::clear */
+
+
+AudioAdaptiveJitterFifo::Stats AudioAdaptiveJitterFifo::stats(void) const
+{
+  Stats s(m_stats);
+  s.depth_ms = toMs(samplesInFifo());
+  s.target_ms = toMs(target);
+  s.jitter_ms = toMs(jitter);
+  return s;
+} /* AudioAdaptiveJitterFifo::stats */
+
+
+void AudioAdaptiveJitterFifo::resetStats(void)
+{
+  m_stats = Stats();
+} /* AudioAdaptiveJitterFifo::resetStats */
+
+
+int AudioAdaptiveJitterFifo::writeSamples(const float *samples, int count)
+{
+  assert(count > 0);
+
+  if (is_flushing)
+  {
+    is_flushing = false;
+    prebuf = true;
+  }
+
+  int64_t now = monotonicNs();
+  bool is_late = stream_active && !prebuf && empty() &&
+                 (now - last_arrival > PACKET_GAP_NS);
+  if (is_late)
+  {
+      // The buffer ran dry before this packet arrived
+    m_stats.late += 1;
+    prebuf = true;
+  }
+
+  packetArrived(now);
+  if (is_late)
+  {
+      // The jitter estimate missed this one so add one packet of margin
+    target = min(target + count, static_cast<double>(max_delay));
+  }
+  stream_samples += count;
+  appendSamples(samples, count);
+
+  m_stats.max_depth_ms = max(m_stats.max_depth_ms, toMs(samplesInFifo()));
+
+  if (prebuf && (samplesInFifo() >= target))
+  {
+    prebuf = false;
+    since_stretch = 0;
+  }
+
+  writeSamplesFromFifo();
+
+  return count;
+
+} /* AudioAdaptiveJitterFifo::writeSamples */
+
+
+void AudioAdaptiveJitterFifo::flushSamples(void)
+{
+  is_flushing = true;
+  stream_active = false;
+  if (empty())
+  {
+    sinkFlushSamples();
+  }
+  else
+  {
+    writeSamplesFromFifo();
+  }
+} /* AudioAdaptiveJitterFifo::flushSamples */
+
+
+void AudioAdaptiveJitterFifo::resumeOutput(void)
+{
+  if (output_stopped)
+  {
+    output_stopped = false;
+    writeSamplesFromFifo();
+  }
+} /* AudioAdaptiveJitterFifo::resumeOutput */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+void AudioAdaptiveJitterFifo::allSamplesFlushed(void)
+{
+  if (empty())
+  {
+    if (is_flushing)
+    {
+      is_flushing = false;
+      sourceAllSamplesFlushed();
+    }
+    prebuf = true;
+  }
+} /* AudioAdaptiveJitterFifo::allSamplesFlushed */
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+
+void AudioAdaptiveJitterFifo::allocBuffer(void)
+{
+  unsigned new_size = headroom + 2 * max_delay + 2 * MAX_WRITE_SIZE;
+  if (new_size != buf_size)
+  {
+    if (buf != 0)
+    {
+      AudioBlockPool::freeSamples(buf, buf_size);
+    }
+    buf_size = new_size;
+    buf = AudioBlockPool::allocSamples(buf_size);
+  }
+} /* AudioAdaptiveJitterFifo::allocBuffer */
+
+
+void AudioAdaptiveJitterFifo::packetArrived(int64_t now)
+{
+  if (stream_active && (now - last_arrival < PACKET_GAP_NS))
+  {
+    last_arrival = now;
+    return;
+  }
+
+  m_stats.packets += 1;
+
+    // The relative delay is how much later than expected, judging from the
+    // number of samples received so far, this packet arrived.
+  int64_t rel = 0;
+  if (stream_active)
+  {
+    rel = (now - stream_start) -
+          static_cast<int64_t>(stream_samples * 1000000000ULL / sample_rate);
+    int64_t rel_min = *min_element(rel_delays.begin(), rel_delays.end());
+    if (rel - rel_min > 2000000000LL * max_delay / sample_rate)
+    {
+        // Too large to be jitter. The sender probably paused without
+        // flushing so start over with a new stream.
+      stream_active = false;
+    }
+  }
+
+  if (!stream_active)
+  {
+    stream_active = true;
+    stream_start = now;
+    stream_samples = 0;
+    rel_delays.clear();
+    rel = 0;
+  }
+
+  last_arrival = now;
+  rel_delays.push_back(rel);
+  if (rel_delays.size() > JITTER_WINDOW)
+  {
+    rel_delays.pop_front();
+  }
+  updateTarget();
+} /* AudioAdaptiveJitterFifo::packetArrived */
+
+
+void AudioAdaptiveJitterFifo::updateTarget(void)
+{
+  auto mm = minmax_element(rel_delays.begin(), rel_delays.end());
+  int64_t spread = *mm.second - *mm.first;
+  jitter = spread * sample_rate / 1000000000LL;
+
+  double wanted = jitter + sample_rate * JITTER_MARGIN_MS / 1000;
+  wanted = min(max(wanted, static_cast<double>(min_delay)),
+               static_cast<double>(max_delay));
+  if (wanted > target)
+  {
+    target = wanted;
+  }
+  else
+  {
+    target += (wanted - target) / TARGET_DECAY;
+  }
+} /* AudioAdaptiveJitterFifo::updateTarget */
+
+
+void AudioAdaptiveJitterFifo::appendSamples(const float *samples,
+                                            unsigned count)
+{
+  if (wr + count > buf_size)
+  {
+    compact();
+  }
+
+  unsigned space = buf_size - headroom;
+  if (count > space)
+  {
+    m_stats.overflow_samples += samplesInFifo() + count - space;
+    samples += count - space;
+    count = space;
+    rd = wr = headroom;
+  }
+  else if (wr + count > buf_size)
+  {
+      // Throw away the oldest samples
+    unsigned drop = wr + count - buf_size;
+    m_stats.overflow_samples += drop;
+    rd += drop;
+    compact();
+  }
+
+  memcpy(buf + wr, samples, count * sizeof(*buf));
+  wr += count;
+} /* AudioAdaptiveJitterFifo::appendSamples */
+
+
+void AudioAdaptiveJitterFifo::compact(void)
+{
+  if (rd != headroom)
+  {
+    memmove(buf + headroom, buf + rd, samplesInFifo() * sizeof(*buf));
+    wr = headroom + samplesInFifo();
+    rd = headroom;
+  }
+} /* AudioAdaptiveJitterFifo::compact */
+
+
+void AudioAdaptiveJitterFifo::writeSamplesFromFifo(void)
+{
+  if (output_stopped || (prebuf && !is_flushing))
+  {
+    return;
+  }
+
+  int samples_written = 0;
+  while (!empty())
+  {
+    adjustDepth();
+    int samples_to_write = min(MAX_WRITE_SIZE, samplesInFifo());
+    samples_written = sinkWriteSamples(buf + rd, samples_to_write);
+    rd += samples_written;
+    since_stretch += samples_written;
+    if (samples_written == 0)
+    {
+      output_stopped = true;
+      break;
+    }
+  }
+
+  if (empty())
+  {
+    rd = wr = headroom;
+    if (is_flushing)
+    {
+      sinkFlushSamples();
+    }
+  }
+} /* AudioAdaptiveJitterFifo::writeSamplesFromFifo */
+
+
+void AudioAdaptiveJitterFifo::adjustDepth(void)
+{
+  if (!stretch_enabled || is_flushing || (since_stretch < stretch_interval) ||
+      (samplesInFifo() < pmax + overlap))
+  {
+    return;
+  }
+
+    // The depth swing with the jitter so do not chase every dip and peak
+  double hysteresis = pmax + jitter / 2;
+  double depth = samplesInFifo();
+  if (depth > target + hysteresis)
+  {
+    compress();
+  }
+  else if (depth < target - hysteresis)
+  {
+    expand();
+  }
+} /* AudioAdaptiveJitterFifo::adjustDepth */
+
+
+unsigned AudioAdaptiveJitterFifo::findPeriod(const float *x) const
+{
+    // Find the shift that makes the waveform look most like itself using
+    // normalized cross correlation
+  float ref_energy = 0.0f;
+  for (unsigned i=0; i<overlap; ++i)
+  {
+    ref_energy += x[i] * x[i];
+  }
+
+  float energy = 0.0f;
+  for (unsigned i=0; i<overlap; ++i)
+  {
+    energy += x[pmin+i] * x[pmin+i];
+  }
+
+  unsigned best_period = pmax;
+  float best_score = -2.0f;
+  for (unsigned p=pmin; p<=pmax; ++p)
+  {
+    if (p > pmin)
+    {
+      float out = x[p-1];
+      float in = x[p+overlap-1];
+      energy += in * in - out * out;
+    }
+    float corr = 0.0f;
+    for (unsigned i=0; i<overlap; ++i)
+    {
+      corr += x[i] * x[p+i];
+    }
+    float den = sqrtf(max(ref_energy * energy, 0.0f));
+    if (den < 1e-9f)
+    {
+      continue;
+    }
+    float score = corr / den;
+    if (score > best_score)
+    {
+      best_score = score;
+      best_period = p;
+    }
+  }
+
+  return best_period;
+} /* AudioAdaptiveJitterFifo::findPeriod */
+
+
+void AudioAdaptiveJitterFifo::compress(void)
+{
+    // Remove one period by crossfading the start of the buffer into the
+    // samples one period later
+  float *x = buf + rd;
+  unsigned p = findPeriod(x);
+  for (unsigned i=0; i<overlap; ++i)
+  {
+    float w = (i + 0.5f) / overlap;
+    x[p+i] = x[i] * (1.0f - w) + x[p+i] * w;
+  }
+  rd += p;
+  since_stretch = 0;
+  m_stats.compressed_samples += p;
+} /* AudioAdaptiveJitterFifo::compress */
+
+
+void AudioAdaptiveJitterFifo::expand(void)
+{
+    // Repeat one period. The first period is played as is, followed by a
+    // crossfade from the samples after it back into the start of the buffer.
+  if (rd < pmax)
+  {
+    compact();
+  }
+  float *x = buf + rd;
+  unsigned p = findPeriod(x);
+  float *fade = AudioBlockPool::allocSamples(overlap);
+  for (unsigned i=0; i<overlap; ++i)
+  {
+    float w = (i + 0.5f) / overlap;
+    fade[i] = x[p+i] * (1.0f - w) + x[i] * w;
+  }
+  memmove(x - p, x, p * sizeof(*x));
+  memcpy(x, fade, overlap * sizeof(*x));
+  AudioBlockPool::freeSamples(fade, overlap);
+  rd -= p;
+  since_stretch = 0;
+  m_stats.expanded_samples += p;
+} /* AudioAdaptiveJitterFifo::expand */
+
+
+unsigned AudioAdaptiveJitterFifo::toMs(double samples) const
+{
+  return static_cast<unsigned>(samples * 1000 / sample_rate + 0.5);
+} /* AudioAdaptiveJitterFifo::toMs */
+
+
+static int64_t monotonicNs(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+} /* monotonicNs */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,319 @@
+/**
+@file	 AsyncAudioAdaptiveJitterFifo.h
+@brief   A jitter buffer with adaptive depth and time scale modification
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-17
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+#ifndef ASYNC_AUDIO_ADAPTIVE_JITTER_FIFO_INCLUDED
+#define ASYNC_AUDIO_ADAPTIVE_JITTER_FIFO_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <stdint.h>
+
+#include <deque>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncAudioSink.h>
+#include <AsyncAudioSource.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+  
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A jitter buffer with adaptive depth and time scale modification
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+This class implements a jitter buffer for audio received from the network.
+The arrival time of each packet, i.e. each burst of samples written to the
+buffer, is compared to the time it should have arrived at according to the
+number of samples received so far in the stream. The spread of this relative
+delay over the last couple of seconds is the packet jitter. The target depth
+of the buffer is set to the jitter plus a small margin, but never lower than
+the minimum delay and never higher than the maximum delay. The target grows
+immediately when the jitter increase and shrinks slowly when it decrease.
+
+At the start of a stream the buffer prebuffer samples up to the target depth.
+While playing, the actual depth is moved towards the target by time scale
+modification of the audio (WSOLA, Waveform Similarity Overlap-Add). One pitch
+period, found by searching for the best waveform match, is removed or
+repeated with a crossfade. The operations are spread out so that the
+playback speed never change by more than about ten percent, which is
+normally not audible in speech.
+
+If the buffer has run empty when a packet arrive, the packet is counted as
+late and the buffer prebuffer up to the target depth again. Lost packets are
+not visible to the buffer, so the owner should report them using
+@ref markLost if the protocol has sequence numbers.
+
+Like Async::AudioJitterFifo, all samples written to the buffer are always
+accepted. If the buffer overflows the oldest samples are thrown away.
+*/
+class AudioAdaptiveJitterFifo : public AudioSink, public AudioSource
+{
+  public:
+    /**
+     * @brief Jitter buffer statistics
+     */
+    struct Stats
+    {
+      unsigned  depth_ms;           ///< Current buffer depth
+      unsigned  target_ms;          ///< Current target depth
+      unsigned  jitter_ms;          ///< Current packet jitter estimate
+      unsigned  max_depth_ms;       ///< Maximum buffer depth seen
+      uint64_t  packets;            ///< Number of received packets
+      uint64_t  late;               ///< Packets arriving after an underrun
+      uint64_t  lost;               ///< Packets reported lost
+      uint64_t  overflow_samples;   ///< Samples thrown away on overflow
+      uint64_t  compressed_samples; ///< Samples removed by time compression
+      uint64_t  expanded_samples;   ///< Samples added by time expansion
+    };
+
+    /**
+     * @brief 	Constructor
+     * @param 	sample_rate The sample rate of the audio stream
+     */
+    explicit AudioAdaptiveJitterFifo(int sample_rate=INTERNAL_SAMPLE_RATE);
+
+    /**
+     * @brief 	Destructor
+     */
+    virtual ~AudioAdaptiveJitterFifo(void);
+
+    /**
+     * @brief   Set the minimum and maximum delay
+     * @param   min_delay_ms The lowest target depth in milliseconds
+     * @param   max_delay_ms The highest target depth in milliseconds
+     *
+     * The buffer is cleared when the limits are changed. The default is
+     * 20 to 500 milliseconds.
+     */
+    void setDelayLimits(unsigned min_delay_ms, unsigned max_delay_ms);
+
+    /**
+     * @brief   Enable or disable time scale modification
+     * @param   enable Set to \em false to disable time scale modification
+     *
+     * When disabled the buffer depth only adapts at the start of a stream and
+     * after an underrun, by prebuffering up to the current target depth.
+     */
+    void setTimeStretchEnabled(bool enable) { stretch_enabled = enable; }
+
+    /**
+     * @brief 	Check if the FIFO is empty
+     * @return	Returns \em true if the FIFO is empty or \em false if not
+     */
+    bool empty(void) const { return wr == rd; }
+
+    /**
+     * @brief 	Find out how many samples there are in the FIFO
+     * @return	Returns the number of samples in the FIFO
+     */
+    unsigned samplesInFifo(void) const { return wr - rd; }
+
+    /**
+     * @brief 	Clear all samples from the FIFO
+     *
+     * The jitter estimate and statistics are kept.
+     */
+    void clear(void);
+
+    /**
+     * @brief   Report packets lost by the network
+     * @param   count The number of lost packets
+     */
+    void markLost(unsigned count) { m_stats.lost += count; }
+
+    /**
+     * @brief   Get jitter buffer statistics
+     * @return  Returns the current depth, target and counters
+     */
+    Stats stats(void) const;
+
+    /**
+     * @brief   Reset the counters in the statistics
+     */
+    void resetStats(void);
+
+    /**
+     * @brief 	Write samples into the FIFO
+     * @param 	samples The buffer containing the samples
+     * @param 	count The number of samples in the buffer
+     * @return	Returns the number of samples that has been taken care of
+     *
+     * This function is used to write audio into the FIFO. All samples are
+     * always accepted.
+     * This function is normally only called from a connected source object.
+     */
+    virtual int writeSamples(const float *samples, int count);
+
+    /**
+     * @brief 	Tell the FIFO to flush the previously written samples
+     *
+     * This function is used to tell the FIFO to flush previously written
+     * samples.
+     * This function is normally only called from a connected source object.
+     */
+    virtual void flushSamples(void);
+
+    /**
+     * @brief 	Resume audio output to the connected sink
+     *
+     * This function will be called when the registered audio sink is ready
+     * to accept more samples.
+     * This function is normally only called from a connected sink object.
+     */
+    virtual void resumeOutput(void);
+
+
+  protected:
+    /**
+     * @brief 	The registered sink has flushed all samples
+     *
+     * This function will be called when all samples have been flushed in the
+     * registered sink.
+     * This function is normally only called from a connected sink object.
+     */
+    virtual void allSamplesFlushed(void);
+
+
+  private:
+    int                 sample_rate;
+    unsigned            min_delay;
+    unsigned            max_delay;
+    unsigned            pmin;
+    unsigned            pmax;
+    unsigned            overlap;
+    unsigned            headroom;
+    float               *buf;
+    unsigned            buf_size;
+    unsigned            rd;
+    unsigned            wr;
+    bool                prebuf;
+    bool                is_flushing;
+    bool                output_stopped;
+    bool                stretch_enabled;
+    bool                stream_active;
+    int64_t             stream_start;
+    int64_t             last_arrival;
+    uint64_t            stream_samples;
+    std::deque<int64_t> rel_delays;
+    unsigned            jitter;
+    double              target;
+    unsigned            stretch_interval;
+    unsigned            since_stretch;
+    Stats               m_stats;
+
+    AudioAdaptiveJitterFifo(const AudioAdaptiveJitterFifo&);
+    AudioAdaptiveJitterFifo& operator=(const AudioAdaptiveJitterFifo&);
+    void allocBuffer(void);
+    void packetArrived(int64_t now);
+    void updateTarget(void);
+    void appendSamples(const float *samples, unsigned count);
+    void compact(void);
+    void writeSamplesFromFifo(void);
+    void adjustDepth(void);
+    unsigned findPeriod(const float *x) const;
+    void compress(void);
+    void expand(void);
+    unsigned toMs(double samples) const;
+
+};  /* class AudioAdaptiveJitterFifo */
+
+
+} /* namespace */
+
+#endif /* ASYNC_AUDIO_ADAPTIVE_JITTER_FIFO_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
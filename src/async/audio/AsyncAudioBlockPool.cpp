@@ -0,0 +1,381 @@
+/**
+@file	 AsyncAudioBlockPool.cpp
+@brief   A size classed memory pool for audio buffers
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-17
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <new>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncAudioBlockPool.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+namespace {
+  const unsigned MIN_SHIFT    = 6;
+  const unsigned MAX_SHIFT    = 20;
+  const unsigned NUM_CLASSES  = MAX_SHIFT - MIN_SHIFT + 1;
+  const size_t   CACHE_SIZE   = 16;
+  const size_t   BATCH_SIZE   = CACHE_SIZE / 2;
+
+  struct SizeClass
+  {
+    std::mutex            mutex;
+    std::vector<void *>   free_list;
+    std::atomic<size_t>   blocks{0};
+    std::atomic<size_t>   in_use{0};
+    std::atomic<size_t>   allocations{0};
+  };
+
+    // The last size class is only used for statistics about buffers that
+    // are too large for the pool
+  struct Pool
+  {
+    SizeClass classes[NUM_CLASSES + 1];
+  };
+
+    // The thread cache state is kept in a separate trivially destructible
+    // variable so that it can be checked after the cache has been destroyed,
+    // e.g. when static objects are deleted after the main thread cache.
+  enum { CACHE_UNUSED, CACHE_ALIVE, CACHE_DEAD };
+  thread_local int cache_state = CACHE_UNUSED;
+
+  struct ThreadCache
+  {
+    std::vector<void *> blocks[NUM_CLASSES];
+
+    ThreadCache(void)
+    {
+      for (unsigned i=0; i<NUM_CLASSES; ++i)
+      {
+        blocks[i].reserve(CACHE_SIZE);
+      }
+      cache_state = CACHE_ALIVE;
+    }
+
+    ~ThreadCache(void);
+  };
+};
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+namespace {
+  Pool& pool(void)
+  {
+      // Never deleted since blocks may be returned by static objects and
+      // threads during program exit
+    static Pool *the_pool = new Pool;
+    return *the_pool;
+  }
+
+  ThreadCache *threadCache(void)
+  {
+    if (cache_state == CACHE_DEAD)
+    {
+      return 0;
+    }
+    thread_local ThreadCache cache;
+    return &cache;
+  }
+
+  unsigned sizeClass(size_t size)
+  {
+    unsigned shift = MIN_SHIFT;
+    while ((shift <= MAX_SHIFT) && ((size_t(1) << shift) < size))
+    {
+      ++shift;
+    }
+    return shift - MIN_SHIFT;
+  }
+
+  size_t blockSize(unsigned cls)
+  {
+    return size_t(1) << (cls + MIN_SHIFT);
+  }
+
+  ThreadCache::~ThreadCache(void)
+  {
+    cache_state = CACHE_DEAD;
+    for (unsigned cls=0; cls<NUM_CLASSES; ++cls)
+    {
+      SizeClass& sc = pool().classes[cls];
+      std::lock_guard<std::mutex> lock(sc.mutex);
+      sc.free_list.insert(sc.free_list.end(), blocks[cls].begin(),
+                          blocks[cls].end());
+    }
+  }
+};
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+void *AudioBlockPool::allocate(size_t size)
+{
+  const unsigned cls = sizeClass(size);
+  SizeClass& sc = pool().classes[cls];
+  sc.allocations.fetch_add(1, std::memory_order_relaxed);
+  sc.in_use.fetch_add(1, std::memory_order_relaxed);
+  if (cls == NUM_CLASSES)
+  {
+    return ::operator new(size);
+  }
+
+  ThreadCache *cache = threadCache();
+  if (cache != 0)
+  {
+    std::vector<void *>& blocks = cache->blocks[cls];
+    if (blocks.empty())
+    {
+      std::lock_guard<std::mutex> lock(sc.mutex);
+      while (!sc.free_list.empty() && (blocks.size() < BATCH_SIZE))
+      {
+        blocks.push_back(sc.free_list.back());
+        sc.free_list.pop_back();
+      }
+    }
+    if (!blocks.empty())
+    {
+      void *ptr = blocks.back();
+      blocks.pop_back();
+      return ptr;
+    }
+  }
+  else
+  {
+    std::lock_guard<std::mutex> lock(sc.mutex);
+    if (!sc.free_list.empty())
+    {
+      void *ptr = sc.free_list.back();
+      sc.free_list.pop_back();
+      return ptr;
+    }
+  }
+
+  sc.blocks.fetch_add(1, std::memory_order_relaxed);
+  return ::operator new(blockSize(cls));
+} /* AudioBlockPool::allocate */
+
+
+void AudioBlockPool::deallocate(void *ptr, size_t size)
+{
+  if (ptr == 0)
+  {
+    return;
+  }
+
+  const unsigned cls = sizeClass(size);
+  SizeClass& sc = pool().classes[cls];
+  sc.in_use.fetch_sub(1, std::memory_order_relaxed);
+  if (cls == NUM_CLASSES)
+  {
+    ::operator delete(ptr);
+    return;
+  }
+
+  ThreadCache *cache = threadCache();
+  if (cache != 0)
+  {
+    std::vector<void *>& blocks = cache->blocks[cls];
+    if (blocks.size() >= CACHE_SIZE)
+    {
+      std::lock_guard<std::mutex> lock(sc.mutex);
+      sc.free_list.insert(sc.free_list.end(), blocks.end() - BATCH_SIZE,
+                          blocks.end());
+      blocks.resize(blocks.size() - BATCH_SIZE);
+    }
+    blocks.push_back(ptr);
+  }
+  else
+  {
+    std::lock_guard<std::mutex> lock(sc.mutex);
+    sc.free_list.push_back(ptr);
+  }
+} /* AudioBlockPool::deallocate */
+
+
+void AudioBlockPool::trim(void)
+{
+  for (unsigned cls=0; cls<NUM_CLASSES; ++cls)
+  {
+    SizeClass& sc = pool().classes[cls];
+    std::lock_guard<std::mutex> lock(sc.mutex);
+    for (void *ptr : sc.free_list)
+    {
+      ::operator delete(ptr);
+    }
+    sc.blocks.fetch_sub(sc.free_list.size(), std::memory_order_relaxed);
+    sc.free_list.clear();
+  }
+} /* AudioBlockPool::trim */
+
+
+std::vector<AudioBlockPool::ClassStats> AudioBlockPool::stats(void)
+{
+  std::vector<ClassStats> all_stats;
+  for (unsigned cls=0; cls<=NUM_CLASSES; ++cls)
+  {
+    const SizeClass& sc = pool().classes[cls];
+    ClassStats stats;
+    stats.block_size = (cls < NUM_CLASSES) ? blockSize(cls) : 0;
+    stats.in_use = sc.in_use.load(std::memory_order_relaxed);
+    stats.blocks = (cls < NUM_CLASSES)
+        ? sc.blocks.load(std::memory_order_relaxed) : stats.in_use;
+    stats.allocations = sc.allocations.load(std::memory_order_relaxed);
+    all_stats.push_back(stats);
+  }
+  return all_stats;
+} /* AudioBlockPool::stats */
+
+
+void AudioBlockPool::printStats(std::ostream& os)
+{
+  size_t total_bytes = 0;
+  os << "Audio block pool:" << std::endl;
+  const std::vector<ClassStats> all_stats = stats();
+  for (const ClassStats& s : all_stats)
+  {
+    if (s.allocations == 0)
+    {
+      continue;
+    }
+    os << "  ";
+    if (s.block_size > 0)
+    {
+      os << std::setw(7) << s.block_size << " bytes:";
+    }
+    else
+    {
+      os << "    large:";
+    }
+    os << " blocks=" << s.blocks
+       << " in_use=" << s.in_use
+       << " allocations=" << s.allocations;
+    if (s.block_size > 0)
+    {
+      os << " memory=" << (s.blocks * s.block_size + 1023) / 1024 << "kB";
+      total_bytes += s.blocks * s.block_size;
+    }
+    os << std::endl;
+  }
+  os << "  Total pooled memory: " << (total_bytes + 1023) / 1024 << "kB"
+     << std::endl;
+} /* AudioBlockPool::printStats */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,263 @@
+/**
+@file	 AsyncAudioBlockPool.h
+@brief   A size classed memory pool for audio buffers
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-17
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+#ifndef ASYNC_AUDIO_BLOCK_POOL_INCLUDED
+#define ASYNC_AUDIO_BLOCK_POOL_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cstddef>
+#include <iosfwd>
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A process wide memory pool for audio buffers
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+Audio pipe objects are created and deleted every time a connection, like an
+EchoLink QSO or a reflector stream, is set up or torn down. Most of them
+allocate one or more working buffers. This pool keep freed buffers around so
+that they can be reused instead of being returned to the heap.
+
+Buffers are grouped in size classes with power of two sizes, from 64 bytes
+up to 1 MiB. Larger buffers are allocated directly from the heap. Each thread
+keep a small cache of free blocks for each size class so that the common case
+does not need any locking. When a thread cache is empty or full, blocks are
+moved in batches to or from a global free list.
+
+The number of blocks allocated from the heap and the number of blocks in use
+for each size class can be read using the stats function or printed using
+printStats.
+
+\code
+float *buf = Async::AudioBlockPool::allocSamples(256);
+...
+Async::AudioBlockPool::freeSamples(buf, 256);
+
+std::vector<float, Async::AudioBlockAllocator<float> > vec(256);
+\endcode
+*/
+class AudioBlockPool
+{
+  public:
+    /**
+     * @brief Statistics for one size class
+     */
+    struct ClassStats
+    {
+      size_t  block_size;     ///< The size of the blocks in bytes
+      size_t  blocks;         ///< Blocks allocated from the heap
+      size_t  in_use;         ///< Blocks currently handed out
+      size_t  allocations;    ///< Number of allocate calls
+    };
+
+    /**
+     * @brief 	Allocate a memory block
+     * @param 	size The size of the block in bytes
+     * @return	Returns a pointer to the block
+     */
+    static void *allocate(size_t size);
+
+    /**
+     * @brief 	Return a memory block to the pool
+     * @param 	ptr  The block to return
+     * @param 	size The size given when the block was allocated
+     */
+    static void deallocate(void *ptr, size_t size);
+
+    /**
+     * @brief 	Allocate a buffer of samples
+     * @param 	count The number of samples
+     * @return	Returns a pointer to the buffer
+     */
+    static float *allocSamples(size_t count)
+    {
+      return static_cast<float *>(allocate(count * sizeof(float)));
+    }
+
+    /**
+     * @brief 	Return a buffer of samples to the pool
+     * @param 	buf   The buffer to return, may be 0
+     * @param 	count The number of samples given when allocating the buffer
+     */
+    static void freeSamples(float *buf, size_t count)
+    {
+      if (buf != 0)
+      {
+        deallocate(buf, count * sizeof(float));
+      }
+    }
+
+    /**
+     * @brief 	Return all unused blocks in the global free lists to the heap
+     *
+     * Blocks cached by threads are not affected.
+     */
+    static void trim(void);
+
+    /**
+     * @brief 	Get statistics for all size classes
+     * @return	Returns the statistics, smallest size class first
+     *
+     * The last element hold the statistics for buffers that are too large
+     * for the pool and therefore are allocated directly from the heap. Its
+     * block_size is set to zero.
+     */
+    static std::vector<ClassStats> stats(void);
+
+    /**
+     * @brief 	Print the pool statistics
+     * @param 	os The stream to print to
+     */
+    static void printStats(std::ostream& os);
+
+};  /* class AudioBlockPool */
+
+
+/**
+@brief	A standard library allocator that use the AudioBlockPool
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+Use this allocator for containers that hold audio samples or other working
+data in audio pipe objects, e.g. std::vector<float, AudioBlockAllocator<float>>.
+*/
+template <typename T>
+class AudioBlockAllocator
+{
+  public:
+    typedef T value_type;
+
+    AudioBlockAllocator(void) noexcept {}
+
+    template <typename U>
+    AudioBlockAllocator(const AudioBlockAllocator<U>&) noexcept {}
+
+    T *allocate(size_t n)
+    {
+      return static_cast<T *>(AudioBlockPool::allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T *ptr, size_t n) noexcept
+    {
+      AudioBlockPool::deallocate(ptr, n * sizeof(T));
+    }
+};  /* class AudioBlockAllocator */
+
+template <typename T, typename U>
+bool operator==(const AudioBlockAllocator<T>&, const AudioBlockAllocator<U>&)
+{
+  return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const AudioBlockAllocator<T>&, const AudioBlockAllocator<U>&)
+{
+  return false;
+}
+
+
+} /* namespace */
+
+#endif /* ASYNC_AUDIO_BLOCK_POOL_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
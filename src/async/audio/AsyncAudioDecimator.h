@@ -38,6 +38,7 @@ ANY KIND. See http://www.dspguru.com/wol.htm for more information.
  ****************************************************************************/
 
 #include <AsyncAudioProcessor.h>
+#include <AsyncAudioFirKernel.h>
 
 
 /****************************************************************************
@@ -147,10 +148,7 @@ class AudioDecimator : public AudioProcessor
 
     
   private:
-    const int 	factor_M;
-    float     	*p_Z;
-    int       	H_size;
-    const float *p_H;
+    FirDecimator<float> fir;
     
     AudioDecimator(const AudioDecimator&);
     AudioDecimator& operator=(const AudioDecimator&);
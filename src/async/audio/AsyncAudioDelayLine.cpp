@@ -52,6 +52,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "AsyncAudioDelayLine.h"
+#include "AsyncAudioBlockPool.h"
 
 
 
@@ -118,7 +119,7 @@ AudioDelayLine::AudioDelayLine(int length_ms)
     is_muted(false), mute_cnt(0), last_clear(0), fade_gain(0), fade_len(0),
     fade_pos(0), fade_dir(0)
 {
-  buf = new float[size];
+  buf = AudioBlockPool::allocSamples(size);
   memset(buf, 0, size * sizeof(*buf));
   clear();
   setFadeTime(DEFAULT_FADE_TIME);
@@ -127,14 +128,14 @@ AudioDelayLine::AudioDelayLine(int length_ms)
 
 AudioDelayLine::~AudioDelayLine(void)
 {
-  delete [] fade_gain;
-  delete [] buf;
+  AudioBlockPool::freeSamples(fade_gain, fade_len);
+  AudioBlockPool::freeSamples(buf, size);
 } /* AudioDelayLine::~AudioDelayLine */
 
 
 void AudioDelayLine::setFadeTime(int time_ms)
 {
-  delete [] fade_gain;
+  AudioBlockPool::freeSamples(fade_gain, fade_len);
   fade_gain = 0;
   
   if (time_ms <= 0)
@@ -147,7 +148,7 @@ void AudioDelayLine::setFadeTime(int time_ms)
 
   fade_len = time_ms * INTERNAL_SAMPLE_RATE / 1000;
   fade_pos = min(fade_pos, fade_len-1);
-  fade_gain = new float[fade_len];
+  fade_gain = AudioBlockPool::allocSamples(fade_len);
   for (int i=0; i<fade_len-1; ++i)
   {
     fade_gain[i] = pow(2.0f, -15.0f * (static_cast<float>(i) / fade_len));
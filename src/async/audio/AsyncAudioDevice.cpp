@@ -256,6 +256,7 @@ AudioDevice::AudioDevice(const string& dev_name)
   : dev_name(dev_name), current_mode(MODE_NONE), use_count(0)
 {
   reopen_timer.setEnable(false);
+  reopen_timer.setTag("Async::AudioDevice");
   reopen_timer.expired.connect(
       sigc::hide(sigc::mem_fun(*this, &AudioDevice::reopenDevice)));
 } /* AudioDevice::AudioDevice */
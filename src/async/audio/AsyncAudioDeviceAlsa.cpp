@@ -36,10 +36,18 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <sigc++/sigc++.h>
 #include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 #include <iostream>
 #include <sstream>
 #include <cmath>
 #include <cstring>
+#include <cerrno>
+#include <thread>
+#include <vector>
+#include <algorithm>
 
 
 /****************************************************************************
@@ -49,6 +57,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <AsyncFdWatch.h>
+#include <AsyncSpscRingBuffer.h>
 
 
 /****************************************************************************
@@ -101,12 +110,14 @@ class AudioDeviceAlsa::AlsaWatch : public sigc::trackable
         if (pfds[i].events & POLLOUT)
         {
           FdWatch *watch = new FdWatch(pfds[i].fd, FdWatch::FD_WATCH_WR);
+          watch->setTag("Async::AudioDeviceAlsa");
           watch->activity.connect(mem_fun(*this, &AlsaWatch::writeEvent));
           watch_list.push_back(watch);
         }
         if (pfds[i].events & POLLIN)
         {
           FdWatch *watch = new FdWatch(pfds[i].fd, FdWatch::FD_WATCH_RD);
+          watch->setTag("Async::AudioDeviceAlsa");
           watch->activity.connect(mem_fun(*this, &AlsaWatch::readEvent));
           watch_list.push_back(watch);
         }
@@ -159,6 +170,444 @@ class AudioDeviceAlsa::AlsaWatch : public sigc::trackable
 };
 
 
+class AudioDeviceAlsa::RtThread : public sigc::trackable
+{
+  public:
+    RtThread(AudioDeviceAlsa *dev, snd_pcm_t *play_handle,
+             snd_pcm_t *rec_handle)
+      : dev(dev), play_handle(play_handle), rec_handle(rec_handle),
+        channels(AudioDevice::channels), play_block_size(dev->play_block_size),
+        play_buffer_size(dev->play_block_size * dev->play_block_count),
+        rec_block_size(dev->rec_block_size), notify_watch(0),
+        wake_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+        notify_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+        stop(false), error(false), play_active(false),
+        play_hw_avail(play_buffer_size), play_pending(0), play_pos(0),
+        underrun_counted(false)
+    {
+      if (play_handle != 0)
+      {
+        play_ring.resize(play_buffer_size * channels);
+        rt_play_buf.resize(play_ring.capacity());
+      }
+      if (rec_handle != 0)
+      {
+        rt_rec_buf.resize(rec_block_size * dev->rec_block_count * channels);
+        rec_ring.resize(4 * rt_rec_buf.size());
+      }
+      main_buf.resize(max(play_ring.capacity(), rec_ring.capacity()));
+    }
+
+    ~RtThread(void)
+    {
+      if (thread.joinable())
+      {
+        stop = true;
+        wake(wake_fd);
+        thread.join();
+      }
+      delete notify_watch;
+      if (wake_fd >= 0)
+      {
+        ::close(wake_fd);
+      }
+      if (notify_fd >= 0)
+      {
+        ::close(notify_fd);
+      }
+    }
+
+    bool start(int prio)
+    {
+      if ((wake_fd < 0) || (notify_fd < 0))
+      {
+        cerr << "*** ERROR: Could not create eventfd for Alsa audio thread: "
+             << strerror(errno) << endl;
+        return false;
+      }
+      notify_watch = new FdWatch(notify_fd, FdWatch::FD_WATCH_RD);
+      notify_watch->setTag("Async::AudioDeviceAlsa");
+      notify_watch->activity.connect(mem_fun(*this, &RtThread::notifyEvent));
+
+      thread = std::thread(&RtThread::run, this);
+      if (prio > 0)
+      {
+        sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = prio;
+        int err = pthread_setschedparam(thread.native_handle(), SCHED_FIFO,
+                                        &param);
+        if (err != 0)
+        {
+          cerr << "*** WARNING: Could not set real time priority " << prio
+               << " for the audio thread of Alsa device \"" << dev->devName()
+               << "\": " << strerror(err) << endl;
+        }
+      }
+      return true;
+    }
+
+    void fillPlaybackRing(void)
+    {
+      if (play_handle == 0)
+      {
+        return;
+      }
+      const size_t block_samples = play_block_size * channels;
+      size_t blocks;
+      while ((blocks = play_ring.writeAvail() / block_samples) > 0)
+      {
+        blocks = dev->getBlocks(&main_buf[0], blocks);
+        play_active = (blocks > 0);
+        if (blocks == 0)
+        {
+          break;
+        }
+        play_ring.write(&main_buf[0], blocks * block_samples);
+        wake(wake_fd);
+      }
+    }
+
+    int samplesToWrite(void) const
+    {
+      return play_ring.readAvail() / channels + play_pending +
+             play_buffer_size - play_hw_avail;
+    }
+
+    void getStats(Stats& stats) const
+    {
+      stats.rt_thread = true;
+      stats.play_ring_size = play_ring.capacity() / channels;
+      stats.play_ring_fill = play_ring.readAvail() / channels;
+      stats.rec_ring_size = rec_ring.capacity() / channels;
+      stats.rec_ring_fill = rec_ring.readAvail() / channels;
+    }
+
+  private:
+    AudioDeviceAlsa*                dev;
+    snd_pcm_t*                      play_handle;
+    snd_pcm_t*                      rec_handle;
+    const size_t                    channels;
+    const size_t                    play_block_size;
+    const size_t                    play_buffer_size;
+    const size_t                    rec_block_size;
+    FdWatch*                        notify_watch;
+    int                             wake_fd;
+    int                             notify_fd;
+    std::thread                     thread;
+    std::atomic<bool>               stop;
+    std::atomic<bool>               error;
+    std::atomic<bool>               play_active;
+    std::atomic<size_t>             play_hw_avail;
+    std::atomic<size_t>             play_pending;
+    size_t                          play_pos;
+    SpscRingBuffer<int16_t>         play_ring;
+    SpscRingBuffer<int16_t>         rec_ring;
+    std::vector<int16_t>            main_buf;
+    std::vector<int16_t>            rt_play_buf;
+    std::vector<int16_t>            rt_rec_buf;
+    bool                            underrun_counted;
+
+    static void wake(int fd)
+    {
+      const uint64_t cnt = 1;
+      if (write(fd, &cnt, sizeof(cnt)) < 0)
+      {
+        // The counter can only overflow if the other side is not reading
+        // so it is already awake
+      }
+    }
+
+      // Called in the main thread when the audio thread has captured
+      // samples, consumed samples or found an error
+    void notifyEvent(FdWatch *watch)
+    {
+      uint64_t cnt;
+      if (read(notify_fd, &cnt, sizeof(cnt)) < 0)
+      {
+        // Spurious wakeup
+      }
+
+      if (error)
+      {
+        dev->setDeviceError();
+        return;
+      }
+
+      size_t frames;
+      while ((frames = rec_ring.readAvail() / channels) > 0)
+      {
+        frames = min(frames, main_buf.size() / channels);
+        rec_ring.read(&main_buf[0], frames * channels);
+        dev->putBlocks(&main_buf[0], frames);
+      }
+
+      fillPlaybackRing();
+      dev->reportXruns();
+    }
+
+      // The audio thread main function. Nothing in here may block, except
+      // poll, or allocate memory.
+    void run(void)
+    {
+      std::vector<pollfd> pfds(1);
+      pfds[0].fd = wake_fd;
+      pfds[0].events = POLLIN;
+      pfds[0].revents = 0;
+      const size_t play_pfd_pos = pfds.size();
+      const size_t play_pfd_cnt = addPollDescriptors(pfds, play_handle);
+      const size_t rec_pfd_pos = pfds.size();
+      const size_t rec_pfd_cnt = addPollDescriptors(pfds, rec_handle);
+      std::vector<pollfd> all_pfds(pfds);
+
+      bool play_ok = (play_handle != 0);
+      bool rec_ok = (rec_handle != 0);
+      while (!stop)
+      {
+          // Do not poll for playback space if there is nothing to write. A
+          // negative file descriptor make poll ignore the entry.
+        const bool play_poll = play_ok && (dev->zerofill_on_underflow ||
+            (play_pending > 0) ||
+            (play_ring.readAvail() >= play_block_size * channels));
+        for (size_t i=play_pfd_pos; i<play_pfd_pos+play_pfd_cnt; ++i)
+        {
+          pfds[i].fd = play_poll ? all_pfds[i].fd : -1;
+        }
+        for (size_t i=rec_pfd_pos; i<rec_pfd_pos+rec_pfd_cnt; ++i)
+        {
+          pfds[i].fd = rec_ok ? all_pfds[i].fd : -1;
+        }
+
+        int ret = poll(&pfds[0], pfds.size(), -1);
+        if (ret < 0)
+        {
+          if (errno == EINTR)
+          {
+            continue;
+          }
+          break;
+        }
+        if (pfds[0].revents & POLLIN)
+        {
+          uint64_t cnt;
+          if (read(wake_fd, &cnt, sizeof(cnt)) < 0)
+          {
+            // Spurious wakeup
+          }
+        }
+        if (stop)
+        {
+          break;
+        }
+
+        bool notify = false;
+        unsigned short revents = 0;
+        if (rec_ok)
+        {
+          snd_pcm_poll_descriptors_revents(rec_handle, &pfds[rec_pfd_pos],
+                                           rec_pfd_cnt, &revents);
+          if (revents & POLLIN)
+          {
+            rec_ok = captureSamples();
+            notify = true;
+          }
+        }
+        if (play_poll)
+        {
+          revents = 0;
+          snd_pcm_poll_descriptors_revents(play_handle, &pfds[play_pfd_pos],
+                                           play_pfd_cnt, &revents);
+          if (revents & POLLOUT)
+          {
+            play_ok = playbackSamples();
+            notify = true;
+          }
+        }
+        if (notify)
+        {
+          wake(notify_fd);
+        }
+      }
+    }
+
+    static size_t addPollDescriptors(std::vector<pollfd>& pfds,
+                                     snd_pcm_t *pcm_handle)
+    {
+      if (pcm_handle == 0)
+      {
+        return 0;
+      }
+      int nfds = snd_pcm_poll_descriptors_count(pcm_handle);
+      if (nfds <= 0)
+      {
+        return 0;
+      }
+      const size_t pos = pfds.size();
+      pfds.resize(pos + nfds);
+      nfds = snd_pcm_poll_descriptors(pcm_handle, &pfds[pos], nfds);
+      pfds.resize(pos + max(nfds, 0));
+      return max(nfds, 0);
+    }
+
+    bool pcmFailed(snd_pcm_t *pcm_handle)
+    {
+      const auto pcm_state = snd_pcm_state(pcm_handle);
+      if ((pcm_state < 0) || (pcm_state == SND_PCM_STATE_DISCONNECTED))
+      {
+        error = true;
+        return true;
+      }
+      return false;
+    }
+
+    bool captureSamples(void)
+    {
+      if (pcmFailed(rec_handle))
+      {
+        return false;
+      }
+
+      snd_pcm_sframes_t frames = snd_pcm_avail_update(rec_handle);
+      if (frames >= 0)
+      {
+        frames = min(static_cast<size_t>(frames) / rec_block_size,
+                     rt_rec_buf.size() / channels / rec_block_size);
+        frames *= rec_block_size;
+        if (frames == 0)
+        {
+          return true;
+        }
+        frames = snd_pcm_readi(rec_handle, &rt_rec_buf[0], frames);
+      }
+      if (frames < 0)
+      {
+        if (frames == -EPIPE)
+        {
+          dev->rec_xruns++;
+        }
+        if ((snd_pcm_prepare(rec_handle) < 0) ||
+            (snd_pcm_start(rec_handle) < 0))
+        {
+          error = true;
+          return false;
+        }
+        return true;
+      }
+
+      size_t samples = frames * channels;
+      const size_t space = rec_ring.writeAvail() / channels * channels;
+      if (samples > space)
+      {
+        dev->rec_ring_overruns++;
+        samples = space;
+      }
+      rec_ring.write(&rt_rec_buf[0], samples);
+
+      const size_t fill = rec_ring.capacity() - rec_ring.writeAvail();
+      if (fill / channels > dev->rec_ring_max_fill)
+      {
+        dev->rec_ring_max_fill = fill / channels;
+      }
+      return true;
+    }
+
+    bool playbackSamples(void)
+    {
+      if (pcmFailed(play_handle))
+      {
+        return false;
+      }
+
+      const size_t block_samples = play_block_size * channels;
+      for (;;)
+      {
+        snd_pcm_sframes_t space_avail = snd_pcm_avail_update(play_handle);
+        if (space_avail < 0)
+        {
+          if (space_avail == -EPIPE)
+          {
+            dev->play_xruns++;
+          }
+          if (snd_pcm_prepare(play_handle) < 0)
+          {
+            error = true;
+            return false;
+          }
+          continue;
+        }
+        play_hw_avail = space_avail;
+        if (static_cast<size_t>(space_avail) < play_block_size)
+        {
+          return true;
+        }
+
+          // Frames left over from a short write are written before anything
+          // new is taken from the ring buffer so that no audio is lost
+        const bool is_leftover = (play_pending > 0);
+        if (!is_leftover)
+        {
+          size_t blocks = min(
+              static_cast<size_t>(space_avail) / play_block_size,
+              play_ring.readAvail() / block_samples);
+          if (blocks == 0)
+          {
+              // The main loop have not kept up with the playback
+            if (play_active && !underrun_counted)
+            {
+              dev->play_ring_underruns++;
+              underrun_counted = true;
+            }
+            if (!dev->zerofill_on_underflow)
+            {
+              return true;
+            }
+            blocks = 1;
+            memset(&rt_play_buf[0], 0,
+                   block_samples * sizeof(rt_play_buf[0]));
+          }
+          else
+          {
+            play_ring.read(&rt_play_buf[0], blocks * block_samples);
+            underrun_counted = false;
+          }
+          play_pos = 0;
+          play_pending = blocks * play_block_size;
+        }
+
+        const snd_pcm_sframes_t frames_to_write =
+            min(static_cast<size_t>(space_avail), size_t(play_pending));
+        const snd_pcm_sframes_t frames_written =
+            snd_pcm_writei(play_handle, &rt_play_buf[play_pos * channels],
+                           frames_to_write);
+        if (frames_written < 0)
+        {
+          if (frames_written == -EPIPE)
+          {
+            dev->play_xruns++;
+          }
+          if (snd_pcm_prepare(play_handle) < 0)
+          {
+            error = true;
+            return false;
+          }
+          continue;
+        }
+        play_pos += frames_written;
+        play_pending -= frames_written;
+        play_hw_avail = space_avail - frames_written;
+
+          // Wait for more space if the write was short. Otherwise go on
+          // writing as long as there may be more space in the Alsa buffer.
+        if ((play_pending > 0) ||
+            (!is_leftover && (frames_written != space_avail)))
+        {
+          return true;
+        }
+      }
+    }
+};  /* class AudioDeviceAlsa::RtThread */
+
+
 /****************************************************************************
  *
  * Prototypes
@@ -195,7 +644,9 @@ AudioDeviceAlsa::AudioDeviceAlsa(const std::string& dev_name)
   : AudioDevice(dev_name), play_block_size(0), play_block_count(0),
     rec_block_size(0), rec_block_count(0), play_handle(0), 
     rec_handle(0), play_watch(0), rec_watch(0), duplex(false),
-    zerofill_on_underflow(true)
+    zerofill_on_underflow(true), rt_prio(-1), rt_thread(0), play_xruns(0),
+    rec_xruns(0), play_ring_underruns(0), rec_ring_overruns(0),
+    rec_ring_max_fill(0), reported_errors(0)
 {
   assert(AudioDeviceAlsa_creator_registered);
 
@@ -205,6 +656,12 @@ AudioDeviceAlsa::AudioDeviceAlsa(const std::string& dev_name)
     istringstream(zerofill_str) >> zerofill_on_underflow;
   }
 
+  char *rt_prio_str = getenv("ASYNC_AUDIO_ALSA_RT_PRIO");
+  if (rt_prio_str != 0)
+  {
+    istringstream(rt_prio_str) >> rt_prio;
+  }
+
   snd_pcm_t *play, *capture;
 
     // Open the device to check its duplex capability
@@ -254,7 +711,11 @@ bool AudioDeviceAlsa::isFullDuplexCapable(void)
 void AudioDeviceAlsa::audioToWriteAvailable(void)
 {
   //printf("AudioDeviceAlsa::audioToWriteAvailable\n");
-  if (play_watch)
+  if (rt_thread != 0)
+  {
+    rt_thread->fillPlaybackRing();
+  }
+  else if (play_watch)
   {
     play_watch->setEnabled(true);
   }
@@ -263,7 +724,11 @@ void AudioDeviceAlsa::audioToWriteAvailable(void)
 
 void AudioDeviceAlsa::flushSamples(void)
 {
-  if (play_watch)
+  if (rt_thread != 0)
+  {
+    rt_thread->fillPlaybackRing();
+  }
+  else if (play_watch)
   {
     play_watch->setEnabled(true);
   }  
@@ -277,6 +742,11 @@ int AudioDeviceAlsa::samplesToWrite(void) const
     return 0;
   }
 
+  if (rt_thread != 0)
+  {
+    return rt_thread->samplesToWrite();
+  }
+
   int space_avail = snd_pcm_avail_update(play_handle);
   if (space_avail < 0)
   {
@@ -292,6 +762,23 @@ int AudioDeviceAlsa::samplesToWrite(void) const
 } /* AudioDeviceAlsa::samplesToWrite */
 
 
+AudioDeviceAlsa::Stats AudioDeviceAlsa::stats(void) const
+{
+  Stats stats;
+  memset(&stats, 0, sizeof(stats));
+  stats.play_xruns = play_xruns;
+  stats.rec_xruns = rec_xruns;
+  stats.play_ring_underruns = play_ring_underruns;
+  stats.rec_ring_overruns = rec_ring_overruns;
+  stats.rec_ring_max_fill = rec_ring_max_fill;
+  if (rt_thread != 0)
+  {
+    rt_thread->getStats(stats);
+  }
+  return stats;
+} /* AudioDeviceAlsa::stats */
+
+
 
 /****************************************************************************
  *
@@ -327,10 +814,13 @@ bool AudioDeviceAlsa::openDevice(Mode mode)
       return false;
     }
 
-    play_watch = new AlsaWatch(play_handle);
-    play_watch->activity.connect(
-            mem_fun(*this, &AudioDeviceAlsa::writeSpaceAvailable));
-    play_watch->setEnabled(true);
+    if (rt_prio < 0)
+    {
+      play_watch = new AlsaWatch(play_handle);
+      play_watch->activity.connect(
+              mem_fun(*this, &AudioDeviceAlsa::writeSpaceAvailable));
+      play_watch->setEnabled(true);
+    }
 
     if (!startPlayback(play_handle))
     {
@@ -364,9 +854,12 @@ bool AudioDeviceAlsa::openDevice(Mode mode)
       return false;
     }
 
-    rec_watch = new AlsaWatch(rec_handle);
-    rec_watch->activity.connect(
-            mem_fun(*this, &AudioDeviceAlsa::audioReadHandler));
+    if (rt_prio < 0)
+    {
+      rec_watch = new AlsaWatch(rec_handle);
+      rec_watch->activity.connect(
+              mem_fun(*this, &AudioDeviceAlsa::audioReadHandler));
+    }
 
     if (!startCapture(rec_handle))
     {
@@ -376,6 +869,16 @@ bool AudioDeviceAlsa::openDevice(Mode mode)
     }
   }
 
+  if (rt_prio >= 0)
+  {
+    rt_thread = new RtThread(this, play_handle, rec_handle);
+    if (!rt_thread->start(rt_prio))
+    {
+      closeDevice();
+      return false;
+    }
+  }
+
   return true;
 
 } /* AudioDeviceAlsa::openDevice */
@@ -383,6 +886,10 @@ bool AudioDeviceAlsa::openDevice(Mode mode)
 
 void AudioDeviceAlsa::closeDevice(void)
 {
+    // The audio thread must be stopped before the PCM handles are closed
+  delete rt_thread;
+  rt_thread = 0;
+
   if (play_handle != 0)
   {
     snd_pcm_close(play_handle);
@@ -433,6 +940,11 @@ void AudioDeviceAlsa::audioReadHandler(FdWatch *watch, unsigned short revents)
   snd_pcm_sframes_t frames_avail = snd_pcm_avail_update(rec_handle);
   if (frames_avail < 0)
   {
+    if (frames_avail == -EPIPE)
+    {
+      rec_xruns++;
+      reportXruns();
+    }
     if (!startCapture(rec_handle))
     {
       watch->setEnabled(false);
@@ -495,6 +1007,11 @@ void AudioDeviceAlsa::writeSpaceAvailable(FdWatch *watch, unsigned short revents
       // Bail out if there's an error
     if (space_avail < 0)
     {
+      if (space_avail == -EPIPE)
+      {
+        play_xruns++;
+        reportXruns();
+      }
       if (!startPlayback(play_handle))
       {
         setDeviceError();
@@ -820,6 +1337,45 @@ bool AudioDeviceAlsa::startCapture(snd_pcm_t *pcm_handle)
 } /* AudioDeviceAlsa::startCapture */
 
 
+void AudioDeviceAlsa::reportXruns(void)
+{
+  const Stats s = stats();
+  unsigned errors = s.rec_xruns + s.rec_ring_overruns;
+    // When not zero filling, the playback runs dry at the end of each
+    // transmission. That is expected so playback xruns and ring underruns
+    // are only counted, not logged, in that case.
+  if (zerofill_on_underflow)
+  {
+    errors += s.play_xruns + s.play_ring_underruns;
+  }
+  if (errors == reported_errors)
+  {
+    return;
+  }
+  const auto now = std::chrono::steady_clock::now();
+  if ((reported_errors != 0) &&
+      (now - last_report < std::chrono::seconds(XRUN_REPORT_INTERVAL)))
+  {
+    return;
+  }
+  reported_errors = errors;
+  last_report = now;
+
+  cerr << "*** WARNING: Audio xrun on Alsa device \"" << dev_name << "\": "
+       << "playback_xruns=" << s.play_xruns
+       << " capture_xruns=" << s.rec_xruns;
+  if (s.rt_thread)
+  {
+    cerr << " playback_ring_underruns=" << s.play_ring_underruns
+         << " capture_ring_overruns=" << s.rec_ring_overruns
+         << " playback_ring=" << s.play_ring_fill << "/" << s.play_ring_size
+         << " capture_ring_max=" << s.rec_ring_max_fill << "/"
+         << s.rec_ring_size;
+  }
+  cerr << endl;
+} /* AudioDeviceAlsa::reportXruns */
+
+
 /*
  * This file has not been truncated
  */
@@ -38,6 +38,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <alsa/asoundlib.h>
 
+#include <atomic>
+#include <chrono>
+
 
 /****************************************************************************
  *
@@ -113,10 +116,37 @@ This class implements the low level interface to an Alsa audio device. This
 class is not intended to be used by the end user of the Async library. It is
 used by the Async::AudioIO class, which is the Async API frontend for using
 audio in an application.
+
+Normally the Alsa device is serviced from the main loop. If the environment
+variable ASYNC_AUDIO_ALSA_RT_PRIO is set, capture and playback is instead done
+by a separate thread that exchange samples with the main loop through lock
+free ring buffers. Slow main loop callbacks then do not cause xruns, as long
+as the ring buffers do not run empty or full. The value of the environment
+variable is the SCHED_FIFO priority (1-99) to run the thread at. If set to 0
+the thread run with normal scheduling. The playback ring buffer hold as many
+samples as the Alsa buffer so the playback delay may increase by up to the
+same amount.
 */
 class AudioDeviceAlsa : public AudioDevice
 {
   public:
+    /**
+     * @brief Audio I/O statistics
+     */
+    struct Stats
+    {
+      bool      rt_thread;            ///< A real time thread is in use
+      unsigned  play_xruns;           ///< Playback underruns reported by Alsa
+      unsigned  rec_xruns;            ///< Capture overruns reported by Alsa
+      unsigned  play_ring_underruns;  ///< Playback ring ran empty
+      unsigned  rec_ring_overruns;    ///< Capture ring full, samples dropped
+      size_t    play_ring_size;       ///< Playback ring size in frames
+      size_t    play_ring_fill;       ///< Frames in the playback ring
+      size_t    rec_ring_size;        ///< Capture ring size in frames
+      size_t    rec_ring_fill;        ///< Frames in the capture ring
+      size_t    rec_ring_max_fill;    ///< Max frames seen in the capture ring
+    };
+
     /**
      * @brief 	Constuctor
      * @param 	dev_name  The name of the Alsa PCM to associate this object with
@@ -169,6 +199,18 @@ class AudioDeviceAlsa : public AudioDevice
      * been flushed.
      */
     virtual int samplesToWrite(void) const;
+
+    /**
+     * @brief   Get audio I/O statistics
+     * @return  Returns the xrun counters and ring buffer fill levels
+     *
+     * The ring buffer fields are only set when a real time thread is used.
+     * The xrun counters are collected in both modes. New xruns are written
+     * to the log, except for playback xruns and ring underruns when zero
+     * fill on underflow is disabled since the playback then run dry at the
+     * end of each transmission.
+     */
+    Stats stats(void) const;
     
     
   protected:
@@ -186,7 +228,10 @@ class AudioDeviceAlsa : public AudioDevice
 
 
   private:
+    static const int XRUN_REPORT_INTERVAL = 10; // Seconds
+
     class       AlsaWatch;
+    class       RtThread;
     size_t      play_block_size;
     size_t      play_block_count;
     size_t      rec_block_size;
@@ -197,6 +242,15 @@ class AudioDeviceAlsa : public AudioDevice
     AlsaWatch   *rec_watch;
     bool        duplex;
     bool        zerofill_on_underflow;
+    int         rt_prio;
+    RtThread    *rt_thread;
+    std::atomic<unsigned>                 play_xruns;
+    std::atomic<unsigned>                 rec_xruns;
+    std::atomic<unsigned>                 play_ring_underruns;
+    std::atomic<unsigned>                 rec_ring_overruns;
+    std::atomic<size_t>                   rec_ring_max_fill;
+    unsigned                              reported_errors;
+    std::chrono::steady_clock::time_point last_report;
 
     AudioDeviceAlsa(const AudioDeviceAlsa&);
     AudioDeviceAlsa& operator=(const AudioDeviceAlsa&);
@@ -207,6 +261,7 @@ class AudioDeviceAlsa : public AudioDevice
                             size_t &period_size);
     bool startPlayback(snd_pcm_t *pcm_handle);
     bool startCapture(snd_pcm_t *pcm_handle);
+    void reportXruns(void);
     
 };  /* class AudioDeviceAlsa */
 
@@ -347,6 +347,7 @@ bool AudioDeviceOSS::openDevice(Mode mode)
   if ((mode == MODE_RD) || (mode == MODE_RDWR))
   {
     read_watch = new FdWatch(fd, FdWatch::FD_WATCH_RD);
+    read_watch->setTag("Async::AudioDeviceOSS");
     assert(read_watch != 0);
     read_watch->activity.connect(
         mem_fun(*this, &AudioDeviceOSS::audioReadHandler));
@@ -356,6 +357,7 @@ bool AudioDeviceOSS::openDevice(Mode mode)
   if ((mode == MODE_WR) || (mode == MODE_RDWR))
   {
     write_watch = new FdWatch(fd, FdWatch::FD_WATCH_WR);
+    write_watch->setTag("Async::AudioDeviceOSS");
     assert(write_watch != 0);
     write_watch->activity.connect(
       	mem_fun(*this, &AudioDeviceOSS::writeSpaceAvailable));
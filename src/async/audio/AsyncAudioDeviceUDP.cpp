@@ -201,6 +201,7 @@ AudioDeviceUDP::AudioDeviceUDP(const string& dev_name)
 
   read_buf = new int16_t[block_size * channels];
   pace_timer = new Timer(pace_interval, Timer::TYPE_PERIODIC);
+  pace_timer->setTag("Async::AudioDeviceUDP");
   pace_timer->setEnable(false);
   pace_timer->expired.connect(
       sigc::hide(mem_fun(*this, &AudioDeviceUDP::audioWriteHandler)));
@@ -55,6 +55,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "AsyncAudioFifo.h"
+#include "AsyncAudioBlockPool.h"
 
 
 
@@ -124,13 +125,13 @@ AudioFifo::AudioFifo(unsigned fifo_size)
     disable_buffering_when_flushed(false), is_idle(true), input_stopped(false)
 {
   assert(fifo_size > 0);
-  fifo = new float[fifo_size];
+  fifo = AudioBlockPool::allocSamples(fifo_size);
 } /* AudioFifo */
 
 
 AudioFifo::~AudioFifo(void)
 {
-  delete [] fifo;
+  AudioBlockPool::freeSamples(fifo, fifo_size);
 } /* ~AudioFifo */
 
 
@@ -139,9 +140,9 @@ void AudioFifo::setSize(unsigned new_size)
   assert(fifo_size > 0);
   if (new_size != fifo_size)
   {
-    delete [] fifo;
+    AudioBlockPool::freeSamples(fifo, fifo_size);
     fifo_size = new_size;
-    fifo = new float[fifo_size];
+    fifo = AudioBlockPool::allocSamples(fifo_size);
   }
   clear();
 } /* AudioFifo::setSize */
@@ -6,7 +6,7 @@
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2008 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -38,6 +38,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <cstdlib>
 #include <cmath>
 #include <locale>
+#include <vector>
+#include <algorithm>
 
 
 /****************************************************************************
@@ -87,17 +89,172 @@ using namespace Async;
  *
  ****************************************************************************/
 
+namespace {
+  const double SOS_FLOAT_MAX_POLE_RADIUS = 0.98;
+
+  /**
+   * A cascade of second order sections in transposed direct form II.
+   * The samples are converted to the state type and then run through the
+   * sections, two at a time, over a whole block before moving on to the
+   * next pair. The inner loop is short and only touch the coefficients and
+   * state of the two sections.
+   */
+  template <typename T>
+  class SosCascade
+  {
+    public:
+      struct Section
+      {
+        T b0, b1, b2, a1, a2;
+        T z1, z2;
+      };
+
+      SosCascade(void) : gain(1.0) {}
+
+      void clear(void)
+      {
+        sections.clear();
+        gain = 1.0;
+      }
+
+      void setGain(double g) { gain = g; }
+
+      double maxPoleRadius(void) const
+      {
+        double max_r = 0.0;
+        for (size_t i=0; i<sections.size(); ++i)
+        {
+          const double a1 = sections[i].a1;
+          const double a2 = sections[i].a2;
+          const double disc = a1 * a1 - 4.0 * a2;
+          double r = 0.0;
+          if (disc < 0.0)
+          {
+            r = sqrt(a2);
+          }
+          else
+          {
+            r = std::max(fabs(-a1 + sqrt(disc)), fabs(-a1 - sqrt(disc))) / 2.0;
+          }
+          max_r = std::max(max_r, r);
+        }
+        return max_r;
+      }
+
+      void addSection(double b0, double b1, double b2, double a1, double a2)
+      {
+        Section sec = { T(b0), T(b1), T(b2), T(a1), T(a2), T(0), T(0) };
+        sections.push_back(sec);
+      }
+
+      void reset(void)
+      {
+        for (size_t i=0; i<sections.size(); ++i)
+        {
+          sections[i].z1 = sections[i].z2 = T(0);
+        }
+      }
+
+      void process(float *dest, const float *src, int count,
+                   float output_gain)
+      {
+          // The overall gain is applied last, like fidlib do it, so that
+          // the signal level inside the sections is not changed
+        const T g = T(gain * output_gain);
+        while (count > 0)
+        {
+          const int cnt = (count < BLOCK_SIZE) ? count : BLOCK_SIZE;
+          for (int n=0; n<cnt; ++n)
+          {
+            buf[n] = src[n];
+          }
+          size_t i = 0;
+          for (; i+1<sections.size(); i+=2)
+          {
+            processPair(sections[i], sections[i+1], cnt);
+          }
+          if (i < sections.size())
+          {
+            processSection(sections[i], cnt);
+          }
+          for (int n=0; n<cnt; ++n)
+          {
+            dest[n] = g * buf[n];
+          }
+          src += cnt;
+          dest += cnt;
+          count -= cnt;
+        }
+      }
+
+    private:
+      static const int BLOCK_SIZE = 128;
+
+      std::vector<Section> sections;
+      double               gain;
+      T                    buf[BLOCK_SIZE];
+
+      static inline T tick(const Section& sec, T x, T& z1, T& z2)
+      {
+        const T y = sec.b0 * x + z1;
+        z1 = sec.b1 * x - sec.a1 * y + z2;
+        z2 = sec.b2 * x - sec.a2 * y;
+        return y;
+      }
+
+      void processSection(Section& sec, int cnt)
+      {
+        T z1 = sec.z1, z2 = sec.z2;
+        for (int n=0; n<cnt; ++n)
+        {
+          buf[n] = tick(sec, buf[n], z1, z2);
+        }
+        sec.z1 = z1;
+        sec.z2 = z2;
+      }
+
+        // Run two sections with the second one lagging one sample behind so
+        // that the two recursions are independent of each other within a
+        // loop iteration and can execute in parallel in the CPU
+      void processPair(Section& sa, Section& sb, int cnt)
+      {
+        T za1 = sa.z1, za2 = sa.z2;
+        T zb1 = sb.z1, zb2 = sb.z2;
+        T ya = tick(sa, buf[0], za1, za2);
+        for (int n=1; n<cnt; ++n)
+        {
+          const T xa = buf[n];
+          buf[n-1] = tick(sb, ya, zb1, zb2);
+          ya = tick(sa, xa, za1, za2);
+        }
+        buf[cnt-1] = tick(sb, ya, zb1, zb2);
+        sa.z1 = za1;
+        sa.z2 = za2;
+        sb.z1 = zb1;
+        sb.z2 = zb2;
+      }
+  };
+};
+
 namespace Async
 {
   class FidVars
   {
     public:
-      FidFilter 	*ff;
-      FidRun    	*run;
-      FidFunc   	*func;
-      void      	*buf;
-
-      FidVars(void) : ff(0), run(0), func(0), buf(0) {}
+      FidFilter 	          *ff;
+      FidRun    	          *run;
+      FidFunc   	          *func;
+      void      	          *buf;
+      AudioFilter::Engine   engine;
+      SosCascade<double>    sos_double;
+      SosCascade<float>     sos_float;
+
+      FidVars(void)
+        : ff(0), run(0), func(0), buf(0),
+          engine(AudioFilter::ENGINE_FIDLIB) {}
+
+      template <typename T>
+      bool buildSos(SosCascade<T>& sos);
   };
 };
 
@@ -134,14 +291,16 @@ namespace Async
  ****************************************************************************/
 
 AudioFilter::AudioFilter(int sample_rate)
-  : sample_rate(sample_rate), fv(0), output_gain(1.0f)
+  : sample_rate(sample_rate), fv(0), output_gain(1.0f),
+    preferred_engine(ENGINE_SOS_DOUBLE)
 {
 
 } /* AudioFilter::AudioFilter */
 
 
 AudioFilter::AudioFilter(const string &filter_spec, int sample_rate)
-  : sample_rate(sample_rate), fv(0), output_gain(1.0f)
+  : sample_rate(sample_rate), fv(0), output_gain(1.0f),
+    preferred_engine(ENGINE_SOS_DOUBLE)
 {
   if (!parseFilterSpec(filter_spec))
   {
@@ -177,8 +336,7 @@ bool AudioFilter::parseFilterSpec(const std::string &filter_spec)
     deleteFilter();
     return false;
   }
-  fv->run = fid_run_new(fv->ff, &fv->func);
-  fv->buf = fid_run_newbuf(fv->run);
+  setupEngine();
   return true;
 } /* AudioFilter::parseFilterSpec */
 
@@ -191,10 +349,41 @@ void AudioFilter::setOutputGain(float gain_db)
 
 void AudioFilter::reset(void)
 {
-  fid_run_zapbuf(fv->buf);
+  if (fv == 0)
+  {
+    return;
+  }
+  switch (fv->engine)
+  {
+    case ENGINE_SOS_DOUBLE:
+      fv->sos_double.reset();
+      break;
+    case ENGINE_SOS_FLOAT:
+      fv->sos_float.reset();
+      break;
+    case ENGINE_FIDLIB:
+      fid_run_zapbuf(fv->buf);
+      break;
+  }
 } /* AudioFilter::reset */
 
 
+void AudioFilter::setEngine(Engine engine)
+{
+  preferred_engine = engine;
+  if (fv != 0)
+  {
+    setupEngine();
+  }
+} /* AudioFilter::setEngine */
+
+
+AudioFilter::Engine AudioFilter::engine(void) const
+{
+  return (fv != 0) ? fv->engine : preferred_engine;
+} /* AudioFilter::engine */
+
+
 
 /****************************************************************************
  *
@@ -207,9 +396,20 @@ void AudioFilter::processSamples(float *dest, const float *src, int count)
 {
   //cout << "AudioFilter::processSamples: len=" << len << endl;
   
-  for (int i=0; i<count; ++i)
+  switch (fv->engine)
   {
-    dest[i] = output_gain * fv->func(fv->buf, src[i]);
+    case ENGINE_SOS_DOUBLE:
+      fv->sos_double.process(dest, src, count, output_gain);
+      break;
+    case ENGINE_SOS_FLOAT:
+      fv->sos_float.process(dest, src, count, output_gain);
+      break;
+    case ENGINE_FIDLIB:
+      for (int i=0; i<count; ++i)
+      {
+        dest[i] = output_gain * fv->func(fv->buf, src[i]);
+      }
+      break;
   }
 } /* AudioFilter::writeSamples */
 
@@ -226,10 +426,13 @@ void AudioFilter::deleteFilter(void)
 {
   if (fv != 0)
   {
-    if (fv->ff != 0)
+    if (fv->run != 0)
     {
       fid_run_freebuf(fv->buf);
       fid_run_free(fv->run);
+    }
+    if (fv->ff != 0)
+    {
       free(fv->ff);
     }
     delete fv;
@@ -238,6 +441,128 @@ void AudioFilter::deleteFilter(void)
 } /* AudioFilter::deleteFilter */
 
 
+void AudioFilter::setupEngine(void)
+{
+  fv->sos_double.clear();
+  fv->sos_float.clear();
+  fv->engine = ENGINE_FIDLIB;
+  if ((preferred_engine != ENGINE_FIDLIB) && fv->buildSos(fv->sos_double))
+  {
+    fv->engine = ENGINE_SOS_DOUBLE;
+
+      // The rounding errors in a float state grow too large when poles are
+      // close to the unit circle, e.g. in high order narrow band filters,
+      // so keep the double state for such filters
+    if ((preferred_engine == ENGINE_SOS_FLOAT) &&
+        (fv->sos_double.maxPoleRadius() < SOS_FLOAT_MAX_POLE_RADIUS) &&
+        fv->buildSos(fv->sos_float))
+    {
+      fv->sos_double.clear();
+      fv->engine = ENGINE_SOS_FLOAT;
+    }
+  }
+
+  if ((fv->engine == ENGINE_FIDLIB) && (fv->run == 0))
+  {
+    fv->run = fid_run_new(fv->ff, &fv->func);
+    fv->buf = fid_run_newbuf(fv->run);
+  }
+  else if (fv->run != 0)
+  {
+    fid_run_zapbuf(fv->buf);
+  }
+} /* AudioFilter::setupEngine */
+
+
+/*
+ * Convert the list of IIR and FIR coefficient vectors produced by fidlib
+ * into second order sections. The elements are paired up in the same way
+ * as fid_run_new do it, an IIR element optionally followed by an FIR
+ * element. Single coefficient FIR elements are pure gain factors which are
+ * multiplied together and applied after the last section. Elements with more than three
+ * coefficients cannot be converted without factoring the polynomials so
+ * then false is returned and the fidlib interpreter is used instead.
+ */
+template <typename T>
+bool FidVars::buildSos(SosCascade<T>& sos)
+{
+  struct Coeffs { double b0, b1, b2, a1, a2; };
+  std::vector<Coeffs> secs;
+  double gain = 1.0;
+  FidFilter *f = ff;
+  while (f->len != 0)
+  {
+    const FidFilter *iir = 0;
+    const FidFilter *fir = 0;
+    if ((f->typ == 'F') && (f->len == 1))
+    {
+      gain *= f->val[0];
+      f = FFNEXT(f);
+      continue;
+    }
+    if (f->typ == 'F')
+    {
+      fir = f;
+      f = FFNEXT(f);
+    }
+    else if (f->typ == 'I')
+    {
+      iir = f;
+      f = FFNEXT(f);
+      while ((f->typ == 'F') && (f->len == 1))
+      {
+        gain *= f->val[0];
+        f = FFNEXT(f);
+      }
+      if (f->typ == 'F')
+      {
+        fir = f;
+        f = FFNEXT(f);
+      }
+    }
+    else
+    {
+      return false;
+    }
+
+    if (((iir != 0) && (iir->len > 3)) || ((fir != 0) && (fir->len > 3)))
+    {
+      return false;
+    }
+
+      // D.y[n] + E.y[n-1] + F.y[n-2] == x[n] for the IIR part and
+      // y[n] == A.x[n] + B.x[n-1] + C.x[n-2] for the FIR part
+    double a0 = 1.0;
+    Coeffs c = { 1.0, 0.0, 0.0, 0.0, 0.0 };
+    if (iir != 0)
+    {
+      a0 = iir->val[0];
+      c.a1 = (iir->len > 1) ? iir->val[1] / a0 : 0.0;
+      c.a2 = (iir->len > 2) ? iir->val[2] / a0 : 0.0;
+    }
+    if (fir != 0)
+    {
+      c.b0 = fir->val[0];
+      c.b1 = (fir->len > 1) ? fir->val[1] : 0.0;
+      c.b2 = (fir->len > 2) ? fir->val[2] : 0.0;
+    }
+    c.b0 /= a0;
+    c.b1 /= a0;
+    c.b2 /= a0;
+    secs.push_back(c);
+  }
+
+  sos.clear();
+  for (size_t i=0; i<secs.size(); ++i)
+  {
+    const Coeffs& c = secs[i];
+    sos.addSection(c.b0, c.b1, c.b2, c.a1, c.a2);
+  }
+  sos.setGain(gain);
+  return true;
+} /* FidVars::buildSos */
+
+
 
 /*
  * This file has not been truncated
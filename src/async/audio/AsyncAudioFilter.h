@@ -6,7 +6,7 @@
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2008 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -109,10 +109,29 @@ class FidVars;
 @brief	A class for creating a wide range of audio filters
 @author Tobias Blomberg / SM0SVX
 @date   2006-04-23
+
+The filter is specified using a fidlib filter specification string, e.g.
+"BpCh12/-0.1/300-3500". By default the filter produced by fidlib is
+converted to a cascade of second order sections (biquads) which is run on
+whole blocks of samples. That is a lot faster than running the filter
+through the fidlib interpreter one sample at a time. Filter specifications
+that cannot be split into second order sections, like long FIR filters,
+automatically fall back to the fidlib interpreter. The engine to use can be
+chosen using the setEngine function.
 */
 class AudioFilter : public AudioProcessor
 {
   public:
+    /**
+     * @brief The filter engines that can be used to run the filter
+     */
+    typedef enum
+    {
+      ENGINE_SOS_DOUBLE,  ///< Second order sections with double state
+      ENGINE_SOS_FLOAT,   ///< Second order sections with float state
+      ENGINE_FIDLIB       ///< The fidlib filter interpreter
+    } Engine;
+
     /**
      * @brief 	Constuctor
      * @param 	sample_rate The sampling rate
@@ -171,6 +190,27 @@ class AudioFilter : public AudioProcessor
      * @brief Reset the filter state
      */
     void reset(void);
+
+    /**
+     * @brief   Choose which filter engine to use
+     * @param   engine The preferred filter engine
+     *
+     * The default engine is ENGINE_SOS_DOUBLE which give the same result as
+     * the fidlib interpreter. ENGINE_SOS_FLOAT is a bit faster but is less
+     * accurate. It is only used if all poles of the filter are well inside
+     * the unit circle, otherwise ENGINE_SOS_DOUBLE is used. The filter
+     * state is reset when the engine is changed.
+     */
+    void setEngine(Engine engine);
+
+    /**
+     * @brief   Get the filter engine in use
+     * @return  Returns the engine that is used to run the current filter
+     *
+     * This may be ENGINE_FIDLIB even if another engine was chosen if the
+     * current filter specification cannot be run by that engine.
+     */
+    Engine engine(void) const;
     
     
   protected:
@@ -193,10 +233,12 @@ class AudioFilter : public AudioProcessor
     FidVars   	*fv;
     float     	output_gain;
     std::string error_str;
+    Engine      preferred_engine;
     
     AudioFilter(const AudioFilter&);
     AudioFilter& operator=(const AudioFilter&);
     void deleteFilter(void);
+    void setupEngine(void);
 
 };  /* class AudioFilter */
 
@@ -0,0 +1,473 @@
+/**
+@file	 AsyncAudioFirKernel.cpp
+@brief   FIR filter kernels for decimation and interpolation
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-17
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FIR_KERNEL_X86
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define FIR_KERNEL_NEON
+#include <arm_neon.h>
+#endif
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncAudioFirKernel.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+namespace {
+  float dotGeneric(const float *h, const float *x, size_t n)
+  {
+      // Four partial sums to break the dependency chain between the
+      // additions so that the compiler can keep more than one in flight
+    float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+    size_t i = 0;
+    for (; i+4<=n; i+=4)
+    {
+      s0 += h[i] * x[i];
+      s1 += h[i+1] * x[i+1];
+      s2 += h[i+2] * x[i+2];
+      s3 += h[i+3] * x[i+3];
+    }
+    for (; i<n; ++i)
+    {
+      s0 += h[i] * x[i];
+    }
+    return (s0 + s1) + (s2 + s3);
+  }
+
+  complex<float> dotComplexGeneric(const float *h, const complex<float> *x,
+                                   size_t n)
+  {
+    const float *xf = reinterpret_cast<const float *>(x);
+    float re0 = 0.0f, im0 = 0.0f, re1 = 0.0f, im1 = 0.0f;
+    size_t i = 0;
+    for (; i+2<=n; i+=2)
+    {
+      re0 += h[i] * xf[2*i];
+      im0 += h[i] * xf[2*i+1];
+      re1 += h[i+1] * xf[2*i+2];
+      im1 += h[i+1] * xf[2*i+3];
+    }
+    for (; i<n; ++i)
+    {
+      re0 += h[i] * xf[2*i];
+      im0 += h[i] * xf[2*i+1];
+    }
+    return complex<float>(re0 + re1, im0 + im1);
+  }
+
+#ifdef FIR_KERNEL_X86
+  __attribute__((target("sse")))
+  inline float hsumSse(__m128 v)
+  {
+    v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 1));
+    return _mm_cvtss_f32(v);
+  }
+
+  __attribute__((target("sse")))
+  float dotSse(const float *h, const float *x, size_t n)
+  {
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i+8<=n; i+=8)
+    {
+      acc0 = _mm_add_ps(acc0,
+          _mm_mul_ps(_mm_loadu_ps(h+i), _mm_loadu_ps(x+i)));
+      acc1 = _mm_add_ps(acc1,
+          _mm_mul_ps(_mm_loadu_ps(h+i+4), _mm_loadu_ps(x+i+4)));
+    }
+    for (; i+4<=n; i+=4)
+    {
+      acc0 = _mm_add_ps(acc0,
+          _mm_mul_ps(_mm_loadu_ps(h+i), _mm_loadu_ps(x+i)));
+    }
+    float sum = hsumSse(_mm_add_ps(acc0, acc1));
+    for (; i<n; ++i)
+    {
+      sum += h[i] * x[i];
+    }
+    return sum;
+  }
+
+  __attribute__((target("sse")))
+  complex<float> dotComplexSse(const float *h, const complex<float> *x,
+                               size_t n)
+  {
+    const float *xf = reinterpret_cast<const float *>(x);
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i+4<=n; i+=4)
+    {
+        // Duplicate each coefficient so that it lines up with the real and
+        // imaginary parts of the interleaved complex samples
+      __m128 hv = _mm_loadu_ps(h+i);
+      acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_unpacklo_ps(hv, hv),
+                                         _mm_loadu_ps(xf+2*i)));
+      acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_unpackhi_ps(hv, hv),
+                                         _mm_loadu_ps(xf+2*i+4)));
+    }
+    __m128 acc = _mm_add_ps(acc0, acc1);
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    float re = _mm_cvtss_f32(acc);
+    float im = _mm_cvtss_f32(_mm_shuffle_ps(acc, acc, 1));
+    for (; i<n; ++i)
+    {
+      re += h[i] * xf[2*i];
+      im += h[i] * xf[2*i+1];
+    }
+    return complex<float>(re, im);
+  }
+
+  __attribute__((target("avx2,fma")))
+  float dotAvx2(const float *h, const float *x, size_t n)
+  {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i+16<=n; i+=16)
+    {
+      acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(h+i), _mm256_loadu_ps(x+i),
+                             acc0);
+      acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(h+i+8), _mm256_loadu_ps(x+i+8),
+                             acc1);
+    }
+    for (; i+8<=n; i+=8)
+    {
+      acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(h+i), _mm256_loadu_ps(x+i),
+                             acc0);
+    }
+    acc0 = _mm256_add_ps(acc0, acc1);
+    __m128 acc = _mm_add_ps(_mm256_castps256_ps128(acc0),
+                            _mm256_extractf128_ps(acc0, 1));
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+    float sum = _mm_cvtss_f32(acc);
+    for (; i<n; ++i)
+    {
+      sum += h[i] * x[i];
+    }
+    return sum;
+  }
+
+  __attribute__((target("avx2,fma")))
+  complex<float> dotComplexAvx2(const float *h, const complex<float> *x,
+                                size_t n)
+  {
+    const float *xf = reinterpret_cast<const float *>(x);
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i+8<=n; i+=8)
+    {
+        // Duplicate each coefficient so that it lines up with the real and
+        // imaginary parts of the interleaved complex samples
+      __m256 hv = _mm256_loadu_ps(h+i);
+      __m256 lo = _mm256_unpacklo_ps(hv, hv);
+      __m256 hi = _mm256_unpackhi_ps(hv, hv);
+      acc0 = _mm256_fmadd_ps(_mm256_permute2f128_ps(lo, hi, 0x20),
+                             _mm256_loadu_ps(xf+2*i), acc0);
+      acc1 = _mm256_fmadd_ps(_mm256_permute2f128_ps(lo, hi, 0x31),
+                             _mm256_loadu_ps(xf+2*i+8), acc1);
+    }
+    acc0 = _mm256_add_ps(acc0, acc1);
+    __m128 acc = _mm_add_ps(_mm256_castps256_ps128(acc0),
+                            _mm256_extractf128_ps(acc0, 1));
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    float re = _mm_cvtss_f32(acc);
+    float im = _mm_cvtss_f32(_mm_shuffle_ps(acc, acc, 1));
+    for (; i<n; ++i)
+    {
+      re += h[i] * xf[2*i];
+      im += h[i] * xf[2*i+1];
+    }
+    return complex<float>(re, im);
+  }
+#endif /* FIR_KERNEL_X86 */
+
+#ifdef FIR_KERNEL_NEON
+  inline float hsumNeon(float32x4_t v)
+  {
+    float32x2_t s = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+    return vget_lane_f32(vpadd_f32(s, s), 0);
+  }
+
+  float dotNeon(const float *h, const float *x, size_t n)
+  {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i+8<=n; i+=8)
+    {
+      acc0 = vmlaq_f32(acc0, vld1q_f32(h+i), vld1q_f32(x+i));
+      acc1 = vmlaq_f32(acc1, vld1q_f32(h+i+4), vld1q_f32(x+i+4));
+    }
+    for (; i+4<=n; i+=4)
+    {
+      acc0 = vmlaq_f32(acc0, vld1q_f32(h+i), vld1q_f32(x+i));
+    }
+    float sum = hsumNeon(vaddq_f32(acc0, acc1));
+    for (; i<n; ++i)
+    {
+      sum += h[i] * x[i];
+    }
+    return sum;
+  }
+
+  complex<float> dotComplexNeon(const float *h, const complex<float> *x,
+                                size_t n)
+  {
+    const float *xf = reinterpret_cast<const float *>(x);
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i+4<=n; i+=4)
+    {
+        // Duplicate each coefficient so that it lines up with the real and
+        // imaginary parts of the interleaved complex samples
+      float32x4x2_t hv = vzipq_f32(vld1q_f32(h+i), vld1q_f32(h+i));
+      acc0 = vmlaq_f32(acc0, hv.val[0], vld1q_f32(xf+2*i));
+      acc1 = vmlaq_f32(acc1, hv.val[1], vld1q_f32(xf+2*i+4));
+    }
+    float32x4_t acc = vaddq_f32(acc0, acc1);
+    float32x2_t s = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    float re = vget_lane_f32(s, 0);
+    float im = vget_lane_f32(s, 1);
+    for (; i<n; ++i)
+    {
+      re += h[i] * xf[2*i];
+      im += h[i] * xf[2*i+1];
+    }
+    return complex<float>(re, im);
+  }
+#endif /* FIR_KERNEL_NEON */
+
+  struct KernelInfo
+  {
+    const char *name;
+    bool (*supported)(void);
+    float (*dot_real)(const float *h, const float *x, size_t n);
+    complex<float> (*dot_complex)(const float *h, const complex<float> *x,
+                                  size_t n);
+  };
+
+  bool alwaysSupported(void) { return true; }
+
+#ifdef FIR_KERNEL_X86
+  bool avx2Supported(void)
+  {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  }
+
+  bool sseSupported(void)
+  {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse");
+  }
+#endif
+
+    // Ordered from the fastest to the slowest implementation
+  const KernelInfo kernels[] = {
+#ifdef FIR_KERNEL_X86
+    { "avx2", avx2Supported, dotAvx2, dotComplexAvx2 },
+    { "sse", sseSupported, dotSse, dotComplexSse },
+#endif
+#ifdef FIR_KERNEL_NEON
+    { "neon", alwaysSupported, dotNeon, dotComplexNeon },
+#endif
+    { "generic", alwaysSupported, dotGeneric, dotComplexGeneric }
+  };
+  const size_t num_kernels = sizeof(kernels) / sizeof(*kernels);
+
+  const KernelInfo *findKernel(const std::string& name)
+  {
+    for (size_t i=0; i<num_kernels; ++i)
+    {
+      if ((name == kernels[i].name) && kernels[i].supported())
+      {
+        return &kernels[i];
+      }
+    }
+    return 0;
+  }
+};
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+std::vector<std::string> FirKernel::implementations(void)
+{
+  std::vector<std::string> names;
+  for (size_t i=0; i<num_kernels; ++i)
+  {
+    if (kernels[i].supported())
+    {
+      names.push_back(kernels[i].name);
+    }
+  }
+  return names;
+} /* FirKernel::implementations */
+
+
+bool FirKernel::setImplementation(const std::string& name)
+{
+  const KernelInfo *kernel = findKernel(name);
+  if (kernel == 0)
+  {
+    return false;
+  }
+  Impl& i = impl();
+  i.name = kernel->name;
+  i.dot_real = kernel->dot_real;
+  i.dot_complex = kernel->dot_complex;
+  return true;
+} /* FirKernel::setImplementation */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+FirKernel::Impl& FirKernel::impl(void)
+{
+  static Impl i = []() {
+    const KernelInfo *kernel = 0;
+    const char *env = getenv("ASYNC_FIR_KERNEL");
+    if (env != 0)
+    {
+      kernel = findKernel(env);
+    }
+    for (size_t k=0; (kernel == 0) && (k<num_kernels); ++k)
+    {
+      if (kernels[k].supported())
+      {
+        kernel = &kernels[k];
+      }
+    }
+    Impl impl = { kernel->name, kernel->dot_real, kernel->dot_complex };
+    return impl;
+  }();
+  return i;
+} /* FirKernel::impl */
+
+
+
+/*
+ * This file has not been truncated
+ */
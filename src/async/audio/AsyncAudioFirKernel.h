@@ -0,0 +1,502 @@
+/**
+@file	 AsyncAudioFirKernel.h
+@brief   FIR filter kernels for decimation and interpolation
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-17
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+#ifndef ASYNC_AUDIO_FIR_KERNEL_INCLUDED
+#define ASYNC_AUDIO_FIR_KERNEL_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cassert>
+#include <complex>
+#include <string>
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncAudioBlockPool.h>
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	Dot product kernels used by the FIR filter classes
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+The dot product is where almost all time is spent in a FIR filter. This class
+contain a number of implementations of it and choose the fastest one that the
+CPU support when first used. On x86 an AVX2/FMA version is used if available
+and an SSE version otherwise. On ARM the NEON version is used if the library
+was compiled with NEON support. A plain C++ version is used on all other
+platforms.
+
+The implementation can be forced by setting the environment variable
+ASYNC_FIR_KERNEL to one of the names returned by the implementations
+function, which is mostly useful for testing and benchmarking.
+*/
+class FirKernel
+{
+  public:
+    /**
+     * @brief 	Calculate the dot product of two float vectors
+     * @param 	h The filter coefficients
+     * @param 	x The samples
+     * @param 	n The number of elements in both vectors
+     * @return	Returns the sum of h[i] * x[i] for all i
+     */
+    static float dot(const float *h, const float *x, size_t n)
+    {
+      return impl().dot_real(h, x, n);
+    }
+
+    /**
+     * @brief 	Calculate the dot product of real coefficients and complex data
+     * @param 	h The filter coefficients
+     * @param 	x The complex samples
+     * @param 	n The number of elements in both vectors
+     * @return	Returns the sum of h[i] * x[i] for all i
+     */
+    static std::complex<float> dot(const float *h,
+                                   const std::complex<float> *x, size_t n)
+    {
+      return impl().dot_complex(h, x, n);
+    }
+
+    /**
+     * @brief 	Get the name of the implementation in use
+     * @return	Returns a name like "avx2", "sse", "neon" or "generic"
+     */
+    static const char *implementation(void) { return impl().name; }
+
+    /**
+     * @brief 	Get the names of the implementations usable on this CPU
+     * @return	Returns a list of implementation names, the best one first
+     */
+    static std::vector<std::string> implementations(void);
+
+    /**
+     * @brief 	Choose which implementation to use
+     * @param 	name The name of the implementation
+     * @return	Returns \em true on success or \em false if the named
+     *          implementation is not usable on this CPU
+     *
+     * This function should only be called before any audio processing is
+     * started since the dot product functions are not protected by a lock.
+     */
+    static bool setImplementation(const std::string& name);
+
+  private:
+    struct Impl
+    {
+      const char *name;
+      float (*dot_real)(const float *h, const float *x, size_t n);
+      std::complex<float> (*dot_complex)(const float *h,
+                                         const std::complex<float> *x,
+                                         size_t n);
+    };
+
+    static Impl& impl(void);
+
+};  /* class FirKernel */
+
+
+/**
+@brief	A FIR filter delay line
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+A delay line that hold the last N samples written to it in a contiguous
+array, newest sample first, so that it can be used directly in a dot product
+with the filter coefficients. The samples are stored twice in a buffer of
+double length so adding a sample is just two writes instead of moving the
+whole delay line.
+*/
+template <typename T>
+class FirDelayLine
+{
+  public:
+    /**
+     * @brief 	Constructor
+     * @param 	len The length of the delay line
+     */
+    explicit FirDelayLine(size_t len=0) : m_len(0), m_pos(0)
+    {
+      resize(len);
+    }
+
+    /**
+     * @brief 	Set the length of the delay line
+     * @param 	len The new length of the delay line
+     *
+     * All samples in the delay line are cleared.
+     */
+    void resize(size_t len)
+    {
+      m_len = len;
+      m_pos = 0;
+      m_buf.assign(2 * len, T());
+    }
+
+    /**
+     * @brief 	Clear all samples in the delay line
+     */
+    void reset(void)
+    {
+      m_pos = 0;
+      m_buf.assign(m_buf.size(), T());
+    }
+
+    /**
+     * @brief 	Get the length of the delay line
+     * @return	Returns the length of the delay line
+     */
+    size_t size(void) const { return m_len; }
+
+    /**
+     * @brief 	Add a sample to the delay line, discarding the oldest one
+     * @param 	sample The sample to add
+     */
+    void push(const T& sample)
+    {
+      assert(m_len > 0);
+      if (m_pos == 0)
+      {
+        m_pos = m_len;
+      }
+      --m_pos;
+      m_buf[m_pos] = sample;
+      m_buf[m_pos + m_len] = sample;
+    }
+
+    /**
+     * @brief 	Get the samples in the delay line
+     * @return	Returns a pointer to size() samples, newest first
+     */
+    const T *data(void) const { return &m_buf[m_pos]; }
+
+  private:
+    std::vector<T, AudioBlockAllocator<T> > m_buf;
+    size_t          m_len;
+    size_t          m_pos;
+
+};  /* class FirDelayLine */
+
+
+/**
+@brief	A FIR decimation filter
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+Lowpass filter and decimate a stream of samples by an integer factor. Only
+the samples that are kept after the decimation are calculated so each output
+sample cost one dot product over all filter taps, for every M input samples.
+The samples may be real (float) or complex (std::complex<float>) while the
+filter coefficients always are real.
+*/
+template <typename T>
+class FirDecimator
+{
+  public:
+    /**
+     * @brief 	Default constructor
+     *
+     * The setParams function must be called before the filter is used.
+     */
+    FirDecimator(void) : m_factor(1) {}
+
+    /**
+     * @brief 	Constructor
+     * @param 	factor The decimation factor
+     * @param 	coeff  The filter coefficients
+     * @param 	taps   The number of filter coefficients
+     */
+    FirDecimator(int factor, const float *coeff, int taps) : m_factor(1)
+    {
+      setParams(factor, coeff, taps);
+    }
+
+    /**
+     * @brief 	Set the decimation factor and filter coefficients
+     * @param 	factor The decimation factor
+     * @param 	coeff  The filter coefficients
+     * @param 	taps   The number of filter coefficients
+     *
+     * The gain is reset to 1.0 and the delay line is cleared.
+     */
+    void setParams(int factor, const float *coeff, int taps)
+    {
+      assert((factor > 0) && (taps >= factor));
+      m_factor = factor;
+      m_set_coeff.assign(coeff, coeff + taps);
+      m_coeff = m_set_coeff;
+      m_z.resize(taps);
+    }
+
+    /**
+     * @brief 	Get the decimation factor
+     * @return	Returns the decimation factor
+     */
+    int factor(void) const { return m_factor; }
+
+    /**
+     * @brief 	Get the number of filter taps
+     * @return	Returns the number of filter taps
+     */
+    int taps(void) const { return m_coeff.size(); }
+
+    /**
+     * @brief 	Set the gain of the filter
+     * @param 	gain The linear gain factor
+     *
+     * The gain is applied to the filter coefficients set with setParams.
+     */
+    void setGain(float gain)
+    {
+      for (size_t i=0; i<m_coeff.size(); ++i)
+      {
+        m_coeff[i] = gain * m_set_coeff[i];
+      }
+    }
+
+    /**
+     * @brief 	Clear the delay line
+     */
+    void reset(void) { m_z.reset(); }
+
+    /**
+     * @brief 	Filter and decimate a block of samples
+     * @param 	dest  Destination buffer, at least count / factor() samples
+     * @param 	src   Source buffer
+     * @param 	count Number of samples in the source buffer
+     * @return	Returns the number of samples written to the destination
+     *
+     * The number of samples must be a multiple of the decimation factor.
+     */
+    size_t process(T *dest, const T *src, size_t count)
+    {
+      assert(count % m_factor == 0);
+      const size_t num_out = count / m_factor;
+      for (size_t i=0; i<num_out; ++i)
+      {
+        for (int j=0; j<m_factor; ++j)
+        {
+          m_z.push(*src++);
+        }
+        *dest++ = FirKernel::dot(m_coeff.data(), m_z.data(), m_coeff.size());
+      }
+      return num_out;
+    }
+
+  private:
+    int                 m_factor;
+    std::vector<float>  m_set_coeff;
+    std::vector<float>  m_coeff;
+    FirDelayLine<T>     m_z;
+
+};  /* class FirDecimator */
+
+
+/**
+@brief	A polyphase FIR interpolation filter
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+Increase the sample rate of a stream of samples by an integer factor L and
+lowpass filter the result. The filter is split up into L polyphase filters
+so that the zero samples that are inserted when increasing the sample rate
+never have to be multiplied. The coefficients for each phase are stored
+contiguously so that each output sample is one dot product over
+taps / L coefficients. If the number of taps is not a multiple of L the
+filter is padded with zero coefficients. The output is scaled by L to
+compensate for the inserted zero samples.
+*/
+template <typename T>
+class FirInterpolator
+{
+  public:
+    /**
+     * @brief 	Default constructor
+     *
+     * The setParams function must be called before the filter is used.
+     */
+    FirInterpolator(void) : m_factor(1), m_phase_len(0) {}
+
+    /**
+     * @brief 	Constructor
+     * @param 	factor The interpolation factor
+     * @param 	coeff  The filter coefficients
+     * @param 	taps   The number of filter coefficients
+     */
+    FirInterpolator(int factor, const float *coeff, int taps)
+      : m_factor(1), m_phase_len(0)
+    {
+      setParams(factor, coeff, taps);
+    }
+
+    /**
+     * @brief 	Set the interpolation factor and filter coefficients
+     * @param 	factor The interpolation factor
+     * @param 	coeff  The filter coefficients
+     * @param 	taps   The number of filter coefficients
+     *
+     * The delay line is cleared.
+     */
+    void setParams(int factor, const float *coeff, int taps)
+    {
+      assert((factor > 0) && (taps > 0));
+      m_factor = factor;
+      m_phase_len = (taps + factor - 1) / factor;
+      m_coeff.assign(m_factor * m_phase_len, 0.0f);
+      for (int phase=0; phase<m_factor; ++phase)
+      {
+        for (int tap=0; tap<m_phase_len; ++tap)
+        {
+          const int idx = phase + tap * m_factor;
+          if (idx < taps)
+          {
+            m_coeff[phase * m_phase_len + tap] = m_factor * coeff[idx];
+          }
+        }
+      }
+      m_z.resize(m_phase_len);
+    }
+
+    /**
+     * @brief 	Get the interpolation factor
+     * @return	Returns the interpolation factor
+     */
+    int factor(void) const { return m_factor; }
+
+    /**
+     * @brief 	Clear the delay line
+     */
+    void reset(void) { m_z.reset(); }
+
+    /**
+     * @brief 	Interpolate and filter a block of samples
+     * @param 	dest  Destination buffer, at least count * factor() samples
+     * @param 	src   Source buffer
+     * @param 	count Number of samples in the source buffer
+     * @return	Returns the number of samples written to the destination
+     */
+    size_t process(T *dest, const T *src, size_t count)
+    {
+      for (size_t i=0; i<count; ++i)
+      {
+        m_z.push(*src++);
+        const float *h = m_coeff.data();
+        for (int phase=0; phase<m_factor; ++phase)
+        {
+          *dest++ = FirKernel::dot(h, m_z.data(), m_phase_len);
+          h += m_phase_len;
+        }
+      }
+      return count * m_factor;
+    }
+
+  private:
+    int                 m_factor;
+    int                 m_phase_len;
+    std::vector<float>  m_coeff;
+    FirDelayLine<T>     m_z;
+
+};  /* class FirInterpolator */
+
+
+} /* namespace */
+
+#endif /* ASYNC_AUDIO_FIR_KERNEL_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -55,6 +55,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "AsyncAudioJitterFifo.h"
+#include "AsyncAudioBlockPool.h"
 
 
 
@@ -122,13 +123,13 @@ AudioJitterFifo::AudioJitterFifo(unsigned fifo_size)
     output_stopped(false), prebuf(true), is_flushing(false)
 {
   assert(fifo_size > 0);
-  fifo = new float[fifo_size];
+  fifo = AudioBlockPool::allocSamples(fifo_size);
 } /* AudioJitterFifo */
 
 
 AudioJitterFifo::~AudioJitterFifo(void)
 {
-  delete [] fifo;
+  AudioBlockPool::freeSamples(fifo, fifo_size);
 } /* ~AudioJitterFifo */
 
 
@@ -137,9 +138,9 @@ void AudioJitterFifo::setSize(unsigned new_size)
   assert(fifo_size > 0);
   if (new_size != fifo_size)
   {
-    delete [] fifo;
+    AudioBlockPool::freeSamples(fifo, fifo_size);
     fifo_size = new_size;
-    fifo = new float[fifo_size];
+    fifo = AudioBlockPool::allocSamples(fifo_size);
   }
   clear();
 } /* AudioJitterFifo::setSize */
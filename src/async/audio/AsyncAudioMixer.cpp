@@ -34,6 +34,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <algorithm>
 #include <cstring>
+#include <cmath>
 
 
 /****************************************************************************
@@ -88,7 +89,8 @@ class Async::AudioMixer::MixerSrc : public AudioSink
     static const int FIFO_SIZE = AudioMixer::OUTBUF_SIZE;
     
     MixerSrc(AudioMixer *mixer)
-      : fifo(FIFO_SIZE), mixer(mixer), is_flushed(true), do_flush(false)
+      : gain(1.0f), duck_gain(1.0f), fifo(FIFO_SIZE), mixer(mixer),
+        is_flushed(true), do_flush(false)
     {
       AudioSink::setHandler(&fifo);
       fifo.registerSink(&reader);
@@ -99,8 +101,9 @@ class Async::AudioMixer::MixerSrc : public AudioSink
       //printf("Async::AudioMixer::MixerSrc::writeSamples: count=%d\n", count);
       is_flushed = false;
       do_flush = false;
+      int ret = fifo.writeSamples(samples, count);
       mixer->setAudioAvailable();
-      return fifo.writeSamples(samples, count);
+      return ret;
     }
     
     void flushSamples(void)
@@ -143,6 +146,9 @@ class Async::AudioMixer::MixerSrc : public AudioSink
     }
     
     unsigned samplesInFifo(void) const { return fifo.samplesInFifo(); }
+
+    float gain;
+    float duck_gain;
     
   private:
     AudioFifo 	fifo;
@@ -162,6 +168,26 @@ class Async::AudioMixer::MixerSrc : public AudioSink
  *
  ****************************************************************************/
 
+namespace {
+    // Written so that the compiler can vectorize the loop (-O3 by default)
+  void mixAdd(float * __restrict dest, const float * __restrict src,
+              float gain, unsigned count)
+  {
+    for (unsigned i=0; i<count; ++i)
+    {
+      dest[i] += gain * src[i];
+    }
+  }
+
+  void mixScale(float * __restrict dest, float gain, unsigned count)
+  {
+    for (unsigned i=0; i<count; ++i)
+    {
+      dest[i] *= gain;
+    }
+  }
+};
+
 
 
 /****************************************************************************
@@ -189,8 +215,10 @@ class Async::AudioMixer::MixerSrc : public AudioSink
 
 AudioMixer::AudioMixer(void)
   : output_timer(0, Timer::TYPE_ONESHOT, false), outbuf_pos(0),
-    outbuf_cnt(0), is_flushed(true), output_stopped(false)
+    outbuf_cnt(0), is_flushed(true), output_stopped(false),
+    sync_output(false), in_output_handler(false)
 {
+  output_timer.setTag("Async::AudioMixer");
   output_timer.expired.connect(mem_fun(*this, &AudioMixer::outputHandler));
 } /* AudioMixer::AudioMixer */
 
@@ -212,9 +240,34 @@ void AudioMixer::addSource(AudioSource *source)
   //mixer_src->setOverwrite(false);
   mixer_src->registerSource(source);
   sources.push_back(mixer_src);
+  active_sources.reserve(sources.size());
 } /* AudioMixer::addSource */
 
 
+bool AudioMixer::setSourceGain(AudioSource *source, float gain_db)
+{
+  MixerSrc *mixer_src = findSource(source);
+  if (mixer_src == 0)
+  {
+    return false;
+  }
+  mixer_src->gain = powf(10, gain_db / 20);
+  return true;
+} /* AudioMixer::setSourceGain */
+
+
+bool AudioMixer::setSourceDucking(AudioSource *source, float gain_db)
+{
+  MixerSrc *mixer_src = findSource(source);
+  if (mixer_src == 0)
+  {
+    return false;
+  }
+  mixer_src->duck_gain = powf(10, gain_db / 20);
+  return true;
+} /* AudioMixer::setSourceDucking */
+
+
 void AudioMixer::resumeOutput(void)
 {
   //printf("AudioMixer::resumeOutput\n");
@@ -265,7 +318,14 @@ void AudioMixer::allSamplesFlushed(void)
  */
 void AudioMixer::setAudioAvailable(void)
 {
-  output_timer.setEnable(true);
+  if (sync_output && !in_output_handler)
+  {
+    outputHandler(0);
+  }
+  else
+  {
+    output_timer.setEnable(true);
+  }
 } /* AudioMixer::setAudioAvailable */
 
 
@@ -283,7 +343,7 @@ void AudioMixer::setAudioAvailable(void)
  */
 void AudioMixer::flushSamples(void)
 {
-  output_timer.setEnable(true);
+  setAudioAvailable();
 } /* AudioMixer::flushSamples */
 
 
@@ -307,6 +367,12 @@ void AudioMixer::outputHandler(Timer *t)
   {
     return;
   }
+
+    // Sources may write more samples while we read from them. In
+    // synchronous mode those writes fall back to the timer so that this
+    // function is not reentered from a source.
+  const bool was_in_output_handler = in_output_handler;
+  in_output_handler = true;
   
   unsigned samples_written;
   do
@@ -327,11 +393,13 @@ void AudioMixer::outputHandler(Timer *t)
     {
       	// Calculate the maximum number of samples we can read from the FIFOs
       unsigned samples_to_read = MixerSrc::FIFO_SIZE+1;
+      active_sources.clear();
       list<MixerSrc *>::iterator it;
       for (it = sources.begin(); it != sources.end(); ++it)
       {
 	if ((*it)->isActive())
 	{
+	  active_sources.push_back(*it);
 	  samples_to_read = min(samples_to_read, (*it)->samplesInFifo());
 	}
       }
@@ -351,21 +419,36 @@ void AudioMixer::outputHandler(Timer *t)
 	break;
       }
 
-      	// Fill the output buffer with samples from all active FIFOs
-      memset(outbuf, 0, sizeof(outbuf));
-      float tmp[OUTBUF_SIZE];
-      for (it = sources.begin(); it != sources.end(); ++it)
+      	// Mix all active FIFOs into the output buffer. The first source is
+      	// read directly into the output buffer and the rest are added to it.
+      for (size_t i=0; i<active_sources.size(); ++i)
       {
-	if ((*it)->isActive())
-	{
-	  unsigned samples_read = (*it)->readSamples(tmp, samples_to_read);
-	  assert(samples_read == samples_to_read);
-
-	  for (unsigned i=0; i<samples_to_read; ++i)
-	  {
-      	    outbuf[i] += tmp[i];
-	  }
-	}
+        MixerSrc *src = active_sources[i];
+        float gain = src->gain;
+        for (size_t j=0; j<active_sources.size(); ++j)
+        {
+          if (j != i)
+          {
+            gain *= active_sources[j]->duck_gain;
+          }
+        }
+
+        float *buf = (i == 0) ? outbuf : tmpbuf;
+        unsigned samples_read = src->readSamples(buf, samples_to_read);
+        assert(samples_read == samples_to_read);
+        (void)samples_read;
+
+        if (i == 0)
+        {
+          if (gain != 1.0f)
+          {
+            mixScale(outbuf, gain, samples_to_read);
+          }
+        }
+        else
+        {
+          mixAdd(outbuf, tmpbuf, gain, samples_to_read);
+        }
       }
 
       outbuf_pos = 0;
@@ -374,6 +457,7 @@ void AudioMixer::outputHandler(Timer *t)
   } while (samples_written > 0);
   
   output_stopped = (samples_written == 0);
+  in_output_handler = was_in_output_handler;
   
 } /* AudioMixer::outputHandler */
 
@@ -401,6 +485,20 @@ void AudioMixer::checkFlush(void)
 } /* AudioMixer::checkFlush */
 
 
+AudioMixer::MixerSrc *AudioMixer::findSource(AudioSource *source)
+{
+  list<MixerSrc *>::iterator it;
+  for (it = sources.begin(); it != sources.end(); ++it)
+  {
+    if ((*it)->source() == source)
+    {
+      return *it;
+    }
+  }
+  return 0;
+} /* AudioMixer::findSource */
+
+
 
 
 
@@ -36,6 +36,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <list>
+#include <vector>
 
 
 /****************************************************************************
@@ -110,6 +111,17 @@ namespace Async
 @date   2007-10-05
 
 This class is used to mix audio streams together.
+
+Each source can be given a gain using setSourceGain. A source can also be
+set up to duck the other sources using setSourceDucking, e.g. so that
+announcements are attenuated while there is normal audio being transmitted.
+
+By default the mixing is deferred to a zero length timer so that all sources
+get a chance to write their samples before the mixing is done. When
+synchronous output is enabled using setSynchronousOutput, the mixed samples
+are instead written to the sink directly when the last active source write
+its samples. That remove one main loop iteration of latency and the timer
+overhead for each block of samples.
 */
 class AudioMixer : public sigc::trackable, public Async::AudioSource
 {
@@ -130,6 +142,44 @@ class AudioMixer : public sigc::trackable, public Async::AudioSource
      */
     void addSource(AudioSource *source);
 
+    /**
+     * @brief 	Set the gain for a source
+     * @param 	source  A source previously added using addSource
+     * @param 	gain_db The gain given in dB
+     * @return	Returns \em true on success or \em false if the source is
+     *          not added to this mixer
+     */
+    bool setSourceGain(AudioSource *source, float gain_db);
+
+    /**
+     * @brief 	Set the ducking gain for a source
+     * @param 	source  A source previously added using addSource
+     * @param 	gain_db The gain given in dB
+     * @return	Returns \em true on success or \em false if the source is
+     *          not added to this mixer
+     *
+     * While the given source is active, all other sources are attenuated by
+     * the given gain, in addition to their own gain. Set the gain to 0 dB to
+     * disable ducking for the source.
+     */
+    bool setSourceDucking(AudioSource *source, float gain_db);
+
+    /**
+     * @brief 	Enable or disable synchronous output
+     * @param 	enable Set to \em true to enable synchronous output
+     *
+     * When enabled, samples are mixed and written to the sink directly from
+     * the writeSamples call of the source that complete a block, instead of
+     * from a zero length timer.
+     */
+    void setSynchronousOutput(bool enable) { sync_output = enable; }
+
+    /**
+     * @brief 	Check if synchronous output is enabled
+     * @return	Returns \em true if synchronous output is enabled
+     */
+    bool synchronousOutput(void) const { return sync_output; }
+
     /**
      * @brief Resume audio output to the sink
      * 
@@ -157,12 +207,16 @@ class AudioMixer : public sigc::trackable, public Async::AudioSource
     static const int OUTBUF_SIZE = 256;
     
     std::list<MixerSrc *> sources;
+    std::vector<MixerSrc *> active_sources;
     Timer     	      	  output_timer;
     float     	      	  outbuf[OUTBUF_SIZE];
+    float     	      	  tmpbuf[OUTBUF_SIZE];
     unsigned       	  outbuf_pos;
     unsigned  	      	  outbuf_cnt;
     bool      	      	  is_flushed;
     bool      	      	  output_stopped;
+    bool      	      	  sync_output;
+    bool      	      	  in_output_handler;
     
     AudioMixer(const AudioMixer&);
     AudioMixer& operator=(const AudioMixer&);
@@ -171,6 +225,7 @@ class AudioMixer : public sigc::trackable, public Async::AudioSource
     void flushSamples(void);
     void outputHandler(Timer *t);
     void checkFlush(void);
+    MixerSrc *findSource(AudioSource *source);
 
     friend class MixerSrc;
     
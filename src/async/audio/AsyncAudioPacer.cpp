@@ -33,10 +33,18 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef HAS_TIMERFD_SUPPORT
+#include <sys/timerfd.h>
+#endif
 
 #include <algorithm>
 #include <cstring>
 #include <cassert>
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
 
 
 /****************************************************************************
@@ -46,6 +54,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <AsyncTimer.h>
+#include <AsyncFdWatch.h>
 
 
 /****************************************************************************
@@ -55,6 +64,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "AsyncAudioPacer.h"
+#include "AsyncAudioBlockPool.h"
 
 
 
@@ -91,6 +101,8 @@ using namespace Async;
  *
  ****************************************************************************/
 
+static int64_t monotonicNs(void);
+
 
 
 /****************************************************************************
@@ -119,31 +131,44 @@ using namespace Async;
 
 AudioPacer::AudioPacer(int sample_rate, int block_size, int prebuf_time)
   : sample_rate(sample_rate), buf_size(block_size), prebuf_time(prebuf_time),
-    buf_pos(0), pace_timer(0), do_flush(false), input_stopped(false)
+    buf_pos(0), pace_timer(0), do_flush(false), input_stopped(false),
+    mode(PACING_TIMER), timer_fd(-1), timer_watch(0), pacing(false),
+    pace_start(0), pace_blocks(0), last_tick(0), lateness_sum_us(0)
 {
   assert(sample_rate > 0);
   assert(block_size > 0);
   assert(prebuf_time >= 0);
   
-  buf = new float[buf_size];
+  buf = AudioBlockPool::allocSamples(buf_size);
   prebuf_samples = prebuf_time * sample_rate / 1000;
   
   pace_timer = new Timer(buf_size * 1000 / sample_rate,
        	      	      	 Timer::TYPE_PERIODIC);
+  pace_timer->setTag("Async::AudioPacer");
   pace_timer->expired.connect(mem_fun(*this, &AudioPacer::outputNextBlock));
   
+  pacing = true;
+  pace_start = last_tick = monotonicNs();
+  
   if (prebuf_samples > 0)
   {
-    pace_timer->setEnable(false);
+    setPacing(false);
   }
+
+  resetStats();
   
 } /* AudioPacer::AudioPacer */
 
 
 AudioPacer::~AudioPacer(void)
 {
+  delete timer_watch;
+  if (timer_fd >= 0)
+  {
+    close(timer_fd);
+  }
   delete pace_timer;
-  delete [] buf;
+  AudioBlockPool::freeSamples(buf, buf_size);
 } /* AudioPacer::~AudioPacer */
 
 
@@ -175,7 +200,7 @@ int AudioPacer::writeSamples(const float *samples, int count)
 	samples_written += writeSamples(samples + samples_written,
 	      	      	      	      	samples_left);
       }
-      pace_timer->setEnable(true);
+      setPacing(true);
     }
     else
     {
@@ -192,9 +217,9 @@ int AudioPacer::writeSamples(const float *samples, int count)
     memcpy(buf + buf_pos, samples, samples_written * sizeof(*buf));
     buf_pos += samples_written;
     
-    if (!pace_timer->isEnabled())
+    if (!isPacing())
     {
-      pace_timer->setEnable(true);
+      setPacing(true);
     }
   }
   
@@ -224,10 +249,56 @@ void AudioPacer::resumeOutput(void)
 {
   if (prebuf_samples <= 0)
   {
-    pace_timer->setEnable(true);
+    setPacing(true);
     outputNextBlock();
   }
 } /* AudioPacer::resumeOutput */
+
+
+void AudioPacer::setPacingMode(PacingMode new_mode)
+{
+  if (new_mode == mode)
+  {
+    return;
+  }
+
+#ifdef HAS_TIMERFD_SUPPORT
+  if ((new_mode == PACING_DEADLINE) && (timer_fd < 0))
+  {
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_fd < 0)
+    {
+      cerr << "*** WARNING: Could not create timerfd for audio pacing: "
+           << strerror(errno) << ". Falling back to timer pacing." << endl;
+      return;
+    }
+    timer_watch = new FdWatch(timer_fd, FdWatch::FD_WATCH_RD);
+    timer_watch->setTag("Async::AudioPacer");
+    timer_watch->setEnabled(false);
+    timer_watch->activity.connect(
+        mem_fun(*this, &AudioPacer::deadlineExpired));
+  }
+#else
+  if (new_mode == PACING_DEADLINE)
+  {
+    return;
+  }
+#endif
+
+  bool was_pacing = isPacing();
+  setPacing(false);
+  mode = new_mode;
+  m_stats.mode = mode;
+  setPacing(was_pacing);
+} /* AudioPacer::setPacingMode */
+
+
+void AudioPacer::resetStats(void)
+{
+  m_stats = Stats();
+  m_stats.mode = mode;
+  lateness_sum_us = 0;
+} /* AudioPacer::resetStats */
     
 
 
@@ -257,9 +328,17 @@ void AudioPacer::allSamplesFlushed(void)
 
 void AudioPacer::outputNextBlock(Timer *t)
 {
+  if (t != 0)
+  {
+    int64_t now = monotonicNs();
+    pace_blocks += 1;
+    updateStats(now, last_tick + 1000000LL * t->timeout());
+    last_tick = now;
+  }
+
   if (buf_pos < buf_size)
   {
-    pace_timer->setEnable(false);
+    setPacing(false);
     prebuf_samples = prebuf_time * sample_rate / 1000;
   }
   
@@ -291,7 +370,7 @@ void AudioPacer::outputNextBlock(Timer *t)
   
   if (samples_written == 0)
   {
-    pace_timer->setEnable(false);
+    setPacing(false);
   }
   
   if (input_stopped && (buf_pos < buf_size))
@@ -308,6 +387,163 @@ void AudioPacer::outputNextBlock(Timer *t)
 } /* AudioPacer::outputNextBlock */
 
 
+void AudioPacer::setPacing(bool enable)
+{
+  if (enable == pacing)
+  {
+    return;
+  }
+  pacing = enable;
+
+  if (enable)
+  {
+    pace_start = last_tick = monotonicNs();
+    pace_blocks = 0;
+  }
+
+  if (mode == PACING_DEADLINE)
+  {
+    if (enable)
+    {
+      armDeadline();
+    }
+    else
+    {
+#ifdef HAS_TIMERFD_SUPPORT
+      struct itimerspec its;
+      memset(&its, 0, sizeof(its));
+      timerfd_settime(timer_fd, 0, &its, 0);
+#endif
+    }
+    timer_watch->setEnabled(enable);
+  }
+  else
+  {
+    pace_timer->setEnable(enable);
+  }
+} /* AudioPacer::setPacing */
+
+
+bool AudioPacer::isPacing(void) const
+{
+  return pacing;
+} /* AudioPacer::isPacing */
+
+
+void AudioPacer::armDeadline(void)
+{
+#ifdef HAS_TIMERFD_SUPPORT
+  int64_t deadline = blockDeadline(pace_blocks + 1);
+  struct itimerspec its;
+  memset(&its, 0, sizeof(its));
+  its.it_value.tv_sec = deadline / 1000000000LL;
+  its.it_value.tv_nsec = deadline % 1000000000LL;
+  if (timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &its, 0) < 0)
+  {
+    cerr << "*** ERROR: timerfd_settime failed in Async::AudioPacer: "
+         << strerror(errno) << endl;
+  }
+#endif
+} /* AudioPacer::armDeadline */
+
+
+void AudioPacer::deadlineExpired(FdWatch *w)
+{
+#ifdef HAS_TIMERFD_SUPPORT
+  uint64_t expirations;
+  if (read(timer_fd, &expirations, sizeof(expirations)) < 0)
+  {
+    if (errno != EAGAIN)
+    {
+      cerr << "*** ERROR: Could not read timerfd in Async::AudioPacer: "
+           << strerror(errno) << endl;
+    }
+    return;
+  }
+#endif
+
+  int64_t now = monotonicNs();
+  int64_t first_deadline = blockDeadline(pace_blocks + 1);
+  if (now < first_deadline)
+  {
+    armDeadline();
+    return;
+  }
+
+    // Find out how many blocks are due. If we are too far behind, e.g. after
+    // a long stall in the main loop, restart the schedule instead of
+    // bursting out a lot of audio.
+  uint64_t due = 1;
+  while ((due <= MAX_CATCHUP_BLOCKS) &&
+         (blockDeadline(pace_blocks + due + 1) <= now))
+  {
+    ++due;
+  }
+  if (due > MAX_CATCHUP_BLOCKS)
+  {
+    m_stats.resyncs += 1;
+    pace_start = now - (blockDeadline(1) - pace_start);
+    pace_blocks = 0;
+    due = 1;
+  }
+
+  const int64_t start = pace_start;
+  for (uint64_t i=0; i<due; ++i)
+  {
+    pace_blocks += 1;
+    if (i > 0)
+    {
+      m_stats.catchup_blocks += 1;
+    }
+    outputNextBlock();
+    if (!pacing || (pace_start != start))
+    {
+      break;
+    }
+  }
+
+  if (pacing && (pace_start == start))
+  {
+    updateStats(monotonicNs(), first_deadline);
+    armDeadline();
+  }
+} /* AudioPacer::deadlineExpired */
+
+
+void AudioPacer::updateStats(int64_t now, int64_t deadline)
+{
+  int64_t lateness_us = (now - deadline) / 1000;
+  int64_t drift_us = (now - blockDeadline(pace_blocks)) / 1000;
+
+  m_stats.ticks += 1;
+  m_stats.last_lateness_us = lateness_us;
+  m_stats.max_lateness_us = max(m_stats.max_lateness_us, lateness_us);
+  lateness_sum_us += max(lateness_us, int64_t(0));
+  m_stats.avg_lateness_us = lateness_sum_us / m_stats.ticks;
+  m_stats.drift_us = drift_us;
+  m_stats.max_drift_us = max(m_stats.max_drift_us, std::abs(drift_us));
+} /* AudioPacer::updateStats */
+
+
+int64_t AudioPacer::blockDeadline(uint64_t block) const
+{
+    // Split the calculation to avoid overflow on very long streams
+  uint64_t samples = block * buf_size;
+  uint64_t secs = samples / sample_rate;
+  uint64_t rem = samples % sample_rate;
+  return pace_start + static_cast<int64_t>(
+      secs * 1000000000ULL + rem * 1000000000ULL / sample_rate);
+} /* AudioPacer::blockDeadline */
+
+
+static int64_t monotonicNs(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+} /* monotonicNs */
+
+
 
 
 /*
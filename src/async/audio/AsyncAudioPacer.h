@@ -37,6 +37,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <sigc++/sigc++.h>
 
+#include <stdint.h>
+
 
 /****************************************************************************
  *
@@ -81,6 +83,7 @@ namespace Async
  ****************************************************************************/
 
 class Timer;
+class FdWatch;
   
 
 /****************************************************************************
@@ -111,10 +114,52 @@ class Timer;
 @date   2007-11-17
 
 This class is used in an audio pipe chain to pace audio output.
+
+By default a periodic Async::Timer is used to output one block of samples at a
+time. The timer period is rounded to whole milliseconds and each expiration is
+delayed by the main loop, so over a long stream the output rate will drift
+away from the nominal sample rate. In the deadline pacing mode (see
+@ref setPacingMode) each block is instead scheduled at an absolute
+CLOCK_MONOTONIC deadline, computed from the time pacing started and the number
+of blocks output since then. If the main loop is late, as many blocks as are
+due are written at once so that the output rate is exact over time. The
+deadline mode is implemented using a timerfd so it is only available on
+Linux. On other platforms the timer mode is always used.
 */
 class AudioPacer : public AudioSink, public AudioSource, public sigc::trackable
 {
   public:
+    /**
+     * @brief The pacing mode
+     */
+    typedef enum
+    {
+      PACING_TIMER,     ///< Periodic millisecond timer (default)
+      PACING_DEADLINE   ///< Absolute monotonic deadlines
+    } PacingMode;
+
+    /**
+     * @brief Pacing statistics
+     *
+     * The lateness is how long after its deadline a block was actually
+     * output. The drift is the difference between the time that has elapsed
+     * since pacing started and the time it takes to play the blocks that has
+     * been output. A positive drift mean that output is behind. The
+     * statistics are collected in both pacing modes.
+     */
+    struct Stats
+    {
+      PacingMode  mode;             ///< The pacing mode in use
+      uint64_t    ticks;            ///< Timer or deadline expirations
+      uint64_t    catchup_blocks;   ///< Extra blocks output due to lateness
+      unsigned    resyncs;          ///< Times the schedule was restarted
+      int64_t     last_lateness_us; ///< Lateness of the last block
+      int64_t     max_lateness_us;  ///< Maximum lateness seen
+      int64_t     avg_lateness_us;  ///< Average lateness
+      int64_t     drift_us;         ///< Current drift against the schedule
+      int64_t     max_drift_us;     ///< Maximum absolute drift seen
+    };
+
     /**
      * @brief 	Constuctor
      * @param 	sample_rate The sample rate of the incoming samples
@@ -159,6 +204,33 @@ class AudioPacer : public AudioSink, public AudioSource, public sigc::trackable
      * This function is normally only called from a connected sink object.
      */
     virtual void resumeOutput(void);
+
+    /**
+     * @brief   Set the pacing mode
+     * @param   mode The pacing mode to use (see @ref PacingMode)
+     *
+     * If PACING_DEADLINE is not available on this platform the timer mode
+     * will be used. Use @ref pacingMode to find out which mode is in use.
+     * The mode should be set before audio start to flow through the pacer.
+     */
+    void setPacingMode(PacingMode mode);
+
+    /**
+     * @brief   Get the pacing mode in use
+     * @return  Returns the pacing mode
+     */
+    PacingMode pacingMode(void) const { return mode; }
+
+    /**
+     * @brief   Get pacing statistics
+     * @return  Returns the lateness and drift statistics
+     */
+    const Stats& stats(void) const { return m_stats; }
+
+    /**
+     * @brief   Reset the pacing statistics
+     */
+    void resetStats(void);
     
 
   protected:
@@ -174,6 +246,8 @@ class AudioPacer : public AudioSink, public AudioSource, public sigc::trackable
     
     
   private:
+    static const int MAX_CATCHUP_BLOCKS = 8;
+
     int       	  sample_rate;
     int       	  buf_size;
     int       	  prebuf_time;
@@ -183,8 +257,23 @@ class AudioPacer : public AudioSink, public AudioSource, public sigc::trackable
     Async::Timer  *pace_timer;
     bool      	  do_flush;
     bool      	  input_stopped;
+    PacingMode    mode;
+    int           timer_fd;
+    FdWatch       *timer_watch;
+    bool          pacing;
+    int64_t       pace_start;
+    uint64_t      pace_blocks;
+    int64_t       last_tick;
+    uint64_t      lateness_sum_us;
+    Stats         m_stats;
     
     void outputNextBlock(Async::Timer *t=0);
+    void setPacing(bool enable);
+    bool isPacing(void) const;
+    void armDeadline(void);
+    void deadlineExpired(FdWatch *w);
+    void updateStats(int64_t now, int64_t deadline);
+    int64_t blockDeadline(uint64_t block) const;
 
 };  /* class AudioPacer */
 
@@ -54,6 +54,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "AsyncAudioProcessor.h"
+#include "AsyncAudioBlockPool.h"
 
 
 
@@ -126,7 +127,7 @@ AudioProcessor::AudioProcessor(void)
 
 AudioProcessor::~AudioProcessor(void)
 {
-  delete [] input_buf;
+  AudioBlockPool::freeSamples(input_buf, input_buf_size);
 } /* AudioProcessor::~AudioProcessor */
 
 
@@ -249,11 +250,11 @@ void AudioProcessor::setInputOutputSampleRate(int input_rate, int output_rate)
   this->input_rate = input_rate;
   this->output_rate = output_rate;
   
-  delete [] input_buf;
+  AudioBlockPool::freeSamples(input_buf, input_buf_size);
   if (input_rate > output_rate)
   {
     input_buf_size = input_rate / output_rate;
-    input_buf = new float[input_buf_size];
+    input_buf = AudioBlockPool::allocSamples(input_buf_size);
   }
   else
   {
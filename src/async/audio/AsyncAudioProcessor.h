@@ -175,6 +175,8 @@ class AudioProcessor : public AudioSink, public AudioSource, public sigc::tracka
     
     
   private:
+    friend class AudioProcessorChain;
+
     static const int BUFSIZE = 256;
     
     float     	buf[BUFSIZE];
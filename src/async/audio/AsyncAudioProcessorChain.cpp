@@ -0,0 +1,300 @@
+/**
+@file	 AsyncAudioProcessorChain.cpp
+@brief   Run a number of audio processors as one fused audio pipe object
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-17
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <sstream>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncAudioProcessorChain.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+namespace {
+  int gcd(int a, int b)
+  {
+    while (b != 0)
+    {
+      int t = a % b;
+      a = b;
+      b = t;
+    }
+    return a;
+  }
+};
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+AudioProcessorChain::AudioProcessorChain(void)
+  : m_rate_num(1), m_rate_den(1), m_unit(1), m_block_size(BLOCK_SIZE)
+{
+} /* AudioProcessorChain::AudioProcessorChain */
+
+
+AudioProcessorChain::AudioProcessorChain(
+    std::initializer_list<AudioProcessor*> stages)
+  : m_rate_num(1), m_rate_den(1), m_unit(1), m_block_size(BLOCK_SIZE)
+{
+  for (AudioProcessor *stage : stages)
+  {
+    bool stage_added = addStage(stage);
+    assert(stage_added);
+    (void)stage_added;
+  }
+} /* AudioProcessorChain::AudioProcessorChain */
+
+
+AudioProcessorChain::~AudioProcessorChain(void)
+{
+  for (vector<Stage>::iterator it = m_stages.begin();
+       it != m_stages.end(); ++it)
+  {
+    if (it->managed)
+    {
+      delete it->proc;
+    }
+  }
+} /* AudioProcessorChain::~AudioProcessorChain */
+
+
+bool AudioProcessorChain::addStage(AudioProcessor *stage, bool managed,
+                                   const std::string& name)
+{
+  assert(stage != 0);
+  assert((stage->sink() == 0) && (stage->source() == 0));
+
+  Stage new_stage = { stage, managed, name,
+                      stage->input_rate, stage->output_rate };
+
+    // The number of input samples to the new stage, per m_unit input samples
+    // to the chain, is m_unit * m_rate_num / m_rate_den. A decimating stage
+    // must get a multiple of its decimation factor so the smallest block of
+    // input samples to the chain may have to grow.
+  int dec = max(new_stage.in_rate / new_stage.out_rate, 1);
+  int need = m_rate_den * dec / gcd(m_rate_num, m_rate_den * dec);
+  int unit = m_unit / gcd(m_unit, need) * need;
+
+  int rate_num = m_rate_num * new_stage.out_rate;
+  int rate_den = m_rate_den * new_stage.in_rate;
+  int div = gcd(rate_num, rate_den);
+  rate_num /= div;
+  rate_den /= div;
+
+    // The total rate change must be an integer factor and the base class only
+    // guarantee that the number of samples written is a multiple of the
+    // decimation factor
+  if ((rate_num != 1) && (rate_den != 1))
+  {
+    return false;
+  }
+  if (rate_den % unit != 0)
+  {
+    return false;
+  }
+
+  m_stages.push_back(new_stage);
+  m_rate_num = rate_num;
+  m_rate_den = rate_den;
+  m_unit = unit;
+  setInputOutputSampleRate(m_rate_den, m_rate_num);
+
+    // Size the scratch buffers for the largest intermediate block
+  m_block_size = max(BLOCK_SIZE / m_unit, 1) * m_unit;
+  int num = 1;
+  int den = 1;
+  size_t max_cnt = m_block_size;
+  for (vector<Stage>::const_iterator it = m_stages.begin();
+       it != m_stages.end(); ++it)
+  {
+    num *= it->out_rate;
+    den *= it->in_rate;
+    div = gcd(num, den);
+    num /= div;
+    den /= div;
+    max_cnt = max(max_cnt, size_t(m_block_size * num / den));
+  }
+  m_buf[0].resize(max_cnt);
+  m_buf[1].resize(max_cnt);
+
+  return true;
+} /* AudioProcessorChain::addStage */
+
+
+std::string AudioProcessorChain::topology(void) const
+{
+  std::ostringstream ss;
+  for (size_t i=0; i<m_stages.size(); ++i)
+  {
+    const Stage& stage = m_stages[i];
+    if (i > 0)
+    {
+      ss << " -> ";
+    }
+    if (stage.name.empty())
+    {
+      ss << "#" << i;
+    }
+    else
+    {
+      ss << stage.name;
+    }
+    if (stage.in_rate != stage.out_rate)
+    {
+      ss << "[" << stage.in_rate << ":" << stage.out_rate << "]";
+    }
+  }
+  return ss.str();
+} /* AudioProcessorChain::topology */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+void AudioProcessorChain::processSamples(float *dest, const float *src,
+                                         int count)
+{
+  if (m_stages.empty())
+  {
+    memcpy(dest, src, count * sizeof(*dest));
+    return;
+  }
+
+  assert(count % m_unit == 0);
+  const size_t last = m_stages.size() - 1;
+  while (count > 0)
+  {
+    const int block_cnt = min(count, m_block_size);
+    const float *in = src;
+    int cnt = block_cnt;
+    for (size_t i=0; i<=last; ++i)
+    {
+      const Stage& stage = m_stages[i];
+      float *out = (i == last) ? dest : m_buf[i % 2].data();
+      stage.proc->processSamples(out, in, cnt);
+      cnt = cnt * stage.out_rate / stage.in_rate;
+      in = out;
+    }
+    dest += cnt;
+    src += block_cnt;
+    count -= block_cnt;
+  }
+} /* AudioProcessorChain::processSamples */
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,246 @@
+/**
+@file	 AsyncAudioProcessorChain.h
+@brief   Run a number of audio processors as one fused audio pipe object
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-17
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+#ifndef ASYNC_AUDIO_PROCESSOR_CHAIN_INCLUDED
+#define ASYNC_AUDIO_PROCESSOR_CHAIN_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncAudioProcessor.h>
+#include <AsyncAudioBlockPool.h>
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	Run a number of audio processors as one fused audio pipe object
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+Normally each audio processor is a separate object in the audio pipe so that
+every sample pass through one writeSamples call, one output buffer and the
+flow control handling for each object in the chain. This class instead take
+a linear run of audio processors and call their processSamples functions
+directly, one after the other, on small blocks of samples. The samples then
+stay in the CPU cache while passing through all stages and there is only one
+output buffer and one flow control point for the whole chain.
+
+The stages are normal AudioProcessor objects so they can still be configured
+as usual after they have been added to the chain, e.g. by calling
+AudioAmp::setGain. A stage must not be connected to any other audio pipe
+object since it is only used for its processing function.
+
+Stages that change the sample rate, like AudioDecimator and
+AudioInterpolator, can be fused as long as the total rate change of the
+chain is an integer factor after each added stage and the block sizes work
+out for all stages. The addStage function return \em false if that is not the
+case and the stage should then be connected as a separate audio pipe object
+instead.
+
+A chain can be set up in one expression:
+
+\code
+AudioProcessorChain *chain = new AudioProcessorChain({
+    new AudioAmp, new AudioDecimator(3, coeff, coeff_taps), new AudioClipper
+  });
+\endcode
+*/
+class AudioProcessorChain : public AudioProcessor
+{
+  public:
+    /**
+     * @brief 	Default constuctor
+     */
+    AudioProcessorChain(void);
+
+    /**
+     * @brief 	Constuctor
+     * @param 	stages  The stages to add, in processing order
+     *
+     * All stages are managed by the chain so they are deleted when the chain
+     * is deleted. It is an error (assert) if a stage cannot be fused.
+     */
+    explicit AudioProcessorChain(std::initializer_list<AudioProcessor*> stages);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~AudioProcessorChain(void);
+
+    /**
+     * @brief 	Add a stage last in the chain
+     * @param 	stage   The audio processor to add
+     * @param 	managed Set to \em true to delete the stage with the chain
+     * @param   name    An optional name used when printing the topology
+     * @return	Returns \em true on success or else \em false
+     *
+     * If the stage cannot be fused with the stages already in the chain,
+     * \em false is returned and the stage is not added. The caller then
+     * still own the stage, even if managed was set to \em true.
+     * Stages should only be added before any audio is written to the chain.
+     */
+    bool addStage(AudioProcessor *stage, bool managed=true,
+                  const std::string& name="");
+
+    /**
+     * @brief 	Get the number of stages in the chain
+     * @return	Returns the number of stages
+     */
+    size_t size(void) const { return m_stages.size(); }
+
+    /**
+     * @brief 	Check if the chain is empty
+     * @return	Returns \em true if there are no stages in the chain
+     */
+    bool empty(void) const { return m_stages.empty(); }
+
+    /**
+     * @brief 	Get a compact description of the chain
+     * @return	Returns a string like "preamp -> dec[3:1] -> clipper"
+     *
+     * Stages that were added without a name are shown using their position
+     * in the chain. Stages that change the sample rate are shown with their
+     * input to output rate ratio.
+     */
+    std::string topology(void) const;
+
+
+  protected:
+    /**
+     * @brief Process incoming samples and put them into the output buffer
+     * @param dest  Destination buffer
+     * @param src   Source buffer
+     * @param count Number of samples in the source buffer
+     */
+    virtual void processSamples(float *dest, const float *src, int count);
+
+
+  private:
+    static const int BLOCK_SIZE = 64;
+
+    struct Stage
+    {
+      AudioProcessor* proc;
+      bool            managed;
+      std::string     name;
+      int             in_rate;
+      int             out_rate;
+    };
+
+    std::vector<Stage>  m_stages;
+    int                 m_rate_num;
+    int                 m_rate_den;
+    int                 m_unit;
+    int                 m_block_size;
+    std::vector<float, AudioBlockAllocator<float> > m_buf[2];
+
+    AudioProcessorChain(const AudioProcessorChain&);
+    AudioProcessorChain& operator=(const AudioProcessorChain&);
+
+};  /* class AudioProcessorChain */
+
+
+} /* namespace */
+
+#endif /* ASYNC_AUDIO_PROCESSOR_CHAIN_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,598 @@
+/**
+@file	 AsyncAudioProfiler.cpp
+@brief   Collect statistics about the audio pipe objects
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-17
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cxxabi.h>
+#include <stdint.h>
+#include <algorithm>
+#include <cstdlib>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncAudioProfiler.h"
+#include "AsyncAudioSink.h"
+#include "AsyncAudioSource.h"
+#include "AsyncAudioFifo.h"
+#include "AsyncAudioJitterFifo.h"
+#include "AsyncAudioAdaptiveJitterFifo.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+namespace {
+  typedef std::chrono::steady_clock Clock;
+
+  struct Node
+  {
+    std::string                     type;
+    std::string                     owner;
+    uint64_t                        calls         = 0;
+    uint64_t                        samples       = 0;
+    uint64_t                        accepted      = 0;
+    uint64_t                        stalls        = 0;
+    uint64_t                        total_ns      = 0;
+    uint64_t                        self_ns       = 0;
+    unsigned                        max_buffered  = 0;
+    const AudioFifo*                fifo          = 0;
+    const AudioJitterFifo*          jitter_fifo   = 0;
+    const AudioAdaptiveJitterFifo*  adaptive_fifo = 0;
+    std::map<const void*, uint64_t> inputs;
+
+    bool isBuffering(void) const
+    {
+      return (fifo != 0) || (jitter_fifo != 0) || (adaptive_fifo != 0);
+    }
+
+    unsigned buffered(void) const
+    {
+      if (fifo != 0)
+      {
+        return fifo->samplesInFifo();
+      }
+      if (jitter_fifo != 0)
+      {
+        return jitter_fifo->samplesInFifo();
+      }
+      if (adaptive_fifo != 0)
+      {
+        return adaptive_fifo->samplesInFifo();
+      }
+      return 0;
+    }
+  };
+
+    // Objects are identified by the address of the most derived object so
+    // that the sink and source parts of an audio processor end up in the
+    // same node.
+  struct Registry
+  {
+    std::unordered_map<const void*, Node>               nodes;
+    std::unordered_map<const AudioSink*, const void*>   sinks;
+    std::unordered_map<const AudioSource*, const void*> sources;
+    std::unordered_map<const void*, std::string>        owners;
+    std::string                                         owner;
+    uint64_t                                            child_ns = 0;
+    Clock::time_point                                   start = Clock::now();
+  };
+
+    // Audio objects may be destroyed after static objects in this file so
+    // the registry is never deleted
+  Registry *registry = 0;
+
+  Registry& reg(void)
+  {
+    if (registry == 0)
+    {
+      registry = new Registry;
+    }
+    return *registry;
+  }
+
+  std::string typeName(const std::type_info& type)
+  {
+    int status = 0;
+    char *name = abi::__cxa_demangle(type.name(), 0, 0, &status);
+    if ((status != 0) || (name == 0))
+    {
+      return type.name();
+    }
+    std::string ret(name);
+    free(name);
+    return ret;
+  }
+
+  Node& findNode(const void *obj, const void *base, const std::type_info& type)
+  {
+    Node& node = reg().nodes[obj];
+    if (node.type.empty())
+    {
+      node.type = typeName(type);
+    }
+    if (node.owner.empty())
+    {
+      auto it = reg().owners.find(base);
+      if (it != reg().owners.end())
+      {
+        node.owner = it->second;
+      }
+    }
+    return node;
+  }
+
+  const void *sinkNode(AudioSink *sink)
+  {
+    auto it = reg().sinks.find(sink);
+    if (it != reg().sinks.end())
+    {
+      return it->second;
+    }
+    const void *obj = dynamic_cast<const void*>(sink);
+    reg().sinks[sink] = obj;
+    Node& node = findNode(obj, sink, typeid(*sink));
+    node.fifo = dynamic_cast<const AudioFifo*>(sink);
+    node.jitter_fifo = dynamic_cast<const AudioJitterFifo*>(sink);
+    node.adaptive_fifo = dynamic_cast<const AudioAdaptiveJitterFifo*>(sink);
+    return obj;
+  }
+
+  const void *sourceNode(AudioSource *source)
+  {
+    auto it = reg().sources.find(source);
+    if (it != reg().sources.end())
+    {
+      return it->second;
+    }
+    const void *obj = dynamic_cast<const void*>(source);
+    reg().sources[source] = obj;
+    Node& node = findNode(obj, source, typeid(*source));
+    node.fifo = dynamic_cast<const AudioFifo*>(source);
+    node.jitter_fifo = dynamic_cast<const AudioJitterFifo*>(source);
+    node.adaptive_fifo = dynamic_cast<const AudioAdaptiveJitterFifo*>(source);
+    return obj;
+  }
+
+  void removeNode(const void *obj)
+  {
+    reg().nodes.erase(obj);
+    for (auto& item : reg().nodes)
+    {
+      item.second.inputs.erase(obj);
+    }
+  }
+
+  double elapsedSeconds(void)
+  {
+    return std::chrono::duration<double>(Clock::now() - reg().start).count();
+  }
+
+    // Give the nodes short and stable ids in the order they were first seen
+  std::vector<std::pair<const void*, const Node*> > sortedNodes(void)
+  {
+    std::vector<std::pair<const void*, const Node*> > nodes;
+    for (const auto& item : reg().nodes)
+    {
+      nodes.push_back(std::make_pair(item.first, &item.second));
+    }
+    std::sort(nodes.begin(), nodes.end(),
+        [](const std::pair<const void*, const Node*>& a,
+           const std::pair<const void*, const Node*>& b)
+        {
+          if (a.second->owner != b.second->owner)
+          {
+            return a.second->owner < b.second->owner;
+          }
+          return a.first < b.first;
+        });
+    return nodes;
+  }
+
+  unsigned bufferedMs(unsigned samples)
+  {
+    return 1000U * samples / INTERNAL_SAMPLE_RATE;
+  }
+
+  std::string jsonEscape(const std::string& str)
+  {
+    std::string ret;
+    for (char ch : str)
+    {
+      if ((ch == '"') || (ch == '\\'))
+      {
+        ret += '\\';
+      }
+      ret += ch;
+    }
+    return ret;
+  }
+
+  std::string shortType(const std::string& type)
+  {
+    if (type.compare(0, 7, "Async::") == 0)
+    {
+      return type.substr(7);
+    }
+    return type;
+  }
+};
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+bool AudioProfiler::s_enabled = (getenv("ASYNC_AUDIO_PROFILE") != 0) &&
+                                (atoi(getenv("ASYNC_AUDIO_PROFILE")) != 0);
+bool AudioProfiler::s_owner_active = false;
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+AudioProfiler::OwnerScope::OwnerScope(const std::string& owner)
+  : m_prev_owner(reg().owner), m_prev_active(s_owner_active)
+{
+  reg().owner = owner;
+  s_owner_active = true;
+} /* AudioProfiler::OwnerScope::OwnerScope */
+
+
+AudioProfiler::OwnerScope::~OwnerScope(void)
+{
+  reg().owner = m_prev_owner;
+  s_owner_active = m_prev_active;
+} /* AudioProfiler::OwnerScope::~OwnerScope */
+
+
+void AudioProfiler::setEnabled(bool enable)
+{
+  if (enable && !s_enabled)
+  {
+    reset();
+  }
+  s_enabled = enable;
+} /* AudioProfiler::setEnabled */
+
+
+void AudioProfiler::reset(void)
+{
+  reg().nodes.clear();
+  reg().sinks.clear();
+  reg().sources.clear();
+  reg().start = Clock::now();
+} /* AudioProfiler::reset */
+
+
+void AudioProfiler::printDot(std::ostream& os)
+{
+  const double elapsed = elapsedSeconds();
+  const auto nodes = sortedNodes();
+  std::map<const void*, size_t> ids;
+  for (size_t i=0; i<nodes.size(); ++i)
+  {
+    ids[nodes[i].first] = i;
+  }
+
+  os << "digraph audio_pipe {\n"
+     << "  rankdir=LR;\n"
+     << "  node [shape=box, fontsize=10];\n"
+     << "  label=\"Audio pipe profile, " << std::fixed
+     << std::setprecision(1) << elapsed << "s\";\n";
+  std::string owner;
+  bool in_cluster = false;
+  for (size_t i=0; i<nodes.size(); ++i)
+  {
+    const Node& node = *nodes[i].second;
+    if (!in_cluster || (node.owner != owner))
+    {
+      if (in_cluster)
+      {
+        os << "  }\n";
+        in_cluster = false;
+      }
+      owner = node.owner;
+      if (!owner.empty())
+      {
+        os << "  subgraph cluster_" << i << " {\n"
+           << "    label=\"" << jsonEscape(owner) << "\";\n";
+        in_cluster = true;
+      }
+    }
+    os << "    n" << i << " [label=\"" << jsonEscape(shortType(node.type));
+    if (node.calls > 0)
+    {
+      os << std::fixed << std::setprecision(0)
+         << "\\n" << (node.accepted / elapsed) << " smp/s"
+         << std::setprecision(2)
+         << "\\nself " << (100.0 * node.self_ns / 1e9 / elapsed) << "% cpu"
+         << ", total " << (100.0 * node.total_ns / 1e9 / elapsed) << "%";
+      if (node.stalls > 0)
+      {
+        os << "\\nstalls " << node.stalls;
+      }
+    }
+    if (node.isBuffering())
+    {
+      os << "\\nbuffered " << bufferedMs(node.buffered())
+         << "ms (max " << bufferedMs(node.max_buffered) << "ms)";
+    }
+    os << "\"";
+    if (node.stalls > 0)
+    {
+      os << ", color=red";
+    }
+    os << "];\n";
+  }
+  if (in_cluster)
+  {
+    os << "  }\n";
+  }
+  for (size_t i=0; i<nodes.size(); ++i)
+  {
+    for (const auto& input : nodes[i].second->inputs)
+    {
+      auto it = ids.find(input.first);
+      if (it != ids.end())
+      {
+        os << "  n" << it->second << " -> n" << i
+           << " [label=\"" << std::setprecision(0)
+           << (input.second / elapsed) << " smp/s\"];\n";
+      }
+    }
+  }
+  os << "}" << std::endl;
+  os.unsetf(std::ios::floatfield);
+} /* AudioProfiler::printDot */
+
+
+void AudioProfiler::printJson(std::ostream& os)
+{
+  const double elapsed = elapsedSeconds();
+  const auto nodes = sortedNodes();
+  std::map<const void*, size_t> ids;
+  for (size_t i=0; i<nodes.size(); ++i)
+  {
+    ids[nodes[i].first] = i;
+  }
+
+  os << "{\"elapsed\":" << elapsed << ",\"nodes\":[";
+  for (size_t i=0; i<nodes.size(); ++i)
+  {
+    const Node& node = *nodes[i].second;
+    os << (i > 0 ? "," : "")
+       << "{\"id\":" << i
+       << ",\"type\":\"" << jsonEscape(node.type) << "\""
+       << ",\"owner\":\"" << jsonEscape(node.owner) << "\""
+       << ",\"calls\":" << node.calls
+       << ",\"samples\":" << node.samples
+       << ",\"accepted\":" << node.accepted
+       << ",\"stalls\":" << node.stalls
+       << ",\"total_us\":" << node.total_ns / 1000
+       << ",\"self_us\":" << node.self_ns / 1000;
+    if (node.isBuffering())
+    {
+      os << ",\"buffered\":" << node.buffered()
+         << ",\"max_buffered\":" << node.max_buffered
+         << ",\"buffered_ms\":" << bufferedMs(node.buffered())
+         << ",\"max_buffered_ms\":" << bufferedMs(node.max_buffered);
+    }
+    os << "}";
+  }
+  os << "],\"edges\":[";
+  bool first = true;
+  for (size_t i=0; i<nodes.size(); ++i)
+  {
+    for (const auto& input : nodes[i].second->inputs)
+    {
+      auto it = ids.find(input.first);
+      if (it != ids.end())
+      {
+        os << (first ? "" : ",")
+           << "{\"from\":" << it->second << ",\"to\":" << i
+           << ",\"samples\":" << input.second << "}";
+        first = false;
+      }
+    }
+  }
+  os << "]}" << std::endl;
+} /* AudioProfiler::printJson */
+
+
+int AudioProfiler::profileWrite(AudioSource *source, AudioSink *sink,
+                                const float *samples, int len)
+{
+  Registry& r = reg();
+  const void *source_obj = sourceNode(source);
+  const void *sink_obj = sinkNode(sink);
+
+    // Time spent in writes made by the sink, further down the pipe, is
+    // accumulated in child_ns so that the time spent in the sink itself
+    // can be calculated
+  const uint64_t parent_child_ns = r.child_ns;
+  r.child_ns = 0;
+  const Clock::time_point start = Clock::now();
+  const int ret = sink->writeSamples(samples, len);
+  const uint64_t dt = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      Clock::now() - start).count();
+
+    // The objects may have been deleted during the write
+  auto it = r.nodes.find(sink_obj);
+  if ((it != r.nodes.end()) && (r.sinks.count(sink) > 0))
+  {
+    Node& node = it->second;
+    node.calls += 1;
+    node.samples += len;
+    node.accepted += ret;
+    if (ret < len)
+    {
+      node.stalls += 1;
+    }
+    node.total_ns += dt;
+    node.self_ns += dt - std::min(dt, r.child_ns);
+    if (node.isBuffering())
+    {
+      node.max_buffered = std::max(node.max_buffered, node.buffered());
+    }
+    if (r.nodes.count(source_obj) > 0)
+    {
+      node.inputs[source_obj] += ret;
+    }
+  }
+  r.child_ns = parent_child_ns + dt;
+
+  return ret;
+} /* AudioProfiler::profileWrite */
+
+
+void AudioProfiler::objectDestroyed(const AudioSink *sink)
+{
+  if (registry == 0)
+  {
+    return;
+  }
+  registry->owners.erase(sink);
+  auto it = registry->sinks.find(sink);
+  if (it != registry->sinks.end())
+  {
+    removeNode(it->second);
+    registry->sinks.erase(it);
+  }
+} /* AudioProfiler::objectDestroyed */
+
+
+void AudioProfiler::objectDestroyed(const AudioSource *source)
+{
+  if (registry == 0)
+  {
+    return;
+  }
+  registry->owners.erase(source);
+  auto it = registry->sources.find(source);
+  if (it != registry->sources.end())
+  {
+    removeNode(it->second);
+    registry->sources.erase(it);
+  }
+} /* AudioProfiler::objectDestroyed */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void AudioProfiler::setOwner(const void *obj)
+{
+  reg().owners[obj] = reg().owner;
+} /* AudioProfiler::setOwner */
+
+
+
+/*
+ * This file has not been truncated
+ */
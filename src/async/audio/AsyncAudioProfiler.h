@@ -0,0 +1,263 @@
+/**
+@file	 AsyncAudioProfiler.h
+@brief   Collect statistics about the audio pipe objects
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-17
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+#ifndef ASYNC_AUDIO_PROFILER_INCLUDED
+#define ASYNC_AUDIO_PROFILER_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <iosfwd>
+#include <string>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+class AudioSink;
+class AudioSource;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	Collect statistics about the audio pipe objects
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+When enabled, every write from an audio source to an audio sink is measured.
+For each audio pipe object the profiler record the number of samples written
+to it and accepted by it, the number of writes that were not fully accepted
+(stalls), the time spent in the object itself and in the objects after it in
+the pipe. For FIFO objects the number of buffered samples, and the maximum
+seen, is also recorded. The connections between the objects, as seen by the
+profiler, are recorded too so that the live audio graph can be printed in
+DOT (Graphviz) or JSON format.
+
+Objects are shown using their class name. To make it easier to find out
+which part of an application that an object belong to, an owner name can be
+set for all audio pipe objects created while an OwnerScope object exist.
+
+The profiler is disabled by default. It can be enabled using the setEnabled
+function or by setting the environment variable ASYNC_AUDIO_PROFILE=1. When
+disabled the only overhead is one extra test per write. The profiler is not
+thread safe so it must only be used from the thread running the audio pipe.
+
+\code
+bool LocalTx::initialize(void)
+{
+  Async::AudioProfiler::OwnerScope owner_scope("Tx:" + name());
+  ...
+}
+
+Async::AudioProfiler::setEnabled(true);
+...
+Async::AudioProfiler::printDot(std::cout);
+\endcode
+*/
+class AudioProfiler
+{
+  public:
+    /**
+     * @brief Set the owner name for all audio pipe objects created
+     *
+     * All audio pipe objects created while an object of this class exist
+     * will be marked with the given owner name. Scopes can be nested, in
+     * which case the innermost owner name is used.
+     */
+    class OwnerScope
+    {
+      public:
+        /**
+         * @brief   Constructor
+         * @param   owner The owner name
+         */
+        explicit OwnerScope(const std::string& owner);
+
+        /**
+         * @brief   Destructor
+         */
+        ~OwnerScope(void);
+
+      private:
+        std::string   m_prev_owner;
+        bool          m_prev_active;
+
+        OwnerScope(const OwnerScope&);
+        OwnerScope& operator=(const OwnerScope&);
+    };
+
+    /**
+     * @brief   Enable or disable the profiler
+     * @param   enable Set to \em true to enable the profiler
+     */
+    static void setEnabled(bool enable);
+
+    /**
+     * @brief   Check if the profiler is enabled
+     * @return  Returns \em true if the profiler is enabled
+     */
+    static bool isEnabled(void) { return s_enabled; }
+
+    /**
+     * @brief   Clear all statistics
+     *
+     * The owner names are kept.
+     */
+    static void reset(void);
+
+    /**
+     * @brief   Print the audio graph and statistics in DOT format
+     * @param   os The stream to print to
+     *
+     * The output can be rendered using Graphviz, e.g. "dot -Tsvg".
+     */
+    static void printDot(std::ostream& os);
+
+    /**
+     * @brief   Print the audio graph and statistics in JSON format
+     * @param   os The stream to print to
+     */
+    static void printJson(std::ostream& os);
+
+    /**
+     * @brief   Write samples to a sink while measuring
+     * @param   source  The source writing the samples
+     * @param   sink    The sink to write to
+     * @param   samples The samples to write
+     * @param   len     The number of samples
+     * @return  Returns the number of samples accepted by the sink
+     *
+     * This function is called by AudioSource::sinkWriteSamples when the
+     * profiler is enabled.
+     */
+    static int profileWrite(AudioSource *source, AudioSink *sink,
+                            const float *samples, int len);
+
+    /**
+     * @brief   Called by the AudioSink and AudioSource constructors
+     * @param   obj The AudioSink or AudioSource object created
+     */
+    static void objectCreated(const void *obj)
+    {
+      if (s_owner_active)
+      {
+        setOwner(obj);
+      }
+    }
+
+    /**
+     * @brief   Called by the AudioSink destructor
+     * @param   sink The sink being destroyed
+     */
+    static void objectDestroyed(const AudioSink *sink);
+
+    /**
+     * @brief   Called by the AudioSource destructor
+     * @param   source The source being destroyed
+     */
+    static void objectDestroyed(const AudioSource *source);
+
+  private:
+    static bool   s_enabled;
+    static bool   s_owner_active;
+
+    static void setOwner(const void *obj);
+
+};  /* class AudioProfiler */
+
+
+} /* namespace */
+
+#endif /* ASYNC_AUDIO_PROFILER_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
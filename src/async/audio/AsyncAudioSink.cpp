@@ -50,6 +50,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "AsyncAudioSink.h"
 #include "AsyncAudioSource.h"
+#include "AsyncAudioProfiler.h"
 
 
 
@@ -110,9 +111,16 @@ using namespace Async;
  *
  ****************************************************************************/
 
+AudioSink::AudioSink(void)
+  : m_source(0), m_handler(0), m_auto_unreg_sink(false)
+{
+  AudioProfiler::objectCreated(this);
+} /* AudioSink::AudioSink */
+
 
 AudioSink::~AudioSink(void)
 {
+  AudioProfiler::objectDestroyed(this);
   unregisterSource();
   clearHandler();
 } /* AudioSink::~AudioSink */
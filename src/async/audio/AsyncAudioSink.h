@@ -118,7 +118,7 @@ class AudioSink
     /**
      * @brief 	Default constuctor
      */
-    AudioSink(void) : m_source(0), m_handler(0), m_auto_unreg_sink(false) {}
+    AudioSink(void);
   
     /**
      * @brief 	Destructor
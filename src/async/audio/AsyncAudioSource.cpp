@@ -50,6 +50,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "AsyncAudioSource.h"
 #include "AsyncAudioSink.h"
+#include "AsyncAudioProfiler.h"
 
 
 
@@ -110,9 +111,18 @@ using namespace Async;
  *
  ****************************************************************************/
 
+AudioSource::AudioSource(void)
+  : m_sink(0), m_sink_managed(false), m_handler(0),
+    m_auto_unreg_source(false), is_flushing(false)
+{
+  AudioProfiler::objectCreated(this);
+} /* AudioSource::AudioSource */
+
 
 AudioSource::~AudioSource(void)
 {
+  AudioProfiler::objectDestroyed(this);
+
   if (m_sink_managed)
   {
     AudioSink *sink = m_sink;
@@ -171,7 +181,14 @@ int AudioSource::sinkWriteSamples(const float *samples, int len)
   
   if (m_sink != 0)
   {
-    len = m_sink->writeSamples(samples, len);
+    if (AudioProfiler::isEnabled())
+    {
+      len = AudioProfiler::profileWrite(this, m_sink, samples, len);
+    }
+    else
+    {
+      len = m_sink->writeSamples(samples, len);
+    }
   }
   
   return len;
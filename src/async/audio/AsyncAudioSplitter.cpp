@@ -35,6 +35,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <cassert>
 #include <cstring>
 #include <iostream>
+#include <deque>
+#include <memory>
+#include <vector>
 
 
 /****************************************************************************
@@ -54,6 +57,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "AsyncAudioSource.h"
 #include "AsyncAudioSplitter.h"
+#include "AsyncAudioBlockPool.h"
 
 
 /****************************************************************************
@@ -84,22 +88,32 @@ using namespace Async;
 class Async::AudioSplitter::Branch : public AudioSource
 {
   public:
-    int   current_buf_pos;
-    bool  is_flushed;
-  
+    typedef std::vector<float, AudioBlockAllocator<float> > Block;
+    typedef std::shared_ptr<const Block> BlockPtr;
+
     Branch(AudioSplitter *splitter)
-      : current_buf_pos(0), is_flushed(true), is_enabled(true),
-	is_stopped(false), is_flushing(false), splitter(splitter)
+      : is_enabled(true), is_stopped(false), is_flushed(true),
+        is_flushing(false), flush_pending(false), is_writing(false),
+        backlog_len(0), dropped_samples(0), splitter(splitter)
     {
     }
     
     virtual ~Branch(void)
     {
-      if (is_stopped)
-      {
-      	splitter->branchResumeOutput();
-      }
     }
+
+      // A branch is active if it has an enabled sink that samples are
+      // written to
+    bool isActive(void) const { return is_enabled && (sink() != 0); }
+
+    bool isStalled(void) const
+    {
+      return isActive() && (is_stopped || (backlog_len > 0));
+    }
+
+    int backlogLength(void) const { return backlog_len; }
+
+    unsigned long droppedSamples(void) const { return dropped_samples; }
     
     void setEnabled(bool enabled)
     {
@@ -111,14 +125,16 @@ class Async::AudioSplitter::Branch : public AudioSource
       
       if (!enabled)
       {
+        clearBacklog();
 	if (is_stopped)
 	{
 	  is_stopped = false;
 	  splitter->branchResumeOutput();
 	}
-	if (is_flushing)
+	if (is_flushing || flush_pending)
 	{
 	  is_flushing = false;
+          flush_pending = false;
 	  splitter->branchAllSamplesFlushed();
 	}
 	else if (!is_flushed)
@@ -127,57 +143,160 @@ class Async::AudioSplitter::Branch : public AudioSource
 	}
       }
     }
-    
-    int sinkWriteSamples(const float *samples, int len)
+
+      // Write samples to the branch. If not all samples are accepted, the
+      // rest are put in the backlog. The block pointer is set to a shared
+      // copy of the samples the first time a branch need one.
+    void write(const float *samples, int len, BlockPtr& block)
     {
+      if (!is_enabled)
+      {
+        return;
+      }
+
       is_flushed = false;
       is_flushing = false;
-      
-      if (is_enabled)
+      flush_pending = false;
+
+      if (sink() == 0)
       {
-	if (is_stopped)
-	{
-	  return 0;
-	}
-      
-      	len = AudioSource::sinkWriteSamples(samples, len);
-      	is_stopped = (len == 0);
+        clearBacklog();
+        is_stopped = false;
+        return;
       }
-      
-      current_buf_pos += len;
-      
-      return len;
-      
-    } /* sinkWriteSamples */
-    
-    void sinkFlushSamples(void)
+
+      int pos = 0;
+      if ((backlog_len == 0) && !is_stopped)
+      {
+        pos = writeToSink(samples, len);
+      }
+      if (pos == len)
+      {
+        return;
+      }
+
+      const int remaining = len - pos;
+      if (splitter->independent_branches &&
+          (backlog_len + remaining > splitter->max_backlog))
+      {
+        dropped_samples += remaining;
+        return;
+      }
+      if (!block)
+      {
+        block = std::allocate_shared<Block>(AudioBlockAllocator<Block>(),
+                                            samples, samples + len);
+      }
+      BacklogItem item = { block, pos };
+      backlog.push_back(item);
+      backlog_len += remaining;
+    }
+
+      // Called before the sink is removed from the branch
+    void detach(void)
     {
-      if (is_enabled)
+      clearBacklog();
+      is_stopped = false;
+      if (is_flushing || flush_pending)
+      {
+        is_flushing = false;
+        flush_pending = false;
+        is_flushed = true;
+        splitter->branchAllSamplesFlushed();
+      }
+    }
+
+    void flush(void)
+    {
+      if (!is_enabled)
+      {
+        is_flushed = true;
+        splitter->branchAllSamplesFlushed();
+      }
+      else if (backlog_len > 0)
       {
-      	is_flushing = true;
-      	AudioSource::sinkFlushSamples();
+        flush_pending = true;
       }
       else
       {
-      	is_flushed = true;
-      	splitter->branchAllSamplesFlushed();
+        is_flushing = true;
+        AudioSource::sinkFlushSamples();
       }
-    } /* sinkFlushSamples */
-    
+    }
 
   private:
-    bool      	  is_enabled;
-    bool      	  is_stopped;
-    bool      	  is_flushing;
-    AudioSplitter *splitter;
+    struct BacklogItem
+    {
+      BlockPtr  block;
+      int       pos;
+    };
+
+    std::deque<BacklogItem> backlog;
+    bool      	            is_enabled;
+    bool      	            is_stopped;
+    bool                    is_flushed;
+    bool      	            is_flushing;
+    bool                    flush_pending;
+    bool                    is_writing;
+    int                     backlog_len;
+    unsigned long           dropped_samples;
+    AudioSplitter           *splitter;
+
+    int writeToSink(const float *samples, int len)
+    {
+      int pos = 0;
+      while (pos < len)
+      {
+        int written = AudioSource::sinkWriteSamples(samples + pos, len - pos);
+        if (written == 0)
+        {
+          is_stopped = true;
+          break;
+        }
+        pos += written;
+      }
+      return pos;
+    }
+
+    void writeBacklog(void)
+    {
+      is_writing = true;
+      while (!backlog.empty() && !is_stopped)
+      {
+        BacklogItem& item = backlog.front();
+        const int len = item.block->size() - item.pos;
+        const int written = writeToSink(item.block->data() + item.pos, len);
+        item.pos += written;
+        backlog_len -= written;
+        if (item.pos == static_cast<int>(item.block->size()))
+        {
+          backlog.pop_front();
+        }
+      }
+      is_writing = false;
+    }
+
+    void clearBacklog(void)
+    {
+      backlog.clear();
+      backlog_len = 0;
+    }
   
     virtual void resumeOutput(void)
     {
       is_stopped = false;
-      if (is_enabled)
+      if (!is_enabled || is_writing)
       {
-      	splitter->branchResumeOutput();
+        return;
       }
+      writeBacklog();
+      if ((backlog_len == 0) && flush_pending)
+      {
+        flush_pending = false;
+        is_flushing = true;
+        AudioSource::sinkFlushSamples();
+      }
+      splitter->branchResumeOutput();
     } /* resumeOutput */
     
     virtual void allSamplesFlushed(void)
@@ -227,8 +346,9 @@ class Async::AudioSplitter::Branch : public AudioSource
  ****************************************************************************/
 
 AudioSplitter::AudioSplitter(void)
-  : buf(0), buf_size(0), buf_len(0), do_flush(false), input_stopped(false),
-    flushed_branches(0), main_branch(0)
+  : do_flush(false), input_stopped(false), flushed_branches(0),
+    max_backlog(DEFAULT_MAX_BACKLOG), independent_branches(false),
+    main_branch(0)
 {
   main_branch = new Branch(this);
   branches.push_back(main_branch);
@@ -238,7 +358,6 @@ AudioSplitter::AudioSplitter(void)
 
 AudioSplitter::~AudioSplitter(void)
 {
-  delete [] buf;
   removeAllSinks();
   AudioSource::clearHandler();
   delete main_branch;
@@ -254,7 +373,7 @@ void AudioSplitter::addSink(AudioSink *sink, bool managed)
   branches.push_back(branch);
   if (do_flush)
   {
-    branch->sinkFlushSamples();
+    branch->flush();
   }
 } /* AudioSplitter::addSink */
 
@@ -266,23 +385,21 @@ void AudioSplitter::removeSink(AudioSink *sink)
     return;
   }
 
-  list<Branch *>::iterator it;
-  for (it = branches.begin(); it != branches.end(); ++it)
+  Branch *branch = findBranch(sink);
+  if (branch != 0)
   {
-    if ((*it)->sink() == sink)
+    branch->detach();
+    if (branch->sinkManaged())
     {
-      if ((*it)->sinkManaged())
-      {
-      	delete (*it)->sink();
-      }
-      else
-      {
-      	(*it)->unregisterSink();
-      }
-      Async::Application::app().runTask(
-          mem_fun(*this, &AudioSplitter::cleanupBranches));
-      break;
+      delete branch->sink();
+    }
+    else
+    {
+      branch->unregisterSink();
     }
+    Async::Application::app().runTask(
+        mem_fun(*this, &AudioSplitter::cleanupBranches));
+    branchResumeOutput();
   }
 } /* AudioSplitter::removeSink */
 
@@ -299,6 +416,7 @@ void AudioSplitter::removeAllSinks(void)
   }
   branches.clear();
   branches.push_back(main_branch);
+  branchResumeOutput();
 } /* AudioSplitter::removeAllSinks */
 
 
@@ -309,18 +427,46 @@ void AudioSplitter::enableSink(AudioSink *sink, bool enable)
     return;
   }
 
-  list<Branch *>::iterator it;
-  for (it = branches.begin(); it != branches.end(); ++it)
+  Branch *branch = findBranch(sink);
+  if (branch != 0)
   {
-    if ((*it)->sink() == sink)
-    {
-      (*it)->setEnabled(enable);
-      break;
-    }
+    branch->setEnabled(enable);
   }
 } /* AudioSplitter::enableSink */
 
 
+void AudioSplitter::setIndependentBranches(bool enable)
+{
+  independent_branches = enable;
+  branchResumeOutput();
+} /* AudioSplitter::setIndependentBranches */
+
+
+unsigned long AudioSplitter::droppedSamples(AudioSink *sink) const
+{
+  if (sink != 0)
+  {
+    Branch *branch = findBranch(sink);
+    return (branch != 0) ? branch->droppedSamples() : 0;
+  }
+
+  unsigned long dropped = 0;
+  list<Branch *>::const_iterator it;
+  for (it = branches.begin(); it != branches.end(); ++it)
+  {
+    dropped += (*it)->droppedSamples();
+  }
+  return dropped;
+} /* AudioSplitter::droppedSamples */
+
+
+int AudioSplitter::backlog(AudioSink *sink) const
+{
+  Branch *branch = findBranch(sink);
+  return (branch != 0) ? branch->backlogLength() : 0;
+} /* AudioSplitter::backlog */
+
+
 int AudioSplitter::writeSamples(const float *samples, int len)
 {
   do_flush = false;
@@ -330,38 +476,19 @@ int AudioSplitter::writeSamples(const float *samples, int len)
     return 0;
   }
 
-  if (buf_len > 0)
+  if (!inputCanAcceptSamples())
   {
     input_stopped = true;
     return 0;
   }
-  
-  bool samples_written = false;
-  
+
+  Branch::BlockPtr block;
   list<Branch *>::iterator it;
   for (it = branches.begin(); it != branches.end(); ++it)
   {
-    (*it)->current_buf_pos = 0;
-    int written = (*it)->sinkWriteSamples(samples, len);
-    if (written != len)
-    {
-      if (buf_len == 0) // Only copy the buffer one time
-      {
-	if (buf_size < len)
-	{
-	  delete [] buf;
-          buf_size = len;
-	  buf = new float[buf_size];
-	}
-	memcpy(buf, samples, len * sizeof(*samples));
-	buf_len = len;
-      }
-    }
-    samples_written |= (written > 0);
+    (*it)->write(samples, len, block);
   }
   
-  writeFromBuffer();
-  
   return len;
   
 } /* AudioSplitter::writeSamples */
@@ -383,11 +510,6 @@ void AudioSplitter::flushSamples(void)
   do_flush = true;
   flushed_branches = 0;
   
-  if (buf_len > 0)
-  {
-    return;
-  }
-  
   flushAllBranches();
   
 } /* AudioSplitter::flushSamples */
@@ -439,59 +561,38 @@ void AudioSplitter::flushSamples(void)
  * Bugs:      
  *----------------------------------------------------------------------------
  */
-void AudioSplitter::writeFromBuffer(void)
+void AudioSplitter::flushAllBranches(void)
 {
-  bool samples_written = true;
-  bool all_written = (buf_len == 0);
-  
-  //cout << "samples_written=" << samples_written << "  all_written="
-    //   << all_written << endl;
-  
-  while (samples_written && !all_written)
+  list<Branch *>::iterator it;
+  for (it = branches.begin(); it != branches.end(); ++it)
   {
-    samples_written = false;
-    all_written = true;
-    list<Branch *>::iterator it;
-    for (it = branches.begin(); it != branches.end(); ++it)
-    {
-      //cout << "(*it)->current_buf_pos=" << (*it)->current_buf_pos
-	//   << "  buf_len=" << buf_len << endl;
-      if ((*it)->current_buf_pos < buf_len)
-      {
-	int written = (*it)->sinkWriteSamples(buf+(*it)->current_buf_pos,
-	      	      	      	      	      buf_len-(*it)->current_buf_pos);
-	//cout << "written=" << written << endl;
-	samples_written |= (written > 0);
-	all_written &= ((*it)->current_buf_pos == buf_len);
-      }
-    }
-    
-    if (all_written)
-    {
-      buf_len = 0;
-      if (do_flush)
-      {
-	flushAllBranches();
-      }
-    }
+    (*it)->flush();
   }
-} /* AudioSplitter::writeFromBuffer */
+} /* AudioSplitter::flushAllBranches */
 
 
-void AudioSplitter::flushAllBranches(void)
+AudioSplitter::Branch *AudioSplitter::findBranch(AudioSink *sink) const
 {
-  list<Branch *>::iterator it;
+  list<Branch *>::const_iterator it;
   for (it = branches.begin(); it != branches.end(); ++it)
   {
-    (*it)->sinkFlushSamples();
+    if ((*it)->sink() == sink)
+    {
+      return *it;
+    }
   }
-} /* AudioSplitter::flushAllBranches */
+  return 0;
+} /* AudioSplitter::findBranch */
 
 
 void AudioSplitter::branchResumeOutput(void)
 {
-  writeFromBuffer();
-  if (input_stopped && (buf_len == 0))
+  if (!input_stopped)
+  {
+    return;
+  }
+
+  if (inputCanAcceptSamples())
   {
     input_stopped = false;
     sourceResumeOutput();
@@ -536,9 +637,41 @@ void AudioSplitter::cleanupBranches(void)
       ++it;
     }
   }
+  branchResumeOutput();
 } /* AudioSplitter::cleanupBranches */
 
 
+/*
+ * @brief: Check if new samples can be written to the branches
+ *
+ * In lockstep mode all branches must have written all previous samples. With
+ * independent branches it is enough that one active branch is ready since the
+ * stalled branches get the samples in their backlog. If there are no active
+ * branches, the samples are just thrown away.
+ */
+bool AudioSplitter::inputCanAcceptSamples(void) const
+{
+  bool all_stalled = false;
+  list<Branch *>::const_iterator it;
+  for (it = branches.begin(); it != branches.end(); ++it)
+  {
+    if ((*it)->isStalled())
+    {
+      if (!independent_branches)
+      {
+        return false;
+      }
+      all_stalled = true;
+    }
+    else if (independent_branches && (*it)->isActive())
+    {
+      return true;
+    }
+  }
+  return !all_stalled;
+} /* AudioSplitter::inputCanAcceptSamples */
+
+
 
 /*
  * This file has not been truncated
@@ -6,7 +6,7 @@
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2004-2024 Tobias Blomberg / SM0SVX
+Copyright (C) 2004-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -113,6 +113,24 @@ namespace Async
 
 This class is part of the audio pipe framework. It is used to split one
 incoming audio source into multiple outgoing sources.
+
+By default the branches are written in lockstep. If a branch does not accept
+all samples, the incoming audio stream is stopped until all branches have
+taken the samples. This propagates flow control from any branch back to the
+source, which is what is needed when the source can produce audio faster than
+real time, like when playing back a file or a FIFO.
+
+For real time sources, where there is no way to slow the source down anyway,
+independent branches can be enabled using setIndependentBranches. If a branch
+then does not accept all samples, the remaining samples are kept in a backlog
+for that branch only while the other branches continue to receive new
+samples. The backlog refers to a reference counted copy of the incoming block
+of samples, which is only made once no matter how many branches that need
+it. If the backlog of a branch would grow larger than the limit set using
+setMaxBacklog, the new samples are dropped for that branch and counted. The
+number of dropped samples can be read using the droppedSamples function. The
+incoming audio stream is only stopped when all enabled branches are stalled,
+so a single slow branch does not add latency to the other branches.
 */
 class AudioSplitter : public Async::AudioSink, public Async::AudioSource,
                       public sigc::trackable
@@ -155,6 +173,57 @@ class AudioSplitter : public Async::AudioSink, public Async::AudioSource,
      */
     void enableSink(AudioSink *sink, bool enable);
 
+    /**
+     * @brief 	Write to the branches independently of each other
+     * @param 	enable Set to \em true to enable independent branches
+     *
+     * When independent branches are enabled, a stalled branch does not stop
+     * the other branches. Samples for a stalled branch are buffered, up to
+     * the maximum backlog, and then dropped. Only use this for real time
+     * audio sources. The default is to write to all branches in lockstep so
+     * that any stalled branch stop the input.
+     */
+    void setIndependentBranches(bool enable);
+
+    /**
+     * @brief 	Check if the branches are written independently
+     * @return	Returns \em true if independent branches are enabled
+     */
+    bool independentBranches(void) const { return independent_branches; }
+
+    /**
+     * @brief 	Set the maximum backlog for each branch
+     * @param 	samples The maximum number of samples to buffer for a branch
+     *
+     * When independent branches are enabled and a branch does not accept
+     * samples, up to this many samples are buffered for the branch. Samples
+     * that do not fit are dropped for that branch. The limit is not used in
+     * lockstep mode.
+     */
+    void setMaxBacklog(int samples) { max_backlog = samples; }
+
+    /**
+     * @brief 	Get the maximum backlog for each branch
+     * @return	Returns the maximum number of samples buffered for a branch
+     */
+    int maxBacklog(void) const { return max_backlog; }
+
+    /**
+     * @brief 	Get the number of dropped samples
+     * @param 	sink The sink to get the count for or 0 for all sinks
+     * @return	Returns the number of samples dropped since the splitter was
+     *          created because the backlog was full
+     */
+    unsigned long droppedSamples(AudioSink *sink=0) const;
+
+    /**
+     * @brief 	Get the number of samples buffered for a sink
+     * @param 	sink The sink to get the backlog for
+     * @return	Returns the number of samples that are waiting to be written
+     *          to the given sink
+     */
+    int backlog(AudioSink *sink) const;
+
     /**
      * @brief 	Write samples into this audio sink
      * @param 	samples The buffer containing the samples
@@ -183,22 +252,24 @@ class AudioSplitter : public Async::AudioSink, public Async::AudioSource,
   private:
     class Branch;
     
+    static const int DEFAULT_MAX_BACKLOG = 16384;
+
     std::list<Branch *> branches;
-    float     	      	*buf;
-    int       	      	buf_size;
-    int       	      	buf_len;
     bool      	      	do_flush;
     bool      	      	input_stopped;
     int       	      	flushed_branches;
+    int                 max_backlog;
+    bool                independent_branches;
     Branch              *main_branch;
     
-    void writeFromBuffer(void);
     void flushAllBranches(void);
+    Branch *findBranch(AudioSink *sink) const;
 
     friend class Branch;
     void branchResumeOutput(void);
     void branchAllSamplesFlushed(void);
     void cleanupBranches(void);
+    bool inputCanAcceptSamples(void) const;
 
 };  /* class AudioSplitter */
 
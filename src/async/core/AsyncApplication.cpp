@@ -146,6 +146,7 @@ Application::Application(void)
   assert(app_ptr == 0);
   app_ptr = this;  
   task_timer = new Async::Timer(0, Timer::TYPE_ONESHOT, false);
+  task_timer->setTag("Async::Application");
   task_timer->expired.connect(
       sigc::hide(mem_fun(*this, &Application::taskTimerExpired)));
 } /* Application::Application */
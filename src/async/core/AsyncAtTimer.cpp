@@ -119,6 +119,7 @@ using namespace Async;
 AtTimer::AtTimer(void)
 {
   timerclear(&m_expire_at);
+  m_timer.setTag("Async::AtTimer");
   m_timer.expired.connect(mem_fun(*this, &AtTimer::onTimerExpired));
 } /* AtTimer::AtTimer */
 
@@ -126,6 +127,7 @@ AtTimer::AtTimer(void)
 AtTimer::AtTimer(struct tm &tm, bool do_start)
 {
   timerclear(&m_expire_at);
+  m_timer.setTag("Async::AtTimer");
   m_timer.expired.connect(mem_fun(*this, &AtTimer::onTimerExpired));
   setTimeout(tm);
   if (do_start)
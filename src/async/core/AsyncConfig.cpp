@@ -143,6 +143,9 @@ bool Config::open(const string& name)
   fclose(file);
   file = NULL;
 
+  m_generation += 1;
+  m_snapshot = nullptr;
+
   return success;
 
 } /* Config::open */
@@ -249,6 +252,12 @@ void Config::setValue(const std::string& section, const std::string& tag,
                       const std::string& value)
 {
   Values &values = sections[section];
+  const bool is_new = (values.find(tag) == values.end());
+  if (is_new || (value != values[tag].val))
+  {
+    m_generation += 1;
+    m_snapshot = nullptr;
+  }
   if (value != values[tag].val)
   {
     values[tag].val = value;
@@ -261,6 +270,69 @@ void Config::setValue(const std::string& section, const std::string& tag,
 } /* Config::setValue */
 
 
+ConfigSnapshot::Ptr Config::snapshot(void) const
+{
+  if (m_snapshot == nullptr)
+  {
+    ConfigSnapshot::Entries entries;
+    for (const auto& section : sections)
+    {
+      for (const auto& value : section.second)
+      {
+        entries.push_back({section.first, value.first, value.second.val});
+      }
+    }
+    m_snapshot = std::make_shared<const ConfigSnapshot>(m_generation,
+                                                        std::move(entries));
+  }
+  return m_snapshot;
+} /* Config::snapshot */
+
+
+const std::string* ConfigSnapshot::find(const std::string& section,
+                                        const std::string& tag) const
+{
+  auto it = std::lower_bound(m_entries.begin(), m_entries.end(),
+      std::make_pair(&section, &tag),
+      [](const Entry& e, const std::pair<const std::string*,
+                                         const std::string*>& key)
+      {
+        int cmp = e.section.compare(*key.first);
+        return (cmp < 0) || ((cmp == 0) && (e.tag < *key.second));
+      });
+  if ((it == m_entries.end()) || (it->section != section) || (it->tag != tag))
+  {
+    return nullptr;
+  }
+  return &it->value;
+} /* ConfigSnapshot::find */
+
+
+bool ConfigSnapshot::hasSection(const std::string& section) const
+{
+  auto it = std::lower_bound(m_entries.begin(), m_entries.end(), section,
+      [](const Entry& e, const std::string& key)
+      {
+        return e.section < key;
+      });
+  return (it != m_entries.end()) && (it->section == section);
+} /* ConfigSnapshot::hasSection */
+
+
+bool ConfigSnapshot::getValue(const std::string& section,
+                              const std::string& tag,
+                              std::string& value, bool missing_ok) const
+{
+  const std::string* val = find(section, tag);
+  if (val == nullptr)
+  {
+    return missing_ok;
+  }
+  value = *val;
+  return true;
+} /* ConfigSnapshot::getValue */
+
+
 /****************************************************************************
  *
  * Protected member functions
@@ -46,6 +46,7 @@ An example of how to use the Config class
  ****************************************************************************/
 
 #include <stdio.h>
+#include <stdint.h>
 #include <sigc++/sigc++.h>
 
 #include <string>
@@ -55,6 +56,7 @@ An example of how to use the Config class
 #include <sstream>
 #include <locale>
 #include <vector>
+#include <algorithm>
 #include <cassert>
 
 
@@ -122,6 +124,132 @@ namespace Async
  *
  ****************************************************************************/
 
+/**
+@brief  A read-only copy of all configuration variables
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+This class hold a copy of all configuration variables at the time when it was
+created by the Config::snapshot function. The variables are stored in one
+sorted array so a lookup does not allocate any memory. A snapshot never change
+after it has been created so it can be shared between many objects, and
+threads, using the Ptr type. Use the generation function to find out if a
+snapshot is older than the configuration it was created from.
+
+\code
+Async::ConfigSnapshot::Ptr snap = cfg.snapshot();
+unsigned timeout = 15;
+snap->getValue("GLOBAL", "SQL_TIMEOUT", timeout);
+\endcode
+*/
+class ConfigSnapshot
+{
+  public:
+    /**
+     * @brief A configuration variable
+     */
+    struct Entry
+    {
+      std::string section;  ///< The name of the section
+      std::string tag;      ///< The name of the configuration variable
+      std::string value;    ///< The value of the configuration variable
+    };
+    using Entries = std::vector<Entry>;
+    using Ptr     = std::shared_ptr<const ConfigSnapshot>;
+
+    /**
+     * @brief   Constructor
+     * @param   generation  The configuration generation of the snapshot
+     * @param   entries     All variables, sorted on section and tag
+     */
+    ConfigSnapshot(uint64_t generation, Entries&& entries)
+      : m_generation(generation), m_entries(std::move(entries)) {}
+
+    /**
+     * @brief   Get the configuration generation of the snapshot
+     * @return  Returns the value of Config::generation at creation time
+     */
+    uint64_t generation(void) const { return m_generation; }
+
+    /**
+     * @brief   Get all configuration variables
+     * @return  Returns all variables, sorted on section and tag
+     */
+    const Entries& entries(void) const { return m_entries; }
+
+    /**
+     * @brief   Find a configuration variable
+     * @param   section The name of the section where the variable is located
+     * @param   tag     The name of the configuration variable
+     * @return  Returns a pointer to the value or \em nullptr if not found
+     */
+    const std::string* find(const std::string& section,
+                            const std::string& tag) const;
+
+    /**
+     * @brief   Check if a section exist
+     * @param   section The name of the section
+     * @return  Returns \em true if there is at least one variable in the
+     *          section
+     */
+    bool hasSection(const std::string& section) const;
+
+    /**
+     * @brief   Get the string value of a configuration variable
+     * @param   section    The name of the section where the variable is
+     *                     located
+     * @param   tag        The name of the configuration variable to get
+     * @param   value      The value is returned in this argument
+     * @param   missing_ok If set to \em true, return \em true if the
+     *                     configuration variable is missing
+     * @return  Returns \em true on success or else \em false on failure
+     */
+    bool getValue(const std::string& section, const std::string& tag,
+                  std::string& value, bool missing_ok = false) const;
+
+    /**
+     * @brief   Get the value of a configuration variable
+     * @param   section    The name of the section where the variable is
+     *                     located
+     * @param   tag        The name of the configuration variable to get
+     * @param   rsp        The value is returned in this argument
+     * @param   missing_ok If set to \em true, return \em true if the
+     *                     configuration variable is missing
+     * @return  Returns \em true on success or else \em false on failure
+     *
+     * The value is converted in the same way as for Config::getValue.
+     */
+    template <typename Rsp>
+    bool getValue(const std::string& section, const std::string& tag,
+                  Rsp &rsp, bool missing_ok = false) const
+    {
+      const std::string* str_val = find(section, tag);
+      if (str_val == nullptr)
+      {
+        return missing_ok;
+      }
+      std::stringstream ssval(*str_val);
+      Rsp tmp;
+      ssval >> tmp;
+      if(!ssval.eof())
+      {
+        ssval >> std::ws;
+      }
+      if (ssval.fail() || !ssval.eof())
+      {
+        return false;
+      }
+      rsp = tmp;
+      return true;
+    } /* ConfigSnapshot::getValue */
+
+  private:
+    uint64_t  m_generation;
+    Entries   m_entries;
+
+};  /* class ConfigSnapshot */
+
+
 /**
 @brief	A class for reading INI-formatted configuration files
 @author Tobias Blomberg
@@ -597,6 +725,25 @@ class Config
      */
     std::list<std::string> listSection(const std::string& section);
 
+    /**
+     * @brief   Get the configuration generation
+     * @return  Returns a number that is increased on every change
+     *
+     * The generation is increased every time the configuration is changed,
+     * either by reading a configuration file or by calling setValue.
+     */
+    uint64_t generation(void) const { return m_generation; }
+
+    /**
+     * @brief   Get a read-only snapshot of the configuration
+     * @return  Returns a shared snapshot of all configuration variables
+     *
+     * The snapshot is only created once for each configuration generation.
+     * Calling this function again without any changes to the configuration
+     * in between return the same snapshot.
+     */
+    ConfigSnapshot::Ptr snapshot(void) const;
+
     /**
      * @brief   Set the value of a configuration variable
      * @param 	section   The name of the section where the configuration
@@ -729,7 +876,9 @@ class Config
       csv_whitespace(std::size_t refs=0) : ctype(make_table(), false, refs) {}
     };
 
-    Sections  sections;
+    Sections                    sections;
+    uint64_t                    m_generation = 0;
+    mutable ConfigSnapshot::Ptr m_snapshot;
 
     bool parseCfgFile(FILE *file);
     char *trimSpaces(char *line);
@@ -767,6 +916,160 @@ class Config
 }; /* class Config */
 
 
+/**
+@brief  A typed handle to a configuration variable
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+This class is used to read a configuration variable that is used often. The
+value is converted once to the given type and cached. When the configuration
+variable is changed using Config::setValue, the cached value is updated and
+the valueChanged signal is emitted. Reading the value is then as cheap as
+reading a member variable.
+
+If the configuration variable is not set, or if it cannot be converted to the
+given type, the default value is used.
+
+\code
+Async::ConfigValue<unsigned> sql_timeout(cfg, "GLOBAL", "SQL_TIMEOUT", 15);
+if (sql_timeout.value() > 0)
+{
+  ...
+}
+\endcode
+*/
+template <typename T>
+class ConfigValue : public sigc::trackable
+{
+  public:
+    /**
+     * @brief   Default constructor
+     *
+     * The handle hold a default constructed value until attach is called.
+     */
+    ConfigValue(void) {}
+
+    /**
+     * @brief   Constructor
+     * @param   cfg     The configuration object to read from
+     * @param   section The name of the section where the variable is located
+     * @param   tag     The name of the configuration variable
+     * @param   def     The value to use if the variable is not set
+     */
+    ConfigValue(Config& cfg, const std::string& section,
+                const std::string& tag, const T& def=T())
+    {
+      attach(cfg, section, tag, def);
+    }
+
+    /**
+     * @brief   Disallow copy construction
+     */
+    ConfigValue(const ConfigValue&) = delete;
+
+    /**
+     * @brief   Disallow copy assignment
+     */
+    ConfigValue& operator=(const ConfigValue&) = delete;
+
+    /**
+     * @brief   Destructor
+     */
+    ~ConfigValue(void) { m_updated_con.disconnect(); }
+
+    /**
+     * @brief   Attach the handle to a configuration variable
+     * @param   cfg     The configuration object to read from
+     * @param   section The name of the section where the variable is located
+     * @param   tag     The name of the configuration variable
+     * @param   def     The value to use if the variable is not set
+     */
+    void attach(Config& cfg, const std::string& section,
+                const std::string& tag, const T& def=T())
+    {
+      m_updated_con.disconnect();
+      m_cfg = &cfg;
+      m_section = section;
+      m_tag = tag;
+      m_def = def;
+      m_updated_con = cfg.valueUpdated.connect(
+          sigc::mem_fun(*this, &ConfigValue::onValueUpdated));
+      update();
+    }
+
+    /**
+     * @brief   Get the cached value
+     * @return  Returns the converted value of the configuration variable
+     */
+    const T& value(void) const { return m_value; }
+
+    /**
+     * @brief   Get the cached value
+     * @return  Returns the converted value of the configuration variable
+     */
+    operator const T&(void) const { return m_value; }
+
+    /**
+     * @brief   Access members of the cached value
+     * @return  Returns a pointer to the cached value
+     */
+    const T* operator->(void) const { return &m_value; }
+
+    /**
+     * @brief   Check if the configuration variable is set
+     * @return  Returns \em true if the variable is set in the configuration
+     */
+    bool isSet(void) const { return m_is_set; }
+
+    /**
+     * @brief   Check if the configuration variable could be converted
+     * @return  Returns \em false if the variable is set but is not valid
+     */
+    bool isValid(void) const { return m_is_valid; }
+
+    /**
+     * @brief   A signal that is emitted when the cached value is updated
+     * @param   value The new value
+     */
+    sigc::signal<void(const T&)> valueChanged;
+
+  private:
+    Config*           m_cfg       = nullptr;
+    std::string       m_section;
+    std::string       m_tag;
+    T                 m_def       {};
+    T                 m_value     {};
+    bool              m_is_set    = false;
+    bool              m_is_valid  = true;
+    sigc::connection  m_updated_con;
+
+    void update(void)
+    {
+      std::string str_val;
+      m_is_set = m_cfg->getValue(m_section, m_tag, str_val);
+      m_is_valid = true;
+      if (!m_is_set)
+      {
+        m_value = m_def;
+        return;
+      }
+      T tmp{};
+      m_is_valid = m_cfg->getValue(m_section, m_tag, tmp);
+      m_value = m_is_valid ? std::move(tmp) : m_def;
+    }
+
+    void onValueUpdated(const std::string& section, const std::string& tag)
+    {
+      if ((tag == m_tag) && (section == m_section))
+      {
+        update();
+        valueChanged(m_value);
+      }
+    }
+
+};  /* class ConfigValue */
+
+
 } /* namespace */
 
 #endif /* ASYNC_CONFIG_INCLUDED */
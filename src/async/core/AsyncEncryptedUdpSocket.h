@@ -320,6 +320,11 @@ class EncryptedUdpSocket : public UdpSocket
      * @param   buf         A buffer containing the data to send
      * @param   count       The number of bytes to write
      * @return  Return \em true on success or \em false on failure
+     *
+     * The datagram is encrypted immediately using the currently set up IV and
+     * key so these may be changed between calls. If a write batch is active
+     * (see UdpSocket::beginWriteBatch) the encrypted datagram is queued and
+     * sent when the batch is flushed.
      */
     bool write(const IpAddress& remote_ip, int remote_port,
                const void *aad, int aadlen, const void *buf, int cnt);
@@ -144,6 +144,7 @@ Exec::Exec(const std::string &cmd)
       exit(1);
     }
     sigchld_watch = new FdWatch(sigchld_pipe[0], FdWatch::FD_WATCH_RD);
+    sigchld_watch->setTag("Async::Exec");
     sigchld_watch->activity.connect(
         sigc::hide(sigc::ptr_fun(Exec::sigchldReceived)));
 
@@ -256,6 +257,7 @@ void Exec::setTimeout(int time_s)
 {
   delete timeout_timer;
   timeout_timer = new Timer(1000 * time_s);
+  timeout_timer->setTag("Async::Exec");
   timeout_timer->expired.connect(hide(mem_fun(*this, &Exec::handleTimeout)));
   timeout_timer->setEnable(pid > 0);
 } /* Exec::setTimeout */
@@ -320,11 +322,13 @@ bool Exec::run(void)
       // Set up handling for subprocess stdout
     close(out_filedes[1]);
     stdout_watch = new FdWatch(out_filedes[0], FdWatch::FD_WATCH_RD);
+    stdout_watch->setTag("Async::Exec");
     stdout_watch->activity.connect(mem_fun(*this, &Exec::stdoutActivity));
 
       // Set up handling for subprocess stderr
     close(err_filedes[1]);
     stderr_watch = new FdWatch(err_filedes[0], FdWatch::FD_WATCH_RD);
+    stderr_watch->setTag("Async::Exec");
     stderr_watch->activity.connect(mem_fun(*this, &Exec::stderrActivity));
 
     if (timeout_timer != 0)
@@ -115,13 +115,13 @@ using namespace Async;
  ****************************************************************************/
 
 FdWatch::FdWatch(void)
-  : m_fd(-1), m_type(FD_WATCH_RD), m_enabled(false)
+  : m_fd(-1), m_type(FD_WATCH_RD), m_enabled(false), m_tag(0)
 {
 } /* FdWatch::FdWatch */
 
 
 FdWatch::FdWatch(int fd, FdWatchType type)
-  : m_fd(fd), m_type(type), m_enabled(true)
+  : m_fd(fd), m_type(type), m_enabled(true), m_tag(0)
 {
   Application::app().addFdWatch(this);
 } /* FdWatch::FdWatch */
@@ -147,6 +147,8 @@ FdWatch& FdWatch::operator=(FdWatch&& other)
   other.m_fd = -1;
   m_type = other.m_type;
   other.m_type = FD_WATCH_RD;
+  m_tag = other.m_tag;
+  other.m_tag = 0;
   setEnabled(other_was_enabled);
   return *this;
 } /* FdWatch::operator=(FdWatch&&) */
@@ -200,6 +200,22 @@ class FdWatch : public sigc::trackable
      */
     void setFd(int fd, FdWatchType type);
 
+    /**
+     * @brief   Set a tag that identify the owner of this watch
+     * @param   tag A string, normally the class name of the owning object
+     *
+     * The tag is used by the main loop profiler (see Async::LoopProfiler) to
+     * group callback statistics. The string is not copied so it must stay
+     * valid for the lifetime of the watch, e.g. a string literal.
+     */
+    void setTag(const char *tag) { m_tag = tag; }
+
+    /**
+     * @brief   Get the tag that identify the owner of this watch
+     * @return  Returns the tag or 0 if not set
+     */
+    const char *tag(void) const { return m_tag; }
+
     /**
      * @brief Signal to indicate that the descriptor is active
      * @param watch Pointer to the watch object
@@ -213,6 +229,7 @@ class FdWatch : public sigc::trackable
     int       	m_fd;
     FdWatchType m_type;
     bool      	m_enabled;
+    const char* m_tag;
   
 };  /* class FdWatch */
 
@@ -142,6 +142,7 @@ bool FileReader::open(const string& name)
   }
   
   rd_watch = new FdWatch(fd, FdWatch::FD_WATCH_RD);
+  rd_watch->setTag("Async::FileReader");
   rd_watch->activity.connect(mem_fun(*this, &FileReader::onDataAvail));
 
   return fillBuffer();
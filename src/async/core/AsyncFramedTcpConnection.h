@@ -131,6 +131,56 @@ that only want to see completely transfered messages at the other end.
 class FramedTcpConnection : public TcpConnection
 {
   public:
+    /**
+     * @brief   An immutable, reference counted, ready to send frame
+     *
+     * The frame header is added and the payload is copied once when the
+     * frame is created. After that the frame can be written to any number of
+     * connections without being copied again, e.g. when broadcasting the same
+     * message to many clients. Copying a Frame object only copy a reference.
+     */
+    class Frame
+    {
+      public:
+        /**
+         * @brief   Default constructor, creating an invalid frame
+         */
+        Frame(void) {}
+
+        /**
+         * @brief   Constructor
+         * @param   buf   The buffer containing the frame payload
+         * @param   count The number of bytes in the payload
+         */
+        Frame(const void* buf, int count);
+
+        /**
+         * @brief   Check if the frame is valid
+         * @return  Returns \em true if the frame contain data
+         */
+        bool isValid(void) const { return m_buf != nullptr; }
+
+        /**
+         * @brief   Get the size of the payload
+         * @return  Returns the payload size in bytes, not counting the header
+         */
+        size_t payloadSize(void) const
+        {
+          return isValid() ? m_buf->size() - HEADER_SIZE : 0;
+        }
+
+        /**
+         * @brief   Get the framed buffer, header included
+         * @return  Returns the buffer
+         */
+        const SharedBuffer& buffer(void) const { return m_buf; }
+
+      private:
+        static const size_t HEADER_SIZE = 4;
+
+        SharedBuffer m_buf;
+    };
+
     /**
      * @brief 	Constructor
      * @param 	recv_buf_len  The length of the receiver buffer to use
@@ -206,6 +256,28 @@ class FramedTcpConnection : public TcpConnection
       setMaxTxFrameSize(frame_size);
     }
 
+    /**
+     * @brief   Set the maximum size of the transmit queue
+     * @param   queue_size The maximum number of queued bytes, 0=unlimited
+     *
+     * Use this function to put a limit on how much data that may be waiting
+     * to be sent to a slow remote peer. When the limit has been reached,
+     * the write functions will discard the frame and return -1 with errno set
+     * to ENOBUFS. It is up to the caller to decide what to do with the slow
+     * consumer, e.g. disconnect it. A frame is always accepted if the queue is
+     * empty. The default is to not limit the queue size.
+     */
+    void setMaxTxQueueSize(size_t queue_size)
+    {
+      m_max_tx_queue_size = queue_size;
+    }
+
+    /**
+     * @brief   Get the maximum size of the transmit queue
+     * @return  Returns the maximum number of queued bytes, 0=unlimited
+     */
+    size_t maxTxQueueSize(void) const { return m_max_tx_queue_size; }
+
     /**
      * @brief 	Send a frame on the TCP connection
      * @param 	buf The buffer containing the frame to send
@@ -219,6 +291,18 @@ class FramedTcpConnection : public TcpConnection
      */
     virtual int write(const void *buf, int count) override;
 
+    /**
+     * @brief   Send a prepared frame on the TCP connection
+     * @param   frame The frame to send
+     * @return  Return the payload size or -1 on failure
+     *
+     * This function work like the other write function but the frame has
+     * already been prepared so no copy has to be made on an unencrypted
+     * connection. Use this function when sending the same data to many
+     * connections.
+     */
+    int write(const Frame& frame);
+
     /**
      * @brief 	A signal that is emitted when a connection has been terminated
      * @param 	con   	The connection object
@@ -243,23 +327,6 @@ class FramedTcpConnection : public TcpConnection
 
     FramedTcpConnection& operator=(const FramedTcpConnection&) = delete;
 
-    /**
-     * @brief   Disconnect from the remote peer
-     *
-     * This function is used internally to close the connection to the remote
-     * peer.
-     */
-    virtual void closeConnection(void) override;
-
-    /**
-     * @brief 	Called when a connection has been terminated
-     * @param 	reason  The reason for the disconnect
-     *
-     * This function will be called when the connection has been terminated.
-     * The default action for this function is to emit the disconnected signal.
-     */
-    virtual void onDisconnected(DisconnectReason reason) override;
-
     /**
      * @brief 	Called when data has been received on the connection
      * @param 	buf   A buffer containg the read data
@@ -289,37 +356,14 @@ class FramedTcpConnection : public TcpConnection
   private:
     static const uint32_t DEFAULT_MAX_FRAME_SIZE = 1024 * 1024; // 1MB
 
-    struct QueueItem
-    {
-      char* m_buf;
-      int   m_size;
-      int   m_pos;
-
-      QueueItem(const void* buf, int count)
-        : m_buf(0), m_size(4+count), m_pos(0)
-      {
-        m_buf = new char[4+count];
-        char *ptr = m_buf;
-        *ptr++ = static_cast<uint32_t>(count) >> 24;
-        *ptr++ = (static_cast<uint32_t>(count) >> 16) & 0xff;
-        *ptr++ = (static_cast<uint32_t>(count) >> 8) & 0xff;
-        *ptr++ = (static_cast<uint32_t>(count)) & 0xff;
-        std::memcpy(ptr, buf, count);
-      }
-      ~QueueItem(void) { delete [] m_buf; }
-    };
-    typedef std::deque<QueueItem*> TxQueue;
-
     uint32_t              m_max_rx_frame_size;
     uint32_t              m_max_tx_frame_size;
+    size_t                m_max_tx_queue_size;
     bool                  m_size_received;
     uint32_t              m_frame_size;
     std::vector<uint8_t>  m_frame;
-    TxQueue               m_txq;
 
     FramedTcpConnection(const FramedTcpConnection&) = delete;
-    //void onSendBufferFull(bool is_full);
-    void disconnectCleanup(void);
 
 };  /* class FramedTcpConnection */
 
@@ -0,0 +1,361 @@
+/**
+@file   AsyncLoopProfiler.cpp
+@brief  Collect statistics about where time is spent in the main loop
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <time.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <map>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncLoopProfiler.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Static class variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+namespace {
+
+
+/****************************************************************************
+ *
+ * Local functions
+ *
+ ****************************************************************************/
+
+double toUs(uint64_t ns)
+{
+  return ns / 1000.0;
+}
+
+
+}; /* End of anonymous namespace */
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+void LoopProfiler::Histogram::add(uint64_t ns)
+{
+  unsigned bucket = 0;
+  while ((bucket < BUCKET_CNT - 1) && (ns >= bucketLimitNs(bucket)))
+  {
+    ++bucket;
+  }
+  m_buckets[bucket] += 1;
+  m_count += 1;
+  m_total_ns += ns;
+  m_max_ns = std::max(m_max_ns, ns);
+} /* LoopProfiler::Histogram::add */
+
+
+void LoopProfiler::Histogram::merge(const Histogram& other)
+{
+  for (unsigned i=0; i<BUCKET_CNT; ++i)
+  {
+    m_buckets[i] += other.m_buckets[i];
+  }
+  m_count += other.m_count;
+  m_total_ns += other.m_total_ns;
+  m_max_ns = std::max(m_max_ns, other.m_max_ns);
+} /* LoopProfiler::Histogram::merge */
+
+
+void LoopProfiler::Histogram::reset(void)
+{
+  memset(m_buckets, 0, sizeof(m_buckets));
+  m_count = 0;
+  m_total_ns = 0;
+  m_max_ns = 0;
+} /* LoopProfiler::Histogram::reset */
+
+
+uint64_t LoopProfiler::Histogram::percentileNs(double pct) const
+{
+  if (m_count == 0)
+  {
+    return 0;
+  }
+  const double limit = pct * m_count / 100.0;
+  uint64_t cnt = 0;
+  for (unsigned i=0; i<BUCKET_CNT - 1; ++i)
+  {
+    cnt += m_buckets[i];
+    if (cnt >= limit)
+    {
+      return std::min(bucketLimitNs(i), m_max_ns);
+    }
+  }
+  return m_max_ns;
+} /* LoopProfiler::Histogram::percentileNs */
+
+
+void LoopProfiler::Snapshot::print(std::ostream& os) const
+{
+  if (!enabled)
+  {
+    os << "Main loop profiling is disabled" << std::endl;
+    return;
+  }
+
+  const std::ios_base::fmtflags flags = os.flags();
+  const std::streamsize precision = os.precision();
+  os << std::fixed << std::setprecision(1);
+
+  const uint64_t loop_ns = busy_ns + idle_ns;
+  os << "Main loop profile for the last " << (period_ns / 1.0e9) << "s: "
+     << iterations << " iterations, "
+     << (loop_ns > 0 ? 100.0 * busy_ns / loop_ns : 0.0) << "% busy"
+     << std::endl;
+  os << "Timer lag (us): count=" << timer_lag.count()
+     << " avg=" << toUs(timer_lag.avgNs())
+     << " p50<=" << toUs(timer_lag.percentileNs(50))
+     << " p99<=" << toUs(timer_lag.percentileNs(99))
+     << " max=" << toUs(timer_lag.maxNs())
+     << std::endl;
+  os << std::left << std::setw(32) << "Callback"
+     << std::setw(9) << "Type" << std::right
+     << std::setw(10) << "Count"
+     << std::setw(10) << "Avg(us)"
+     << std::setw(10) << "p99(us)"
+     << std::setw(10) << "Max(us)"
+     << std::setw(12) << "Total(ms)"
+     << std::endl;
+  for (const auto& cb : callbacks)
+  {
+    os << std::left << std::setw(32) << cb.tag
+       << std::setw(9) << callbackTypeName(cb.type) << std::right
+       << std::setw(10) << cb.duration.count()
+       << std::setw(10) << toUs(cb.duration.avgNs())
+       << std::setw(10) << toUs(cb.duration.percentileNs(99))
+       << std::setw(10) << toUs(cb.duration.maxNs())
+       << std::setw(12) << (cb.duration.totalNs() / 1.0e6)
+       << std::endl;
+  }
+
+  os.flags(flags);
+  os.precision(precision);
+} /* LoopProfiler::Snapshot::print */
+
+
+LoopProfiler& LoopProfiler::instance(void)
+{
+  static LoopProfiler profiler;
+  return profiler;
+} /* LoopProfiler::instance */
+
+
+const char *LoopProfiler::callbackTypeName(CallbackType type)
+{
+  switch (type)
+  {
+    case CB_FD_READ:
+      return "fd_read";
+    case CB_FD_WRITE:
+      return "fd_write";
+    case CB_TIMER:
+      return "timer";
+  }
+  return "?";
+} /* LoopProfiler::callbackTypeName */
+
+
+uint64_t LoopProfiler::nowNs(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return uint64_t(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+} /* LoopProfiler::nowNs */
+
+
+void LoopProfiler::setEnabled(bool enable)
+{
+  if (enable && !m_enabled)
+  {
+    reset();
+  }
+  m_enabled = enable;
+} /* LoopProfiler::setEnabled */
+
+
+void LoopProfiler::reset(void)
+{
+  m_start_ns = nowNs();
+  m_wait_begin_ns = 0;
+  m_wait_end_ns = 0;
+  m_iterations = 0;
+  m_busy_ns = 0;
+  m_idle_ns = 0;
+  m_timer_lag.reset();
+  m_callbacks.clear();
+} /* LoopProfiler::reset */
+
+
+LoopProfiler::Snapshot LoopProfiler::snapshot(void) const
+{
+  Snapshot snap;
+  snap.enabled = m_enabled;
+  snap.period_ns = nowNs() - m_start_ns;
+  snap.iterations = m_iterations;
+  snap.busy_ns = m_busy_ns;
+  snap.idle_ns = m_idle_ns;
+  snap.timer_lag = m_timer_lag;
+
+    // The same tag may be stored at different addresses so merge the
+    // statistics for equal tags
+  std::map<std::pair<CallbackType, std::string>, Histogram> merged;
+  for (const auto& item : m_callbacks)
+  {
+    const char *tag = (item.first.tag != 0) ? item.first.tag : "(untagged)";
+    merged[std::make_pair(item.first.type, std::string(tag))]
+      .merge(item.second);
+  }
+  for (const auto& item : merged)
+  {
+    snap.callbacks.push_back({item.first.first, item.first.second,
+                              item.second});
+  }
+  std::sort(snap.callbacks.begin(), snap.callbacks.end(),
+      [](const CallbackStats& a, const CallbackStats& b)
+      {
+        return a.duration.totalNs() > b.duration.totalNs();
+      });
+  return snap;
+} /* LoopProfiler::snapshot */
+
+
+void LoopProfiler::waitBegin(void)
+{
+  m_wait_begin_ns = nowNs();
+  if (m_wait_end_ns > 0)
+  {
+    m_busy_ns += m_wait_begin_ns - m_wait_end_ns;
+  }
+} /* LoopProfiler::waitBegin */
+
+
+void LoopProfiler::waitEnd(void)
+{
+  m_wait_end_ns = nowNs();
+  if (m_wait_begin_ns > 0)
+  {
+    m_idle_ns += m_wait_end_ns - m_wait_begin_ns;
+  }
+  m_iterations += 1;
+} /* LoopProfiler::waitEnd */
+
+
+void LoopProfiler::addCallback(CallbackType type, const char *tag,
+                               uint64_t duration_ns)
+{
+  m_callbacks[Key{type, tag}].add(duration_ns);
+} /* LoopProfiler::addCallback */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+LoopProfiler::LoopProfiler(void)
+  : m_enabled(false)
+{
+  reset();
+  const char *env = std::getenv("ASYNC_LOOP_PROFILE");
+  if ((env != 0) && (std::atoi(env) != 0))
+  {
+    m_enabled = true;
+  }
+} /* LoopProfiler::LoopProfiler */
+
+
+
+/*
+ * This file has not been truncated
+ */
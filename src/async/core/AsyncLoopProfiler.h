@@ -0,0 +1,389 @@
+/**
+@file   AsyncLoopProfiler.h
+@brief  Collect statistics about where time is spent in the main loop
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_LOOP_PROFILER_INCLUDED
+#define ASYNC_LOOP_PROFILER_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <stdint.h>
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief  Collect statistics about where time is spent in the main loop
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+This class collect statistics about the main loop. When enabled, the main
+loop implementation report the duration of each file descriptor watch and
+timer callback, how late each timer expire compared to its deadline and how
+much time is spent waiting for events. Callbacks are grouped by the tag set
+on the Async::FdWatch or Async::Timer object, which normally is the class
+name of the owning object.
+
+The profiler is disabled by default. It can be enabled using the setEnabled
+function or by setting the environment variable ASYNC_LOOP_PROFILE=1. Use the
+snapshot function to get a copy of the collected statistics.
+
+\code
+Async::LoopProfiler::instance().setEnabled(true);
+...
+Async::LoopProfiler::instance().snapshot().print(std::cout);
+\endcode
+*/
+class LoopProfiler
+{
+  public:
+    /**
+     * @brief The type of callback
+     */
+    typedef enum
+    {
+      CB_FD_READ,   ///< A read file descriptor watch callback
+      CB_FD_WRITE,  ///< A write file descriptor watch callback
+      CB_TIMER      ///< A timer expiration callback
+    } CallbackType;
+
+    /**
+     * @brief A histogram with logarithmic time buckets
+     *
+     * Bucket zero count durations shorter than one microsecond. Each
+     * following bucket cover twice the time of the previous one. The last
+     * bucket count everything that did not fit in the other buckets.
+     */
+    class Histogram
+    {
+      public:
+        static const unsigned BUCKET_CNT = 24;  ///< The number of buckets
+
+        /**
+         * @brief   Get the upper limit for a bucket
+         * @param   bucket The bucket index
+         * @return  Returns the exclusive upper limit in nanoseconds
+         */
+        static uint64_t bucketLimitNs(unsigned bucket)
+        {
+          return 1000ULL << bucket;
+        }
+
+        /**
+         * @brief   Default constructor
+         */
+        Histogram(void) { reset(); }
+
+        /**
+         * @brief   Add a sample to the histogram
+         * @param   ns The sample value in nanoseconds
+         */
+        void add(uint64_t ns);
+
+        /**
+         * @brief   Add all samples from another histogram to this one
+         * @param   other The histogram to merge into this one
+         */
+        void merge(const Histogram& other);
+
+        /**
+         * @brief   Clear all samples
+         */
+        void reset(void);
+
+        /**
+         * @brief   Get the number of samples
+         * @return  Returns the number of samples in the histogram
+         */
+        uint64_t count(void) const { return m_count; }
+
+        /**
+         * @brief   Get the sum of all samples
+         * @return  Returns the sum in nanoseconds
+         */
+        uint64_t totalNs(void) const { return m_total_ns; }
+
+        /**
+         * @brief   Get the largest sample
+         * @return  Returns the largest sample in nanoseconds
+         */
+        uint64_t maxNs(void) const { return m_max_ns; }
+
+        /**
+         * @brief   Get the average of all samples
+         * @return  Returns the average in nanoseconds
+         */
+        uint64_t avgNs(void) const
+        {
+          return (m_count > 0) ? m_total_ns / m_count : 0;
+        }
+
+        /**
+         * @brief   Get the number of samples in a bucket
+         * @param   bucket The bucket index
+         * @return  Returns the number of samples in the given bucket
+         */
+        uint64_t bucketCount(unsigned bucket) const
+        {
+          return m_buckets[bucket];
+        }
+
+        /**
+         * @brief   Estimate a percentile
+         * @param   pct The percentile to estimate (0-100)
+         * @return  Returns an upper bound in nanoseconds for the percentile
+         */
+        uint64_t percentileNs(double pct) const;
+
+      private:
+        uint64_t m_buckets[BUCKET_CNT];
+        uint64_t m_count;
+        uint64_t m_total_ns;
+        uint64_t m_max_ns;
+    };
+
+    /**
+     * @brief Statistics for all callbacks of one type with the same tag
+     */
+    struct CallbackStats
+    {
+      CallbackType  type;       ///< The type of callback
+      std::string   tag;        ///< The tag of the watch or timer
+      Histogram     duration;   ///< Callback durations
+    };
+
+    /**
+     * @brief A copy of the collected statistics
+     */
+    struct Snapshot
+    {
+      bool          enabled     = false;  ///< Profiling enabled
+      uint64_t      period_ns   = 0;      ///< Time since enable or reset
+      uint64_t      iterations  = 0;      ///< Number of loop iterations
+      uint64_t      busy_ns     = 0;      ///< Time spent handling events
+      uint64_t      idle_ns     = 0;      ///< Time spent waiting for events
+      Histogram     timer_lag;            ///< How late timers expire
+      std::vector<CallbackStats> callbacks; ///< Sorted by total duration
+
+      /**
+       * @brief   Print the snapshot in a human readable format
+       * @param   os The stream to print to
+       */
+      void print(std::ostream& os) const;
+    };
+
+    /**
+     * @brief   Get the profiler instance
+     * @return  Returns the one and only profiler instance
+     */
+    static LoopProfiler& instance(void);
+
+    /**
+     * @brief   Get the name of a callback type
+     * @param   type The callback type
+     * @return  Returns a short name for the callback type
+     */
+    static const char *callbackTypeName(CallbackType type);
+
+    /**
+     * @brief   Read the monotonic clock
+     * @return  Returns the current monotonic time in nanoseconds
+     */
+    static uint64_t nowNs(void);
+
+    /**
+     * @brief   Disallow copy construction
+     */
+    LoopProfiler(const LoopProfiler&) = delete;
+
+    /**
+     * @brief   Disallow copy assignment
+     */
+    LoopProfiler& operator=(const LoopProfiler&) = delete;
+
+    /**
+     * @brief   Check if profiling is enabled
+     * @return  Returns \em true if profiling is enabled
+     */
+    bool isEnabled(void) const { return m_enabled; }
+
+    /**
+     * @brief   Enable or disable profiling
+     * @param   enable Set to \em true to enable profiling
+     *
+     * Enabling the profiler will also reset all statistics.
+     */
+    void setEnabled(bool enable);
+
+    /**
+     * @brief   Clear all collected statistics
+     */
+    void reset(void);
+
+    /**
+     * @brief   Get a copy of the collected statistics
+     * @return  Returns a snapshot of the statistics
+     */
+    Snapshot snapshot(void) const;
+
+    /**
+     * @brief   Called by the main loop before waiting for events
+     */
+    void waitBegin(void);
+
+    /**
+     * @brief   Called by the main loop after waiting for events
+     */
+    void waitEnd(void);
+
+    /**
+     * @brief   Called by the main loop after a callback have returned
+     * @param   type        The type of callback
+     * @param   tag         The tag of the watch or timer (may be 0)
+     * @param   duration_ns The time spent in the callback
+     */
+    void addCallback(CallbackType type, const char *tag, uint64_t duration_ns);
+
+    /**
+     * @brief   Called by the main loop when a timer expire
+     * @param   lag_ns How late the timer expired compared to its deadline
+     */
+    void addTimerLag(uint64_t lag_ns) { m_timer_lag.add(lag_ns); }
+
+  protected:
+
+  private:
+    struct Key
+    {
+      CallbackType  type;
+      const char*   tag;
+      bool operator==(const Key& other) const
+      {
+        return (type == other.type) && (tag == other.tag);
+      }
+    };
+    struct KeyHash
+    {
+      size_t operator()(const Key& key) const
+      {
+        return std::hash<const void*>()(key.tag) ^ key.type;
+      }
+    };
+    typedef std::unordered_map<Key, Histogram, KeyHash> CallbackMap;
+
+    bool        m_enabled;
+    uint64_t    m_start_ns;
+    uint64_t    m_wait_begin_ns;
+    uint64_t    m_wait_end_ns;
+    uint64_t    m_iterations;
+    uint64_t    m_busy_ns;
+    uint64_t    m_idle_ns;
+    Histogram   m_timer_lag;
+    CallbackMap m_callbacks;
+
+    LoopProfiler(void);
+
+};  /* class LoopProfiler */
+
+
+} /* namespace Async */
+
+#endif /* ASYNC_LOOP_PROFILER_INCLUDED */
+
+/*
+ * This file has not been truncated
+ */
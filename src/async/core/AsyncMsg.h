@@ -86,12 +86,32 @@ MsgDerived d2;
 d2.unpack(ss);
 \endcode
 
+Messages can also be packed directly into a caller supplied buffer, and
+unpacked from one, without going through a stream. This is faster and does
+not allocate any memory, which is useful in hot paths like when handling audio
+packets. For messages where all members have a fixed size, the packed size is
+also available at compile time through the static fixedPackedSize function.
+
+\code{.cpp}
+char buf[512];
+Async::MsgBufWriter w(buf, sizeof(buf));
+if (d1.pack(w))
+{
+  Async::MsgBufReader r(buf, w.size());
+  d2.unpack(r);
+}
+\endcode
+
+MsgPacker specializations, like the std::pair example above, may implement
+pack(Async::MsgBufWriter&, ...), unpack(Async::MsgBufReader&, ...) and
+fixedSize() too. If they do not, the stream functions are used.
+
 For a working example, have a look at the demo application,
 \ref AsyncMsg_demo.cpp.
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2023 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -128,9 +148,14 @@ An example of how to use the AsyncMsg class
 #include <ostream>
 #include <vector>
 #include <array>
+#include <iterator>
 #include <set>
 #include <map>
 #include <limits>
+#include <streambuf>
+#include <type_traits>
+#include <utility>
+#include <cstring>
 #include <endian.h>
 #include <stdint.h>
 
@@ -195,13 +220,25 @@ namespace Async
     { \
       return BASE_CLASS::pack(os); \
     } \
+    bool packParent(Async::MsgBufWriter& w) const \
+    { \
+      return BASE_CLASS::pack(w); \
+    } \
     size_t packedSizeParent(void) const \
     { \
       return BASE_CLASS::packedSize(); \
     } \
+    static constexpr size_t fixedPackedSizeParent(void) \
+    { \
+      return BASE_CLASS::fixedPackedSize(); \
+    } \
     bool unpackParent(std::istream& is) \
     { \
       return BASE_CLASS::unpack(is); \
+    } \
+    bool unpackParent(Async::MsgBufReader& r) \
+    { \
+      return BASE_CLASS::unpack(r); \
     }
 
 /**
@@ -216,13 +253,26 @@ namespace Async
     { \
       return packParent(os) && Msg::pack(os, __VA_ARGS__); \
     } \
+    bool pack(Async::MsgBufWriter& w) const override \
+    { \
+      return packParent(w) && Msg::pack(w, __VA_ARGS__); \
+    } \
     size_t packedSize(void) const override \
     { \
       return packedSizeParent() + Msg::packedSize(__VA_ARGS__); \
     } \
+    static constexpr size_t fixedPackedSize(void) \
+    { \
+      return Async::msgAddPackedSize(fixedPackedSizeParent(), \
+          decltype(Msg::fixedPackedSizeOf(__VA_ARGS__))::value); \
+    } \
     bool unpack(std::istream& is) override \
     { \
       return unpackParent(is) && Msg::unpack(is, __VA_ARGS__); \
+    } \
+    bool unpack(Async::MsgBufReader& r) override \
+    { \
+      return unpackParent(r) && Msg::unpack(r, __VA_ARGS__); \
     }
 
 /**
@@ -235,12 +285,54 @@ namespace Async
     { \
       return packParent(os); \
     } \
+    bool pack(Async::MsgBufWriter& w) const override \
+    { \
+      return packParent(w); \
+    } \
     size_t packedSize(void) const override { return packedSizeParent(); } \
+    static constexpr size_t fixedPackedSize(void) \
+    { \
+      return fixedPackedSizeParent(); \
+    } \
     bool unpack(std::istream& is) override \
     { \
       return unpackParent(is); \
+    } \
+    bool unpack(Async::MsgBufReader& r) override \
+    { \
+      return unpackParent(r); \
     }
 
+/**
+ * @brief   The fixed packed size of a type that have a variable packed size
+ */
+constexpr size_t MSG_VARIABLE_PACKED_SIZE =
+  std::numeric_limits<size_t>::max();
+
+/**
+ * @brief   Add two fixed packed sizes
+ * @param   a The first size
+ * @param   b The second size
+ * @return  Returns the sum or MSG_VARIABLE_PACKED_SIZE if any is variable
+ */
+constexpr size_t msgAddPackedSize(size_t a, size_t b)
+{
+  return ((a == MSG_VARIABLE_PACKED_SIZE) || (b == MSG_VARIABLE_PACKED_SIZE))
+    ? MSG_VARIABLE_PACKED_SIZE : a + b;
+}
+
+/**
+ * @brief   Multiply a fixed packed size with a count
+ * @param   size  The size of one item
+ * @param   cnt   The number of items
+ * @return  Returns the product or MSG_VARIABLE_PACKED_SIZE if size is variable
+ */
+constexpr size_t msgMulPackedSize(size_t size, size_t cnt)
+{
+  return (size == MSG_VARIABLE_PACKED_SIZE)
+    ? MSG_VARIABLE_PACKED_SIZE : size * cnt;
+}
+
 
 /****************************************************************************
  *
@@ -256,13 +348,206 @@ namespace Async
  *
  ****************************************************************************/
 
+/**
+@brief  Write packed data to a caller supplied buffer
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+This class is used to pack messages directly into a contiguous memory area
+instead of to a std::ostream. No memory is allocated. A write that does not
+fit in the buffer fails and put the writer in an error state so that all
+following writes also fail.
+*/
+class MsgBufWriter
+{
+  public:
+    /**
+     * @brief   Constructor
+     * @param   buf The buffer to write to
+     * @param   len The size of the buffer
+     */
+    MsgBufWriter(void* buf, size_t len)
+      : m_buf(static_cast<char*>(buf)), m_len(len), m_pos(0), m_good(true) {}
+
+    /**
+     * @brief   Write data to the buffer
+     * @param   data  The data to write
+     * @param   len   The number of bytes to write
+     * @return  Returns \em true on success or \em false if it did not fit
+     */
+    bool write(const void* data, size_t len)
+    {
+      char* dest = reserve(len);
+      if ((dest != 0) && (len > 0))
+      {
+        std::memcpy(dest, data, len);
+      }
+      return dest != 0;
+    }
+
+    /**
+     * @brief   Reserve space in the buffer
+     * @param   len The number of bytes to reserve
+     * @return  Returns a pointer to the reserved space or 0 if it did not fit
+     */
+    char* reserve(size_t len)
+    {
+      if (!m_good || (len > m_len - m_pos))
+      {
+        m_good = false;
+        return 0;
+      }
+      char* dest = m_buf + m_pos;
+      m_pos += len;
+      return dest;
+    }
+
+    /**
+     * @brief   Check if all writes have succeeded
+     * @return  Returns \em true if no write have failed
+     */
+    bool good(void) const { return m_good; }
+
+    /**
+     * @brief   Get the number of bytes written
+     * @return  Returns the number of bytes written to the buffer
+     */
+    size_t size(void) const { return m_pos; }
+
+    /**
+     * @brief   Get the number of bytes left in the buffer
+     * @return  Returns the number of bytes that still can be written
+     */
+    size_t remaining(void) const { return m_len - m_pos; }
+
+    /**
+     * @brief   Get a pointer to the next byte to write
+     * @return  Returns a pointer to the current write position
+     */
+    char* current(void) const { return m_buf + m_pos; }
+
+  private:
+    char*   m_buf;
+    size_t  m_len;
+    size_t  m_pos;
+    bool    m_good;
+};  /* class MsgBufWriter */
+
+
+/**
+@brief  Read packed data from a caller supplied buffer
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+This class is used to unpack messages directly from a contiguous memory area
+instead of from a std::istream. All reads are bounds checked and no memory
+is allocated by the reader itself. A read past the end of the buffer fails
+and put the reader in an error state so that all following reads also fail.
+*/
+class MsgBufReader
+{
+  public:
+    /**
+     * @brief   Constructor
+     * @param   buf The buffer to read from
+     * @param   len The size of the buffer
+     */
+    MsgBufReader(const void* buf, size_t len)
+      : m_buf(static_cast<const char*>(buf)), m_len(len), m_pos(0),
+        m_good(true) {}
+
+    /**
+     * @brief   Read data from the buffer
+     * @param   data  Where to store the data
+     * @param   len   The number of bytes to read
+     * @return  Returns \em true on success or \em false on buffer underrun
+     */
+    bool read(void* data, size_t len)
+    {
+      const char* src = consume(len);
+      if ((src != 0) && (len > 0))
+      {
+        std::memcpy(data, src, len);
+      }
+      return src != 0;
+    }
+
+    /**
+     * @brief   Consume data from the buffer without copying it
+     * @param   len The number of bytes to consume
+     * @return  Returns a pointer to the consumed data or 0 on buffer underrun
+     */
+    const char* consume(size_t len)
+    {
+      if (!m_good || (len > m_len - m_pos))
+      {
+        m_good = false;
+        return 0;
+      }
+      const char* src = m_buf + m_pos;
+      m_pos += len;
+      return src;
+    }
+
+    /**
+     * @brief   Check if all reads have succeeded
+     * @return  Returns \em true if no read have failed
+     */
+    bool good(void) const { return m_good; }
+
+    /**
+     * @brief   Get the number of bytes read
+     * @return  Returns the number of bytes read from the buffer
+     */
+    size_t pos(void) const { return m_pos; }
+
+    /**
+     * @brief   Get the number of bytes left in the buffer
+     * @return  Returns the number of bytes that still can be read
+     */
+    size_t remaining(void) const { return m_len - m_pos; }
+
+    /**
+     * @brief   Get a pointer to the next byte to read
+     * @return  Returns a pointer to the current read position
+     */
+    const char* current(void) const { return m_buf + m_pos; }
+
+  private:
+    const char* m_buf;
+    size_t      m_len;
+    size_t      m_pos;
+    bool        m_good;
+};  /* class MsgBufReader */
+
+
+template <typename T> bool msgPack(MsgBufWriter& w, const T& val);
+template <typename T> bool msgUnpack(MsgBufReader& r, T& val);
+template <typename T> constexpr size_t msgFixedPackedSize(void);
+
+
 template <typename T>
 class MsgPacker
 {
   public:
     static bool pack(std::ostream& os, const T& val) { return val.pack(os); }
+    template <typename U>
+    static auto pack(MsgBufWriter& w, const U& val) -> decltype(val.pack(w))
+    {
+      return val.pack(w);
+    }
     static size_t packedSize(const T& val) { return val.packedSize(); }
+    template <typename U=T>
+    static constexpr auto fixedSize(void) -> decltype(U::fixedPackedSize())
+    {
+      return U::fixedPackedSize();
+    }
     static bool unpack(std::istream& is, T& val) { return val.unpack(is); }
+    template <typename U>
+    static auto unpack(MsgBufReader& r, U& val) -> decltype(val.unpack(r))
+    {
+      return val.unpack(r);
+    }
 };
 
 template <>
@@ -274,13 +559,16 @@ class MsgPacker<char>
       //std::cout << "pack<char>("<< int(val) << ")" << std::endl;
       return os.write(&val, 1).good();
     }
+    static bool pack(MsgBufWriter& w, char val) { return w.write(&val, 1); }
     static size_t packedSize(const char& val) { return sizeof(char); }
+    static constexpr size_t fixedSize(void) { return sizeof(char); }
     static bool unpack(std::istream& is, char& val)
     {
       is.read(&val, 1);
       //std::cout << "unpack<char>(" << int(val) << ")" << std::endl;
       return is.good();
     }
+    static bool unpack(MsgBufReader& r, char& val) { return r.read(&val, 1); }
 };
 
 template <typename T>
@@ -295,7 +583,15 @@ class Packer64
       o.uval = htobe64(o.uval);
       return os.write(o.buf, sizeof(T)).good();
     }
+    static bool pack(MsgBufWriter& w, const T& val)
+    {
+      Overlay o;
+      o.val = val;
+      o.uval = htobe64(o.uval);
+      return w.write(o.buf, sizeof(T));
+    }
     static size_t packedSize(const T& val) { return sizeof(T); }
+    static constexpr size_t fixedSize(void) { return sizeof(T); }
     static bool unpack(std::istream& is, T& val)
     {
       Overlay o;
@@ -305,6 +601,17 @@ class Packer64
       //std::cout << "unpack<64>(" << val << ")" << std::endl;
       return is.good();
     }
+    static bool unpack(MsgBufReader& r, T& val)
+    {
+      Overlay o;
+      if (!r.read(o.buf, sizeof(T)))
+      {
+        return false;
+      }
+      o.uval = be64toh(o.uval);
+      val = o.val;
+      return true;
+    }
   private:
     union Overlay
     {
@@ -329,7 +636,15 @@ class Packer32
       o.uval = htobe32(o.uval);
       return os.write(o.buf, sizeof(T)).good();
     }
+    static bool pack(MsgBufWriter& w, const T& val)
+    {
+      Overlay o;
+      o.val = val;
+      o.uval = htobe32(o.uval);
+      return w.write(o.buf, sizeof(T));
+    }
     static size_t packedSize(const T& val) { return sizeof(T); }
+    static constexpr size_t fixedSize(void) { return sizeof(T); }
     static bool unpack(std::istream& is, T& val)
     {
       Overlay o;
@@ -339,6 +654,17 @@ class Packer32
       //std::cout << "unpack<32>(" << val << ")" << std::endl;
       return is.good();
     }
+    static bool unpack(MsgBufReader& r, T& val)
+    {
+      Overlay o;
+      if (!r.read(o.buf, sizeof(T)))
+      {
+        return false;
+      }
+      o.uval = be32toh(o.uval);
+      val = o.val;
+      return true;
+    }
   private:
     union Overlay
     {
@@ -363,7 +689,15 @@ class Packer16
       o.uval = htobe16(o.uval);
       return os.write(o.buf, sizeof(T)).good();
     }
+    static bool pack(MsgBufWriter& w, const T& val)
+    {
+      Overlay o;
+      o.val = val;
+      o.uval = htobe16(o.uval);
+      return w.write(o.buf, sizeof(T));
+    }
     static size_t packedSize(const T& val) { return sizeof(T); }
+    static constexpr size_t fixedSize(void) { return sizeof(T); }
     static bool unpack(std::istream& is, T& val)
     {
       Overlay o;
@@ -373,6 +707,17 @@ class Packer16
       //std::cout << "unpack<16>(" << val << ")" << std::endl;
       return is.good();
     }
+    static bool unpack(MsgBufReader& r, T& val)
+    {
+      Overlay o;
+      if (!r.read(o.buf, sizeof(T)))
+      {
+        return false;
+      }
+      o.uval = be16toh(o.uval);
+      val = o.val;
+      return true;
+    }
   private:
     union Overlay
     {
@@ -393,17 +738,80 @@ class Packer8
       //std::cout << "pack<8>(" << int(val) << ")" << std::endl;
       return os.write(reinterpret_cast<const char*>(&val), sizeof(T)).good();
     }
+    static bool pack(MsgBufWriter& w, const T& val)
+    {
+      return w.write(&val, sizeof(T));
+    }
     static size_t packedSize(const T& val) { return sizeof(T); }
+    static constexpr size_t fixedSize(void) { return sizeof(T); }
     static bool unpack(std::istream& is, T& val)
     {
       is.read(reinterpret_cast<char*>(&val), sizeof(T));
       //std::cout << "unpack<8>(" << int(val) << ")" << std::endl;
       return is.good();
     }
+    static bool unpack(MsgBufReader& r, T& val)
+    {
+      return r.read(&val, sizeof(T));
+    }
 };
 template <> class MsgPacker<uint8_t> : public Packer8<uint8_t> {};
 template <> class MsgPacker<int8_t> : public Packer8<int8_t> {};
 
+  // Types that are packed as they are, one byte per item, so that arrays of
+  // them can be copied in one go
+template <typename T>
+struct MsgIsRawByte
+  : std::integral_constant<bool, std::is_same<T, char>::value ||
+                                 std::is_same<T, uint8_t>::value ||
+                                 std::is_same<T, int8_t>::value>
+{
+};
+
+  // Pack and unpack the items of a vector or an array. Tag dispatch on
+  // MsgIsRawByte is used so that the raw copy is only compiled for raw byte
+  // types. Other types, like std::vector<bool>, cannot be accessed as a
+  // plain array.
+template <typename C>
+bool msgPackItems(MsgBufWriter& w, const C& items, std::true_type)
+{
+  const size_t cnt = std::end(items) - std::begin(items);
+  return (cnt == 0) || w.write(&*std::begin(items), cnt);
+}
+
+template <typename C>
+bool msgPackItems(MsgBufWriter& w, const C& items, std::false_type)
+{
+  for (const auto& item : items)
+  {
+    if (!msgPack(w, item))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename C>
+bool msgUnpackItems(MsgBufReader& r, C& items, std::true_type)
+{
+  const size_t cnt = std::end(items) - std::begin(items);
+  return (cnt == 0) || r.read(&*std::begin(items), cnt);
+}
+
+template <typename C>
+bool msgUnpackItems(MsgBufReader& r, C& items, std::false_type)
+{
+  for (auto& item : items)
+  {
+    if (!msgUnpack(r, item))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
 template <>
 class MsgPacker<std::string>
 {
@@ -419,10 +827,24 @@ class MsgPacker<std::string>
       return MsgPacker<uint16_t>::pack(os, str_len) &&
              os.write(val.c_str(), val.size());
     }
+    static bool pack(MsgBufWriter& w, const std::string& val)
+    {
+      if (val.size() > std::numeric_limits<uint16_t>::max())
+      {
+        return false;
+      }
+      uint16_t str_len(val.size());
+      return MsgPacker<uint16_t>::pack(w, str_len) &&
+             w.write(val.data(), val.size());
+    }
     static size_t packedSize(const std::string& val)
     {
       return sizeof(uint16_t) + val.size();
     }
+    static constexpr size_t fixedSize(void)
+    {
+      return MSG_VARIABLE_PACKED_SIZE;
+    }
     static bool unpack(std::istream& is, std::string& val)
     {
       uint16_t str_len;
@@ -442,6 +864,21 @@ class MsgPacker<std::string>
       }
       return false;
     }
+    static bool unpack(MsgBufReader& r, std::string& val)
+    {
+      uint16_t str_len;
+      if (!MsgPacker<uint16_t>::unpack(r, str_len))
+      {
+        return false;
+      }
+      const char* str = r.consume(str_len);
+      if (str == 0)
+      {
+        return false;
+      }
+      val.assign(str, str_len);
+      return true;
+    }
 };
 
 template <typename I>
@@ -465,6 +902,15 @@ class MsgPacker<std::vector<I>>
       }
       return true;
     }
+    static bool pack(MsgBufWriter& w, const std::vector<I>& vec)
+    {
+      if ((vec.size() > std::numeric_limits<uint16_t>::max()) ||
+          !MsgPacker<uint16_t>::pack(w, vec.size()))
+      {
+        return false;
+      }
+      return msgPackItems(w, vec, MsgIsRawByte<I>());
+    }
     static size_t packedSize(const std::vector<I>& vec)
     {
       size_t size = sizeof(uint16_t);
@@ -474,6 +920,10 @@ class MsgPacker<std::vector<I>>
       }
       return size;
     }
+    static constexpr size_t fixedSize(void)
+    {
+      return MSG_VARIABLE_PACKED_SIZE;
+    }
     static bool unpack(std::istream& is, std::vector<I>& vec)
     {
       uint16_t vec_size;
@@ -493,6 +943,25 @@ class MsgPacker<std::vector<I>>
       }
       return true;
     }
+    static bool unpack(MsgBufReader& r, std::vector<I>& vec)
+    {
+      uint16_t vec_size;
+      if (!MsgPacker<uint16_t>::unpack(r, vec_size))
+      {
+        return false;
+      }
+        // Do not trust the size field before the data have been checked to
+        // fit in what is left of the buffer
+      const size_t item_size = msgFixedPackedSize<I>();
+      if ((item_size != MSG_VARIABLE_PACKED_SIZE) &&
+          (msgMulPackedSize(item_size, vec_size) > r.remaining()))
+      {
+        r.consume(r.remaining() + 1);
+        return false;
+      }
+      vec.resize(vec_size);
+      return msgUnpackItems(r, vec, MsgIsRawByte<I>());
+    }
 };
 
 template <typename I>
@@ -519,6 +988,22 @@ class MsgPacker<std::set<I>>
       }
       return true;
     }
+    static bool pack(MsgBufWriter& w, const std::set<I>& s)
+    {
+      if ((s.size() > std::numeric_limits<uint16_t>::max()) ||
+          !MsgPacker<uint16_t>::pack(w, s.size()))
+      {
+        return false;
+      }
+      for (const auto& item : s)
+      {
+        if (!msgPack(w, item))
+        {
+          return false;
+        }
+      }
+      return true;
+    }
     static size_t packedSize(const std::set<I>& s)
     {
       size_t size = sizeof(uint16_t);
@@ -528,6 +1013,10 @@ class MsgPacker<std::set<I>>
       }
       return size;
     }
+    static constexpr size_t fixedSize(void)
+    {
+      return MSG_VARIABLE_PACKED_SIZE;
+    }
     static bool unpack(std::istream& is, std::set<I>& s)
     {
       uint16_t set_size;
@@ -552,6 +1041,25 @@ class MsgPacker<std::set<I>>
       }
       return true;
     }
+    static bool unpack(MsgBufReader& r, std::set<I>& s)
+    {
+      uint16_t set_size;
+      if (!MsgPacker<uint16_t>::unpack(r, set_size))
+      {
+        return false;
+      }
+      s.clear();
+      for (int i=0; i<set_size; ++i)
+      {
+        I val;
+        if (!msgUnpack(r, val))
+        {
+          return false;
+        }
+        s.insert(val);
+      }
+      return true;
+    }
 };
 
 template <typename Tag, typename Value>
@@ -573,6 +1081,22 @@ class MsgPacker<std::map<Tag,Value>>
       }
       return true;
     }
+    static bool pack(MsgBufWriter& w, const std::map<Tag, Value>& m)
+    {
+      if ((m.size() > std::numeric_limits<uint16_t>::max()) ||
+          !MsgPacker<uint16_t>::pack(w, m.size()))
+      {
+        return false;
+      }
+      for (const auto& item : m)
+      {
+        if (!msgPack(w, item.first) || !msgPack(w, item.second))
+        {
+          return false;
+        }
+      }
+      return true;
+    }
     static size_t packedSize(const std::map<Tag, Value>& m)
     {
       size_t size = sizeof(uint16_t);
@@ -583,6 +1107,10 @@ class MsgPacker<std::map<Tag,Value>>
       }
       return size;
     }
+    static constexpr size_t fixedSize(void)
+    {
+      return MSG_VARIABLE_PACKED_SIZE;
+    }
     static bool unpack(std::istream& is, std::map<Tag,Value>& m)
     {
       uint16_t map_size;
@@ -603,6 +1131,26 @@ class MsgPacker<std::map<Tag,Value>>
       }
       return true;
     }
+    static bool unpack(MsgBufReader& r, std::map<Tag,Value>& m)
+    {
+      uint16_t map_size;
+      if (!MsgPacker<uint16_t>::unpack(r, map_size))
+      {
+        return false;
+      }
+      m.clear();
+      for (int i=0; i<map_size; ++i)
+      {
+        Tag tag;
+        Value val;
+        if (!msgUnpack(r, tag) || !msgUnpack(r, val))
+        {
+          return false;
+        }
+        m[tag] = val;
+      }
+      return true;
+    }
 };
 
 template <typename T, size_t N>
@@ -620,6 +1168,10 @@ class MsgPacker<std::array<T, N>>
       }
       return true;
     }
+    static bool pack(MsgBufWriter& w, const std::array<T, N>& vec)
+    {
+      return msgPackItems(w, vec, MsgIsRawByte<T>());
+    }
     static size_t packedSize(const std::array<T, N>& vec)
     {
       size_t size = 0;
@@ -629,6 +1181,10 @@ class MsgPacker<std::array<T, N>>
       }
       return size;
     }
+    static constexpr size_t fixedSize(void)
+    {
+      return msgMulPackedSize(msgFixedPackedSize<T>(), N);
+    }
     static bool unpack(std::istream& is, std::array<T, N>& vec)
     {
       for (auto& item : vec)
@@ -640,6 +1196,10 @@ class MsgPacker<std::array<T, N>>
       }
       return true;
     }
+    static bool unpack(MsgBufReader& r, std::array<T, N>& vec)
+    {
+      return msgUnpackItems(r, vec, MsgIsRawByte<T>());
+    }
 };
 
 template <typename T, size_t N> class MsgPacker<T[N]>
@@ -656,6 +1216,10 @@ template <typename T, size_t N> class MsgPacker<T[N]>
       }
       return true;
     }
+    static bool pack(MsgBufWriter& w, const T (&vec)[N])
+    {
+      return msgPackItems(w, vec, MsgIsRawByte<T>());
+    }
     static size_t packedSize(const T (&vec)[N])
     {
       size_t size = 0;
@@ -665,6 +1229,10 @@ template <typename T, size_t N> class MsgPacker<T[N]>
       }
       return size;
     }
+    static constexpr size_t fixedSize(void)
+    {
+      return msgMulPackedSize(msgFixedPackedSize<T>(), N);
+    }
     static bool unpack(std::istream& is, T (&vec)[N])
     {
       for (auto& item : vec)
@@ -676,8 +1244,134 @@ template <typename T, size_t N> class MsgPacker<T[N]>
       }
       return true;
     }
+    static bool unpack(MsgBufReader& r, T (&vec)[N])
+    {
+      return msgUnpackItems(r, vec, MsgIsRawByte<T>());
+    }
+};
+
+
+  // The functions below dispatch to the MsgBufWriter/MsgBufReader functions
+  // of a MsgPacker if available. MsgPacker specializations that only
+  // implement the std::ostream/std::istream functions still work since they
+  // then are used via a stream buffer on top of the caller supplied buffer.
+template <typename T, typename Enable = void>
+struct MsgBufPacker
+{
+  class OStreamBuf : public std::streambuf
+  {
+    public:
+      OStreamBuf(char* buf, size_t len) { setp(buf, buf + len); }
+      size_t written(void) const { return pptr() - pbase(); }
+  };
+  class IStreamBuf : public std::streambuf
+  {
+    public:
+      IStreamBuf(const char* buf, size_t len)
+      {
+        char* b = const_cast<char*>(buf);
+        setg(b, b, b + len);
+      }
+      size_t consumed(void) const { return gptr() - eback(); }
+  };
+
+  static bool pack(MsgBufWriter& w, const T& val)
+  {
+    if (!w.good())
+    {
+      return false;
+    }
+    OStreamBuf sb(w.current(), w.remaining());
+    std::ostream os(&sb);
+    return MsgPacker<T>::pack(os, val) && (w.reserve(sb.written()) != 0);
+  }
+  static bool unpack(MsgBufReader& r, T& val)
+  {
+    if (!r.good())
+    {
+      return false;
+    }
+    IStreamBuf sb(r.current(), r.remaining());
+    std::istream is(&sb);
+    return MsgPacker<T>::unpack(is, val) && (r.consume(sb.consumed()) != 0);
+  }
+};
+
+template <typename T>
+struct MsgBufPacker<T, decltype(void(MsgPacker<T>::pack(
+        std::declval<MsgBufWriter&>(), std::declval<const T&>())))>
+{
+  static bool pack(MsgBufWriter& w, const T& val)
+  {
+    return MsgPacker<T>::pack(w, val);
+  }
+  static bool unpack(MsgBufReader& r, T& val)
+  {
+    return MsgPacker<T>::unpack(r, val);
+  }
+};
+
+template <typename T, typename Enable = void>
+struct MsgFixedPackedSize
+  : std::integral_constant<size_t, MSG_VARIABLE_PACKED_SIZE>
+{
 };
 
+template <typename T>
+struct MsgFixedPackedSize<T, decltype(void(MsgPacker<T>::fixedSize()))>
+  : std::integral_constant<size_t, MsgPacker<T>::fixedSize()>
+{
+};
+
+template <typename... Args> struct MsgFixedPackedSizeSum;
+
+template <>
+struct MsgFixedPackedSizeSum<> : std::integral_constant<size_t, 0>
+{
+};
+
+template <typename T, typename... Args>
+struct MsgFixedPackedSizeSum<T, Args...>
+  : std::integral_constant<size_t,
+      msgAddPackedSize(MsgFixedPackedSize<T>::value,
+                       MsgFixedPackedSizeSum<Args...>::value)>
+{
+};
+
+/**
+ * @brief   Pack a value into a buffer
+ * @param   w   The buffer writer to use
+ * @param   val The value to pack
+ * @return  Returns \em true on success or \em false on failure
+ */
+template <typename T>
+bool msgPack(MsgBufWriter& w, const T& val)
+{
+  return MsgBufPacker<T>::pack(w, val);
+}
+
+/**
+ * @brief   Unpack a value from a buffer
+ * @param   r   The buffer reader to use
+ * @param   val The value to unpack into
+ * @return  Returns \em true on success or \em false on failure
+ */
+template <typename T>
+bool msgUnpack(MsgBufReader& r, T& val)
+{
+  return MsgBufPacker<T>::unpack(r, val);
+}
+
+/**
+ * @brief   Get the packed size of a type, known at compile time
+ * @return  Returns the packed size or MSG_VARIABLE_PACKED_SIZE
+ */
+template <typename T>
+constexpr size_t msgFixedPackedSize(void)
+{
+  return MsgFixedPackedSize<T>::value;
+}
+
 
 /**
 @brief	Base class for all messages
@@ -690,12 +1384,18 @@ class Msg
     virtual ~Msg(void) {}
 
     bool packParent(std::ostream&) const { return true; }
+    bool packParent(MsgBufWriter&) const { return true; }
     size_t packedSizeParent(void) const { return 0; }
+    static constexpr size_t fixedPackedSizeParent(void) { return 0; }
     bool unpackParent(std::istream&) { return true; }
+    bool unpackParent(MsgBufReader&) { return true; }
 
     virtual bool pack(std::ostream&) const { return true; }
+    virtual bool pack(MsgBufWriter&) const { return true; }
     virtual size_t packedSize(void) const { return 0; }
+    static constexpr size_t fixedPackedSize(void) { return 0; }
     virtual bool unpack(std::istream&) { return true; }
+    virtual bool unpack(MsgBufReader&) { return true; }
 
     template <typename T>
     bool pack(std::ostream& os, const T& val) const
@@ -703,6 +1403,11 @@ class Msg
       return MsgPacker<T>::pack(os, val);
     }
     template <typename T>
+    bool pack(MsgBufWriter& w, const T& val) const
+    {
+      return msgPack(w, val);
+    }
+    template <typename T>
     size_t packedSize(const T& val) const
     {
       return MsgPacker<T>::packedSize(val);
@@ -712,6 +1417,11 @@ class Msg
     {
       return MsgPacker<T>::unpack(is, val);
     }
+    template <typename T>
+    bool unpack(MsgBufReader& r, T& val) const
+    {
+      return msgUnpack(r, val);
+    }
 
     template <typename T1, typename T2, typename... Args>
     bool pack(std::ostream& os, const T1& v1, const T2& v2,
@@ -720,6 +1430,12 @@ class Msg
       return pack(os, v1) && pack(os, v2, args...);
     }
     template <typename T1, typename T2, typename... Args>
+    bool pack(MsgBufWriter& w, const T1& v1, const T2& v2,
+              const Args&... args) const
+    {
+      return pack(w, v1) && pack(w, v2, args...);
+    }
+    template <typename T1, typename T2, typename... Args>
     size_t packedSize(const T1& v1, const T2& v2, const Args&... args) const
     {
       return packedSize(v1) + packedSize(v2, args...);
@@ -729,6 +1445,16 @@ class Msg
     {
       return unpack(is, v1) && unpack(is, v2, args...);
     }
+    template <typename T1, typename T2, typename... Args>
+    bool unpack(MsgBufReader& r, T1& v1, T2& v2, Args&... args)
+    {
+      return unpack(r, v1) && unpack(r, v2, args...);
+    }
+
+      // Only used in unevaluated context by ASYNC_MSG_MEMBERS to find the
+      // types of the members
+    template <typename... Args>
+    static MsgFixedPackedSizeSum<Args...> fixedPackedSizeOf(const Args&...);
 }; /* class Msg */
 
 
@@ -127,6 +127,7 @@ Pty::Pty(const std::string &slave_link)
   m_watch.activity.connect(
       sigc::hide(sigc::mem_fun(*this, &Pty::charactersReceived)));
   m_pollhup_timer.setEnable(false);
+  m_pollhup_timer.setTag("Async::Pty");
   m_pollhup_timer.expired.connect(
       sigc::hide(sigc::mem_fun(*this, &Pty::checkIfSlaveEndOpen)));
 } /* Pty::Pty */
@@ -212,6 +213,7 @@ bool Pty::open(void)
   m_slave_path = slave_path;
 
   m_watch.setFd(m_master, Async::FdWatch::FD_WATCH_RD);
+  m_watch.setTag("Async::Pty");
   m_watch.setEnabled(false);
   m_pollhup_timer.setEnable(true);
 
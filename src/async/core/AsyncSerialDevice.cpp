@@ -263,6 +263,7 @@ bool SerialDevice::openPort(bool flush)
   }
 
   rd_watch = new FdWatch(fd, FdWatch::FD_WATCH_RD);
+  rd_watch->setTag("Async::Serial");
   rd_watch->activity.connect(mem_fun(*this, &SerialDevice::onIncomingData));
   
   return true;
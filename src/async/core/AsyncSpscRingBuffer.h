@@ -0,0 +1,268 @@
+/**
+@file   AsyncSpscRingBuffer.h
+@brief  A lock free single producer, single consumer ring buffer
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_SPSC_RING_BUFFER_INCLUDED
+#define ASYNC_SPSC_RING_BUFFER_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief  A lock free single producer, single consumer ring buffer
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+This class implements a ring buffer that can be used to pass elements, like
+audio samples, from one thread to another without any locking. Exactly one
+thread may write to the buffer and exactly one thread may read from it. The
+functions marked as producer functions must only be called by the writing
+thread and the consumer functions must only be called by the reading thread.
+Neither side will ever block so the buffer can safely be used from a real
+time thread.
+
+The capacity is rounded up to the nearest power of two.
+
+\code
+Async::SpscRingBuffer<int16_t> ring(4096);
+
+// Producer thread
+size_t written = ring.write(buf, count);
+
+// Consumer thread
+size_t read = ring.read(buf, ring.readAvail());
+\endcode
+*/
+template <typename T>
+class SpscRingBuffer
+{
+  public:
+    /**
+     * @brief   Constructor
+     * @param   capacity The minimum number of elements the buffer can hold
+     */
+    explicit SpscRingBuffer(size_t capacity=0)
+    {
+      resize(capacity);
+    }
+
+    /**
+     * @brief   Change the capacity of the buffer
+     * @param   capacity The minimum number of elements the buffer can hold
+     *
+     * All elements in the buffer are thrown away. This function must not be
+     * called while another thread is accessing the buffer.
+     */
+    void resize(size_t capacity)
+    {
+      size_t size = 1;
+      while (size < capacity)
+      {
+        size <<= 1;
+      }
+      m_buf.assign(size, T());
+      m_mask = size - 1;
+      clear();
+    }
+
+    /**
+     * @brief   Throw away all elements in the buffer
+     *
+     * This function must not be called while another thread is accessing the
+     * buffer.
+     */
+    void clear(void)
+    {
+      m_head.store(0, std::memory_order_relaxed);
+      m_tail.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief   Get the number of elements the buffer can hold
+     * @return  Returns the capacity of the buffer
+     */
+    size_t capacity(void) const { return m_buf.size(); }
+
+    /**
+     * @brief   Get the number of elements available for reading
+     * @return  Returns the number of elements in the buffer
+     *
+     * This is a consumer function. When called from the producer thread the
+     * value is only an estimate.
+     */
+    size_t readAvail(void) const
+    {
+      return m_head.load(std::memory_order_acquire) -
+             m_tail.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief   Get the number of elements that can be written
+     * @return  Returns the free space in the buffer
+     *
+     * This is a producer function. When called from the consumer thread the
+     * value is only an estimate.
+     */
+    size_t writeAvail(void) const
+    {
+      return capacity() - (m_head.load(std::memory_order_relaxed) -
+                           m_tail.load(std::memory_order_acquire));
+    }
+
+    /**
+     * @brief   Write elements to the buffer
+     * @param   buf   The elements to write
+     * @param   count The number of elements to write
+     * @return  Returns the number of elements actually written
+     *
+     * This is a producer function. If there is not room for all elements,
+     * as many as fit are written.
+     */
+    size_t write(const T *buf, size_t count)
+    {
+      const size_t head = m_head.load(std::memory_order_relaxed);
+      const size_t tail = m_tail.load(std::memory_order_acquire);
+      count = std::min(count, capacity() - (head - tail));
+      const size_t pos = head & m_mask;
+      const size_t first = std::min(count, capacity() - pos);
+      std::copy(buf, buf + first, m_buf.begin() + pos);
+      std::copy(buf + first, buf + count, m_buf.begin());
+      m_head.store(head + count, std::memory_order_release);
+      return count;
+    }
+
+    /**
+     * @brief   Read elements from the buffer
+     * @param   buf   The buffer to store the elements in
+     * @param   count The maximum number of elements to read
+     * @return  Returns the number of elements actually read
+     *
+     * This is a consumer function.
+     */
+    size_t read(T *buf, size_t count)
+    {
+      const size_t tail = m_tail.load(std::memory_order_relaxed);
+      const size_t head = m_head.load(std::memory_order_acquire);
+      count = std::min(count, head - tail);
+      const size_t pos = tail & m_mask;
+      const size_t first = std::min(count, capacity() - pos);
+      std::copy(m_buf.begin() + pos, m_buf.begin() + pos + first, buf);
+      std::copy(m_buf.begin(), m_buf.begin() + (count - first), buf + first);
+      m_tail.store(tail + count, std::memory_order_release);
+      return count;
+    }
+
+  private:
+    std::vector<T>                  m_buf;
+    size_t                          m_mask    = 0;
+    alignas(64) std::atomic<size_t> m_head    {0};
+    alignas(64) std::atomic<size_t> m_tail    {0};
+
+};  /* class SpscRingBuffer */
+
+
+} /* namespace */
+
+#endif /* ASYNC_SPSC_RING_BUFFER_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -167,6 +167,7 @@ class StateMachine
      */
     StateMachine(ContextT* ctx) : m_ctx(ctx)
     {
+      m_timer.setTag("Async::StateMachine");
       m_timer.expired.connect(
           [&](Timer*)
           {
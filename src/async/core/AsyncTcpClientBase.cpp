@@ -340,6 +340,7 @@ void TcpClientBase::connectToRemote(void)
     if (errno == EINPROGRESS)
     {
       wr_watch.setFd(sock, FdWatch::FD_WATCH_WR);
+      wr_watch.setTag("Async::TcpClient");
       wr_watch.setEnabled(true);
     }
     else
@@ -35,6 +35,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <assert.h>
@@ -202,7 +203,9 @@ TcpConnection& TcpConnection::operator=(TcpConnection&& other)
 
   m_write_buf = std::move(other.m_write_buf);
   other.m_write_buf.clear();
-  other.m_write_buf.reserve(m_write_buf.capacity());
+
+  m_write_buf_size = other.m_write_buf_size;
+  other.m_write_buf_size = 0;
 
   m_ssl_ctx = other.m_ssl_ctx;
   other.m_ssl_ctx = nullptr;
@@ -375,13 +378,35 @@ std::string TcpConnection::sslCommonName(void) const
  *
  ****************************************************************************/
 
+int TcpConnection::writeShared(const SharedBuffer& buf)
+{
+  assert(sock >= 0);
+  assert(buf != nullptr);
+  if (m_ssl != nullptr)
+  {
+    return sslWrite(buf->data(), buf->size());
+  }
+  if (!buf->empty())
+  {
+    TxSegment seg;
+    seg.shared = buf;
+    m_write_buf.push_back(std::move(seg));
+    m_write_buf_size += buf->size();
+    m_wr_watch.setEnabled(!m_freezed);
+  }
+  return buf->size();
+} /* TcpConnection::writeShared */
+
+
 void TcpConnection::setSocket(int sock)
 {
   this->sock = sock;
   rd_watch.setFd(sock, FdWatch::FD_WATCH_RD);
+  rd_watch.setTag("Async::TcpConnection");
   rd_watch.setEnabled(sock >= 0);
   m_wr_watch.setEnabled(false);
   m_wr_watch.setFd(sock, FdWatch::FD_WATCH_WR);
+  m_wr_watch.setTag("Async::TcpConnection");
 } /* TcpConnection::setSocket */
 
 
@@ -435,6 +460,7 @@ void TcpConnection::closeConnection(void)
 {
   m_recv_buf.clear();
   m_write_buf.clear();
+  m_write_buf_size = 0;
   m_ssl_encrypt_buf.clear();
 
   m_wr_watch.setEnabled(false);
@@ -563,45 +589,78 @@ void TcpConnection::processRecvBuf(void)
 
 void TcpConnection::addToWriteBuf(const char *buf, size_t len)
 {
-  m_write_buf.insert(m_write_buf.end(), buf, buf+len);
-  m_wr_watch.setEnabled(!m_freezed && !m_write_buf.empty());
+  if (len == 0)
+  {
+    return;
+  }
+    // Append to the last segment if it is owned by this connection and
+    // sending it has not started, so that small writes do not create one
+    // segment each. Limit the size so that sent data is released regularly.
+  if (m_write_buf.empty() || (m_write_buf.back().shared != nullptr) ||
+      (m_write_buf.back().pos > 0) ||
+      (m_write_buf.back().owned.size() >= MAX_OWNED_SEGMENT_SIZE))
+  {
+    m_write_buf.emplace_back();
+  }
+  std::vector<char>& owned = m_write_buf.back().owned;
+  owned.insert(owned.end(), buf, buf+len);
+  m_write_buf_size += len;
+  m_wr_watch.setEnabled(!m_freezed);
 } /* TcpConnection::addToWriteBuf */
 
 
 void TcpConnection::onWriteSpaceAvailable(Async::FdWatch* w)
 {
-  ssize_t n = rawWrite(m_write_buf.data(), m_write_buf.size());
+  struct iovec iov[WRITE_IOV_MAX];
+  int iovcnt = 0;
+  for (auto it = m_write_buf.begin();
+       (it != m_write_buf.end()) && (iovcnt < int(WRITE_IOV_MAX)); ++it)
+  {
+    const std::vector<char>& buf = it->buf();
+    iov[iovcnt].iov_base = const_cast<char*>(buf.data()) + it->pos;
+    iov[iovcnt].iov_len = buf.size() - it->pos;
+    ++iovcnt;
+  }
+
+  ssize_t n = rawWritev(iov, iovcnt);
   //std::cout << "### TcpConnection::onWriteSpaceAvailabe:"
   //          << "  fd=" << w->fd()
   //          << "  n=" << n
-  //          << "  bufsize=" << m_write_buf.size()
+  //          << "  bufsize=" << m_write_buf_size
   //          << std::endl;
-  assert(n <= static_cast<ssize_t>(m_write_buf.size()));
+  assert(n <= static_cast<ssize_t>(m_write_buf_size));
   if (n >= 0)
   {
-    if (n == static_cast<ssize_t>(m_write_buf.size()))
-    {
-      m_write_buf.clear();
-    }
-    else if (n > 0)
+    m_write_buf_size -= n;
+    while (n > 0)
     {
-      std::rotate(m_write_buf.begin(), m_write_buf.begin() + n,
-                  m_write_buf.end());
-      m_write_buf.resize(m_write_buf.size() - n);
+      TxSegment& seg = m_write_buf.front();
+      const size_t seg_left = seg.buf().size() - seg.pos;
+      if (static_cast<size_t>(n) < seg_left)
+      {
+        seg.pos += n;
+        break;
+      }
+      n -= seg_left;
+      m_write_buf.pop_front();
     }
   }
   else
   {
-    perror("### TcpConnection::onWriteSpaceAvailable: rawWrite()");
+    perror("### TcpConnection::onWriteSpaceAvailable: rawWritev()");
   }
   w->setEnabled(!m_write_buf.empty());
 } /* TcpConnection::onWriteSpaceAvailable */
 
 
-int TcpConnection::rawWrite(const void* buf, int count)
+ssize_t TcpConnection::rawWritev(const struct iovec* iov, int iovcnt)
 {
   assert(sock != -1);
-  int cnt = ::send(sock, buf, count, MSG_NOSIGNAL);
+  struct msghdr msg;
+  std::memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = const_cast<struct iovec*>(iov);
+  msg.msg_iovlen = iovcnt;
+  ssize_t cnt = ::sendmsg(sock, &msg, MSG_NOSIGNAL);
   if (cnt < 0)
   {
     if (errno != EAGAIN)
@@ -612,7 +671,7 @@ int TcpConnection::rawWrite(const void* buf, int count)
   }
 
   return cnt;
-} /* TcpConnection::rawWrite */
+} /* TcpConnection::rawWritev */
 
 
 TcpConnection::SslStatus TcpConnection::sslGetStatus(int n)
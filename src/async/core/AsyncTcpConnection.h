@@ -49,6 +49,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <cstring>
 #include <vector>
 #include <map>
+#include <deque>
+#include <memory>
 
 
 /****************************************************************************
@@ -77,6 +79,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+struct iovec;
 
 
 /****************************************************************************
@@ -152,6 +155,14 @@ class TcpConnection : virtual public sigc::trackable
       DR_BAD_STATE             ///< The connection ended up in a bad state
     } DisconnectReason;
 
+    /**
+     * @brief   An immutable reference counted buffer
+     *
+     * A buffer of this type can be queued for transmission on many
+     * connections without being copied.
+     */
+    using SharedBuffer = std::shared_ptr<const std::vector<char>>;
+
     /**
      * @brief   A sigc return value accumulator for signals returning bool
      *
@@ -245,6 +256,19 @@ class TcpConnection : virtual public sigc::trackable
      */
     virtual int write(const void *buf, int count);
 
+    /**
+     * @brief   Get the number of bytes waiting to be sent
+     * @return  Returns the number of bytes in the transmit buffers
+     *
+     * Data written to the connection is buffered until the socket is
+     * writable. This function return how much data that is waiting, which can
+     * be used to detect slow consumers.
+     */
+    size_t writeBufSize(void) const
+    {
+      return m_write_buf_size + m_ssl_encrypt_buf.size();
+    }
+
     /**
      * @brief   Get the local IP address associated with this connection
      * @return  Returns an IP address
@@ -432,6 +456,18 @@ class TcpConnection : virtual public sigc::trackable
      */
     int socket(void) const { return sock; }
 
+    /**
+     * @brief   Write a shared buffer to the TCP connection
+     * @param   buf The buffer to send
+     * @return  Returns the number of bytes written or -1 on failure
+     *
+     * On an unencrypted connection a reference to the buffer is queued so
+     * the same buffer can be written to many connections without copying it.
+     * The buffers are sent using vectored I/O. On a TLS connection the data
+     * is encrypted and the buffer is released immediately.
+     */
+    int writeShared(const SharedBuffer& buf);
+
     /**
      * @brief   Disconnect from the remote peer
      *
@@ -511,7 +547,21 @@ class TcpConnection : virtual public sigc::trackable
       }
     };
 
+    struct TxSegment
+    {
+      SharedBuffer      shared;
+      std::vector<char> owned;
+      size_t            pos = 0;
+
+      const std::vector<char>& buf(void) const
+      {
+        return (shared != nullptr) ? *shared : owned;
+      }
+    };
+
     static constexpr const size_t DEFAULT_BUF_SIZE = 1024;
+    static constexpr const size_t WRITE_IOV_MAX    = 64;
+    static constexpr const size_t MAX_OWNED_SEGMENT_SIZE = 65536;
 
     static std::map<SSL*, TcpConnection*> ssl_con_map;
 
@@ -521,7 +571,8 @@ class TcpConnection : virtual public sigc::trackable
     FdWatch           rd_watch;
     std::vector<Char> m_recv_buf;
     Async::FdWatch    m_wr_watch;
-    std::vector<char> m_write_buf;
+    std::deque<TxSegment> m_write_buf;
+    size_t            m_write_buf_size    = 0;
 
     SslContext*       m_ssl_ctx           = nullptr;
     bool              m_ssl_is_server     = false;
@@ -544,7 +595,7 @@ class TcpConnection : virtual public sigc::trackable
     void processRecvBuf(void);
     void addToWriteBuf(const char *buf, size_t len);
     void onWriteSpaceAvailable(Async::FdWatch* w);
-    int rawWrite(const void* buf, int count);
+    ssize_t rawWritev(const struct iovec* iov, int iovcnt);
 
     SslStatus sslGetStatus(int n);
     int sslRecvHandler(char* src, int count);
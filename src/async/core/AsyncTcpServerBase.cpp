@@ -200,8 +200,10 @@ TcpServerBase::TcpServerBase(const string& port_str,
   }
 
   m_rd_watch = new FdWatch(m_sock, FdWatch::FD_WATCH_RD);
+  m_rd_watch->setTag("Async::TcpServer");
   m_rd_watch->activity.connect(mem_fun(*this, &TcpServerBase::onConnection));
 
+  m_con_throt_timer.setTag("Async::TcpServer");
   m_con_throt_timer.expired.connect(
       sigc::mem_fun(*this, &TcpServerBase::updateConnThrotMap));
 } /* TcpServerBase::TcpServerBase */
@@ -119,7 +119,8 @@ using namespace Async;
 
 
 Timer::Timer(int timeout_ms, Type type, bool enabled)
-  : m_type(type), m_timeout_ms(timeout_ms), m_is_enabled(false)
+  : m_type(type), m_timeout_ms(timeout_ms), m_is_enabled(false),
+    m_is_coarse(false), m_tag(0)
 {
   setEnable(enabled && (timeout_ms >= 0));
 } /* Timer::Timer */
@@ -198,6 +198,46 @@ class Timer : public sigc::trackable
      * If the timer is disabled, this function will do nothing.
      */
     void reset(void);
+
+    /**
+     * @brief   Allow the timer to expire with a coarse resolution
+     * @param   coarse Set to \em true to allow coarse expiration
+     *
+     * A coarse timer may expire up to COARSE_RESOLUTION_MS milliseconds
+     * later than requested. All coarse timers are aligned to the same
+     * ticks so that many timers with similar timeouts, like heartbeat
+     * timers, are handled together in one main loop iteration. Periodic
+     * coarse timers do not drift. The setting takes effect the next time the
+     * timer is enabled, reset or expired.
+     */
+    void setCoarse(bool coarse) { m_is_coarse = coarse; }
+
+    /**
+     * @brief   Check if the timer is allowed to expire with coarse resolution
+     * @return  Returns \em true if the timer is coarse
+     */
+    bool isCoarse(void) const { return m_is_coarse; }
+
+    /**
+     * @brief   The resolution in milliseconds used for coarse timers
+     */
+    static constexpr int COARSE_RESOLUTION_MS = 100;
+
+    /**
+     * @brief   Set a tag that identify the owner of this timer
+     * @param   tag A string, normally the class name of the owning object
+     *
+     * The tag is used by the main loop profiler (see Async::LoopProfiler) to
+     * group timer callback statistics. The string is not copied so it must
+     * stay valid for the lifetime of the timer, e.g. a string literal.
+     */
+    void setTag(const char *tag) { m_tag = tag; }
+
+    /**
+     * @brief   Get the tag that identify the owner of this timer
+     * @return  Returns the tag or 0 if not set
+     */
+    const char *tag(void) const { return m_tag; }
     
     /**
      * @brief 	A signal that is emitted when the timer expires
@@ -216,6 +256,8 @@ class Timer : public sigc::trackable
     Type  m_type;
     int   m_timeout_ms;
     bool  m_is_enabled;
+    bool  m_is_coarse;
+    const char* m_tag;
   
 };  /* class Timer */
 
@@ -45,6 +45,8 @@
 #include <cerrno>
 #include <cstdio>
 #include <cstring>
+#include <vector>
+#include <algorithm>
 
 
 /****************************************************************************
@@ -84,6 +86,11 @@ using namespace Async;
  *
  ****************************************************************************/
 
+namespace {
+  const size_t      RX_SLOT_SIZE        = 65536;
+  const unsigned    RX_BATCH_SIZE_MAX   = 256;
+  const size_t      TX_BATCH_SIZE_MAX   = 256;
+};
 
 
 /****************************************************************************
@@ -92,20 +99,140 @@ using namespace Async;
  *
  ****************************************************************************/
 
-class UdpPacket
+class UdpSocket::TxQueue
 {
   public:
-    const IpAddress ip;
-    int       	    port;
-    char    	    buf[65535];
-    int       	    len;
-    
-    UdpPacket(const IpAddress& ip, int port, const void *buf, int len)
-      : ip(ip), port(port), len(len)
+    struct Slot
+    {
+      struct sockaddr_in  addr;
+      std::vector<char>   buf;
+    };
+
+    TxQueue(size_t depth) : slots(depth), head(0), cnt(0) {}
+
+    size_t capacity(void) const { return slots.size(); }
+    size_t size(void) const { return cnt; }
+    bool empty(void) const { return (cnt == 0); }
+    bool full(void) const { return (cnt == slots.size()); }
+    Slot& front(void) { return slots[head]; }
+
+    void pop(void)
     {
-      memcpy(this->buf, buf, len);
+      assert(cnt > 0);
+      head = (head + 1) % slots.size();
+      --cnt;
+    }
+
+    void push(const struct sockaddr_in& addr, const void *buf, int count)
+    {
+      assert(cnt < slots.size());
+      Slot& slot = slots[(head + cnt) % slots.size()];
+      slot.addr = addr;
+      const char *ptr = reinterpret_cast<const char*>(buf);
+      slot.buf.assign(ptr, ptr + count);
+      ++cnt;
+    }
+
+    void clear(void)
+    {
+      head = 0;
+      cnt = 0;
+    }
+
+    size_t resize(size_t depth)
+    {
+      size_t dropped = 0;
+      while (cnt > depth)
+      {
+        pop();
+        ++dropped;
+      }
+      std::vector<Slot> new_slots(depth);
+      for (size_t i=0; i<cnt; ++i)
+      {
+        new_slots[i] = std::move(slots[(head + i) % slots.size()]);
+      }
+      slots.swap(new_slots);
+      head = 0;
+      return dropped;
+    }
+
+  private:
+    std::vector<Slot> slots;
+    size_t            head;
+    size_t            cnt;
+};
+
+
+class UdpSocket::RxBatch
+{
+  public:
+    std::vector<char>           buf;
+#ifdef HAS_MMSG_SUPPORT
+    std::vector<struct mmsghdr> hdrs;
+    std::vector<struct iovec>   iov;
+    std::vector<sockaddr_in>    addrs;
+#endif
+
+    RxBatch(unsigned cnt) : buf(cnt * RX_SLOT_SIZE)
+#ifdef HAS_MMSG_SUPPORT
+      , hdrs(cnt), iov(cnt), addrs(cnt)
+#endif
+    {
+#ifdef HAS_MMSG_SUPPORT
+      for (unsigned i=0; i<cnt; ++i)
+      {
+        iov[i].iov_base = &buf[i * RX_SLOT_SIZE];
+        iov[i].iov_len = RX_SLOT_SIZE;
+        memset(&hdrs[i], 0, sizeof(hdrs[i]));
+        hdrs[i].msg_hdr.msg_iov = &iov[i];
+        hdrs[i].msg_hdr.msg_iovlen = 1;
+        hdrs[i].msg_hdr.msg_name = &addrs[i];
+      }
+#endif
+    }
+
+    unsigned size(void) const { return buf.size() / RX_SLOT_SIZE; }
+    char* slot(unsigned i) { return &buf[i * RX_SLOT_SIZE]; }
+};
+
+
+class UdpSocket::TxBatch
+{
+  public:
+    struct Item
+    {
+      struct sockaddr_in  addr;
+      size_t              offset;
+      size_t              len;
+    };
+
+    std::vector<char>           data;
+    std::vector<Item>           items;
+#ifdef HAS_MMSG_SUPPORT
+    std::vector<struct mmsghdr> hdrs;
+    std::vector<struct iovec>   iov;
+#endif
+
+    void add(const IpAddress& ip, int port, const void *buf, int count)
+    {
+      Item item;
+      memset(&item.addr, 0, sizeof(item.addr));
+      item.addr.sin_family = AF_INET;
+      item.addr.sin_port = htons(port);
+      item.addr.sin_addr = ip.ip4Addr();
+      item.offset = data.size();
+      item.len = count;
+      const char *ptr = reinterpret_cast<const char*>(buf);
+      data.insert(data.end(), ptr, ptr + count);
+      items.push_back(item);
+    }
+
+    void clear(void)
+    {
+      data.clear();
+      items.clear();
     }
-  
 };
 
 
@@ -154,7 +281,9 @@ class UdpPacket
  *------------------------------------------------------------------------
  */
 UdpSocket::UdpSocket(uint16_t local_port, const IpAddress &bind_ip)
-  : sock(-1), rd_watch(0), wr_watch(0), send_buf(0)
+  : sock(-1), rd_watch(0), wr_watch(0), tx_queue(new TxQueue(1)),
+    tx_drop_policy(SEND_QUEUE_DROP_NEWEST), rx_batch_size(1), rx_batch(0),
+    tx_batch(0), tx_batch_depth(0), destroyed(0)
 {
     // Create UDP socket
   sock = socket(AF_INET, SOCK_DGRAM, 0);
@@ -199,12 +328,14 @@ UdpSocket::UdpSocket(uint16_t local_port, const IpAddress &bind_ip)
 
     // Setup a watch for incoming data
   rd_watch = new FdWatch(sock, FdWatch::FD_WATCH_RD);
+  rd_watch->setTag("Async::UdpSocket");
   assert(rd_watch != 0);
   rd_watch->activity.connect(mem_fun(*this, &UdpSocket::handleInput));
 
     // Setup a watch for outgoing data (signals activity when a buffer full
     // condition occurs)
   wr_watch = new FdWatch(sock, FdWatch::FD_WATCH_WR);
+  wr_watch->setTag("Async::UdpSocket");
   assert(wr_watch != 0);
   wr_watch->activity.connect(mem_fun(*this, &UdpSocket::sendRest));
   wr_watch->setEnabled(false);
@@ -214,7 +345,12 @@ UdpSocket::UdpSocket(uint16_t local_port, const IpAddress &bind_ip)
 
 UdpSocket::~UdpSocket(void)
 {
+  if (destroyed != 0)
+  {
+    *destroyed = true;
+  }
   cleanup();
+  delete tx_queue;
 } /* UdpSocket::~UdpSocket */
 
 
@@ -255,25 +391,43 @@ uint16_t UdpSocket::localPort(void) const
 bool UdpSocket::write(const IpAddress& remote_ip, int remote_port,
     const void *buf, int count)
 {
-  if (send_buf != 0)
+  if (tx_batch_depth > 0)
   {
-    return false;
+    if (tx_batch->items.size() >= TX_BATCH_SIZE_MAX)
+    {
+      const bool was_empty = tx_queue->empty();
+      sendBatch();
+      if (was_empty && !tx_queue->empty())
+      {
+        sendBufferFull(true);
+      }
+    }
+    tx_batch->add(remote_ip, remote_port, buf, count);
+    return true;
   }
   
   struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
   addr.sin_family = AF_INET;
   addr.sin_port = htons(remote_port);
   addr.sin_addr = remote_ip.ip4Addr();
+
+    // Keep the datagram order if there already are datagrams waiting
+  if (!tx_queue->empty())
+  {
+    return enqueue(addr, buf, count);
+  }
+
   int ret = sendto(sock, buf, count, 0,
       reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr));
+  io_stats.tx_syscalls += 1;
   if (ret == -1)
   {
     if (errno == EAGAIN)
     {
-      send_buf = new UdpPacket(remote_ip, remote_port, buf, count);
-      wr_watch->setEnabled(true);
+      bool success = enqueue(addr, buf, count);
       sendBufferFull(true);
-      return true;
+      return success;
     }
     else
     {
@@ -282,12 +436,65 @@ bool UdpSocket::write(const IpAddress& remote_ip, int remote_port,
     }
   }
   assert(ret == count);
+  io_stats.tx_datagrams += 1;
+  io_stats.tx_max_batch = std::max<uint64_t>(io_stats.tx_max_batch, 1);
   
   return true;
   
 } /* UdpSocket::write */
 
 
+void UdpSocket::beginWriteBatch(void)
+{
+  if (tx_batch == 0)
+  {
+    tx_batch = new TxBatch;
+  }
+  tx_batch_depth += 1;
+} /* UdpSocket::beginWriteBatch */
+
+
+bool UdpSocket::flushWriteBatch(void)
+{
+  assert(tx_batch_depth > 0);
+  if (--tx_batch_depth > 0)
+  {
+    return true;
+  }
+  const bool was_empty = tx_queue->empty();
+  bool success = sendBatch();
+  if (was_empty && !tx_queue->empty())
+  {
+    sendBufferFull(true);
+  }
+  return success;
+} /* UdpSocket::flushWriteBatch */
+
+
+void UdpSocket::setRecvBatchSize(unsigned cnt)
+{
+  rx_batch_size = std::min(std::max(cnt, 1U), RX_BATCH_SIZE_MAX);
+} /* UdpSocket::setRecvBatchSize */
+
+
+void UdpSocket::setSendQueueDepth(size_t depth)
+{
+  io_stats.tx_dropped += tx_queue->resize(std::max<size_t>(depth, 1));
+} /* UdpSocket::setSendQueueDepth */
+
+
+size_t UdpSocket::sendQueueDepth(void) const
+{
+  return tx_queue->capacity();
+} /* UdpSocket::sendQueueDepth */
+
+
+size_t UdpSocket::sendQueueSize(void) const
+{
+  return tx_queue->size();
+} /* UdpSocket::sendQueueSize */
+
+
 
 /****************************************************************************
  *
@@ -329,8 +536,14 @@ void UdpSocket::cleanup(void)
   delete wr_watch;
   wr_watch = 0;
   
-  delete send_buf;
-  send_buf = 0;
+  tx_queue->clear();
+
+  delete rx_batch;
+  rx_batch = 0;
+
+  delete tx_batch;
+  tx_batch = 0;
+  tx_batch_depth = 0;
   
   if (sock != -1)
   {
@@ -345,7 +558,13 @@ void UdpSocket::cleanup(void)
 
 void UdpSocket::handleInput(FdWatch *watch)
 {
-  char buf[65536];
+  if (rx_batch_size > 1)
+  {
+    handleInputBatch();
+    return;
+  }
+
+  char buf[RX_SLOT_SIZE];
   struct sockaddr_in addr;
   socklen_t addr_len = sizeof(addr);
   
@@ -356,48 +575,231 @@ void UdpSocket::handleInput(FdWatch *watch)
     perror("recvfrom in UdpSocket::handleInput");
     return;
   }
+  io_stats.rx_syscalls += 1;
+  io_stats.rx_datagrams += 1;
+  io_stats.rx_max_batch = std::max<uint64_t>(io_stats.rx_max_batch, 1);
 
   onDataReceived(IpAddress(addr.sin_addr), ntohs(addr.sin_port), buf, len);
 } /* UdpSocket::handleInput */
 
 
-void UdpSocket::sendRest(FdWatch *watch)
+void UdpSocket::handleInputBatch(void)
 {
-  struct sockaddr_in addr;
-  addr.sin_family = AF_INET;
-  addr.sin_port = htons(send_buf->port);
-  addr.sin_addr = send_buf->ip.ip4Addr();
-  /*
-  cout << "sock=" << sock << "  port=" << send_buf->port
-      << "  ip=" << send_buf->ip.toString() << "  len=" << send_buf->len
-      << endl;
-  */
-  int ret = sendto(sock, send_buf->buf, send_buf->len, 0,
-      reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr));
-  if (ret == -1)
+    // The batch size may have been changed from within a previous
+    // dataReceived handler so the buffers are (re)allocated here
+  if ((rx_batch == 0) || (rx_batch->size() != rx_batch_size))
   {
-    if (errno == EAGAIN)
+    delete rx_batch;
+    rx_batch = new RxBatch(rx_batch_size);
+  }
+  RxBatch *batch = rx_batch;
+  rx_batch = 0;
+
+    // A dataReceived handler may delete this object so we need to know if
+    // that happened before handling the next datagram in the batch
+  bool is_destroyed = false;
+  destroyed = &is_destroyed;
+
+#ifdef HAS_MMSG_SUPPORT
+  const unsigned max_cnt = batch->size();
+  for (unsigned i=0; i<max_cnt; ++i)
+  {
+    batch->hdrs[i].msg_hdr.msg_namelen = sizeof(batch->addrs[i]);
+    batch->hdrs[i].msg_hdr.msg_flags = 0;
+  }
+  int cnt = recvmmsg(sock, &batch->hdrs[0], max_cnt, 0, 0);
+  if (cnt == -1)
+  {
+    if (errno != EAGAIN)
     {
+      perror("recvmmsg in UdpSocket::handleInputBatch");
+    }
+    cnt = 0;
+  }
+  else
+  {
+    io_stats.rx_syscalls += 1;
+    io_stats.rx_datagrams += cnt;
+    io_stats.rx_max_batch = std::max<uint64_t>(io_stats.rx_max_batch, cnt);
+  }
+  for (int i=0; i<cnt; ++i)
+  {
+    const struct sockaddr_in& addr = batch->addrs[i];
+    onDataReceived(IpAddress(addr.sin_addr), ntohs(addr.sin_port),
+                   batch->slot(i), batch->hdrs[i].msg_len);
+    if (is_destroyed)
+    {
+      delete batch;
       return;
     }
-    else
+  }
+#else
+  const unsigned max_cnt = batch->size();
+  unsigned cnt = 0;
+  while (cnt < max_cnt)
+  {
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    int len = recvfrom(sock, batch->slot(0), RX_SLOT_SIZE, 0,
+        reinterpret_cast<struct sockaddr *>(&addr), &addr_len);
+    if (len == -1)
     {
-      perror("sendto in UdpSocket::sendRest");
+      if (errno != EAGAIN)
+      {
+        perror("recvfrom in UdpSocket::handleInputBatch");
+      }
+      break;
+    }
+    ++cnt;
+    io_stats.rx_syscalls += 1;
+    io_stats.rx_datagrams += 1;
+    io_stats.rx_max_batch = std::max<uint64_t>(io_stats.rx_max_batch, 1);
+    onDataReceived(IpAddress(addr.sin_addr), ntohs(addr.sin_port),
+                   batch->slot(0), len);
+    if (is_destroyed)
+    {
+      delete batch;
+      return;
     }
   }
-  else
+#endif
+
+  destroyed = 0;
+  rx_batch = batch;
+} /* UdpSocket::handleInputBatch */
+
+
+void UdpSocket::sendRest(FdWatch *watch)
+{
+  while (!tx_queue->empty())
   {
-    assert(ret == send_buf->len);
-    sendBufferFull(false);
+    TxQueue::Slot& slot = tx_queue->front();
+    int ret = sendto(sock, slot.buf.data(), slot.buf.size(), 0,
+        reinterpret_cast<struct sockaddr *>(&slot.addr), sizeof(slot.addr));
+    io_stats.tx_syscalls += 1;
+    if (ret == -1)
+    {
+      if (errno == EAGAIN)
+      {
+        return;
+      }
+      perror("sendto in UdpSocket::sendRest");
+    }
+    else
+    {
+      assert(static_cast<size_t>(ret) == slot.buf.size());
+      io_stats.tx_datagrams += 1;
+      io_stats.tx_max_batch = std::max<uint64_t>(io_stats.tx_max_batch, 1);
+    }
+    tx_queue->pop();
   }
-  
-  delete send_buf;
-  send_buf = 0;
+
   wr_watch->setEnabled(false);
+  sendBufferFull(false);
   
 } /* UdpSocket::sendRest */
 
 
+bool UdpSocket::sendBatch(void)
+{
+  TxBatch *batch = tx_batch;
+  const size_t cnt = batch->items.size();
+  bool success = true;
+  size_t pos = 0;
+
+#ifdef HAS_MMSG_SUPPORT
+  batch->hdrs.resize(cnt);
+  batch->iov.resize(cnt);
+  for (size_t i=0; i<cnt; ++i)
+  {
+    TxBatch::Item& item = batch->items[i];
+    batch->iov[i].iov_base = &batch->data[item.offset];
+    batch->iov[i].iov_len = item.len;
+    struct msghdr& hdr = batch->hdrs[i].msg_hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.msg_name = &item.addr;
+    hdr.msg_namelen = sizeof(item.addr);
+    hdr.msg_iov = &batch->iov[i];
+    hdr.msg_iovlen = 1;
+  }
+  while ((pos < cnt) && tx_queue->empty())
+  {
+    int ret = sendmmsg(sock, &batch->hdrs[pos], cnt - pos, 0);
+    io_stats.tx_syscalls += 1;
+    if (ret == -1)
+    {
+      if (errno == EAGAIN)
+      {
+        break;
+      }
+      perror("sendmmsg in UdpSocket::sendBatch");
+      success = false;
+      pos += 1;
+      continue;
+    }
+    io_stats.tx_datagrams += ret;
+    io_stats.tx_max_batch = std::max<uint64_t>(io_stats.tx_max_batch, ret);
+    pos += ret;
+  }
+#else
+  while ((pos < cnt) && tx_queue->empty())
+  {
+    const TxBatch::Item& item = batch->items[pos];
+    int ret = sendto(sock, &batch->data[item.offset], item.len, 0,
+        reinterpret_cast<const struct sockaddr *>(&item.addr),
+        sizeof(item.addr));
+    io_stats.tx_syscalls += 1;
+    if (ret == -1)
+    {
+      if (errno == EAGAIN)
+      {
+        break;
+      }
+      perror("sendto in UdpSocket::sendBatch");
+      success = false;
+      pos += 1;
+      continue;
+    }
+    io_stats.tx_datagrams += 1;
+    io_stats.tx_max_batch = std::max<uint64_t>(io_stats.tx_max_batch, 1);
+    pos += 1;
+  }
+#endif
+
+    // Put datagrams that could not be sent in the send queue
+  for (; pos < cnt; ++pos)
+  {
+    const TxBatch::Item& item = batch->items[pos];
+    success = enqueue(item.addr, &batch->data[item.offset], item.len) &&
+              success;
+  }
+  batch->clear();
+
+  return success;
+} /* UdpSocket::sendBatch */
+
+
+bool UdpSocket::enqueue(const struct sockaddr_in& addr, const void *buf,
+                        int count)
+{
+  if (tx_queue->full())
+  {
+    io_stats.tx_dropped += 1;
+    if (tx_drop_policy == SEND_QUEUE_DROP_NEWEST)
+    {
+      return false;
+    }
+    tx_queue->pop();
+  }
+  tx_queue->push(addr, buf, count);
+  io_stats.tx_queued += 1;
+  io_stats.tx_queue_hwm = std::max<uint64_t>(io_stats.tx_queue_hwm,
+                                             tx_queue->size());
+  wr_watch->setEnabled(true);
+  return true;
+} /* UdpSocket::enqueue */
+
+
 
 
 
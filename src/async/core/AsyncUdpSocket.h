@@ -68,7 +68,7 @@ An example of how to use the Async::UdpSocket class
  *
  ****************************************************************************/
 
-class UdpPacket;
+struct sockaddr_in;
 
 
 /****************************************************************************
@@ -124,6 +124,15 @@ This class is used to work with UDP sockets. An example usage is shown below.
 class UdpSocket : public sigc::trackable
 {
   public:
+    /**
+     * @brief What to do when the send queue is full
+     */
+    typedef enum
+    {
+      SEND_QUEUE_DROP_NEWEST, ///< Drop the datagram that is being written
+      SEND_QUEUE_DROP_OLDEST  ///< Drop the oldest queued datagram
+    } SendQueueDropPolicy;
+
     /**
      * @brief 	Constructor
      * @param 	local_port  The local port to use. If not specified, a random
@@ -171,6 +180,142 @@ class UdpSocket : public sigc::trackable
     virtual bool write(const IpAddress& remote_ip, int remote_port,
         const void *buf, int count);
 
+    /**
+     * @brief   Start a batch of writes
+     *
+     * All calls to write made after this function has been called will be
+     * queued up instead of being sent directly. The queued datagrams are
+     * sent using as few system calls as possible when flushWriteBatch is
+     * called. Batches may be nested, in which case the queued datagrams are
+     * sent when the outermost batch is flushed.
+     */
+    void beginWriteBatch(void);
+
+    /**
+     * @brief   Send all datagrams queued since beginWriteBatch was called
+     * @return  Returns \em false if one or more datagrams could not be sent
+     */
+    bool flushWriteBatch(void);
+
+    /**
+     * @brief   Check if a write batch is in progress
+     * @return  Returns \em true if writes are currently being queued
+     */
+    bool writeBatchActive(void) const { return (tx_batch_depth > 0); }
+
+    /**
+     * @brief   Set the maximum number of datagrams to read at once
+     * @param   cnt The maximum number of datagrams to read per event
+     *
+     * When the socket becomes readable, up to the given number of datagrams
+     * will be read using a single system call, if supported by the OS. The
+     * dataReceived signal is still emitted once for each datagram. Setting
+     * the batch size to one, which is the default, will read one datagram
+     * per event. A larger batch size is useful for sockets that receive a
+     * lot of traffic since it reduce the number of system calls and main
+     * loop iterations. Each slot in the batch require 64kB of buffer space.
+     */
+    void setRecvBatchSize(unsigned cnt);
+
+    /**
+     * @brief   Get the maximum number of datagrams to read at once
+     * @return  Returns the receive batch size
+     */
+    unsigned recvBatchSize(void) const { return rx_batch_size; }
+
+    /**
+     * @brief   Set the maximum number of datagrams in the send queue
+     * @param   depth The maximum number of queued datagrams
+     *
+     * When the OS send buffer is full, datagrams are put in a send queue
+     * which is drained as soon as the socket is writable again. When the
+     * queue is full, datagrams are dropped according to the drop policy set
+     * using setSendQueueDropPolicy. The default depth is one. If the queue
+     * is made smaller than the number of currently queued datagrams, the
+     * oldest datagrams are dropped.
+     */
+    void setSendQueueDepth(size_t depth);
+
+    /**
+     * @brief   Get the maximum number of datagrams in the send queue
+     * @return  Returns the send queue depth
+     */
+    size_t sendQueueDepth(void) const;
+
+    /**
+     * @brief   Get the number of datagrams currently in the send queue
+     * @return  Returns the number of queued datagrams
+     */
+    size_t sendQueueSize(void) const;
+
+    /**
+     * @brief   Set what to do when the send queue is full
+     * @param   policy The drop policy to use
+     *
+     * The default is to drop the datagram that is being written, in which
+     * case the write function will return \em false.
+     */
+    void setSendQueueDropPolicy(SendQueueDropPolicy policy)
+    {
+      tx_drop_policy = policy;
+    }
+
+    /**
+     * @brief   Get the drop policy used when the send queue is full
+     * @return  Returns the current drop policy
+     */
+    SendQueueDropPolicy sendQueueDropPolicy(void) const
+    {
+      return tx_drop_policy;
+    }
+
+    /**
+     * @brief   Socket I/O statistics
+     */
+    struct Stats
+    {
+      uint64_t rx_syscalls  = 0;  ///< Number of receive system calls
+      uint64_t rx_datagrams = 0;  ///< Number of received datagrams
+      uint64_t rx_max_batch = 0;  ///< Max datagrams read in one call
+      uint64_t tx_syscalls  = 0;  ///< Number of send system calls
+      uint64_t tx_datagrams = 0;  ///< Number of sent datagrams
+      uint64_t tx_max_batch = 0;  ///< Max datagrams sent in one call
+      uint64_t tx_queued    = 0;  ///< Datagrams put in the send queue
+      uint64_t tx_dropped   = 0;  ///< Datagrams dropped on a full queue
+      uint64_t tx_queue_hwm = 0;  ///< Send queue high water mark
+
+      /**
+       * @brief   Get the average number of datagrams read per system call
+       * @return  Returns the average receive batch size
+       */
+      double rxAvgBatch(void) const
+      {
+        return (rx_syscalls > 0)
+          ? static_cast<double>(rx_datagrams) / rx_syscalls : 0.0;
+      }
+
+      /**
+       * @brief   Get the average number of datagrams sent per system call
+       * @return  Returns the average send batch size
+       */
+      double txAvgBatch(void) const
+      {
+        return (tx_syscalls > 0)
+          ? static_cast<double>(tx_datagrams) / tx_syscalls : 0.0;
+      }
+    };
+
+    /**
+     * @brief   Get the I/O statistics for this socket
+     * @return  Returns the statistics counters
+     */
+    const Stats& stats(void) const { return io_stats; }
+
+    /**
+     * @brief   Reset the I/O statistics for this socket
+     */
+    void resetStats(void) { io_stats = Stats(); }
+
     /**
      * @brief   Get the file descriptor for the UDP socket
      * @return  Returns the file descriptor associated with the socket or
@@ -199,14 +344,28 @@ class UdpSocket : public sigc::trackable
         int count);
 
   private:
-    int       	sock;
-    FdWatch * 	rd_watch;
-    FdWatch * 	wr_watch;
-    UdpPacket * send_buf;
+    class RxBatch;
+    class TxBatch;
+    class TxQueue;
+
+    int                 sock;
+    FdWatch *           rd_watch;
+    FdWatch *           wr_watch;
+    TxQueue *           tx_queue;
+    SendQueueDropPolicy tx_drop_policy;
+    unsigned            rx_batch_size;
+    RxBatch *           rx_batch;
+    TxBatch *           tx_batch;
+    unsigned            tx_batch_depth;
+    Stats               io_stats;
+    bool *              destroyed;
     
     void cleanup(void);
     void handleInput(FdWatch *watch);
+    void handleInputBatch(void);
     void sendRest(FdWatch *watch);
+    bool sendBatch(void);
+    bool enqueue(const struct sockaddr_in& addr, const void *buf, int count);
 
 };  /* class UdpSocket */
 
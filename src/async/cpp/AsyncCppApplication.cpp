@@ -9,7 +9,7 @@
  *
  * \verbatim
  * Async - A library for programming event driven applications
- * Copyright (C) 2003-2022 Tobias Blomberg
+ * Copyright (C) 2003-2026 Tobias Blomberg
  *
  * This program is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -37,14 +37,22 @@
  ****************************************************************************/
 
 #include <sys/select.h>
+#ifdef HAS_EPOLL_SUPPORT
+#include <sys/epoll.h>
+#endif
 #include <signal.h>
 #include <unistd.h>
 
 #include <cstdlib>
 #include <cstdio>
+#include <cstring>
 #include <cerrno>
 #include <cassert>
+#include <climits>
+#include <cstdint>
 #include <algorithm>
+#include <iostream>
+#include <vector>
 
 
 /****************************************************************************
@@ -64,6 +72,7 @@
 #include "AsyncCppDnsLookupWorker.h"
 #include "AsyncFdWatch.h"
 #include "AsyncTimer.h"
+#include "AsyncLoopProfiler.h"
 #include "AsyncCppApplication.h"
 
 
@@ -85,26 +94,6 @@ using namespace Async;
  *
  ****************************************************************************/
 
-# define clock_timeradd(a, b, result)                                         \
-  do {                                                                        \
-    (result)->tv_sec = (a)->tv_sec + (b)->tv_sec;                             \
-    (result)->tv_nsec = (a)->tv_nsec + (b)->tv_nsec;                          \
-    if ((result)->tv_nsec >= 1000000000)                                      \
-      {                                                                       \
-        ++(result)->tv_sec;                                                   \
-        (result)->tv_nsec -= 1000000000;                                      \
-      }                                                                       \
-  } while (0)
-
-# define clock_timersub(a, b, result)                                         \
-  do {                                                                        \
-    (result)->tv_sec = (a)->tv_sec - (b)->tv_sec;                             \
-    (result)->tv_nsec = (a)->tv_nsec - (b)->tv_nsec;                          \
-    if ((result)->tv_nsec < 0) {                                              \
-      --(result)->tv_sec;                                                     \
-      (result)->tv_nsec += 1000000000;                                        \
-    }                                                                         \
-  } while (0)
 
 
 
@@ -115,6 +104,12 @@ using namespace Async;
  *
  ****************************************************************************/
 
+#ifdef HAS_EPOLL_SUPPORT
+class CppApplication::EpollEvents : public std::vector<struct epoll_event>
+{
+};
+#endif
+
 
 
 /****************************************************************************
@@ -161,18 +156,66 @@ int CppApplication::sighandler_pipe[2];
  * Bugs:      
  *------------------------------------------------------------------------
  */
-CppApplication::CppApplication(void)
-  : do_quit(false), max_desc(0), unix_signal_recv(-1), unix_signal_recv_cnt(0)
+CppApplication::CppApplication(Backend backend)
+  : m_backend(backend), epoll_fd(-1), epoll_events(0), do_quit(false),
+    max_desc(0),
+    unix_signal_recv(-1), unix_signal_recv_cnt(0)
 {
   FD_ZERO(&rd_set);
   FD_ZERO(&wr_set);
   sighandler_pipe[0] = sighandler_pipe[1] = -1;
+
+  if (m_backend == BACKEND_DEFAULT)
+  {
+    m_backend = BACKEND_EPOLL;
+    const char *backend_str = getenv("ASYNC_CPP_APP_BACKEND");
+    if (backend_str != 0)
+    {
+      if (strcmp(backend_str, "select") == 0)
+      {
+        m_backend = BACKEND_SELECT;
+      }
+      else if (strcmp(backend_str, "epoll") != 0)
+      {
+        cerr << "*** WARNING: Unknown ASYNC_CPP_APP_BACKEND \""
+             << backend_str << "\". Using the default backend." << endl;
+      }
+    }
+  }
+
+  if (m_backend == BACKEND_EPOLL)
+  {
+#ifdef HAS_EPOLL_SUPPORT
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd == -1)
+    {
+      perror("epoll_create1");
+      m_backend = BACKEND_SELECT;
+    }
+    else
+    {
+      epoll_events = new EpollEvents;
+      epoll_events->resize(64);
+    }
+#else
+    m_backend = BACKEND_SELECT;
+#endif
+  }
 } /* CppApplication::CppApplication */
 
 
 CppApplication::~CppApplication(void)
 {
   clearTasks();
+#ifdef HAS_EPOLL_SUPPORT
+  if (epoll_fd != -1)
+  {
+    close(epoll_fd);
+    epoll_fd = -1;
+  }
+  delete epoll_events;
+  epoll_events = 0;
+#endif
 } /* CppApplication::~CppApplication */
 
 
@@ -203,37 +246,33 @@ void CppApplication::exec(void)
     }
   }
   
+  LoopProfiler& profiler = LoopProfiler::instance();
   while (!do_quit)
   {
-    struct timespec *timeout_ptr = 0;
     struct timespec timeout;
-    TimerMap::iterator titer = timer_map.begin();
-    while (titer != timer_map.end())
+    struct timespec *timeout_ptr = 0;
+    if (timer_wheel.nextTimeout(timeout))
     {
-      if (titer->second != 0)
-      {
-	struct timespec ts;
-	clock_gettime(CLOCK_MONOTONIC, &ts);
-	clock_timersub(&titer->first, &ts, &timeout);
-	if (timeout.tv_sec < 0)
-	{
-	  timeout.tv_sec = 0;
-	  timeout.tv_nsec = 0;
-	}
-	timeout_ptr = &timeout;
-	break;
-      }
-      else
-      {
-	timer_map.erase(titer);
-      }
-      titer = timer_map.begin();
+      timeout_ptr = &timeout;
     }
     
-    fd_set local_rd_set = rd_set;
-    fd_set local_wr_set = wr_set;
-    int dcnt = pselect(max_desc, &local_rd_set, &local_wr_set, NULL,
-	timeout_ptr, NULL);
+    if (profiler.isEnabled())
+    {
+      profiler.waitBegin();
+    }
+    fd_set local_rd_set;
+    fd_set local_wr_set;
+#ifdef HAS_EPOLL_SUPPORT
+    int dcnt = (m_backend == BACKEND_EPOLL)
+      ? waitEpoll(timeout_ptr)
+      : waitSelect(timeout_ptr, local_rd_set, local_wr_set);
+#else
+    int dcnt = waitSelect(timeout_ptr, local_rd_set, local_wr_set);
+#endif
+    if (profiler.isEnabled())
+    {
+      profiler.waitEnd();
+    }
     if (dcnt == -1)
     {
       if ((errno == EINTR) || (errno == EAGAIN))
@@ -242,71 +281,22 @@ void CppApplication::exec(void)
       }
       else
       {
-        perror("pselect");
+        perror((m_backend == BACKEND_EPOLL) ? "epoll_wait" : "pselect");
         exit(1);
       }
     }
     
-    if ((timeout_ptr != 0)
-        && ((dcnt == 0)
-            || ((timeout_ptr->tv_sec == 0) && (timeout_ptr->tv_nsec == 0))
-           )
-       )
-    {
-      titer->second->expired(titer->second);
-      if ((titer->second != 0) &&
-	  (titer->second->type() == Timer::TYPE_PERIODIC))
-      {
-	addTimerP(titer->second, titer->first);
-      }
-      timer_map.erase(titer);
-    }
-    
-    WatchMap::iterator witer, next_witer;
-    
-      /* Check for activity on the read watch file descriptors */
-    witer=rd_watch_map.begin();
-    while ((dcnt > 0) && (witer != rd_watch_map.end()))
-    {
-      next_witer = witer;
-      ++next_witer;
-      if (FD_ISSET(witer->first, &local_rd_set))
-      {
-	if (witer->second != 0)
-	{
-	  witer->second->activity(witer->second);
-	}
-	else
-	{
-	  rd_watch_map.erase(witer);
-	}
-	--dcnt;
-      }
-      witer = next_witer;
-    }
+      // Expire all timers that are due in one go
+    timer_wheel.expire();
     
-      /* Check for activity on the write watch file descriptors */
-    witer=wr_watch_map.begin();
-    while ((dcnt > 0) && (witer != wr_watch_map.end()))
+#ifdef HAS_EPOLL_SUPPORT
+    if (m_backend == BACKEND_EPOLL)
     {
-      next_witer = witer;
-      ++next_witer;
-      if (FD_ISSET(witer->first, &local_wr_set))
-      {
-	if (witer->second != 0)
-	{
-	  witer->second->activity(witer->second);
-	}
-	else
-	{
-	  wr_watch_map.erase(witer);
-	}
-	--dcnt;
-      }
-      witer = next_witer;
+      dispatchEpoll(dcnt);
+      continue;
     }
-    
-    assert(dcnt == 0);
+#endif
+    dispatchSelect(dcnt, local_rd_set, local_wr_set);
   }
 
   for (UnixSignalMap::const_iterator it = unix_signals.begin();
@@ -378,6 +368,12 @@ void CppApplication::uncatchUnixSignal(int signum)
 } /* CppApplication::uncatchUnixSignal */
 
 
+const char *CppApplication::backendName(void) const
+{
+  return (m_backend == BACKEND_EPOLL) ? "epoll" : "select";
+} /* CppApplication::backendName */
+
+
 
 /****************************************************************************
  *
@@ -426,12 +422,10 @@ void CppApplication::addFdWatch(FdWatch *fd_watch)
   switch (fd_watch->type())
   {
     case FdWatch::FD_WATCH_RD:
-      FD_SET(fd, &rd_set);
       watch_map = &rd_watch_map;
       break;
 
     case FdWatch::FD_WATCH_WR:
-      FD_SET(fd, &wr_set);
       watch_map = &wr_watch_map;
       break;
   }
@@ -440,13 +434,28 @@ void CppApplication::addFdWatch(FdWatch *fd_watch)
   WatchMap::iterator iter = watch_map->find(fd);
   assert((iter == watch_map->end()) || (iter->second == 0));
   
+  (*watch_map)[fd] = fd_watch;
+
+#ifdef HAS_EPOLL_SUPPORT
+  if (m_backend == BACKEND_EPOLL)
+  {
+    updateEpoll(fd);
+    return;
+  }
+#endif
+
+  if (fd >= FD_SETSIZE)
+  {
+    cerr << "*** ERROR: File descriptor " << fd << " is too large for the "
+            "select backend (FD_SETSIZE=" << FD_SETSIZE << ")" << endl;
+    abort();
+  }
+
+  FD_SET(fd, (watch_map == &rd_watch_map) ? &rd_set : &wr_set);
   if (fd+1 > max_desc)
   {
     max_desc = fd+1;
   }
-
-  (*watch_map)[fd] = fd_watch;
-  
 } /* CppApplication::addFdWatch */
 
 
@@ -457,12 +466,10 @@ void CppApplication::delFdWatch(FdWatch *fd_watch)
   switch (fd_watch->type())
   {
     case FdWatch::FD_WATCH_RD:
-      FD_CLR(fd, &rd_set);
       watch_map = &rd_watch_map;
       break;
       
     case FdWatch::FD_WATCH_WR:
-      FD_CLR(fd, &wr_set);
       watch_map = &wr_watch_map;
       break;
   }
@@ -470,6 +477,19 @@ void CppApplication::delFdWatch(FdWatch *fd_watch)
   
   WatchMap::iterator iter = watch_map->find(fd);
   assert((iter != watch_map->end()) && (iter->second != 0));
+
+#ifdef HAS_EPOLL_SUPPORT
+  if (m_backend == BACKEND_EPOLL)
+  {
+      // The epoll dispatcher look up each ready file descriptor in the watch
+      // maps so it is safe to erase the entry right away.
+    watch_map->erase(iter);
+    updateEpoll(fd);
+    return;
+  }
+#endif
+
+  FD_CLR(fd, (watch_map == &rd_watch_map) ? &rd_set : &wr_set);
   iter->second = 0;
   
   if (fd+1 == max_desc)
@@ -500,40 +520,233 @@ void CppApplication::delFdWatch(FdWatch *fd_watch)
 } /* CppApplication::delFdWatch */
 
 
-void CppApplication::addTimer(Timer *timer)
+int CppApplication::waitSelect(struct timespec *timeout_ptr,
+                               fd_set& local_rd_set, fd_set& local_wr_set)
 {
-  struct timespec current;
-  clock_gettime(CLOCK_MONOTONIC, &current);
-  addTimerP(timer, current);
-} /* CppApplication::addTimer */
+  local_rd_set = rd_set;
+  local_wr_set = wr_set;
+  return pselect(max_desc, &local_rd_set, &local_wr_set, NULL,
+                 timeout_ptr, NULL);
+} /* CppApplication::waitSelect */
+
+
+void CppApplication::emitActivity(FdWatch *watch)
+{
+  LoopProfiler& profiler = LoopProfiler::instance();
+  if (!profiler.isEnabled())
+  {
+    watch->activity(watch);
+    return;
+  }
 
+    // The watch may be deleted in the callback so save what we need first
+  const LoopProfiler::CallbackType type =
+    (watch->type() == FdWatch::FD_WATCH_RD)
+      ? LoopProfiler::CB_FD_READ : LoopProfiler::CB_FD_WRITE;
+  const char *tag = watch->tag();
+  const uint64_t start_ns = LoopProfiler::nowNs();
+  watch->activity(watch);
+  profiler.addCallback(type, tag, LoopProfiler::nowNs() - start_ns);
+} /* CppApplication::emitActivity */
 
-void CppApplication::addTimerP(Timer *timer, const struct timespec& current)
+
+void CppApplication::dispatchSelect(int dcnt, fd_set& local_rd_set,
+                                    fd_set& local_wr_set)
 {
-  struct timespec add;
-  struct timespec expiration;
-  int timeout = timer->timeout();
-  add.tv_sec = timeout / 1000;
-  timeout -= add.tv_sec * 1000;
-  add.tv_nsec = timeout * 1000000;
-  clock_timeradd(&current, &add, &expiration);
+  WatchMap::iterator witer, next_witer;
   
-  timer_map.insert(pair<struct timespec, Timer *>(expiration, timer));
-} /* CppApplication::addTimerP */
+    /* Check for activity on the read watch file descriptors */
+  witer=rd_watch_map.begin();
+  while ((dcnt > 0) && (witer != rd_watch_map.end()))
+  {
+    next_witer = witer;
+    ++next_witer;
+    if (FD_ISSET(witer->first, &local_rd_set))
+    {
+      if (witer->second != 0)
+      {
+        emitActivity(witer->second);
+      }
+      else
+      {
+        rd_watch_map.erase(witer);
+      }
+      --dcnt;
+    }
+    witer = next_witer;
+  }
+  
+    /* Check for activity on the write watch file descriptors */
+  witer=wr_watch_map.begin();
+  while ((dcnt > 0) && (witer != wr_watch_map.end()))
+  {
+    next_witer = witer;
+    ++next_witer;
+    if (FD_ISSET(witer->first, &local_wr_set))
+    {
+      if (witer->second != 0)
+      {
+        emitActivity(witer->second);
+      }
+      else
+      {
+        wr_watch_map.erase(witer);
+      }
+      --dcnt;
+    }
+    witer = next_witer;
+  }
+  
+  assert(dcnt == 0);
+} /* CppApplication::dispatchSelect */
 
 
-void CppApplication::delTimer(Timer *timer)
+#ifdef HAS_EPOLL_SUPPORT
+int CppApplication::waitEpoll(struct timespec *timeout_ptr)
+{
+    // Round the timeout up to whole milliseconds so that we never wake up
+    // before the timer is due
+  int timeout_ms = -1;
+  if (!always_ready_fds.empty())
+  {
+    timeout_ms = 0;
+  }
+  else if (timeout_ptr != 0)
+  {
+      // Calculate in 64 bits and clamp since timers far in the future would
+      // overflow an int, and a negative timeout block forever
+    const int64_t ms = static_cast<int64_t>(timeout_ptr->tv_sec) * 1000 +
+                       (timeout_ptr->tv_nsec + 999999) / 1000000;
+    timeout_ms = static_cast<int>(std::min<int64_t>(ms, INT_MAX));
+  }
+  return epoll_wait(epoll_fd, &(*epoll_events)[0], epoll_events->size(),
+                    timeout_ms);
+} /* CppApplication::waitEpoll */
+
+
+void CppApplication::dispatchEpoll(int dcnt)
 {
-  TimerMap::iterator iter;
-  for (iter=timer_map.begin(); iter!=timer_map.end(); ++iter)
+  for (int i=0; i<dcnt; ++i)
   {
-    if (iter->second == timer)
+    int fd = (*epoll_events)[i].data.fd;
+    uint32_t events = (*epoll_events)[i].events;
+
+      // A callback may remove any watch so the watch maps must be consulted
+      // for every file descriptor and every type of watch
+    if (events & (EPOLLIN | EPOLLHUP | EPOLLERR))
     {
-      //timer_map.erase(iter);
-      iter->second = 0;
-      break;
+      WatchMap::iterator witer = rd_watch_map.find(fd);
+      if (witer != rd_watch_map.end())
+      {
+        emitActivity(witer->second);
+      }
+    }
+      // A hangup is only reported as write activity when there is no read
+      // watch that can pick it up. Otherwise epoll would keep reporting it.
+    if ((events & (EPOLLOUT | EPOLLERR)) ||
+        ((events & EPOLLHUP) && (rd_watch_map.find(fd) == rd_watch_map.end())))
+    {
+      WatchMap::iterator witer = wr_watch_map.find(fd);
+      if (witer != wr_watch_map.end())
+      {
+        emitActivity(witer->second);
+      }
     }
   }
+
+    // File descriptors that epoll cannot handle, like regular files, are
+    // always reported as ready just like select would do
+  if (!always_ready_fds.empty())
+  {
+    std::vector<int> fds(always_ready_fds.begin(), always_ready_fds.end());
+    for (std::vector<int>::const_iterator it = fds.begin();
+         it != fds.end(); ++it)
+    {
+      WatchMap::iterator witer = rd_watch_map.find(*it);
+      if (witer != rd_watch_map.end())
+      {
+        emitActivity(witer->second);
+      }
+      witer = wr_watch_map.find(*it);
+      if (witer != wr_watch_map.end())
+      {
+        emitActivity(witer->second);
+      }
+    }
+  }
+
+  if (static_cast<size_t>(dcnt) == epoll_events->size())
+  {
+    epoll_events->resize(2 * epoll_events->size());
+  }
+} /* CppApplication::dispatchEpoll */
+
+
+void CppApplication::updateEpoll(int fd)
+{
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.data.fd = fd;
+  if (rd_watch_map.find(fd) != rd_watch_map.end())
+  {
+    ev.events |= EPOLLIN;
+  }
+  if (wr_watch_map.find(fd) != wr_watch_map.end())
+  {
+    ev.events |= EPOLLOUT;
+  }
+
+  FdSet::iterator ait = always_ready_fds.find(fd);
+  if (ait != always_ready_fds.end())
+  {
+    if (ev.events == 0)
+    {
+      always_ready_fds.erase(ait);
+    }
+    return;
+  }
+
+  if (ev.events == 0)
+  {
+      // The file descriptor may already have been closed, in which case the
+      // kernel have removed it from the epoll set automatically
+    if ((epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, &ev) == -1) &&
+        (errno != ENOENT) && (errno != EBADF))
+    {
+      perror("epoll_ctl(EPOLL_CTL_DEL)");
+    }
+    return;
+  }
+
+  int ret = epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev);
+  if ((ret == -1) && (errno == ENOENT))
+  {
+    ret = epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+  }
+  if (ret == -1)
+  {
+    if (errno == EPERM)
+    {
+      always_ready_fds.insert(fd);
+    }
+    else
+    {
+      perror("epoll_ctl");
+    }
+  }
+} /* CppApplication::updateEpoll */
+#endif
+
+
+void CppApplication::addTimer(Timer *timer)
+{
+  timer_wheel.add(timer);
+} /* CppApplication::addTimer */
+
+
+void CppApplication::delTimer(Timer *timer)
+{
+  timer_wheel.remove(timer);
 } /* CppApplication::delTimer */
 
 
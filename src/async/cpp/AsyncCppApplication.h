@@ -9,7 +9,7 @@
  *
  * \verbatim
  * Async - A library for programming event driven applications
- * Copyright (C) 2003-2022 Tobias Blomberg
+ * Copyright (C) 2003-2026 Tobias Blomberg
  *
  * This program is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -45,6 +45,7 @@
 #include <sigc++/sigc++.h>
 
 #include <map>
+#include <set>
 #include <utility>
 
 
@@ -63,6 +64,8 @@
  *
  ****************************************************************************/
 
+#include "AsyncCppTimerWheel.h"
+
 
 
 /****************************************************************************
@@ -132,14 +135,41 @@ namespace Async
 
 /**
 * @brief An application class for writing non GUI applications.
+*
+* The main loop can be run using one of two backends for waiting on file
+* descriptor activity. The select backend use pselect(2) and is available on
+* all platforms. It is limited to file descriptors below FD_SETSIZE
+* (normally 1024) and the cost of each loop iteration grow with the number of
+* watched file descriptors. The epoll backend, which is only available on
+* Linux, register file descriptors incrementally and only dispatch the ones
+* that are ready. The epoll backend is the default where it is available.
+*
+* The backend can be chosen when constructing the application object or at
+* runtime by setting the environment variable ASYNC_CPP_APP_BACKEND to
+* "select" or "epoll".
 */
 class CppApplication : public Application
 {
   public:
+    /**
+     * @brief The backend used to wait for file descriptor activity
+     */
+    typedef enum
+    {
+      BACKEND_DEFAULT,  ///< Use the best available backend
+      BACKEND_SELECT,   ///< Use pselect(2)
+      BACKEND_EPOLL     ///< Use epoll(7) (Linux only)
+    } Backend;
+
     /**
      * @brief Constructor
+     * @param backend The backend to use for watching file descriptors
+     *
+     * If the backend is BACKEND_DEFAULT, the environment variable
+     * ASYNC_CPP_APP_BACKEND is consulted. If that is not set, the epoll
+     * backend is used if available, otherwise the select backend.
      */
-    CppApplication(void);
+    explicit CppApplication(Backend backend=BACKEND_DEFAULT);
 
     /**
      * @brief Destructor
@@ -174,6 +204,18 @@ class CppApplication : public Application
      */
     void quit(void);
 
+    /**
+     * @brief   Get the backend in use for watching file descriptors
+     * @return  Returns BACKEND_SELECT or BACKEND_EPOLL
+     */
+    Backend backend(void) const { return m_backend; }
+
+    /**
+     * @brief   Get the name of the backend in use
+     * @return  Returns "select" or "epoll"
+     */
+    const char *backendName(void) const;
+
     /**
      * @brief   A signal that is emitted when a monitored UNIX signal is caught
      * @param   signum The signal number that was caught
@@ -187,28 +229,25 @@ class CppApplication : public Application
   protected:
     
   private:
-    struct lttimespec
-    {
-      bool operator()(const struct timespec& t1, const struct timespec& t2) const
-      {
-        return ((t1.tv_sec == t2.tv_sec)
-                ? (t1.tv_nsec < t2.tv_nsec)
-                : (t1.tv_sec < t2.tv_sec));
-      }
-    };
     typedef std::map<int, FdWatch*>   	      	      	        WatchMap;
-    typedef std::multimap<struct timespec, Timer *, lttimespec> TimerMap;
     typedef std::map<int, struct sigaction>                     UnixSignalMap;
-    
+    typedef std::set<int>                                       FdSet;
+
+    class EpollEvents;
+
     static int          sighandler_pipe[2];
 
+    Backend             m_backend;
+    int                 epoll_fd;
+    EpollEvents *       epoll_events;
+    FdSet               always_ready_fds;
     bool      	      	do_quit;
     int       	      	max_desc;
     fd_set    	      	rd_set;
     fd_set    	      	wr_set;
     WatchMap  	      	rd_watch_map;
     WatchMap  	      	wr_watch_map;
-    TimerMap  	      	timer_map;
+    CppTimerWheel       timer_wheel;
     UnixSignalMap       unix_signals;
     int                 unix_signal_recv;
     size_t              unix_signal_recv_cnt;
@@ -217,8 +256,14 @@ class CppApplication : public Application
 
     void addFdWatch(FdWatch *fd_watch);
     void delFdWatch(FdWatch *fd_watch);
+    int waitSelect(struct timespec *timeout_ptr, fd_set& local_rd_set,
+                   fd_set& local_wr_set);
+    void dispatchSelect(int dcnt, fd_set& local_rd_set, fd_set& local_wr_set);
+    int waitEpoll(struct timespec *timeout_ptr);
+    void dispatchEpoll(int dcnt);
+    void updateEpoll(int fd);
+    void emitActivity(FdWatch *watch);
     void addTimer(Timer *timer);
-    void addTimerP(Timer *timer, const struct timespec& current);
     void delTimer(Timer *timer);    
     DnsLookupWorker *newDnsLookupWorker(const DnsLookup& lookup);
     void handleUnixSignal(void);
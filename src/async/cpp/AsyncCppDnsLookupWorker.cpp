@@ -232,6 +232,7 @@ bool CppDnsLookupWorker::doLookup(void)
     return false;
   }
   m_notifier_watch.setFd(fd[0], FdWatch::FD_WATCH_RD);
+  m_notifier_watch.setTag("Async::DnsLookup");
   m_notifier_watch.setEnabled(true);
 
   m_ctx = std::unique_ptr<ThreadContext>(new ThreadContext);
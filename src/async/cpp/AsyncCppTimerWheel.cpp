@@ -0,0 +1,486 @@
+/**
+@file	 AsyncCppTimerWheel.cpp
+@brief   A hierarchical timing wheel used by the Cpp application main loop
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-17
+
+This file contains a hierarchical timing wheel that keep track of all active
+timers in the Cpp variant of the async environment.
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncTimer.h"
+#include "AsyncLoopProfiler.h"
+#include "AsyncCppTimerWheel.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Static class variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+namespace {
+
+const uint64_t NS_PER_MS = 1000000;
+
+
+/****************************************************************************
+ *
+ * Local functions
+ *
+ ****************************************************************************/
+
+
+
+}; /* End of anonymous namespace */
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+CppTimerWheel::CppTimerWheel(void)
+  : m_wheel_tick(nowNs() / NS_PER_MS), m_wheel_cnt(0)
+{
+  memset(m_tvr_bitmap, 0, sizeof(m_tvr_bitmap));
+  memset(m_tvn_bitmap, 0, sizeof(m_tvn_bitmap));
+} /* CppTimerWheel::CppTimerWheel */
+
+
+CppTimerWheel::~CppTimerWheel(void)
+{
+
+} /* CppTimerWheel::~CppTimerWheel */
+
+
+void CppTimerWheel::add(Timer *timer)
+{
+  uint64_t now_ns = nowNs();
+  if (m_wheel_cnt == 0)
+  {
+      // Catch up with the current time when the wheel is empty since there
+      // is no need to step through all ticks in that case
+    m_wheel_tick = std::max<uint64_t>(m_wheel_tick, now_ns / NS_PER_MS);
+  }
+  addAt(timer, now_ns + timer->timeout() * NS_PER_MS,
+        timer->timeout() == 0);
+} /* CppTimerWheel::add */
+
+
+void CppTimerWheel::remove(Timer *timer)
+{
+  TimerMap::iterator tit = m_timer_map.find(timer);
+  if (tit == m_timer_map.end())
+  {
+    return;
+  }
+  unlink(tit->second);
+  m_timer_map.erase(tit);
+} /* CppTimerWheel::remove */
+
+
+bool CppTimerWheel::nextTimeout(struct timespec& timeout)
+{
+  if (!m_expired.empty())
+  {
+    timeout.tv_sec = 0;
+    timeout.tv_nsec = 0;
+    return true;
+  }
+  if (m_wheel_cnt == 0)
+  {
+    return false;
+  }
+
+  uint64_t next_tick = UINT64_MAX;
+
+    // Timers in the innermost wheel expire on the exact tick of the slot
+  unsigned cur = m_wheel_tick & TVR_MASK;
+  int slot = findNextTvr(cur);
+  if (slot < 0)
+  {
+    slot = findNextTvr(0);
+  }
+  if (slot >= 0)
+  {
+    next_tick = m_wheel_tick + ((slot - cur) & TVR_MASK);
+  }
+
+    // Timers in the outer wheels need attention when their slot is cascaded
+  for (unsigned level=0; level<TVN_CNT; ++level)
+  {
+    if (m_tvn_bitmap[level] == 0)
+    {
+      continue;
+    }
+    unsigned shift = tvnShift(level);
+    uint64_t mask = (1ULL << shift) - 1;
+    uint64_t base = (m_wheel_tick + mask) & ~mask;
+    unsigned bidx = (base >> shift) & TVN_MASK;
+    uint64_t rotated = (m_tvn_bitmap[level] >> bidx) |
+                       ((bidx > 0) ? (m_tvn_bitmap[level] << (TVN_SIZE - bidx))
+                                   : 0);
+    unsigned dist = __builtin_ctzll(rotated);
+    next_tick = std::min<uint64_t>(next_tick, base + (uint64_t(dist) << shift));
+  }
+
+  uint64_t now_ns = nowNs();
+  uint64_t next_ns = next_tick * NS_PER_MS;
+  uint64_t left_ns = (next_ns > now_ns) ? (next_ns - now_ns) : 0;
+  timeout.tv_sec = left_ns / 1000000000ULL;
+  timeout.tv_nsec = left_ns % 1000000000ULL;
+  return true;
+} /* CppTimerWheel::nextTimeout */
+
+
+void CppTimerWheel::expire(void)
+{
+  advance(nowNs() / NS_PER_MS);
+  if (m_expired.empty())
+  {
+    return;
+  }
+
+    // Only timers that are due right now are expired. Timers that become
+    // due while expiring, e.g. zero timeout timers, are put on the expired
+    // list and will be handled on the next main loop iteration.
+  for (EntryList::iterator it=m_expired.begin(); it!=m_expired.end(); ++it)
+  {
+    it->list = &m_firing;
+    it->firing = true;
+  }
+  m_firing.splice(m_firing.end(), m_expired);
+
+  while (!m_firing.empty())
+  {
+    Timer *timer = m_firing.front().timer;
+    uint64_t expire_ns = m_firing.front().expire_ns;
+
+    LoopProfiler& profiler = LoopProfiler::instance();
+    if (profiler.isEnabled())
+    {
+        // Coarse timers are late by design so their lag is not interesting
+      const uint64_t start_ns = LoopProfiler::nowNs();
+      if (!timer->isCoarse())
+      {
+        profiler.addTimerLag(
+            (start_ns > expire_ns) ? (start_ns - expire_ns) : 0);
+      }
+      const char *tag = timer->tag();
+      timer->expired(timer);
+      profiler.addCallback(LoopProfiler::CB_TIMER, tag,
+                           LoopProfiler::nowNs() - start_ns);
+    }
+    else
+    {
+      timer->expired(timer);
+    }
+
+      // The timer may have been removed, reset or even deleted and replaced
+      // by a new timer with the same address in the callback. It's only
+      // ours if it is still firing.
+    TimerMap::iterator tit = m_timer_map.find(timer);
+    if ((tit == m_timer_map.end()) || !tit->second->firing)
+    {
+      continue;
+    }
+    if (timer->type() == Timer::TYPE_PERIODIC)
+    {
+      unlink(tit->second);
+      m_timer_map.erase(tit);
+      addAt(timer, expire_ns + timer->timeout() * NS_PER_MS, false);
+    }
+    else
+    {
+      unlink(tit->second);
+      m_timer_map.erase(tit);
+    }
+  }
+} /* CppTimerWheel::expire */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+uint64_t CppTimerWheel::nowNs(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return uint64_t(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+} /* CppTimerWheel::nowNs */
+
+
+void CppTimerWheel::addAt(Timer *timer, uint64_t expire_ns, bool due)
+{
+  remove(timer);
+
+    // A timer that is due right away is put directly on the expired list so
+    // that it is not delayed until the next millisecond tick
+  uint64_t tick = due ? 0 : (expire_ns + NS_PER_MS - 1) / NS_PER_MS;
+  if (!due && timer->isCoarse())
+  {
+    const uint64_t res = Timer::COARSE_RESOLUTION_MS;
+    tick = (tick + res - 1) / res * res;
+  }
+
+    // Reuse list nodes from previously removed timers to avoid allocations
+  if (m_unused.empty())
+  {
+    m_unused.emplace_back();
+  }
+  EntryList::iterator it = m_unused.begin();
+  it->timer = timer;
+  it->expire_ns = expire_ns;
+  it->tick = tick;
+  it->list = &m_unused;
+  it->level = -1;
+  it->slot = 0;
+  it->firing = false;
+  m_timer_map[timer] = it;
+  place(m_unused, it);
+} /* CppTimerWheel::addAt */
+
+
+void CppTimerWheel::place(EntryList& src, EntryList::iterator it)
+{
+  if (it->tick < m_wheel_tick)
+  {
+    it->list = &m_expired;
+    it->level = -1;
+    m_expired.splice(m_expired.end(), src, it);
+    return;
+  }
+
+  uint64_t delta = it->tick - m_wheel_tick;
+  if (delta < TVR_SIZE)
+  {
+    unsigned slot = it->tick & TVR_MASK;
+    it->list = &m_tvr[slot];
+    it->level = 0;
+    it->slot = slot;
+    m_tvr_bitmap[slot / 64] |= 1ULL << (slot % 64);
+  }
+  else
+  {
+    unsigned level = 0;
+    while ((level < TVN_CNT-1) &&
+           (delta >= (1ULL << (tvnShift(level) + TVN_BITS))))
+    {
+      ++level;
+    }
+      // Timers too far into the future are parked in the last slot reachable
+      // by the outermost wheel and will be placed again when cascaded
+    uint64_t tick = std::min<uint64_t>(it->tick,
+        m_wheel_tick + (1ULL << (tvnShift(level) + TVN_BITS)) - 1);
+    unsigned slot = (tick >> tvnShift(level)) & TVN_MASK;
+    it->list = &m_tvn[level][slot];
+    it->level = level + 1;
+    it->slot = slot;
+    m_tvn_bitmap[level] |= 1ULL << slot;
+  }
+  it->list->splice(it->list->end(), src, it);
+  ++m_wheel_cnt;
+} /* CppTimerWheel::place */
+
+
+void CppTimerWheel::unlink(EntryList::iterator it)
+{
+  EntryList *list = it->list;
+  m_unused.splice(m_unused.begin(), *list, it);
+  if (it->level >= 0)
+  {
+    assert(m_wheel_cnt > 0);
+    --m_wheel_cnt;
+    if (list->empty())
+    {
+      if (it->level == 0)
+      {
+        m_tvr_bitmap[it->slot / 64] &= ~(1ULL << (it->slot % 64));
+      }
+      else
+      {
+        m_tvn_bitmap[it->level - 1] &= ~(1ULL << it->slot);
+      }
+    }
+  }
+  it->list = &m_unused;
+  it->level = -1;
+  it->firing = false;
+} /* CppTimerWheel::unlink */
+
+
+void CppTimerWheel::advance(uint64_t now_tick)
+{
+  while (m_wheel_tick <= now_tick)
+  {
+    if (m_wheel_cnt == 0)
+    {
+      m_wheel_tick = now_tick + 1;
+      break;
+    }
+
+    unsigned idx = m_wheel_tick & TVR_MASK;
+    if (idx == 0)
+    {
+      for (unsigned level=0; level<TVN_CNT; ++level)
+      {
+        unsigned slot = (m_wheel_tick >> tvnShift(level)) & TVN_MASK;
+        cascade(level, slot);
+        if (slot != 0)
+        {
+          break;
+        }
+      }
+    }
+
+    if (!m_tvr[idx].empty())
+    {
+      m_wheel_cnt -= m_tvr[idx].size();
+      m_tvr_bitmap[idx / 64] &= ~(1ULL << (idx % 64));
+      moveToExpired(m_tvr[idx]);
+    }
+
+      // Jump directly to the next tick that need attention, which is either
+      // a non-empty slot in the innermost wheel or the next cascade
+    int next = (idx < TVR_MASK) ? findNextTvr(idx + 1) : -1;
+    uint64_t next_tick = (next >= 0)
+      ? (m_wheel_tick - idx + next)
+      : ((m_wheel_tick | TVR_MASK) + 1);
+    m_wheel_tick = std::min<uint64_t>(next_tick, now_tick + 1);
+  }
+} /* CppTimerWheel::advance */
+
+
+void CppTimerWheel::cascade(unsigned level, unsigned slot)
+{
+  EntryList& src = m_tvn[level][slot];
+  if (src.empty())
+  {
+    return;
+  }
+  m_tvn_bitmap[level] &= ~(1ULL << slot);
+  m_wheel_cnt -= src.size();
+
+  EntryList tmp;
+  tmp.splice(tmp.end(), src);
+  while (!tmp.empty())
+  {
+    place(tmp, tmp.begin());
+  }
+} /* CppTimerWheel::cascade */
+
+
+void CppTimerWheel::moveToExpired(EntryList& src)
+{
+  for (EntryList::iterator it=src.begin(); it!=src.end(); ++it)
+  {
+    it->list = &m_expired;
+    it->level = -1;
+  }
+  m_expired.splice(m_expired.end(), src);
+} /* CppTimerWheel::moveToExpired */
+
+
+int CppTimerWheel::findNextTvr(unsigned from) const
+{
+  for (unsigned word=from/64; word<TVR_SIZE/64; ++word)
+  {
+    uint64_t bits = m_tvr_bitmap[word];
+    if (word == from/64)
+    {
+      bits &= ~0ULL << (from % 64);
+    }
+    if (bits != 0)
+    {
+      return word * 64 + __builtin_ctzll(bits);
+    }
+  }
+  return -1;
+} /* CppTimerWheel::findNextTvr */
+
+
+/*
+ * This file has not been truncated
+ */
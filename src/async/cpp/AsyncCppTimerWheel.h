@@ -0,0 +1,248 @@
+/**
+@file	 AsyncCppTimerWheel.h
+@brief   A hierarchical timing wheel used by the Cpp application main loop
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-17
+
+This file contains a hierarchical timing wheel that keep track of all active
+timers in the Cpp variant of the async environment. This class should never
+be used directly. It is used by Async::CppApplication.
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_CPP_TIMER_WHEEL_INCLUDED
+#define ASYNC_CPP_TIMER_WHEEL_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <time.h>
+#include <stdint.h>
+
+#include <list>
+#include <unordered_map>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+class Timer;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief  A hierarchical timing wheel for Async::Timer objects
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+This class keep track of the active timers for the Cpp application. The
+timers are sorted into a hierarchy of wheels with a resolution of one
+millisecond in the innermost wheel. Adding and removing a timer are constant
+time operations. Timers in the outer wheels are cascaded inwards as time
+pass. All timers that are due are expired in one call to expire().
+
+It is an internal class that should only be used from within the async
+library.
+*/
+class CppTimerWheel
+{
+  public:
+    /**
+     * @brief   Default constructor
+     */
+    CppTimerWheel(void);
+
+    /**
+     * @brief   Disallow copy construction
+     */
+    CppTimerWheel(const CppTimerWheel&) = delete;
+
+    /**
+     * @brief   Disallow copy assignment
+     */
+    CppTimerWheel& operator=(const CppTimerWheel&) = delete;
+
+    /**
+     * @brief   Destructor
+     */
+    ~CppTimerWheel(void);
+
+    /**
+     * @brief   Add a timer
+     * @param   timer The timer to add
+     *
+     * The timer will expire when its timeout have elapsed, counted from now.
+     */
+    void add(Timer *timer);
+
+    /**
+     * @brief   Remove a timer
+     * @param   timer The timer to remove
+     *
+     * It is safe to remove a timer that is not in the wheel and to remove
+     * timers from within a timer expiration callback.
+     */
+    void remove(Timer *timer);
+
+    /**
+     * @brief   Find out how long it is until the wheel need attention
+     * @param   timeout Set to the time left until expire() should be called
+     * @return  Returns \em false if there are no active timers
+     */
+    bool nextTimeout(struct timespec& timeout);
+
+    /**
+     * @brief   Expire all timers that are due
+     *
+     * All timers that are due when this function is called will be expired
+     * in a single pass. Timers that become due while expiring timers, like
+     * timers added with a zero timeout, will be expired on the next call.
+     */
+    void expire(void);
+
+    /**
+     * @brief   Get the number of active timers
+     * @return  Returns the number of timers in the wheel
+     */
+    size_t size(void) const { return m_timer_map.size(); }
+
+  protected:
+
+  private:
+    static const unsigned TVR_BITS  = 8;
+    static const unsigned TVN_BITS  = 6;
+    static const unsigned TVR_SIZE  = 1 << TVR_BITS;
+    static const unsigned TVN_SIZE  = 1 << TVN_BITS;
+    static const unsigned TVR_MASK  = TVR_SIZE - 1;
+    static const unsigned TVN_MASK  = TVN_SIZE - 1;
+    static const unsigned TVN_CNT   = 4;
+
+    struct Entry;
+    typedef std::list<Entry>                        EntryList;
+    typedef std::unordered_map<Timer*, EntryList::iterator> TimerMap;
+
+    struct Entry
+    {
+      Timer*      timer;
+      uint64_t    expire_ns;
+      uint64_t    tick;
+      EntryList*  list;
+      int         level;
+      unsigned    slot;
+      bool        firing;
+    };
+
+    EntryList   m_tvr[TVR_SIZE];
+    EntryList   m_tvn[TVN_CNT][TVN_SIZE];
+    uint64_t    m_tvr_bitmap[TVR_SIZE / 64];
+    uint64_t    m_tvn_bitmap[TVN_CNT];
+    EntryList   m_expired;
+    EntryList   m_firing;
+    EntryList   m_unused;
+    TimerMap    m_timer_map;
+    uint64_t    m_wheel_tick;
+    size_t      m_wheel_cnt;
+
+    static uint64_t nowNs(void);
+    static unsigned tvnShift(unsigned level)
+    {
+      return TVR_BITS + level * TVN_BITS;
+    }
+    void addAt(Timer *timer, uint64_t expire_ns, bool due);
+    void place(EntryList& src, EntryList::iterator it);
+    void unlink(EntryList::iterator it);
+    void advance(uint64_t now_tick);
+    void cascade(unsigned level, unsigned slot);
+    void moveToExpired(EntryList& src);
+    int findNextTvr(unsigned from) const;
+
+};  /* class CppTimerWheel */
+
+
+} /* namespace Async */
+
+#endif /* ASYNC_CPP_TIMER_WHEEL_INCLUDED */
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,144 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
+
+#include <AsyncAudioFilter.h>
+#include <AsyncAudioSink.h>
+
+// Compare the output and the speed of the different AudioFilter engines for
+// the filters used in the SvxLink receiver and transmitter audio paths. The
+// filter specifications may also be given on the command line.
+
+using namespace Async;
+
+namespace {
+  class Collector : public AudioSink
+  {
+    public:
+      std::vector<float> samples;
+      int writeSamples(const float *s, int count)
+      {
+        samples.insert(samples.end(), s, s + count);
+        return count;
+      }
+      void flushSamples(void) { sourceAllSamplesFlushed(); }
+  };
+
+  const int SAMPLE_RATE = 16000;
+  const int BLOCK_SIZE = 256;
+
+  double runFilter(const std::string& spec, AudioFilter::Engine engine,
+                   const std::vector<float>& in, std::vector<float>& out,
+                   AudioFilter::Engine& used_engine)
+  {
+    AudioFilter filter(spec, SAMPLE_RATE);
+    filter.setEngine(engine);
+    used_engine = filter.engine();
+    Collector collector;
+    collector.samples.reserve(in.size());
+    filter.registerSink(&collector);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t pos=0; pos<in.size(); pos+=BLOCK_SIZE)
+    {
+      filter.writeSamples(&in[pos], BLOCK_SIZE);
+    }
+    auto end = std::chrono::steady_clock::now();
+    filter.unregisterSink();
+    out.swap(collector.samples);
+    return std::chrono::duration<double>(end - start).count();
+  }
+
+  const char *engineName(AudioFilter::Engine engine)
+  {
+    switch (engine)
+    {
+      case AudioFilter::ENGINE_SOS_DOUBLE:
+        return "sos/double";
+      case AudioFilter::ENGINE_SOS_FLOAT:
+        return "sos/float";
+      case AudioFilter::ENGINE_FIDLIB:
+        return "fidlib";
+    }
+    return "?";
+  }
+};
+
+int main(int argc, const char **argv)
+{
+  std::vector<std::string> specs;
+  for (int i=1; i<argc; ++i)
+  {
+    specs.push_back(argv[i]);
+  }
+  if (specs.empty())
+  {
+    specs.push_back("BpCh12/-0.1/300-3500");
+    specs.push_back("LpCh9/-0.05/3500");
+    specs.push_back("LpCh9/-0.05/5500 x HpCh12/-0.05/300");
+    specs.push_back("HpBu4/3500");
+    specs.push_back("BpBu4/5000-5500");
+    specs.push_back("BpBu8/5400-6500");
+    specs.push_back("LpBu3/5500 x HpBu1/3000");
+    specs.push_back("x 0.2 0.2 0.2 0.2 0.2");
+  }
+
+    // 60 seconds of a tone sweep mixed with noise
+  std::vector<float> in(60 * SAMPLE_RATE);
+  double phi = 0.0;
+  for (size_t i=0; i<in.size(); ++i)
+  {
+    double f = 100.0 + 7000.0 * (i % SAMPLE_RATE) / SAMPLE_RATE;
+    phi += 2.0 * M_PI * f / SAMPLE_RATE;
+    in[i] = 0.5 * sin(phi) + 0.2 * (2.0 * rand() / RAND_MAX - 1.0);
+  }
+
+  const AudioFilter::Engine engines[] = {
+    AudioFilter::ENGINE_FIDLIB, AudioFilter::ENGINE_SOS_DOUBLE,
+    AudioFilter::ENGINE_SOS_FLOAT
+  };
+
+  std::cout << std::left << std::setw(40) << "Filter"
+            << std::setw(12) << "Engine" << std::right
+            << std::setw(12) << "Msamples/s"
+            << std::setw(10) << "Speedup"
+            << std::setw(14) << "Max abs diff"
+            << std::endl;
+  for (const auto& spec : specs)
+  {
+    std::vector<float> ref;
+    double ref_time = 0.0;
+    for (AudioFilter::Engine engine : engines)
+    {
+      std::vector<float> out;
+      AudioFilter::Engine used_engine;
+      double t = runFilter(spec, engine, in, out, used_engine);
+      if (engine == AudioFilter::ENGINE_FIDLIB)
+      {
+        ref.swap(out);
+        ref_time = t;
+      }
+      double max_diff = 0.0;
+      if (engine != AudioFilter::ENGINE_FIDLIB)
+      {
+        for (size_t i=0; i<ref.size() && i<out.size(); ++i)
+        {
+          max_diff = std::max(max_diff, double(fabs(ref[i] - out[i])));
+        }
+      }
+      std::cout << std::left << std::setw(40) << spec
+                << std::setw(12) << engineName(used_engine) << std::right
+                << std::setw(12) << std::fixed << std::setprecision(1)
+                << (in.size() / t / 1e6)
+                << std::setw(10) << std::setprecision(2) << (ref_time / t)
+                << std::setw(14) << std::scientific << std::setprecision(2)
+                << max_diff
+                << std::endl;
+    }
+  }
+
+  return 0;
+}
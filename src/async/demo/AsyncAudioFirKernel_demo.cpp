@@ -0,0 +1,80 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <cstdlib>
+#include <chrono>
+
+#include <AsyncAudioFirKernel.h>
+
+// Measure the speed of the FIR kernel implementations available on this CPU
+// for the 48 -> 16 -> 8 kHz rate conversions done in the SvxLink audio paths
+// and for complex decimation like in the Ddr receiver.
+
+using namespace Async;
+
+namespace {
+  const int TAPS = 96;
+  const int BLOCK_SIZE = 480;
+
+  template <typename T, typename Filter>
+  double run(Filter& filter, const std::vector<T>& in, std::vector<T>& out)
+  {
+    auto start = std::chrono::steady_clock::now();
+    size_t out_pos = 0;
+    for (size_t pos=0; pos+BLOCK_SIZE<=in.size(); pos+=BLOCK_SIZE)
+    {
+      out_pos += filter.process(&out[out_pos], &in[pos], BLOCK_SIZE);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return in.size() / std::chrono::duration<double>(end - start).count();
+  }
+};
+
+int main(void)
+{
+  std::vector<float> coeff(TAPS);
+  for (int i=0; i<TAPS; ++i)
+  {
+      // Hann windowed sinc with a cutoff suitable for decimation by three
+    double x = i - (TAPS - 1) / 2.0;
+    double sinc = (x == 0.0) ? 1.0 / 3.0 : sin(M_PI * x / 3.0) / (M_PI * x);
+    coeff[i] = sinc * (0.5 - 0.5 * cos(2.0 * M_PI * i / (TAPS - 1)));
+  }
+
+    // 60 seconds of noise at 48 kHz
+  std::vector<float> in(60 * 48000);
+  std::vector<std::complex<float> > cin(in.size());
+  for (size_t i=0; i<in.size(); ++i)
+  {
+    in[i] = 2.0 * rand() / RAND_MAX - 1.0;
+    cin[i] = std::complex<float>(in[i], 2.0 * rand() / RAND_MAX - 1.0);
+  }
+  std::vector<float> out(3 * in.size());
+  std::vector<std::complex<float> > cplx_out(in.size());
+
+  std::cout << std::left << std::setw(10) << "Kernel" << std::right
+            << std::setw(14) << "dec 48->16"
+            << std::setw(14) << "dec 16->8"
+            << std::setw(14) << "int 16->48"
+            << std::setw(14) << "cdec 48->16"
+            << "   (Msamples/s in)" << std::endl;
+  for (const auto& name : FirKernel::implementations())
+  {
+    FirKernel::setImplementation(name);
+    FirDecimator<float> dec3(3, coeff.data(), TAPS);
+    FirDecimator<float> dec2(2, coeff.data(), TAPS);
+    FirInterpolator<float> int3(3, coeff.data(), TAPS);
+    FirDecimator<std::complex<float> > cdec3(3, coeff.data(), TAPS);
+    std::cout << std::left << std::setw(10) << FirKernel::implementation()
+              << std::right << std::fixed << std::setprecision(1)
+              << std::setw(14) << run(dec3, in, out) / 1e6
+              << std::setw(14) << run(dec2, in, out) / 1e6
+              << std::setw(14) << run(int3, in, out) / 1e6
+              << std::setw(14) << run(cdec3, cin, cplx_out) / 1e6
+              << std::endl;
+  }
+
+  return 0;
+}
@@ -52,6 +52,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncAudioSelector.h>
 #include <AsyncAudioPassthrough.h>
 #include <AsyncAudioFifo.h>
+#include <AsyncAudioAdaptiveJitterFifo.h>
 #include <AsyncAudioDecimator.h>
 #include <AsyncAudioInterpolator.h>
 #include <AsyncAudioDebugger.h>
@@ -271,11 +272,27 @@ QsoImpl::QsoImpl(const StationData &station, ModuleEchoLink *module)
   
   prev_src = &m_qso;
   
-  AudioFifo *input_fifo = new AudioFifo(2048);
-  input_fifo->setOverwrite(true);
-  input_fifo->setPrebufSamples(1024);
-  prev_src->registerSink(input_fifo, true);
-  prev_src = input_fifo;
+  bool adaptive_jitter_buffer = false;
+  cfg.getValue(cfg_name, "ADAPTIVE_JITTER_BUFFER", adaptive_jitter_buffer);
+  if (adaptive_jitter_buffer)
+  {
+    unsigned jitter_buffer_delay = 100;
+    cfg.getValue(cfg_name, "JITTER_BUFFER_DELAY", jitter_buffer_delay);
+    unsigned jitter_buffer_max_delay = 500;
+    cfg.getValue(cfg_name, "JITTER_BUFFER_MAX_DELAY", jitter_buffer_max_delay);
+    AudioAdaptiveJitterFifo *input_fifo = new AudioAdaptiveJitterFifo(8000);
+    input_fifo->setDelayLimits(jitter_buffer_delay, jitter_buffer_max_delay);
+    prev_src->registerSink(input_fifo, true);
+    prev_src = input_fifo;
+  }
+  else
+  {
+    AudioFifo *input_fifo = new AudioFifo(2048);
+    input_fifo->setOverwrite(true);
+    input_fifo->setPrebufSamples(1024);
+    prev_src->registerSink(input_fifo, true);
+    prev_src = input_fifo;
+  }
   
 #if INTERNAL_SAMPLE_RATE == 16000
   AudioInterpolator *up_sampler = new AudioInterpolator(
@@ -0,0 +1,634 @@
+/**
+@file   BenchClient.cpp
+@brief  A simulated reflector client used by the load generator
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sstream>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncSslCertSigningReq.h>
+#include <AsyncSslX509Extensions.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "BenchClient.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+namespace {
+  const char* NODE_INFO_JSON = "{\"sw\":\"svxreflector-bench\"}";
+};
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+BenchClient::BenchClient(const Config& cfg, const std::string& callsign,
+                         bool use_v3, uint32_t tg)
+  : m_cfg(cfg), m_callsign(callsign), m_use_v3(use_v3), m_tg(tg),
+    m_con(cfg.host, cfg.port)
+{
+  m_con.connected.connect(
+      sigc::mem_fun(*this, &BenchClient::onConnected));
+  m_con.disconnected.connect(
+      sigc::mem_fun(*this, &BenchClient::onDisconnected));
+  m_con.frameReceived.connect(
+      sigc::mem_fun(*this, &BenchClient::onFrameReceived));
+  m_con.verifyPeer.connect(
+      sigc::mem_fun(*this, &BenchClient::onVerifyPeer));
+  m_con.sslConnectionReady.connect(
+      sigc::mem_fun(*this, &BenchClient::onSslConnectionReady));
+  m_con.setMaxFrameSize(ReflectorMsg::MAX_POSTAUTH_FRAME_SIZE);
+} /* BenchClient::BenchClient */
+
+
+BenchClient::~BenchClient(void)
+{
+  m_con.disconnect();
+  deleteUdpSockets();
+} /* BenchClient::~BenchClient */
+
+
+void BenchClient::connect(void)
+{
+  m_state = m_use_v3 ? STATE_EXPECT_CA_INFO : STATE_EXPECT_AUTH;
+  m_connect_time = Clock::now();
+  m_con.connect();
+  if (m_use_v3)
+  {
+    m_con.setSslContext(*m_cfg.ssl_ctx);
+  }
+} /* BenchClient::connect */
+
+
+void BenchClient::disconnect(void)
+{
+  m_con.disconnect();
+  deleteUdpSockets();
+  if (m_state != STATE_FAILED)
+  {
+    m_state = STATE_IDLE;
+  }
+} /* BenchClient::disconnect */
+
+
+double BenchClient::loginTime(void) const
+{
+  if (m_state != STATE_READY)
+  {
+    return -1.0;
+  }
+  return std::chrono::duration<double>(m_ready_time - m_connect_time).count();
+} /* BenchClient::loginTime */
+
+
+bool BenchClient::sendAudio(const void* buf, size_t len)
+{
+  if (m_state != STATE_READY)
+  {
+    return false;
+  }
+  return sendUdpMsg(MsgUdpAudio(buf, len));
+} /* BenchClient::sendAudio */
+
+
+void BenchClient::sendFlush(void)
+{
+  if (m_state == STATE_READY)
+  {
+    sendUdpMsg(MsgUdpFlushSamples());
+  }
+} /* BenchClient::sendFlush */
+
+
+void BenchClient::tick(void)
+{
+  if ((m_state == STATE_IDLE) || (m_state == STATE_FAILED) ||
+      !m_con.isConnected())
+  {
+    return;
+  }
+  if (--m_tcp_heartbeat_tx_cnt == 0)
+  {
+    sendMsg(MsgHeartbeat());
+  }
+  if ((m_state == STATE_READY) && (--m_udp_heartbeat_tx_cnt == 0))
+  {
+    sendUdpMsg(MsgUdpHeartbeat());
+  }
+} /* BenchClient::tick */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void BenchClient::onConnected(void)
+{
+  m_tcp_heartbeat_tx_cnt = TCP_HEARTBEAT_TX_CNT_RESET;
+  m_udp_heartbeat_tx_cnt = UDP_HEARTBEAT_TX_CNT_RESET;
+  sendMsg(MsgProtoVer(m_use_v3 ? 3 : 2, 0));
+} /* BenchClient::onConnected */
+
+
+void BenchClient::onDisconnected(TcpConnection*,
+                                 TcpConnection::DisconnectReason reason)
+{
+  if ((m_state != STATE_IDLE) && (m_state != STATE_FAILED))
+  {
+    fail(std::string("Disconnected: ") +
+         TcpConnection::disconnectReasonStr(reason));
+  }
+} /* BenchClient::onDisconnected */
+
+
+bool BenchClient::onVerifyPeer(TcpConnection*, bool, X509_STORE_CTX*)
+{
+    // The load generator is run against a test reflector so the server
+    // certificate is accepted as is
+  return true;
+} /* BenchClient::onVerifyPeer */
+
+
+void BenchClient::onSslConnectionReady(TcpConnection*)
+{
+  if (m_state != STATE_EXPECT_SSL_CON_READY)
+  {
+    fail("Unexpected SSL connection readiness");
+    return;
+  }
+  m_state = STATE_EXPECT_AUTH;
+} /* BenchClient::onSslConnectionReady */
+
+
+void BenchClient::onFrameReceived(FramedTcpConnection*,
+                                  std::vector<uint8_t>& data)
+{
+  Async::MsgBufReader r(data.data(), data.size());
+  ReflectorMsg header;
+  if (!header.unpack(r))
+  {
+    fail("Unpacking failed for TCP message header");
+    return;
+  }
+
+  switch (header.type())
+  {
+    case MsgHeartbeat::TYPE:
+      break;
+
+    case MsgError::TYPE:
+    {
+      MsgError msg;
+      fail(std::string("Error message received: ") +
+           (msg.unpack(r) ? msg.message() : "?"));
+      break;
+    }
+
+    case MsgProtoVerDowngrade::TYPE:
+      fail("The server requested a protocol downgrade");
+      break;
+
+    case MsgCAInfo::TYPE:
+      if (m_state != STATE_EXPECT_CA_INFO)
+      {
+        fail("Unexpected MsgCAInfo");
+        return;
+      }
+      sendMsg(MsgStartEncryptionRequest());
+      m_state = STATE_EXPECT_START_ENCRYPTION;
+      break;
+
+    case MsgStartEncryption::TYPE:
+      if (m_state != STATE_EXPECT_START_ENCRYPTION)
+      {
+        fail("Unexpected MsgStartEncryption");
+        return;
+      }
+      m_state = STATE_EXPECT_SSL_CON_READY;
+      m_con.enableSsl(true);
+      break;
+
+    case MsgClientCsrRequest::TYPE:
+    {
+      if (!m_use_v3 || (m_state != STATE_EXPECT_AUTH))
+      {
+        fail("Unexpected MsgClientCsrRequest");
+        return;
+      }
+        // All clients share the same key pair. The reflector will not find
+        // a certificate for the CSR so it fall back to asking for the
+        // shared key.
+      Async::SslCertSigningReq csr;
+      csr.setVersion(Async::SslCertSigningReq::VERSION_1);
+      csr.addSubjectName("CN", m_callsign);
+      Async::SslX509Extensions csr_exts;
+      csr_exts.addBasicConstraints("critical, CA:FALSE");
+      csr_exts.addKeyUsage(
+          "critical, digitalSignature, keyEncipherment, keyAgreement");
+      csr_exts.addExtKeyUsage("clientAuth");
+      csr.addExtensions(csr_exts);
+      if (!csr.setPublicKey(*m_cfg.keypair) || !csr.sign(*m_cfg.keypair))
+      {
+        fail("Could not create certificate signing request");
+        return;
+      }
+      sendMsg(MsgClientCsr(csr.pem()));
+      break;
+    }
+
+    case MsgClientCert::TYPE:
+      fail("Unexpected client certificate received. Remove the certificate "
+           "for " + m_callsign + " from the reflector CA.");
+      break;
+
+    case MsgAuthChallenge::TYPE:
+    {
+      MsgAuthChallenge msg;
+      if ((m_state != STATE_EXPECT_AUTH) || !msg.unpack(r) ||
+          (msg.challenge() == nullptr))
+      {
+        fail("Unexpected or illegal MsgAuthChallenge");
+        return;
+      }
+      sendMsg(MsgAuthResponse(m_callsign, m_cfg.auth_key, msg.challenge()));
+      break;
+    }
+
+    case MsgAuthOk::TYPE:
+      if (m_state != STATE_EXPECT_AUTH)
+      {
+        fail("Unexpected MsgAuthOk");
+        return;
+      }
+      m_state = STATE_EXPECT_SERVER_INFO;
+      break;
+
+    case MsgServerInfo::TYPE:
+      handleServerInfo(r);
+      break;
+
+    case MsgStartUdpEncryption::TYPE:
+      if (m_state != STATE_EXPECT_START_UDP_ENCRYPTION)
+      {
+        fail("Unexpected MsgStartUdpEncryption");
+        return;
+      }
+      m_state = STATE_EXPECT_UDP_HEARTBEAT;
+      sendUdpMsg(UdpCipher::InitialAAD{m_client_id}, MsgUdpHeartbeat());
+      break;
+
+    default:
+        // Node lists, talker start/stop and other messages are not
+        // interesting to the load generator
+      break;
+  }
+} /* BenchClient::onFrameReceived */
+
+
+void BenchClient::handleServerInfo(Async::MsgBufReader& r)
+{
+  MsgServerInfo msg;
+  if ((m_state != STATE_EXPECT_SERVER_INFO) || !msg.unpack(r))
+  {
+    fail("Unexpected or illegal MsgServerInfo");
+    return;
+  }
+  m_client_id = msg.clientId();
+  if (!setupUdp())
+  {
+    return;
+  }
+
+  if (m_use_v3)
+  {
+    m_state = STATE_EXPECT_START_UDP_ENCRYPTION;
+    sendMsg(MsgNodeInfo(m_udp_cipher_iv_rand, m_enc_udp_sock->cipherKey(),
+                        NODE_INFO_JSON));
+  }
+  else
+  {
+    m_state = STATE_EXPECT_UDP_HEARTBEAT;
+    sendMsg(MsgNodeInfoV2(NODE_INFO_JSON));
+    sendUdpMsg(MsgUdpHeartbeat());
+  }
+} /* BenchClient::handleServerInfo */
+
+
+bool BenchClient::setupUdp(void)
+{
+  deleteUdpSockets();
+  m_udp_tx_cntr = 0;
+
+  if (!m_use_v3)
+  {
+    m_udp_sock = new Async::UdpSocket;
+    if (!m_udp_sock->initOk())
+    {
+      fail("Could not create UDP socket");
+      return false;
+    }
+    m_udp_sock->dataReceived.connect(
+        sigc::mem_fun(*this, &BenchClient::udpDatagramReceived));
+    return true;
+  }
+
+  m_udp_tx_cntr = 1;
+  m_enc_udp_sock = new Async::EncryptedUdpSocket;
+  m_udp_cipher_iv_rand.resize(UdpCipher::IVRANDLEN);
+  const auto cipher = EncryptedUdpSocket::fetchCipher(UdpCipher::NAME);
+  if (!m_enc_udp_sock->initOk() || (cipher == nullptr) ||
+      !m_enc_udp_sock->setCipher(cipher) ||
+      !EncryptedUdpSocket::randomBytes(m_udp_cipher_iv_rand) ||
+      !m_enc_udp_sock->setCipherKey())
+  {
+    fail("Could not create encrypted UDP socket");
+    return false;
+  }
+  m_enc_udp_sock->setCipherAADLength(UdpCipher::AADLEN);
+  m_enc_udp_sock->setTagLength(UdpCipher::TAGLEN);
+  m_enc_udp_sock->cipherDataReceived.connect(
+      sigc::mem_fun(*this, &BenchClient::udpCipherDataReceived));
+  m_enc_udp_sock->dataReceived.connect(
+      sigc::mem_fun(*this, &BenchClient::encUdpDatagramReceived));
+  return true;
+} /* BenchClient::setupUdp */
+
+
+void BenchClient::sendMsg(const ReflectorMsg& msg)
+{
+  if (!m_con.isConnected())
+  {
+    return;
+  }
+
+  m_tcp_heartbeat_tx_cnt = TCP_HEARTBEAT_TX_CNT_RESET;
+
+  ReflectorMsg header(msg.type());
+  std::vector<char> buf(header.packedSize() + msg.packedSize());
+  Async::MsgBufWriter w(buf.data(), buf.size());
+  if (!header.pack(w) || !msg.pack(w))
+  {
+    fail("Failed to pack TCP message");
+    return;
+  }
+  if (m_con.write(buf.data(), w.size()) == -1)
+  {
+    fail("Failed to write TCP message");
+  }
+} /* BenchClient::sendMsg */
+
+
+bool BenchClient::sendUdpMsg(const ReflectorUdpMsg& msg)
+{
+  return sendUdpMsg(UdpCipher::AAD{m_udp_tx_cntr++}, msg);
+} /* BenchClient::sendUdpMsg */
+
+
+bool BenchClient::sendUdpMsg(const UdpCipher::AAD& aad,
+                             const ReflectorUdpMsg& msg)
+{
+  m_udp_heartbeat_tx_cnt = UDP_HEARTBEAT_TX_CNT_RESET;
+
+  if (m_enc_udp_sock != nullptr)
+  {
+    ReflectorUdpMsg header(msg.type());
+    const size_t len = header.packedSize() + msg.packedSize();
+    if (m_udp_tx_buf.size() < len)
+    {
+      m_udp_tx_buf.resize(len);
+    }
+    Async::MsgBufWriter w(m_udp_tx_buf.data(), len);
+    char aad_buf[UdpCipher::InitialAAD::fixedPackedSize()];
+    Async::MsgBufWriter aadw(aad_buf, sizeof(aad_buf));
+    if (!header.pack(w) || !msg.pack(w) || !aad.pack(aadw))
+    {
+      return false;
+    }
+    m_enc_udp_sock->setCipherIV(UdpCipher::IV{m_udp_cipher_iv_rand,
+                                              m_client_id, aad.iv_cntr});
+    return m_enc_udp_sock->write(m_con.remoteHost(), m_con.remotePort(),
+                                 aad_buf, aadw.size(),
+                                 m_udp_tx_buf.data(), w.size());
+  }
+  else if (m_udp_sock != nullptr)
+  {
+    ReflectorUdpMsgV2 header(msg.type(), m_client_id, aad.iv_cntr & 0xffff);
+    const size_t len = header.packedSize() + msg.packedSize();
+    if (m_udp_tx_buf.size() < len)
+    {
+      m_udp_tx_buf.resize(len);
+    }
+    Async::MsgBufWriter w(m_udp_tx_buf.data(), len);
+    if (!header.pack(w) || !msg.pack(w))
+    {
+      return false;
+    }
+    return m_udp_sock->write(m_con.remoteHost(), m_con.remotePort(),
+                             m_udp_tx_buf.data(), w.size());
+  }
+  return false;
+} /* BenchClient::sendUdpMsg */
+
+
+bool BenchClient::udpCipherDataReceived(const IpAddress& addr, uint16_t port,
+                                        void* buf, int count)
+{
+  if ((count < 0) || (static_cast<size_t>(count) < UdpCipher::AADLEN))
+  {
+    return true;
+  }
+  Async::MsgBufReader r(buf, UdpCipher::AADLEN);
+  if (!m_aad.unpack(r))
+  {
+    return true;
+  }
+  m_enc_udp_sock->setCipherIV(UdpCipher::IV{m_udp_cipher_iv_rand, 0,
+                                            m_aad.iv_cntr});
+  return false;
+} /* BenchClient::udpCipherDataReceived */
+
+
+void BenchClient::encUdpDatagramReceived(const IpAddress& addr, uint16_t port,
+                                         void* aad, void* buf, int count)
+{
+  Async::MsgBufReader r(buf, count);
+  ReflectorUdpMsg header;
+  if ((port == m_con.remotePort()) && header.unpack(r))
+  {
+    handleUdpMsg(header.type(), r);
+  }
+} /* BenchClient::encUdpDatagramReceived */
+
+
+void BenchClient::udpDatagramReceived(const IpAddress& addr, uint16_t port,
+                                      void* buf, int count)
+{
+  Async::MsgBufReader r(buf, count);
+  ReflectorUdpMsgV2 header;
+  if ((port == m_con.remotePort()) && header.unpack(r))
+  {
+    handleUdpMsg(header.type(), r);
+  }
+} /* BenchClient::udpDatagramReceived */
+
+
+void BenchClient::handleUdpMsg(uint16_t type, Async::MsgBufReader& r)
+{
+  switch (type)
+  {
+    case MsgUdpHeartbeat::TYPE:
+      if (m_state == STATE_EXPECT_UDP_HEARTBEAT)
+      {
+        m_state = STATE_READY;
+        m_ready_time = Clock::now();
+        sendMsg(MsgSelectTG(m_tg));
+        ready(this);
+      }
+      break;
+
+    case MsgUdpAudio::TYPE:
+    {
+      MsgUdpAudio msg;
+      if ((m_state == STATE_READY) && msg.unpack(r) &&
+          !msg.audioData().empty())
+      {
+        audioReceived(this, msg.audioData().data(), msg.audioData().size());
+      }
+      break;
+    }
+
+    case MsgUdpFlushSamples::TYPE:
+        // A real node answer when all received audio has been played
+      sendUdpMsg(MsgUdpAllSamplesFlushed());
+      break;
+
+    default:
+      break;
+  }
+} /* BenchClient::handleUdpMsg */
+
+
+void BenchClient::fail(const std::string& reason)
+{
+  if (m_state == STATE_FAILED)
+  {
+    return;
+  }
+  m_state = STATE_FAILED;
+  m_con.disconnect();
+  failed(this, reason);
+} /* BenchClient::fail */
+
+
+void BenchClient::deleteUdpSockets(void)
+{
+  delete m_udp_sock;
+  m_udp_sock = nullptr;
+  delete m_enc_udp_sock;
+  m_enc_udp_sock = nullptr;
+} /* BenchClient::deleteUdpSockets */
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,331 @@
+/**
+@file   BenchClient.h
+@brief  A simulated reflector client used by the load generator
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef BENCH_CLIENT_INCLUDED
+#define BENCH_CLIENT_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <sigc++/sigc++.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncTcpClient.h>
+#include <AsyncFramedTcpConnection.h>
+#include <AsyncSslContext.h>
+#include <AsyncSslKeypair.h>
+#include <AsyncUdpSocket.h>
+#include <AsyncEncryptedUdpSocket.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "ReflectorMsg.h"
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief  A simulated reflector client used by the load generator
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+This class implement just enough of the client side of the reflector protocol
+to load a reflector like a real SvxLink node does. Both protocol V2 and V3 are
+supported. A V2 client authenticate using the shared key on a plain TCP
+connection and send unencrypted UDP datagrams. A V3 client switch the TCP
+connection to TLS, send a certificate signing request when asked for it,
+authenticate using the shared key and then register its UDP cipher key and
+send encrypted UDP datagrams, starting with the initial AAD registration.
+
+The server certificate is not verified. The load generator is meant to be used
+against a test reflector, typically over the loopback interface.
+
+When the UDP communication has been verified the client select its talk group
+and emit the ready signal. The audio payload is opaque to the client. It is
+just packed into a MsgUdpAudio message when sent and handed to the
+audioReceived signal when received.
+*/
+class BenchClient : public sigc::trackable
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Settings shared by all clients
+     */
+    struct Config
+    {
+      std::string           host      = "127.0.0.1";
+      uint16_t              port      = 5300;
+      std::string           auth_key;
+      Async::SslContext*    ssl_ctx   = nullptr;
+      Async::SslKeypair*    keypair   = nullptr;
+    };
+
+    /**
+     * @brief   Constructor
+     * @param   cfg       The shared settings, must outlive the client
+     * @param   callsign  The callsign to log in with
+     * @param   use_v3    Set to \em true to use protocol V3 or else V2
+     * @param   tg        The talk group to select when logged in
+     */
+    BenchClient(const Config& cfg, const std::string& callsign, bool use_v3,
+                uint32_t tg);
+
+    /**
+     * @brief   Disallow copy construction
+     */
+    BenchClient(const BenchClient&) = delete;
+
+    /**
+     * @brief   Disallow copy assignment
+     */
+    BenchClient& operator=(const BenchClient&) = delete;
+
+    /**
+     * @brief   Destructor
+     */
+    ~BenchClient(void);
+
+    /**
+     * @brief   Start connecting to the reflector
+     */
+    void connect(void);
+
+    /**
+     * @brief   Disconnect from the reflector
+     */
+    void disconnect(void);
+
+    /**
+     * @brief   Get the callsign of this client
+     * @return  Returns the callsign
+     */
+    const std::string& callsign(void) const { return m_callsign; }
+
+    /**
+     * @brief   Get the talk group of this client
+     * @return  Returns the talk group selected when logged in
+     */
+    uint32_t tg(void) const { return m_tg; }
+
+    /**
+     * @brief   Check if protocol V3 is used
+     * @return  Returns \em true for a V3 client or \em false for a V2 client
+     */
+    bool isV3(void) const { return m_use_v3; }
+
+    /**
+     * @brief   Check if the client is fully logged in
+     * @return  Returns \em true if the client can send and receive audio
+     */
+    bool isReady(void) const { return m_state == STATE_READY; }
+
+    /**
+     * @brief   Check if the client has failed
+     * @return  Returns \em true if the client has been disconnected
+     */
+    bool hasFailed(void) const { return m_state == STATE_FAILED; }
+
+    /**
+     * @brief   Get the time it took to log in
+     * @return  Returns the time from connect until ready, in seconds
+     */
+    double loginTime(void) const;
+
+    /**
+     * @brief   Send one audio frame
+     * @param   buf The audio payload
+     * @param   len The length of the payload
+     * @return  Returns \em true on success or else \em false
+     */
+    bool sendAudio(const void* buf, size_t len);
+
+    /**
+     * @brief   Tell the reflector that the talker has stopped talking
+     */
+    void sendFlush(void);
+
+    /**
+     * @brief   Handle heartbeats, to be called once per second
+     */
+    void tick(void);
+
+    /**
+     * @brief   A signal that is emitted when the client is logged in
+     * @param   client A pointer to this client
+     */
+    sigc::signal<void(BenchClient*)> ready;
+
+    /**
+     * @brief   A signal that is emitted when the client fail
+     * @param   client  A pointer to this client
+     * @param   reason  A description of what went wrong
+     *
+     * The client is disconnected when this signal is emitted. It will not
+     * reconnect by itself.
+     */
+    sigc::signal<void(BenchClient*, const std::string&)> failed;
+
+    /**
+     * @brief   A signal that is emitted when an audio frame is received
+     * @param   client  A pointer to this client
+     * @param   buf     The audio payload
+     * @param   len     The length of the payload
+     */
+    sigc::signal<void(BenchClient*, const uint8_t*, size_t)> audioReceived;
+
+  private:
+    using FramedTcpClient = Async::TcpClient<Async::FramedTcpConnection>;
+
+    enum State
+    {
+      STATE_IDLE, STATE_EXPECT_CA_INFO, STATE_EXPECT_START_ENCRYPTION,
+      STATE_EXPECT_SSL_CON_READY, STATE_EXPECT_AUTH, STATE_EXPECT_SERVER_INFO,
+      STATE_EXPECT_START_UDP_ENCRYPTION, STATE_EXPECT_UDP_HEARTBEAT,
+      STATE_READY, STATE_FAILED
+    };
+
+    static const unsigned TCP_HEARTBEAT_TX_CNT_RESET  = 10;
+    static const unsigned UDP_HEARTBEAT_TX_CNT_RESET  = 15;
+
+    const Config&               m_cfg;
+    const std::string           m_callsign;
+    const bool                  m_use_v3;
+    const uint32_t              m_tg;
+    FramedTcpClient             m_con;
+    State                       m_state                 = STATE_IDLE;
+    Clock::time_point           m_connect_time;
+    Clock::time_point           m_ready_time;
+    ReflectorUdpMsg::ClientId   m_client_id             = 0;
+    Async::UdpSocket*           m_udp_sock              = nullptr;
+    Async::EncryptedUdpSocket*  m_enc_udp_sock          = nullptr;
+    std::vector<uint8_t>        m_udp_cipher_iv_rand;
+    UdpCipher::IVCntr           m_udp_tx_cntr           = 0;
+    UdpCipher::AAD              m_aad;
+    std::vector<uint8_t>        m_udp_tx_buf;
+    unsigned                    m_tcp_heartbeat_tx_cnt  = 0;
+    unsigned                    m_udp_heartbeat_tx_cnt  = 0;
+
+    void onConnected(void);
+    void onDisconnected(Async::TcpConnection* con,
+                        Async::TcpConnection::DisconnectReason reason);
+    bool onVerifyPeer(Async::TcpConnection* con, bool preverify_ok,
+                      X509_STORE_CTX* x509_store_ctx);
+    void onSslConnectionReady(Async::TcpConnection* con);
+    void onFrameReceived(Async::FramedTcpConnection* con,
+                         std::vector<uint8_t>& data);
+    void handleServerInfo(Async::MsgBufReader& r);
+    bool setupUdp(void);
+    void sendMsg(const ReflectorMsg& msg);
+    bool sendUdpMsg(const ReflectorUdpMsg& msg);
+    bool sendUdpMsg(const UdpCipher::AAD& aad, const ReflectorUdpMsg& msg);
+    bool udpCipherDataReceived(const Async::IpAddress& addr, uint16_t port,
+                               void* buf, int count);
+    void encUdpDatagramReceived(const Async::IpAddress& addr, uint16_t port,
+                                void* aad, void* buf, int count);
+    void udpDatagramReceived(const Async::IpAddress& addr, uint16_t port,
+                             void* buf, int count);
+    void handleUdpMsg(uint16_t type, Async::MsgBufReader& r);
+    void fail(const std::string& reason);
+    void deleteUdpSockets(void);
+
+};  /* class BenchClient */
+
+
+//} /* namespace */
+
+#endif /* BENCH_CLIENT_INCLUDED */
+
+/*
+ * This file has not been truncated
+ */
@@ -33,6 +33,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <cassert>
 #include <unistd.h>
 #include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <iterator>
 #include <regex>
@@ -53,6 +54,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncEncryptedUdpSocket.h>
 #include <AsyncApplication.h>
 #include <AsyncPty.h>
+#include <AsyncLoopProfiler.h>
+#include <AsyncAudioEncoder.h>
+#include <AsyncAudioDecoder.h>
 
 #include <common.h>
 #include <config.h>
@@ -67,6 +71,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Reflector.h"
 #include "ReflectorClient.h"
 #include "TGHandler.h"
+#include "UdpSealer.h"
 
 
 /****************************************************************************
@@ -174,6 +179,19 @@ namespace {
     timer.setExpireOffset(10000);
     timer.start();
   } /* startCertRenewTimer */
+
+
+  Json::Value histogramToJson(const Async::LoopProfiler::Histogram& hist)
+  {
+    Json::Value obj(Json::objectValue);
+    obj["count"] = Json::UInt64(hist.count());
+    obj["avg_us"] = hist.avgNs() / 1000.0;
+    obj["p50_us"] = hist.percentileNs(50) / 1000.0;
+    obj["p99_us"] = hist.percentileNs(99) / 1000.0;
+    obj["max_us"] = hist.maxNs() / 1000.0;
+    obj["total_ms"] = hist.totalNs() / 1.0e6;
+    return obj;
+  } /* histogramToJson */
 };
 
 
@@ -229,10 +247,13 @@ time_t Reflector::timeToRenewCert(const Async::SslX509& cert)
  ****************************************************************************/
 
 Reflector::Reflector(void)
-  : m_srv(0), m_udp_sock(0), m_tg_for_v1_clients(1), m_random_qsy_lo(0),
-    m_random_qsy_hi(0), m_random_qsy_tg(0), m_http_server(0), m_cmd_pty(0),
+  : m_srv(0), m_udp_sock(0), m_udp_cipher(0), m_udp_workers(0),
+    m_tg_for_v1_clients(1),
+    m_random_qsy_lo(0), m_random_qsy_hi(0), m_random_qsy_tg(0),
+    m_http_server(0), m_cmd_pty(0),
     m_keys_dir("private/"), m_pending_csrs_dir("pending_csrs/"),
-    m_csrs_dir("csrs/"), m_certs_dir("certs/"), m_pki_dir("pki/")
+    m_csrs_dir("csrs/"), m_certs_dir("certs/"), m_pki_dir("pki/"),
+    m_status_event_timer(STATUS_EVENT_INTERVAL_MS, Timer::TYPE_PERIODIC, false)
 {
   TGHandler::instance()->talkerUpdated.connect(
       mem_fun(*this, &Reflector::onTalkerUpdated));
@@ -256,7 +277,9 @@ Reflector::Reflector(void)
                     << std::endl;
         }
       });
-  m_status["nodes"] = Json::Value(Json::objectValue);
+  m_status_event_timer.setTag("Reflector::statusEvents");
+  m_status_event_timer.expired.connect(sigc::hide(
+      sigc::mem_fun(*this, &Reflector::flushStatusEvents)));
 } /* Reflector::Reflector */
 
 
@@ -264,6 +287,8 @@ Reflector::~Reflector(void)
 {
   delete m_http_server;
   m_http_server = 0;
+  delete m_udp_workers;
+  m_udp_workers = 0;
   delete m_udp_sock;
   m_udp_sock = 0;
   delete m_srv;
@@ -289,6 +314,7 @@ bool Reflector::initialize(Async::Config &cfg)
       mem_fun(*this, &Reflector::clientConnected));
   m_srv->clientDisconnected.connect(
       mem_fun(*this, &Reflector::clientDisconnected));
+  cfg.getValue("GLOBAL", "TCP_SEND_QUEUE_SIZE", m_tcp_send_queue_size);
 
   if (!loadCertificateFiles())
   {
@@ -309,12 +335,52 @@ bool Reflector::initialize(Async::Config &cfg)
               << err << std::endl;
     return false;
   }
+  m_udp_cipher = EncryptedUdpSocket::fetchCipher(UdpCipher::NAME);
   m_udp_sock->setCipherAADLength(UdpCipher::AADLEN);
   m_udp_sock->setTagLength(UdpCipher::TAGLEN);
   m_udp_sock->cipherDataReceived.connect(
       mem_fun(*this, &Reflector::udpCipherDataReceived));
   m_udp_sock->dataReceived.connect(
       mem_fun(*this, &Reflector::udpDatagramReceived));
+  unsigned udp_recv_batch_size = 32;
+  cfg.getValue("GLOBAL", "UDP_RECV_BATCH_SIZE", udp_recv_batch_size);
+  m_udp_sock->setRecvBatchSize(udp_recv_batch_size);
+  size_t udp_send_queue_size = 256;
+  cfg.getValue("GLOBAL", "UDP_SEND_QUEUE_SIZE", udp_send_queue_size);
+  m_udp_sock->setSendQueueDepth(udp_send_queue_size);
+  std::string udp_drop_policy_str("OLDEST");
+  cfg.getValue("GLOBAL", "UDP_SEND_QUEUE_DROP_POLICY", udp_drop_policy_str);
+  Async::UdpSocket::SendQueueDropPolicy udp_drop_policy =
+    Async::UdpSocket::SEND_QUEUE_DROP_OLDEST;
+  if (udp_drop_policy_str == "NEWEST")
+  {
+    udp_drop_policy = Async::UdpSocket::SEND_QUEUE_DROP_NEWEST;
+  }
+  else if (udp_drop_policy_str != "OLDEST")
+  {
+    std::cerr << "*** ERROR: Illegal value \"" << udp_drop_policy_str
+              << "\" for configuration variable "
+                 "GLOBAL/UDP_SEND_QUEUE_DROP_POLICY. Valid values are "
+                 "OLDEST and NEWEST." << std::endl;
+    return false;
+  }
+  m_udp_sock->setSendQueueDropPolicy(udp_drop_policy);
+  unsigned udp_worker_threads = 0;
+  cfg.getValue("GLOBAL", "UDP_WORKER_THREADS", udp_worker_threads);
+  if (udp_worker_threads > 0)
+  {
+    m_udp_workers = new UdpWorkerPool;
+    if (!m_udp_workers->initialize(m_udp_sock->fd(), UdpCipher::NAME,
+                                   udp_worker_threads, udp_send_queue_size,
+                                   udp_drop_policy))
+    {
+      std::cerr << "*** ERROR: Could not start the UDP worker threads"
+                << std::endl;
+      return false;
+    }
+    std::cout << "Using " << udp_worker_threads
+              << " worker threads for sending UDP datagrams" << std::endl;
+  }
 
   unsigned sql_timeout = 0;
   cfg.getValue("GLOBAL", "SQL_TIMEOUT", sql_timeout);
@@ -370,6 +436,19 @@ bool Reflector::initialize(Async::Config &cfg)
 
   m_cfg->getValue("GLOBAL", "ACCEPT_CERT_EMAIL", m_accept_cert_email);
 
+  m_codecs_cfg.attach(*m_cfg, "GLOBAL", "CODECS");
+  m_codecs_cfg.valueChanged.connect(sigc::hide(
+      sigc::mem_fun(*this, &Reflector::updateSupportedCodecs)));
+  updateSupportedCodecs();
+
+  m_accept_callsign_cfg.attach(*m_cfg, "GLOBAL", "ACCEPT_CALLSIGN");
+  m_accept_callsign_cfg.valueChanged.connect(sigc::hide(
+      sigc::mem_fun(*this, &Reflector::updateCallsignRegex)));
+  m_reject_callsign_cfg.attach(*m_cfg, "GLOBAL", "REJECT_CALLSIGN");
+  m_reject_callsign_cfg.valueChanged.connect(sigc::hide(
+      sigc::mem_fun(*this, &Reflector::updateCallsignRegex)));
+  updateCallsignRegex();
+
   m_cfg->valueUpdated.connect(sigc::mem_fun(*this, &Reflector::cfgUpdated));
 
   return true;
@@ -393,59 +472,216 @@ void Reflector::nodeList(std::vector<std::string>& nodes) const
 void Reflector::broadcastMsg(const ReflectorMsg& msg,
                              const ReflectorClient::Filter& filter)
 {
-  for (const auto& item : m_client_con_map)
-  {
-    ReflectorClient *client = item.second;
+    // Pack the message once and share the frame between all clients
+  Async::FramedTcpConnection::Frame frame;
+  auto it = m_client_con_map.begin();
+  while (it != m_client_con_map.end())
+  {
+      // A failed send will disconnect the client, which remove it from the
+      // map, so step the iterator before sending
+    ReflectorClient *client = it->second;
+    ++it;
     if (filter(client) &&
         (client->conState() == ReflectorClient::STATE_CONNECTED))
     {
-      client->sendMsg(msg);
+      if (!frame.isValid())
+      {
+        frame = ReflectorClient::packMsg(msg);
+      }
+      client->sendMsg(msg.type(), frame);
     }
   }
 } /* Reflector::broadcastMsg */
 
 
+void Reflector::broadcastMsgToTG(uint32_t tg, const ReflectorMsg& msg,
+                                 const ReflectorClient::Filter& filter,
+                                 bool include_monitoring)
+{
+    // A failed send will disconnect the client, which modify the listener
+    // lists, so work on a copy. Clients that both have selected and monitor
+    // the TG must only get the message once.
+  const TGHandler* tg_handler = TGHandler::instance();
+  TGHandler::ClientList clients(tg_handler->selectedClientsForTG(tg));
+  if (include_monitoring)
+  {
+    const auto& monitoring = tg_handler->monitoringClientsForTG(tg);
+    clients.insert(clients.end(), monitoring.begin(), monitoring.end());
+    std::sort(clients.begin(), clients.end());
+    clients.erase(std::unique(clients.begin(), clients.end()), clients.end());
+  }
+
+  Async::FramedTcpConnection::Frame frame;
+  for (ReflectorClient* client : clients)
+  {
+    if (filter(client) &&
+        (client->conState() == ReflectorClient::STATE_CONNECTED))
+    {
+      if (!frame.isValid())
+      {
+        frame = ReflectorClient::packMsg(msg);
+      }
+      client->sendMsg(msg.type(), frame);
+    }
+  }
+} /* Reflector::broadcastMsgToTG */
+
+
 bool Reflector::sendUdpDatagram(ReflectorClient *client,
     const ReflectorUdpMsg& msg)
 {
   auto udp_addr = client->remoteUdpHost();
   auto udp_port = client->remoteUdpPort();
-  if (client->protoVer() >= ProtoVer(3, 0))
+  if ((client->protoVer() >= ProtoVer(3, 0)) && (m_udp_workers != 0))
   {
-    ReflectorUdpMsg header(msg.type());
-    ostringstream ss;
-    assert(header.pack(ss) && msg.pack(ss));
+      // Hand the datagram over to a worker thread for encryption and
+      // sending. During a broadcast the payload is only packed once.
+    UdpWorkerPool::PayloadPtr payload = udpPayload(msg);
+    if (payload == nullptr)
+    {
+      std::cout << "*** WARNING: Packing message failed for UDP "
+                   "datagram to " << udp_addr << ":" << udp_port << std::endl;
+      return false;
+    }
+    bool success = m_udp_workers->queueDatagram(payload, client->clientId(),
+        udp_addr, udp_port, client->udpCipherIVRand(),
+        client->udpCipherKey(), client->udpCipherIVCntrNext());
+    if (!m_udp_bcast)
+    {
+      m_udp_workers->flush();
+    }
+    if (!success)
+    {
+      std::cout << "*** WARNING: Could not queue UDP datagram to "
+                << udp_addr << ":" << udp_port << std::endl;
+    }
+    return success;
+  }
+  else if (client->protoVer() >= ProtoVer(3, 0))
+  {
+      // The plaintext is only packed once during a broadcast. For each
+      // client only the IV is set up, in the pre-keyed cipher context of the
+      // client, and the datagram is sealed into a reused buffer.
+    UdpWorkerPool::PayloadPtr payload = udpPayload(msg);
+    if (payload == nullptr)
+    {
+      std::cout << "*** WARNING: Packing message failed for UDP "
+                   "datagram to " << udp_addr << ":" << udp_port << std::endl;
+      return false;
+    }
 
-    m_udp_sock->setCipherIV(client->udpCipherIV());
-    m_udp_sock->setCipherKey(client->udpCipherKey());
-    UdpCipher::AAD aad{client->udpCipherIVCntrNext()};
-    std::stringstream aadss;
-    if (!aad.pack(aadss))
+    UdpSealer& sealer = client->udpSealer();
+    const auto& key = client->udpCipherKey();
+    if (!sealer.setKey(m_udp_cipher, key.data(), key.size()))
+    {
+      std::cout << "*** WARNING: Could not set up the cipher for UDP "
+                   "datagram to " << udp_addr << ":" << udp_port << std::endl;
+      return false;
+    }
+    uint8_t iv_rand[UdpCipher::IVRANDLEN] = {0};
+    const auto& client_iv_rand = client->udpCipherIVRand();
+    std::copy_n(client_iv_rand.begin(),
+                std::min(client_iv_rand.size(), sizeof(iv_rand)), iv_rand);
+
+    const size_t max_len = UdpSealer::maxSealedSize(payload->size());
+    if (m_udp_tx_buf.size() < max_len)
     {
-      std::cout << "*** WARNING: Packing associated data failed for UDP "
+      m_udp_tx_buf.resize(max_len);
+    }
+    int len = sealer.seal(iv_rand, client->udpCipherIVCntrNext(),
+        payload->data(), payload->size(),
+        reinterpret_cast<uint8_t*>(m_udp_tx_buf.data()));
+    if (len < 0)
+    {
+      std::cout << "*** WARNING: Encryption failed for UDP "
                    "datagram to " << udp_addr << ":" << udp_port << std::endl;
       return false;
     }
-    return m_udp_sock->write(udp_addr, udp_port,
-                             aadss.str().data(), aadss.str().size(),
-                             ss.str().data(), ss.str().size());
+    return m_udp_sock->UdpSocket::write(udp_addr, udp_port,
+                                        m_udp_tx_buf.data(), len);
   }
   else
   {
     ReflectorUdpMsgV2 header(msg.type(), client->clientId(),
         client->udpCipherIVCntrNext() & 0xffff);
-    ostringstream ss;
-    assert(header.pack(ss) && msg.pack(ss));
+    const size_t len = header.packedSize() + msg.packedSize();
+    if (m_udp_tx_buf.size() < len)
+    {
+      m_udp_tx_buf.resize(len);
+    }
+    Async::MsgBufWriter w(m_udp_tx_buf.data(), len);
+    if (!header.pack(w) || !msg.pack(w))
+    {
+      std::cout << "*** WARNING: Packing message failed for UDP "
+                   "datagram to " << udp_addr << ":" << udp_port << std::endl;
+      return false;
+    }
     return m_udp_sock->UdpSocket::write(
-        udp_addr, udp_port,
-        ss.str().data(), ss.str().size());
+        udp_addr, udp_port, m_udp_tx_buf.data(), w.size());
   }
 } /* Reflector::sendUdpDatagram */
 
 
+UdpWorkerPool::PayloadPtr Reflector::udpPayload(const ReflectorUdpMsg& msg)
+{
+    // During a broadcast the payload is packed when the first V3 client is
+    // found and is then shared by all V3 recipients. V1 and V2 clients use
+    // their own header so they never need the shared payload.
+  if (m_udp_bcast_payload != nullptr)
+  {
+    return m_udp_bcast_payload;
+  }
+  UdpWorkerPool::PayloadPtr payload = packUdpPayload(msg);
+  if (m_udp_bcast)
+  {
+    m_udp_bcast_payload = payload;
+  }
+  return payload;
+} /* Reflector::udpPayload */
+
+
+UdpWorkerPool::PayloadPtr Reflector::packUdpPayload(const ReflectorUdpMsg& msg)
+{
+    // Reuse a payload buffer that no worker thread is holding on to anymore.
+    // The acquire fence pair with the release done by the worker when it
+    // drop its reference so that its reads of the old content are done.
+  std::shared_ptr<UdpWorkerPool::Payload> payload;
+  for (const auto& buf : m_udp_payload_bufs)
+  {
+    if (buf.use_count() == 1)
+    {
+      std::atomic_thread_fence(std::memory_order_acquire);
+      payload = buf;
+      break;
+    }
+  }
+  if (payload == nullptr)
+  {
+    payload = std::make_shared<UdpWorkerPool::Payload>();
+    if (m_udp_payload_bufs.size() < UDP_PAYLOAD_BUF_CNT)
+    {
+      m_udp_payload_bufs.push_back(payload);
+    }
+  }
+
+  ReflectorUdpMsg header(msg.type());
+  payload->resize(header.packedSize() + msg.packedSize());
+  Async::MsgBufWriter w(payload->data(), payload->size());
+  if (!header.pack(w) || !msg.pack(w))
+  {
+    return nullptr;
+  }
+  return payload;
+} /* Reflector::packUdpPayload */
+
+
 void Reflector::broadcastUdpMsg(const ReflectorUdpMsg& msg,
                                 const ReflectorClient::Filter& filter)
 {
+    // Queue up all datagrams so that they are sent using as few system calls
+    // as possible
+  m_udp_sock->beginWriteBatch();
+  m_udp_bcast = true;
   for (const auto& item : m_client_con_map)
   {
     ReflectorClient *client = item.second;
@@ -455,9 +691,45 @@ void Reflector::broadcastUdpMsg(const ReflectorUdpMsg& msg,
       client->sendUdpMsg(msg);
     }
   }
+  m_udp_sock->flushWriteBatch();
+  m_udp_bcast = false;
+  m_udp_bcast_payload = nullptr;
+  if (m_udp_workers != 0)
+  {
+    m_udp_workers->flush();
+  }
 } /* Reflector::broadcastUdpMsg */
 
 
+void Reflector::broadcastUdpMsgToTG(uint32_t tg, const ReflectorUdpMsg& msg,
+                                    const ReflectorClient::Filter& filter)
+{
+  const auto& clients = TGHandler::instance()->selectedClientsForTG(tg);
+  if (clients.empty())
+  {
+    return;
+  }
+
+  m_udp_sock->beginWriteBatch();
+  m_udp_bcast = true;
+  for (ReflectorClient* client : clients)
+  {
+    if (filter(client) &&
+        (client->conState() == ReflectorClient::STATE_CONNECTED))
+    {
+      client->sendUdpMsg(msg);
+    }
+  }
+  m_udp_sock->flushWriteBatch();
+  m_udp_bcast = false;
+  m_udp_bcast_payload = nullptr;
+  if (m_udp_workers != 0)
+  {
+    m_udp_workers->flush();
+  }
+} /* Reflector::broadcastUdpMsgToTG */
+
+
 void Reflector::requestQsy(ReflectorClient *client, uint32_t tg)
 {
   uint32_t current_tg = TGHandler::instance()->TGForClient(client);
@@ -477,10 +749,7 @@ void Reflector::requestQsy(ReflectorClient *client, uint32_t tg)
   cout << client->callsign() << ": Requesting QSY from TG #"
        << current_tg << " to TG #" << tg << endl;
 
-  broadcastMsg(MsgRequestQsy(tg),
-      ReflectorClient::mkAndFilter(
-        ge_v2_client_filter,
-        ReflectorClient::TgFilter(current_tg)));
+  broadcastMsgToTG(current_tg, MsgRequestQsy(tg), ge_v2_client_filter);
 } /* Reflector::requestQsy */
 
 
@@ -661,16 +930,21 @@ bool Reflector::callsignOk(const std::string& callsign, bool verbose) const
     return false;
   }
 
-    // Accept check
-  std::string accept_cs_re_str;
-  if (!m_cfg->getValue("GLOBAL", "ACCEPT_CALLSIGN", accept_cs_re_str) ||
-      accept_cs_re_str.empty())
+    // The regular expressions are compiled when the configuration is
+    // read or updated. Reject all callsigns if any of them is invalid.
+  if (!m_callsign_re_ok)
   {
-    accept_cs_re_str =
-      "[A-Z0-9][A-Z]{0,2}\\d[A-Z0-9]{0,3}[A-Z](?:-[A-Z0-9]{1,3})?";
+    if (verbose)
+    {
+      std::cerr << "*** WARNING: The callsign '" << callsign
+                << "' rejected due to an invalid ACCEPT_CALLSIGN or "
+                   "REJECT_CALLSIGN configuration" << std::endl;
+    }
+    return false;
   }
-  const std::regex accept_callsign_re(accept_cs_re_str);
-  if (!std::regex_match(callsign, accept_callsign_re))
+
+    // Accept check
+  if (!std::regex_match(callsign, m_accept_callsign_re))
   {
     if (verbose)
     {
@@ -682,12 +956,9 @@ bool Reflector::callsignOk(const std::string& callsign, bool verbose) const
   }
 
     // Reject check
-  std::string reject_cs_re_str;
-  m_cfg->getValue("GLOBAL", "REJECT_CALLSIGN", reject_cs_re_str);
-  if (!reject_cs_re_str.empty())
+  if (!m_reject_callsign_cfg->empty())
   {
-    const std::regex reject_callsign_re(reject_cs_re_str);
-    if (std::regex_match(callsign, reject_callsign_re))
+    if (std::regex_match(callsign, m_reject_callsign_re))
     {
       if (verbose)
       {
@@ -832,14 +1103,76 @@ Async::SslX509 Reflector::csrReceived(Async::SslCertSigningReq& req)
 } /* Reflector::csrReceived */
 
 
-Json::Value& Reflector::clientStatus(const std::string& callsign)
+std::string Reflector::jsonString(const Json::Value& val)
+{
+  static std::unique_ptr<Json::StreamWriter> writer;
+  if (writer == nullptr)
+  {
+    Json::StreamWriterBuilder builder;
+    builder["commentStyle"] = "None";
+    builder["indentation"] = ""; //The JSON document is written on a single line
+    writer.reset(builder.newStreamWriter());
+  }
+  std::ostringstream os;
+  writer->write(val, &os);
+  return os.str();
+} /* Reflector::jsonString */
+
+
+void Reflector::nodeInfoUpdated(ReflectorClient* client)
+{
+  m_status_gen += 1;
+  bool is_new =
+    (m_status_nodes.find(client->callsign()) == m_status_nodes.end());
+  m_status_nodes[client->callsign()] = client;
+  m_pending_rx_events.erase(client->callsign());
+  if (!m_status_event_clients.empty())
+  {
+    Json::Value data(Json::objectValue);
+    data["callsign"] = client->callsign();
+    data["status"] = client->status();
+    sendStatusEvent(is_new ? "node_join" : "node_update", data);
+  }
+} /* Reflector::nodeInfoUpdated */
+
+
+void Reflector::nodeTgStatusUpdated(ReflectorClient* client)
+{
+  m_status_gen += 1;
+  if (!m_status_event_clients.empty())
+  {
+    Json::Value data(client->tgStatus());
+    data["callsign"] = client->callsign();
+    sendStatusEvent("node_update", data);
+  }
+} /* Reflector::nodeTgStatusUpdated */
+
+
+void Reflector::nodeRxStatusUpdated(ReflectorClient* client, char rx_id)
 {
-  if (!m_status.isMember(callsign))
+  m_status_gen += 1;
+  if (!m_status_event_clients.empty())
   {
-    m_status["nodes"][callsign] = Json::Value(Json::objectValue);
+      // Signal levels may be updated many times per second so the events
+      // are coalesced and sent by the status event timer
+    m_pending_rx_events[client->callsign()].insert(rx_id);
   }
-  return m_status["nodes"][callsign];
-} /* Reflector::clientStatus */
+} /* Reflector::nodeRxStatusUpdated */
+
+
+void Reflector::nodeTxStatusUpdated(ReflectorClient* client, char tx_id,
+                                    bool transmit)
+{
+  m_status_gen += 1;
+  if (!m_status_event_clients.empty())
+  {
+    Json::Value data(Json::objectValue);
+    data["callsign"] = client->callsign();
+    data["id"] = std::string(1, tx_id);
+    data["transmit"] = transmit;
+    sendStatusEvent("tx", data);
+  }
+} /* Reflector::nodeTxStatusUpdated */
 
 
 /****************************************************************************
@@ -860,6 +1193,7 @@ void Reflector::clientConnected(Async::FramedTcpConnection *con)
 {
   std::cout << con->remoteHost() << ":" << con->remotePort()
        << ": Client connected" << endl;
+  con->setMaxTxQueueSize(m_tcp_send_queue_size);
   ReflectorClient *client = new ReflectorClient(this, con, m_cfg);
   con->verifyPeer.connect(sigc::mem_fun(*this, &Reflector::onVerifyPeer));
   m_client_con_map[con] = client;
@@ -888,9 +1222,26 @@ void Reflector::clientDisconnected(Async::FramedTcpConnection *con,
 
   m_client_con_map.erase(it);
 
+  if (m_udp_workers != 0)
+  {
+    m_udp_workers->forgetClient(client->clientId());
+  }
+
   if (!client->callsign().empty())
   {
-    m_status["nodes"].removeMember(client->callsign());
+    auto node_it = m_status_nodes.find(client->callsign());
+    if ((node_it != m_status_nodes.end()) && (node_it->second == client))
+    {
+      m_status_nodes.erase(node_it);
+      m_pending_rx_events.erase(client->callsign());
+      m_status_gen += 1;
+      if (!m_status_event_clients.empty())
+      {
+        Json::Value data(Json::objectValue);
+        data["callsign"] = client->callsign();
+        sendStatusEvent("node_leave", data);
+      }
+    }
     broadcastMsg(MsgNodeLeft(client->callsign()),
         ReflectorClient::ExceptFilter(client));
   }
@@ -908,9 +1259,11 @@ bool Reflector::udpCipherDataReceived(const IpAddress& addr, uint16_t port,
     return true;
   }
 
-  stringstream ss;
-  ss.write(reinterpret_cast<const char *>(buf), UdpCipher::AADLEN);
-  assert(m_aad.unpack(ss));
+  Async::MsgBufReader r(buf, count);
+  if (!m_aad.unpack(r))
+  {
+    return true;
+  }
 
   ReflectorClient* client = nullptr;
   if (m_aad.iv_cntr == 0)
@@ -924,11 +1277,7 @@ bool Reflector::udpCipherDataReceived(const IpAddress& addr, uint16_t port,
                    "Ignoring malformed UDP registration datagram" << std::endl;
       return true;
     }
-    ss.clear();
-    ss.write(reinterpret_cast<const char *>(buf)+UdpCipher::AADLEN,
-        sizeof(UdpCipher::ClientId));
-
-    Async::MsgPacker<UdpCipher::ClientId>::unpack(ss, iaad.client_id);
+    Async::MsgPacker<UdpCipher::ClientId>::unpack(r, iaad.client_id);
     //std::cout << "### Reflector::udpCipherDataReceived: client_id="
     //          << iaad.client_id << std::endl;
     auto client = ReflectorClient::lookup(iaad.client_id);
@@ -986,11 +1335,10 @@ void Reflector::udpDatagramReceived(const IpAddress& addr, uint16_t port,
 
   assert(m_udp_sock->cipherAADLength() >= UdpCipher::AADLEN);
 
-  stringstream ss;
-  ss.write(reinterpret_cast<const char *>(buf), static_cast<size_t>(count));
+  Async::MsgBufReader r(buf, count);
 
   ReflectorUdpMsg header;
-  if (!header.unpack(ss))
+  if (!header.unpack(r))
   {
     cout << "*** WARNING: Unpacking message header failed for UDP datagram "
             "from " << addr << ":" << port << endl;
@@ -1005,19 +1353,16 @@ void Reflector::udpDatagramReceived(const IpAddress& addr, uint16_t port,
     //std::cout << "### Reflector::udpDatagramReceived: m_aad.iv_cntr="
     //          << m_aad.iv_cntr << std::endl;
 
-    stringstream aadss;
-    aadss.write(reinterpret_cast<const char *>(aadptr),
-        m_udp_sock->cipherAADLength());
-
-    if (!aad.unpack(aadss))
+    Async::MsgBufReader aadr(aadptr, m_udp_sock->cipherAADLength());
+    if (!aad.unpack(aadr))
     {
       return;
     }
     if (aad.iv_cntr == 0) // Client UDP registration
     {
       UdpCipher::InitialAAD iaad;
-      assert(aadss.seekg(0));
-      if (!iaad.unpack(aadss))
+      aadr = Async::MsgBufReader(aadptr, m_udp_sock->cipherAADLength());
+      if (!iaad.unpack(aadr))
       {
         std::cout << "### Reflector::udpDatagramReceived: "
                      "Could not unpack iaad" << std::endl;
@@ -1057,8 +1402,8 @@ void Reflector::udpDatagramReceived(const IpAddress& addr, uint16_t port,
   }
   else
   {
-    ss.seekg(0);
-    if (!header_v2.unpack(ss))
+    r = Async::MsgBufReader(buf, count);
+    if (!header_v2.unpack(r))
     {
       std::cout << "*** WARNING: Unpacking V2 message header failed for UDP "
               "datagram from " << addr << ":" << port << std::endl;
@@ -1163,7 +1508,7 @@ void Reflector::udpDatagramReceived(const IpAddress& addr, uint16_t port,
       if (!client->isBlocked())
       {
         MsgUdpAudio msg;
-        if (!msg.unpack(ss))
+        if (!msg.unpack(r))
         {
           cerr << "*** WARNING[" << client->callsign()
                << "]: Could not unpack incoming MsgUdpAudioV1 message" << endl;
@@ -1181,10 +1526,8 @@ void Reflector::udpDatagramReceived(const IpAddress& addr, uint16_t port,
           if (talker == client)
           {
             TGHandler::instance()->setTalkerForTG(tg, client);
-            broadcastUdpMsg(msg,
-                ReflectorClient::mkAndFilter(
-                  ReflectorClient::ExceptFilter(client),
-                  ReflectorClient::TgFilter(tg)));
+            broadcastUdpMsgToTG(tg, msg,
+                ReflectorClient::ExceptFilter(client));
             //broadcastUdpMsgExcept(tg, client, msg,
             //    ProtoVerRange(ProtoVer(0, 6),
             //                  ProtoVer(1, ProtoVer::max().minor())));
@@ -1257,7 +1600,7 @@ void Reflector::udpDatagramReceived(const IpAddress& addr, uint16_t port,
       if (!client->isBlocked())
       {
         MsgUdpSignalStrengthValues msg;
-        if (!msg.unpack(ss))
+        if (!msg.unpack(r))
         {
           cerr << "*** WARNING[" << client->callsign()
                << "]: Could not unpack incoming "
@@ -1275,10 +1618,7 @@ void Reflector::udpDatagramReceived(const IpAddress& addr, uint16_t port,
           //  << " sql_open=" << rx.sqlOpen()
           //  << " active=" << rx.active()
           //  << std::endl;
-          client->setRxSiglev(rx.id(), rx.siglev());
-          client->setRxEnabled(rx.id(), rx.enabled());
-          client->setRxSqlOpen(rx.id(), rx.sqlOpen());
-          client->setRxActive(rx.id(), rx.active());
+          client->setRxStatus(rx);
         }
       }
       break;
@@ -1303,31 +1643,35 @@ void Reflector::onTalkerUpdated(uint32_t tg, ReflectorClient* old_talker,
   {
     cout << old_talker->callsign() << ": Talker stop on TG #" << tg << endl;
     old_talker->updateIsTalker();
-    broadcastMsg(MsgTalkerStop(tg, old_talker->callsign()),
-        ReflectorClient::mkAndFilter(
-          ge_v2_client_filter,
-          ReflectorClient::mkOrFilter(
-            ReflectorClient::TgFilter(tg),
-            ReflectorClient::TgMonitorFilter(tg))));
+    if (!m_status_event_clients.empty() && old_talker->hasStatus())
+    {
+      Json::Value data(Json::objectValue);
+      data["tg"] = tg;
+      data["callsign"] = old_talker->callsign();
+      sendStatusEvent("talker_stop", data);
+    }
+    broadcastMsgToTG(tg, MsgTalkerStop(tg, old_talker->callsign()),
+        ge_v2_client_filter, true);
     if (tg == tgForV1Clients())
     {
       broadcastMsg(MsgTalkerStopV1(old_talker->callsign()), v1_client_filter);
     }
-    broadcastUdpMsg(MsgUdpFlushSamples(),
-          ReflectorClient::mkAndFilter(
-            ReflectorClient::TgFilter(tg),
-            ReflectorClient::ExceptFilter(old_talker)));
+    broadcastUdpMsgToTG(tg, MsgUdpFlushSamples(),
+          ReflectorClient::ExceptFilter(old_talker));
   }
   if (new_talker != 0)
   {
     cout << new_talker->callsign() << ": Talker start on TG #" << tg << endl;
     new_talker->updateIsTalker();
-    broadcastMsg(MsgTalkerStart(tg, new_talker->callsign()),
-        ReflectorClient::mkAndFilter(
-          ge_v2_client_filter,
-          ReflectorClient::mkOrFilter(
-            ReflectorClient::TgFilter(tg),
-            ReflectorClient::TgMonitorFilter(tg))));
+    if (!m_status_event_clients.empty() && new_talker->hasStatus())
+    {
+      Json::Value data(Json::objectValue);
+      data["tg"] = tg;
+      data["callsign"] = new_talker->callsign();
+      sendStatusEvent("talker_start", data);
+    }
+    broadcastMsgToTG(tg, MsgTalkerStart(tg, new_talker->callsign()),
+        ge_v2_client_filter, true);
     if (tg == tgForV1Clients())
     {
       broadcastMsg(MsgTalkerStartV1(new_talker->callsign()), v1_client_filter);
@@ -1351,7 +1695,34 @@ void Reflector::httpRequestReceived(Async::HttpServerConnection *con,
     return;
   }
 
-  if (req.target != "/status")
+  if (req.target == "/events")
+  {
+    res.setCode(200);
+    res.setHeader("Content-type", "text/event-stream");
+    res.setHeader("Cache-control", "no-cache");
+    if (req.method == "GET")
+    {
+      con->setChunked();
+      con->write(res);
+      addStatusEventClient(con);
+    }
+    else
+    {
+      res.setHeader("Content-length", 0);
+      con->write(res);
+    }
+    return;
+  }
+
+  if (req.target == "/profile")
+  {
+    res.setContent("application/json", jsonString(loopProfileStatus()));
+  }
+  else if (req.target == "/status")
+  {
+    res.setContent("application/json", statusDocument());
+  }
+  else
   {
     res.setCode(404);
     res.setContent("application/json",
@@ -1360,21 +1731,208 @@ void Reflector::httpRequestReceived(Async::HttpServerConnection *con,
     return;
   }
 
-  std::ostringstream os;
-  Json::StreamWriterBuilder builder;
-  builder["commentStyle"] = "None";
-  builder["indentation"] = ""; //The JSON document is written on a single line
-  Json::StreamWriter* writer = builder.newStreamWriter();
-  writer->write(m_status, &os);
-  delete writer;
-
-  res.setContent("application/json", os.str());
   res.setSendContent(req.method == "GET");
   res.setCode(200);
   con->write(res);
 } /* Reflector::requestReceived */
 
 
+Json::Value Reflector::loopProfileStatus(void) const
+{
+  const Async::LoopProfiler::Snapshot snap =
+    Async::LoopProfiler::instance().snapshot();
+
+  Json::Value profile(Json::objectValue);
+  profile["enabled"] = snap.enabled;
+  if (snap.enabled)
+  {
+    const uint64_t loop_ns = snap.busy_ns + snap.idle_ns;
+    profile["period_s"] = snap.period_ns / 1.0e9;
+    profile["iterations"] = Json::UInt64(snap.iterations);
+    profile["busy_pct"] = (loop_ns > 0) ? 100.0 * snap.busy_ns / loop_ns : 0.0;
+    profile["timer_lag"] = histogramToJson(snap.timer_lag);
+    Json::Value callbacks(Json::arrayValue);
+    for (const auto& cb : snap.callbacks)
+    {
+      Json::Value obj = histogramToJson(cb.duration);
+      obj["tag"] = cb.tag;
+      obj["type"] = Async::LoopProfiler::callbackTypeName(cb.type);
+      callbacks.append(obj);
+    }
+    profile["callbacks"] = callbacks;
+  }
+
+  const Async::UdpSocket::Stats& stats = m_udp_sock->stats();
+  Json::Value udp(Json::objectValue);
+  udp["rx_syscalls"] = Json::UInt64(stats.rx_syscalls);
+  udp["rx_datagrams"] = Json::UInt64(stats.rx_datagrams);
+  udp["rx_avg_batch"] = stats.rxAvgBatch();
+  udp["rx_max_batch"] = Json::UInt64(stats.rx_max_batch);
+  udp["tx_syscalls"] = Json::UInt64(stats.tx_syscalls);
+  udp["tx_datagrams"] = Json::UInt64(stats.tx_datagrams);
+  udp["tx_avg_batch"] = stats.txAvgBatch();
+  udp["tx_max_batch"] = Json::UInt64(stats.tx_max_batch);
+  udp["tx_queued"] = Json::UInt64(stats.tx_queued);
+  udp["tx_dropped"] = Json::UInt64(stats.tx_dropped);
+  udp["tx_queue_hwm"] = Json::UInt64(stats.tx_queue_hwm);
+  if (m_udp_workers != 0)
+  {
+    const UdpWorkerPool::Stats wstats = m_udp_workers->stats();
+    Json::Value workers(Json::objectValue);
+    workers["threads"] = m_udp_workers->threadCount();
+    workers["tx_syscalls"] = Json::UInt64(wstats.syscalls);
+    workers["tx_datagrams"] = Json::UInt64(wstats.datagrams);
+    workers["tx_dropped"] = Json::UInt64(wstats.dropped);
+    workers["queue_depth"] = Json::UInt64(wstats.queue_depth);
+    workers["max_queue_depth"] = Json::UInt64(wstats.max_queue_depth);
+    Json::Value threads(Json::arrayValue);
+    for (unsigned i=0; i<m_udp_workers->threadCount(); ++i)
+    {
+      const UdpWorkerPool::Stats tstats = m_udp_workers->workerStats(i);
+      Json::Value thread(Json::objectValue);
+      thread["tx_syscalls"] = Json::UInt64(tstats.syscalls);
+      thread["tx_datagrams"] = Json::UInt64(tstats.datagrams);
+      thread["tx_dropped"] = Json::UInt64(tstats.dropped);
+      thread["handovers"] = Json::UInt64(tstats.handovers);
+      thread["busy_s"] = tstats.busy_ns / 1.0e9;
+      thread["queue_depth"] = Json::UInt64(tstats.queue_depth);
+      thread["max_queue_depth"] = Json::UInt64(tstats.max_queue_depth);
+      threads.append(thread);
+    }
+    workers["per_thread"] = threads;
+    udp["workers"] = workers;
+  }
+  profile["udp"] = udp;
+
+  return profile;
+} /* Reflector::loopProfileStatus */
+
+
+const std::string& Reflector::statusDocument(void)
+{
+  if (m_status_doc_gen != m_status_gen)
+  {
+      // Only the nodes that have changed since the last request are
+      // serialized again. The rest use the JSON cached in the client object.
+    m_status_doc = "{\"nodes\":{";
+    bool first = true;
+    for (const auto& node : m_status_nodes)
+    {
+      if (!first)
+      {
+        m_status_doc += ",";
+      }
+      first = false;
+      m_status_doc += Json::valueToQuotedString(node.first.c_str());
+      m_status_doc += ":";
+      m_status_doc += node.second->statusJson();
+    }
+    m_status_doc += "}}";
+    m_status_doc_gen = m_status_gen;
+  }
+  return m_status_doc;
+} /* Reflector::statusDocument */
+
+
+void Reflector::addStatusEventClient(Async::HttpServerConnection *con)
+{
+  if (m_status_event_clients.empty())
+  {
+    m_status_event_keepalive_cnt = 0;
+    m_status_event_timer.setEnable(true);
+  }
+  m_status_event_clients.insert(con);
+
+    // Start off with the full status so that the deltas can be applied
+  std::ostringstream os;
+  os << "id: " << m_status_gen << "\n"
+     << "event: status\n"
+     << "data: {\"gen\":" << m_status_gen << ","
+     << statusDocument().substr(1) << "\n\n";
+  const std::string msg(os.str());
+  con->write(msg.data(), msg.size());
+} /* Reflector::addStatusEventClient */
+
+
+void Reflector::sendStatusEvent(const std::string& event, Json::Value data)
+{
+  data["gen"] = Json::UInt64(m_status_gen);
+  std::ostringstream os;
+  os << "id: " << m_status_gen << "\n"
+     << "event: " << event << "\n"
+     << "data: " << jsonString(data) << "\n\n";
+  writeStatusEvent(os.str());
+} /* Reflector::sendStatusEvent */
+
+
+void Reflector::writeStatusEvent(const std::string& msg)
+{
+  std::vector<Async::HttpServerConnection*> slow_clients;
+  for (auto con : m_status_event_clients)
+  {
+    if (con->writeBufSize() > STATUS_EVENT_MAX_BACKLOG)
+    {
+      slow_clients.push_back(con);
+      continue;
+    }
+    con->write(msg.data(), msg.size());
+  }
+
+  for (auto con : slow_clients)
+  {
+    std::cout << "*** WARNING: Disconnecting HTTP event client "
+              << con->remoteHost() << ":" << con->remotePort()
+              << " that is not keeping up" << std::endl;
+    m_status_event_clients.erase(con);
+    con->disconnect();
+    con->disconnected(con, Async::HttpServerConnection::DR_ORDERED_DISCONNECT);
+  }
+  if (m_status_event_clients.empty())
+  {
+    m_status_event_timer.setEnable(false);
+    m_pending_rx_events.clear();
+  }
+} /* Reflector::writeStatusEvent */
+
+
+void Reflector::flushStatusEvents(void)
+{
+  PendingRxEventMap pending_rx_events;
+  pending_rx_events.swap(m_pending_rx_events);
+  for (const auto& item : pending_rx_events)
+  {
+    auto node_it = m_status_nodes.find(item.first);
+    if (node_it == m_status_nodes.end())
+    {
+      continue;
+    }
+    for (char rx_id : item.second)
+    {
+      Json::Value data(node_it->second->rxStatus(rx_id));
+      if (data.isNull())
+      {
+        continue;
+      }
+      data["callsign"] = item.first;
+      data["id"] = std::string(1, rx_id);
+      sendStatusEvent("rx", data);
+      if (m_status_event_clients.empty())
+      {
+        return;
+      }
+    }
+  }
+
+    // Send a comment now and then so that proxies do not time out the
+    // connection when nothing happens
+  if (++m_status_event_keepalive_cnt >= STATUS_EVENT_KEEPALIVE)
+  {
+    m_status_event_keepalive_cnt = 0;
+    writeStatusEvent(":\n\n");
+  }
+} /* Reflector::flushStatusEvents */
+
+
 void Reflector::httpClientConnected(Async::HttpServerConnection *con)
 {
   //std::cout << "### HTTP Client connected: "
@@ -1386,6 +1944,12 @@ void Reflector::httpClientConnected(Async::HttpServerConnection *con)
 void Reflector::httpClientDisconnected(Async::HttpServerConnection *con,
     Async::HttpServerConnection::DisconnectReason reason)
 {
+  m_status_event_clients.erase(con);
+  if (m_status_event_clients.empty())
+  {
+    m_status_event_timer.setEnable(false);
+    m_pending_rx_events.clear();
+  }
   //std::cout << "### HTTP Client disconnected: "
   //          << con->remoteHost() << ":" << con->remotePort()
   //          << ": " << Async::HttpServerConnection::disconnectReasonStr(reason)
@@ -1401,10 +1965,7 @@ void Reflector::onRequestAutoQsy(uint32_t from_tg)
   std::cout << "Requesting auto-QSY from TG #" << from_tg
             << " to TG #" << tg << std::endl;
 
-  broadcastMsg(MsgRequestQsy(tg),
-      ReflectorClient::mkAndFilter(
-        ge_v2_client_filter,
-        ReflectorClient::TgFilter(from_tg)));
+  broadcastMsgToTG(from_tg, MsgRequestQsy(tg), ge_v2_client_filter);
 } /* Reflector::onRequestAutoQsy */
 
 
@@ -1601,13 +2162,45 @@ void Reflector::ctrlPtyDataReceived(const void *buf, size_t count)
       goto write_status;
     }
   }
+  else if (cmd == "PROFILE")
+  {
+    std::string subcmd("SHOW");
+    ss >> subcmd;
+    std::transform(subcmd.begin(), subcmd.end(), subcmd.begin(), ::toupper);
+    Async::LoopProfiler& profiler = Async::LoopProfiler::instance();
+    if (subcmd == "ON")
+    {
+      profiler.setEnabled(true);
+    }
+    else if (subcmd == "OFF")
+    {
+      profiler.setEnabled(false);
+    }
+    else if (subcmd == "RESET")
+    {
+      profiler.reset();
+    }
+    else if (subcmd == "SHOW")
+    {
+      std::ostringstream os;
+      profiler.snapshot().print(os);
+      m_cmd_pty->write(os.str());
+    }
+    else
+    {
+      errss << "Invalid PROFILE PTY command '" << cmdline << "'. "
+               "Usage: PROFILE [ON|OFF|RESET|SHOW]";
+      goto write_status;
+    }
+  }
   else
   {
-    errss << "Valid commands are: CFG, NODE, CA\n"
+    errss << "Valid commands are: CFG, NODE, CA, PROFILE\n"
           << "Usage:\n"
           << "CFG <section> <tag> <value>\n"
           << "NODE BLOCK <callsign> <blocktime seconds>\n"
           << "CA LS|LSC|LSP|SIGN <callsign>|RM <callsign>\n"
+          << "PROFILE [ON|OFF|RESET|SHOW]\n"
           << "\nEmpty CFG lists all configuration";
   }
 
@@ -1662,6 +2255,68 @@ void Reflector::cfgUpdated(const std::string& section, const std::string& tag)
 } /* Reflector::cfgUpdated */
 
 
+void Reflector::updateSupportedCodecs(void)
+{
+  m_supported_codecs = m_codecs_cfg.value();
+  if (m_supported_codecs.size() > 1)
+  {
+    m_supported_codecs.erase(m_supported_codecs.begin()+1,
+                             m_supported_codecs.end());
+    std::cout << "*** WARNING: The GLOBAL/CODECS configuration "
+                 "variable can only take one codec at the moment. Using the "
+                 "first one: \"" << m_supported_codecs.front() << "\""
+              << std::endl;
+  }
+  else if (m_supported_codecs.empty())
+  {
+    std::string codec = "GSM";
+    if (Async::AudioDecoder::isAvailable("OPUS") &&
+        Async::AudioEncoder::isAvailable("OPUS"))
+    {
+      codec = "OPUS";
+    }
+    else if (Async::AudioDecoder::isAvailable("SPEEX") &&
+             Async::AudioEncoder::isAvailable("SPEEX"))
+    {
+      codec = "SPEEX";
+    }
+    m_supported_codecs.push_back(codec);
+  }
+} /* Reflector::updateSupportedCodecs */
+
+
+void Reflector::updateCallsignRegex(void)
+{
+  std::string accept_cs_re_str = m_accept_callsign_cfg.value();
+  if (accept_cs_re_str.empty())
+  {
+    accept_cs_re_str =
+      "[A-Z0-9][A-Z]{0,2}\\d[A-Z0-9]{0,3}[A-Z](?:-[A-Z0-9]{1,3})?";
+  }
+  m_callsign_re_ok = true;
+  try
+  {
+    m_accept_callsign_re = std::regex(accept_cs_re_str);
+  }
+  catch (std::regex_error& e)
+  {
+    std::cerr << "*** ERROR: Regular expression parsing error in "
+                 "GLOBAL/ACCEPT_CALLSIGN: " << e.what() << std::endl;
+    m_callsign_re_ok = false;
+  }
+  try
+  {
+    m_reject_callsign_re = std::regex(m_reject_callsign_cfg.value());
+  }
+  catch (std::regex_error& e)
+  {
+    std::cerr << "*** ERROR: Regular expression parsing error in "
+                 "GLOBAL/REJECT_CALLSIGN: " << e.what() << std::endl;
+    m_callsign_re_ok = false;
+  }
+} /* Reflector::updateCallsignRegex */
+
+
 bool Reflector::loadCertificateFiles(void)
 {
   if (!buildPath("GLOBAL", "CERT_PKI_DIR", SVX_LOCAL_STATE_DIR, m_pki_dir) ||
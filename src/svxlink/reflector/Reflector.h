@@ -37,7 +37,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <sigc++/sigc++.h>
 #include <sys/time.h>
 #include <vector>
+#include <map>
+#include <set>
 #include <string>
+#include <regex>
 #include <json/json.h>
 
 
@@ -53,6 +56,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncAtTimer.h>
 #include <AsyncHttpServerConnection.h>
 #include <AsyncExec.h>
+#include <AsyncConfig.h>
 
 
 /****************************************************************************
@@ -63,6 +67,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "ProtoVer.h"
 #include "ReflectorClient.h"
+#include "UdpWorkerPool.h"
 
 
 /****************************************************************************
@@ -185,6 +190,20 @@ class Reflector : public sigc::trackable
     void broadcastMsg(const ReflectorMsg& msg,
         const ReflectorClient::Filter& filter=ReflectorClient::NoFilter());
 
+    /**
+     * @brief   Send a TCP message to the clients on a talk group
+     * @param   tg The talk group
+     * @param   msg The message to send
+     * @param   filter The client filter to apply
+     * @param   include_monitoring Also send to clients monitoring the TG
+     *
+     * Like broadcastMsg but only the clients that have selected the talk
+     * group, and optionally those monitoring it, are considered.
+     */
+    void broadcastMsgToTG(uint32_t tg, const ReflectorMsg& msg,
+        const ReflectorClient::Filter& filter=ReflectorClient::NoFilter(),
+        bool include_monitoring=false);
+
     /**
      * @brief   Send a UDP datagram to the specificed ReflectorClient
      * @param   client The client to the send datagram to
@@ -197,6 +216,18 @@ class Reflector : public sigc::trackable
     void broadcastUdpMsg(const ReflectorUdpMsg& msg,
         const ReflectorClient::Filter& filter=ReflectorClient::NoFilter());
 
+    /**
+     * @brief   Send a UDP message to the clients that have selected a TG
+     * @param   tg The talk group
+     * @param   msg The message to send
+     * @param   filter The client filter to apply
+     *
+     * Like broadcastUdpMsg but only the clients that have selected the talk
+     * group are considered. This is used for the audio fan-out.
+     */
+    void broadcastUdpMsgToTG(uint32_t tg, const ReflectorUdpMsg& msg,
+        const ReflectorClient::Filter& filter=ReflectorClient::NoFilter());
+
     /**
      * @brief   Get the TG for protocol V1 clients
      * @return  Returns the TG used for protocol V1 clients
@@ -228,12 +259,49 @@ class Reflector : public sigc::trackable
     std::string caBundlePem(void) const;
     std::string issuingCertPem(void) const;
     bool callsignOk(const std::string& callsign, bool verbose=true) const;
+    const std::vector<std::string>& supportedCodecs(void) const
+    {
+      return m_supported_codecs;
+    }
     bool reqEmailOk(const Async::SslCertSigningReq& req) const;
     bool emailOk(const std::string& email) const;
     std::string checkCsr(const Async::SslCertSigningReq& req);
     Async::SslX509 csrReceived(Async::SslCertSigningReq& req);
 
-    Json::Value& clientStatus(const std::string& callsign);
+    /**
+     * @brief   Serialize a JSON value to a single line string
+     * @param   val The value to serialize
+     * @return  Returns the serialized value
+     */
+    static std::string jsonString(const Json::Value& val);
+
+    /**
+     * @brief   Notify the reflector that a client sent new node info
+     * @param   client The client that was updated
+     */
+    void nodeInfoUpdated(ReflectorClient* client);
+
+    /**
+     * @brief   Notify the reflector that the TG status of a client changed
+     * @param   client The client that was updated
+     */
+    void nodeTgStatusUpdated(ReflectorClient* client);
+
+    /**
+     * @brief   Notify the reflector that a receiver status changed
+     * @param   client The client that was updated
+     * @param   rx_id  The id of the receiver that changed
+     */
+    void nodeRxStatusUpdated(ReflectorClient* client, char rx_id);
+
+    /**
+     * @brief   Notify the reflector that a transmitter status changed
+     * @param   client    The client that was updated
+     * @param   tx_id     The id of the transmitter that changed
+     * @param   transmit  The new transmitter state
+     */
+    void nodeTxStatusUpdated(ReflectorClient* client, char tx_id,
+                             bool transmit);
 
   protected:
 
@@ -242,14 +310,27 @@ class Reflector : public sigc::trackable
                      ReflectorClient*> ReflectorClientConMap;
     typedef Async::TcpServer<Async::FramedTcpConnection> FramedTcpServer;
     using HttpServer = Async::TcpServer<Async::HttpServerConnection>;
+    using StatusNodeMap = std::map<std::string, ReflectorClient*>;
+    using HttpConSet = std::set<Async::HttpServerConnection*>;
+    using PendingRxEventMap = std::map<std::string, std::set<char>>;
 
     static constexpr unsigned ROOT_CA_VALIDITY_DAYS     = 25*365;
     static constexpr unsigned ISSUING_CA_VALIDITY_DAYS  = 4*90;
     static constexpr unsigned CERT_VALIDITY_DAYS        = 90;
     static constexpr int      CERT_VALIDITY_OFFSET_DAYS = -1;
+    static constexpr size_t   UDP_PAYLOAD_BUF_CNT       = 4;
+    static constexpr int      STATUS_EVENT_INTERVAL_MS  = 200;
+    static constexpr unsigned STATUS_EVENT_KEEPALIVE    = 75;
+    static constexpr size_t   STATUS_EVENT_MAX_BACKLOG  = 256*1024;
 
     FramedTcpServer*            m_srv;
     Async::EncryptedUdpSocket*  m_udp_sock;
+    const EVP_CIPHER*           m_udp_cipher;
+    UdpWorkerPool*              m_udp_workers;
+    UdpWorkerPool::PayloadPtr   m_udp_bcast_payload;
+    bool                        m_udp_bcast = false;
+    std::vector<std::shared_ptr<UdpWorkerPool::Payload>> m_udp_payload_bufs;
+    std::vector<char>           m_udp_tx_buf;
     ReflectorClientConMap       m_client_con_map;
     Async::Config*              m_cfg;
     uint32_t                    m_tg_for_v1_clients;
@@ -277,7 +358,22 @@ class Reflector : public sigc::trackable
     std::vector<uint8_t>        m_ca_md;
     std::vector<uint8_t>        m_ca_sig;
     std::string                 m_accept_cert_email;
-    Json::Value                 m_status;
+    Async::ConfigValue<std::vector<std::string>> m_codecs_cfg;
+    std::vector<std::string>    m_supported_codecs;
+    Async::ConfigValue<std::string> m_accept_callsign_cfg;
+    Async::ConfigValue<std::string> m_reject_callsign_cfg;
+    std::regex                  m_accept_callsign_re;
+    std::regex                  m_reject_callsign_re;
+    bool                        m_callsign_re_ok = false;
+    StatusNodeMap               m_status_nodes;
+    uint64_t                    m_status_gen = 1;
+    uint64_t                    m_status_doc_gen = 0;
+    std::string                 m_status_doc;
+    HttpConSet                  m_status_event_clients;
+    PendingRxEventMap           m_pending_rx_events;
+    Async::Timer                m_status_event_timer;
+    unsigned                    m_status_event_keepalive_cnt = 0;
+    size_t                      m_tcp_send_queue_size = 4*1024*1024;
 
     Reflector(const Reflector&);
     Reflector& operator=(const Reflector&);
@@ -292,6 +388,14 @@ class Reflector : public sigc::trackable
                          ReflectorClient *new_talker);
     void httpRequestReceived(Async::HttpServerConnection *con,
                              Async::HttpServerConnection::Request& req);
+    Json::Value loopProfileStatus(void) const;
+    UdpWorkerPool::PayloadPtr udpPayload(const ReflectorUdpMsg& msg);
+    UdpWorkerPool::PayloadPtr packUdpPayload(const ReflectorUdpMsg& msg);
+    const std::string& statusDocument(void);
+    void addStatusEventClient(Async::HttpServerConnection *con);
+    void sendStatusEvent(const std::string& event, Json::Value data);
+    void writeStatusEvent(const std::string& msg);
+    void flushStatusEvents(void);
     void httpClientConnected(Async::HttpServerConnection *con);
     void httpClientDisconnected(Async::HttpServerConnection *con,
         Async::HttpServerConnection::DisconnectReason reason);
@@ -299,6 +403,8 @@ class Reflector : public sigc::trackable
     uint32_t nextRandomQsyTg(void);
     void ctrlPtyDataReceived(const void *buf, size_t count);
     void cfgUpdated(const std::string& section, const std::string& tag);
+    void updateSupportedCodecs(void);
+    void updateCallsignRegex(void);
     bool loadCertificateFiles(void);
     bool loadServerCertificateFiles(void);
     bool generateKeyFile(Async::SslKeypair& pkey, const std::string& keyfile);
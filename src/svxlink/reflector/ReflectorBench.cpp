@@ -0,0 +1,952 @@
+/**
+@file   ReflectorBench.cpp
+@brief  A load generator and fan-out latency benchmark for SvxReflector
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+The svxreflector-bench program connect a large number of simulated V2 and V3
+clients to a running reflector. In each talk group one client send 20ms audio
+frames while the other clients receive them. The fan-out latency, packet loss
+and the CPU and memory usage of the reflector process are measured and
+written as a JSON document so that the results for different builds can be
+compared.
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include <popt.h>
+#include <sigc++/sigc++.h>
+#include <json/json.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncCppApplication.h>
+#include <AsyncTimer.h>
+#include <AsyncMsg.h>
+#include <AsyncSslContext.h>
+#include <AsyncSslKeypair.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "version/SVXREFLECTOR.h"
+#include "BenchClient.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+#define PROGRAM_NAME "svxreflector-bench"
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+namespace {
+
+/**
+ * @brief The header put first in each audio frame sent by a talker
+ *
+ * The send time is taken from the monotonic clock. Since the talkers and the
+ * receivers live in the same process the fan-out latency can be calculated
+ * directly when the frame is received.
+ */
+struct BenchFrame : public Async::Msg
+{
+  static const uint32_t MAGIC = 0x53564252;   // "SVBR"
+
+  uint32_t  magic       = MAGIC;
+  uint32_t  tg          = 0;
+  uint32_t  seq         = 0;
+  uint64_t  tx_time_ns  = 0;
+
+  ASYNC_MSG_MEMBERS(magic, tg, seq, tx_time_ns)
+};
+
+
+/**
+ * @brief CPU and memory usage for a process, read from /proc
+ */
+struct ProcStats
+{
+  bool      ok          = false;
+  uint64_t  cpu_ticks   = 0;
+  uint64_t  rss_kb      = 0;
+  uint64_t  rss_max_kb  = 0;
+
+  static ProcStats read(const std::string& pid)
+  {
+    ProcStats stats;
+    std::ifstream stat_ifs("/proc/" + pid + "/stat");
+    std::string line;
+    if (!std::getline(stat_ifs, line))
+    {
+      return stats;
+    }
+      // The command name may contain spaces so start parsing after it. The
+      // first field after the command name is field number three. User and
+      // system time are fields 14 and 15.
+    const auto pos = line.rfind(')');
+    if (pos == std::string::npos)
+    {
+      return stats;
+    }
+    std::istringstream is(line.substr(pos + 1));
+    std::string field;
+    for (int i=3; i<14; ++i)
+    {
+      is >> field;
+    }
+    uint64_t utime = 0, stime = 0;
+    if (!(is >> utime >> stime))
+    {
+      return stats;
+    }
+    stats.cpu_ticks = utime + stime;
+
+    std::ifstream status_ifs("/proc/" + pid + "/status");
+    while (std::getline(status_ifs, line))
+    {
+      std::istringstream ls(line);
+      std::string name;
+      uint64_t value = 0;
+      ls >> name >> value;
+      if (name == "VmRSS:")
+      {
+        stats.rss_kb = value;
+      }
+      else if (name == "VmHWM:")
+      {
+        stats.rss_max_kb = value;
+      }
+    }
+    stats.ok = true;
+    return stats;
+  }
+};
+
+
+/**
+ * @brief Drive the simulated clients and collect the measurements
+ *
+ * The run is divided into phases. First all clients are connected, at the
+ * given rate. When all clients have logged in, or failed, the talkers start
+ * sending audio. After the warmup time the measurement window is opened and
+ * it is closed again after the configured duration. Only frames sent within
+ * the window are counted. The talkers then stop and the remaining frames are
+ * given some time to arrive before the results are written.
+ */
+class LoadGenerator : public sigc::trackable
+{
+  public:
+    struct Config
+    {
+      BenchClient::Config client;
+      unsigned            clients         = 100;
+      unsigned            v2_clients      = 0;
+      unsigned            tgs             = 1;
+      uint32_t            first_tg        = 1000;
+      unsigned            talkers         = 1;
+      size_t              frame_size      = 80;
+      double              connect_rate    = 200.0;
+      double              connect_timeout = 60.0;
+      double              warmup          = 2.0;
+      double              duration        = 10.0;
+      std::string         callsign_prefix = "XX0BNC";
+      std::string         reflector_pid;
+    };
+
+    static std::string callsign(const std::string& prefix, unsigned idx)
+    {
+      const char* digits = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+      std::string suffix;
+      do
+      {
+        suffix.insert(suffix.begin(), digits[idx % 36]);
+        idx /= 36;
+      } while (idx > 0);
+      return prefix + "-" + suffix;
+    }
+
+    explicit LoadGenerator(const Config& cfg)
+      : m_cfg(cfg), m_frame(std::max(cfg.frame_size, m_hdr_size), 0)
+    {
+      for (unsigned i=0; i<m_cfg.clients; ++i)
+      {
+        const uint32_t tg = m_cfg.first_tg + (i % m_cfg.tgs);
+        auto client = new BenchClient(m_cfg.client,
+            callsign(m_cfg.callsign_prefix, i), i >= m_cfg.v2_clients, tg);
+        client->ready.connect(
+            sigc::mem_fun(*this, &LoadGenerator::clientReady));
+        client->failed.connect(
+            sigc::mem_fun(*this, &LoadGenerator::clientFailed));
+        client->audioReceived.connect(
+            sigc::mem_fun(*this, &LoadGenerator::audioReceived));
+        m_clients.emplace_back(client);
+        if ((i < m_cfg.tgs) && (i < m_cfg.talkers))
+        {
+          m_tg_map[tg].talker = client;
+        }
+      }
+
+      m_connect_timer.expired.connect(sigc::hide(
+          sigc::mem_fun(*this, &LoadGenerator::connectMoreClients)));
+      m_audio_timer.expired.connect(sigc::hide(
+          sigc::mem_fun(*this, &LoadGenerator::sendAudio)));
+      m_tick_timer.expired.connect(sigc::hide(
+          sigc::mem_fun(*this, &LoadGenerator::tick)));
+      m_phase_timer.expired.connect(sigc::hide(
+          sigc::mem_fun(*this, &LoadGenerator::checkPhase)));
+    }
+
+    void start(void)
+    {
+      std::cerr << "Connecting " << m_cfg.clients << " clients to "
+                << m_cfg.client.host << ":" << m_cfg.client.port
+                << std::endl;
+      m_start_time = BenchClient::Clock::now();
+      m_phase_time = m_start_time;
+      m_connect_timer.setEnable(true);
+      m_tick_timer.setEnable(true);
+      m_phase_timer.setEnable(true);
+      connectMoreClients();
+    }
+
+    bool succeeded(void) const { return m_ready_cnt > 0; }
+
+    Json::Value result(void) const;
+
+  private:
+    enum Phase
+    {
+      PHASE_CONNECTING, PHASE_WARMUP, PHASE_MEASURING, PHASE_DRAINING
+    };
+
+    struct TgState
+    {
+      BenchClient*  talker            = nullptr;
+      uint32_t      next_seq          = 0;
+      uint32_t      window_first_seq  = 0;
+      uint32_t      window_end_seq    = 0;
+      unsigned      receivers         = 0;
+    };
+
+    static constexpr int    CONNECT_INTERVAL_MS = 10;
+    static constexpr int    FRAME_INTERVAL_MS   = 20;
+    static constexpr double DRAIN_TIME          = 1.0;
+
+    using ClientPtr = std::unique_ptr<BenchClient>;
+
+    const Config                      m_cfg;
+    const size_t                      m_hdr_size =
+      Async::msgFixedPackedSize<BenchFrame>();
+    std::vector<uint8_t>              m_frame;
+    std::vector<ClientPtr>            m_clients;
+    std::map<uint32_t, TgState>       m_tg_map;
+    std::set<const BenchClient*>      m_measured;
+    Phase                             m_phase           = PHASE_CONNECTING;
+    bool                              m_window_open     = false;
+    size_t                            m_next_client     = 0;
+    double                            m_connect_credit  = 0.0;
+    unsigned                          m_ready_cnt       = 0;
+    unsigned                          m_failed_cnt      = 0;
+    unsigned                          m_lost_cnt        = 0;
+    std::map<std::string, unsigned>   m_fail_reasons;
+    uint64_t                          m_frames_sent     = 0;
+    uint64_t                          m_frames_received = 0;
+    uint64_t                          m_send_errors     = 0;
+    std::vector<double>               m_latency_ms;
+    std::vector<double>               m_login_ms;
+    BenchClient::Clock::time_point    m_start_time;
+    BenchClient::Clock::time_point    m_phase_time;
+    double                            m_connect_duration = 0.0;
+    double                            m_window_duration  = 0.0;
+    ProcStats                         m_refl_start;
+    ProcStats                         m_refl_end;
+    ProcStats                         m_self_start;
+    ProcStats                         m_self_end;
+    Async::Timer                      m_connect_timer {CONNECT_INTERVAL_MS,
+                                        Async::Timer::TYPE_PERIODIC, false};
+    Async::Timer                      m_audio_timer   {FRAME_INTERVAL_MS,
+                                        Async::Timer::TYPE_PERIODIC, false};
+    Async::Timer                      m_tick_timer    {1000,
+                                        Async::Timer::TYPE_PERIODIC, false};
+    Async::Timer                      m_phase_timer   {100,
+                                        Async::Timer::TYPE_PERIODIC, false};
+
+    static uint64_t nowNs(void)
+    {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+          BenchClient::Clock::now().time_since_epoch()).count();
+    }
+
+    double secondsInPhase(void) const
+    {
+      return std::chrono::duration<double>(
+          BenchClient::Clock::now() - m_phase_time).count();
+    }
+
+    void connectMoreClients(void)
+    {
+      m_connect_credit += m_cfg.connect_rate * CONNECT_INTERVAL_MS / 1000.0;
+      while ((m_connect_credit >= 1.0) && (m_next_client < m_clients.size()))
+      {
+        m_clients[m_next_client++]->connect();
+        m_connect_credit -= 1.0;
+      }
+      if (m_next_client >= m_clients.size())
+      {
+        m_connect_timer.setEnable(false);
+      }
+    }
+
+    void clientReady(BenchClient* client)
+    {
+      m_ready_cnt += 1;
+      m_login_ms.push_back(1000.0 * client->loginTime());
+    }
+
+    void clientFailed(BenchClient* client, const std::string& reason)
+    {
+      if (m_phase == PHASE_CONNECTING)
+      {
+        m_failed_cnt += 1;
+      }
+      else
+      {
+        m_lost_cnt += 1;
+      }
+      m_fail_reasons[reason] += 1;
+      if (m_fail_reasons[reason] == 1)
+      {
+        std::cerr << "*** WARNING[" << client->callsign() << "]: "
+                  << reason << std::endl;
+      }
+    }
+
+    void tick(void)
+    {
+      for (auto& client : m_clients)
+      {
+        client->tick();
+      }
+    }
+
+    void sendAudio(void)
+    {
+      const uint64_t now = nowNs();
+      for (auto& item : m_tg_map)
+      {
+        TgState& tgs = item.second;
+        if ((tgs.talker == nullptr) || !tgs.talker->isReady())
+        {
+          continue;
+        }
+        BenchFrame hdr;
+        hdr.tg = item.first;
+        hdr.seq = tgs.next_seq;
+        hdr.tx_time_ns = now;
+        Async::MsgBufWriter w(m_frame.data(), m_frame.size());
+        if (hdr.pack(w) && tgs.talker->sendAudio(m_frame.data(), m_frame.size()))
+        {
+          tgs.next_seq += 1;
+          if (m_window_open)
+          {
+            m_frames_sent += 1;
+          }
+        }
+        else
+        {
+          m_send_errors += 1;
+        }
+      }
+    }
+
+    void audioReceived(BenchClient* client, const uint8_t* buf, size_t len)
+    {
+      Async::MsgBufReader r(buf, len);
+      BenchFrame hdr;
+      if (!hdr.unpack(r) || (hdr.magic != BenchFrame::MAGIC))
+      {
+        return;
+      }
+      auto it = m_tg_map.find(hdr.tg);
+      if ((it == m_tg_map.end()) || (m_measured.count(client) == 0))
+      {
+        return;
+      }
+      const TgState& tgs = it->second;
+      if ((m_phase < PHASE_MEASURING) || (hdr.seq < tgs.window_first_seq) ||
+          (m_window_open ? false : (hdr.seq >= tgs.window_end_seq)))
+      {
+        return;
+      }
+      m_frames_received += 1;
+      m_latency_ms.push_back((nowNs() - hdr.tx_time_ns) / 1.0e6);
+    }
+
+    void openWindow(void)
+    {
+      m_measured.clear();
+      for (auto& item : m_tg_map)
+      {
+        item.second.window_first_seq = item.second.next_seq;
+        item.second.receivers = 0;
+      }
+      for (const auto& client : m_clients)
+      {
+        auto it = m_tg_map.find(client->tg());
+        if (client->isReady() && (it != m_tg_map.end()) &&
+            (it->second.talker != client.get()))
+        {
+          m_measured.insert(client.get());
+          it->second.receivers += 1;
+        }
+      }
+      m_refl_start = ProcStats::read(m_cfg.reflector_pid);
+      m_self_start = ProcStats::read("self");
+      m_window_open = true;
+    }
+
+    void closeWindow(void)
+    {
+      m_window_open = false;
+      for (auto& item : m_tg_map)
+      {
+        item.second.window_end_seq = item.second.next_seq;
+      }
+      m_refl_end = ProcStats::read(m_cfg.reflector_pid);
+      m_self_end = ProcStats::read("self");
+      m_window_duration = secondsInPhase();
+    }
+
+    void checkPhase(void)
+    {
+      switch (m_phase)
+      {
+        case PHASE_CONNECTING:
+          if ((m_ready_cnt + m_failed_cnt < m_clients.size()) &&
+              (secondsInPhase() < m_cfg.connect_timeout))
+          {
+            return;
+          }
+          m_connect_timer.setEnable(false);
+          m_connect_duration = secondsInPhase();
+          std::cerr << m_ready_cnt << " clients ready and " << m_failed_cnt
+                    << " failed after " << m_connect_duration << "s"
+                    << std::endl;
+          if (m_ready_cnt == 0)
+          {
+            Async::Application::app().quit();
+            return;
+          }
+          m_phase = PHASE_WARMUP;
+          m_audio_timer.setEnable(true);
+          break;
+
+        case PHASE_WARMUP:
+          if (secondsInPhase() < m_cfg.warmup)
+          {
+            return;
+          }
+          std::cerr << "Measuring for " << m_cfg.duration << "s" << std::endl;
+          m_phase = PHASE_MEASURING;
+          openWindow();
+          break;
+
+        case PHASE_MEASURING:
+          if (secondsInPhase() < m_cfg.duration)
+          {
+            return;
+          }
+          closeWindow();
+          m_audio_timer.setEnable(false);
+          for (auto& item : m_tg_map)
+          {
+            if (item.second.talker != nullptr)
+            {
+              item.second.talker->sendFlush();
+            }
+          }
+          m_phase = PHASE_DRAINING;
+          break;
+
+        case PHASE_DRAINING:
+          if (secondsInPhase() < DRAIN_TIME)
+          {
+            return;
+          }
+          for (auto& client : m_clients)
+          {
+            client->disconnect();
+          }
+          Async::Application::app().quit();
+          return;
+      }
+      m_phase_time = BenchClient::Clock::now();
+    }
+};  /* class LoadGenerator */
+
+
+Json::Value percentiles(std::vector<double> values)
+{
+  Json::Value obj(Json::objectValue);
+  obj["count"] = Json::UInt64(values.size());
+  if (values.empty())
+  {
+    return obj;
+  }
+  std::sort(values.begin(), values.end());
+  double sum = 0.0;
+  for (double val : values)
+  {
+    sum += val;
+  }
+  auto pct = [&](double p)
+  {
+    size_t idx = static_cast<size_t>(p * values.size());
+    return values[std::min(idx, values.size() - 1)];
+  };
+  obj["min"] = values.front();
+  obj["mean"] = sum / values.size();
+  obj["p50"] = pct(0.50);
+  obj["p90"] = pct(0.90);
+  obj["p99"] = pct(0.99);
+  obj["p999"] = pct(0.999);
+  obj["max"] = values.back();
+  return obj;
+}
+
+
+Json::Value LoadGenerator::result(void) const
+{
+  Json::Value root(Json::objectValue);
+  root["tool"] = PROGRAM_NAME;
+  root["version"] = SVXREFLECTOR_VERSION;
+
+  Json::Value cfg(Json::objectValue);
+  cfg["host"] = m_cfg.client.host;
+  cfg["port"] = m_cfg.client.port;
+  cfg["clients"] = m_cfg.clients;
+  cfg["v2_clients"] = m_cfg.v2_clients;
+  cfg["v3_clients"] = m_cfg.clients - m_cfg.v2_clients;
+  cfg["tgs"] = m_cfg.tgs;
+  cfg["talkers"] = Json::UInt64(std::count_if(m_tg_map.begin(),
+      m_tg_map.end(), [](const std::pair<const uint32_t, TgState>& item)
+      {
+        return item.second.talker != nullptr;
+      }));
+  cfg["frame_size"] = Json::UInt64(m_frame.size());
+  cfg["frame_interval_ms"] = FRAME_INTERVAL_MS;
+  cfg["warmup_s"] = m_cfg.warmup;
+  cfg["duration_s"] = m_cfg.duration;
+  root["config"] = cfg;
+
+  Json::Value connect(Json::objectValue);
+  connect["ready"] = m_ready_cnt;
+  connect["failed"] = m_failed_cnt;
+  connect["lost_during_test"] = m_lost_cnt;
+  connect["time_s"] = m_connect_duration;
+  connect["login_ms"] = percentiles(m_login_ms);
+  Json::Value reasons(Json::objectValue);
+  for (const auto& item : m_fail_reasons)
+  {
+    reasons[item.first] = item.second;
+  }
+  connect["fail_reasons"] = reasons;
+  root["connect"] = connect;
+
+  uint64_t expected = 0;
+  for (const auto& item : m_tg_map)
+  {
+    const TgState& tgs = item.second;
+    expected += uint64_t(tgs.window_end_seq - tgs.window_first_seq) *
+                tgs.receivers;
+  }
+  Json::Value audio(Json::objectValue);
+  audio["frames_sent"] = Json::UInt64(m_frames_sent);
+  audio["frames_expected"] = Json::UInt64(expected);
+  audio["frames_received"] = Json::UInt64(m_frames_received);
+  audio["send_errors"] = Json::UInt64(m_send_errors);
+  audio["loss_pct"] = (expected > 0)
+    ? 100.0 * (1.0 - double(m_frames_received) / expected) : 0.0;
+  audio["latency_ms"] = percentiles(m_latency_ms);
+  root["audio"] = audio;
+
+  const long ticks_per_s = sysconf(_SC_CLK_TCK);
+  auto procJson = [&](const ProcStats& start, const ProcStats& end)
+  {
+    Json::Value obj(Json::objectValue);
+    obj["cpu_pct"] = (m_window_duration > 0.0) && (ticks_per_s > 0)
+      ? 100.0 * (end.cpu_ticks - start.cpu_ticks) / ticks_per_s /
+        m_window_duration
+      : 0.0;
+    obj["rss_kb"] = Json::UInt64(end.rss_kb);
+    obj["rss_max_kb"] = Json::UInt64(end.rss_max_kb);
+    return obj;
+  };
+  if (m_refl_start.ok && m_refl_end.ok)
+  {
+    Json::Value refl = procJson(m_refl_start, m_refl_end);
+    refl["pid"] = m_cfg.reflector_pid;
+    root["reflector"] = refl;
+  }
+  if (m_self_start.ok && m_self_end.ok)
+  {
+    root["bench"] = procJson(m_self_start, m_self_end);
+  }
+
+  return root;
+} /* LoadGenerator::result */
+
+}; /* anonymous namespace */
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+static void parse_arguments(int argc, const char **argv);
+static void raise_fd_limit(rlim_t needed);
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+static char   *host             = NULL;
+static int    port              = 5300;
+static int    clients           = 100;
+static int    v2_clients        = 0;
+static int    tgs               = 1;
+static int    first_tg          = 1000;
+static int    talkers           = -1;
+static int    frame_size        = 80;
+static double connect_rate      = 200.0;
+static double connect_timeout   = 60.0;
+static double warmup            = 2.0;
+static double duration          = 10.0;
+static char   *auth_key         = NULL;
+static char   *callsign_prefix  = NULL;
+static int    reflector_pid     = 0;
+static char   *output           = NULL;
+static int    print_users       = 0;
+
+
+/****************************************************************************
+ *
+ * MAIN
+ *
+ ****************************************************************************/
+
+int main(int argc, const char **argv)
+{
+  parse_arguments(argc, argv);
+
+  LoadGenerator::Config cfg;
+  if (host != NULL)
+  {
+    cfg.client.host = host;
+  }
+  cfg.client.port = port;
+  if (auth_key != NULL)
+  {
+    cfg.client.auth_key = auth_key;
+  }
+  if (callsign_prefix != NULL)
+  {
+    cfg.callsign_prefix = callsign_prefix;
+  }
+  cfg.clients = std::max(clients, 1);
+  cfg.v2_clients = std::min(std::max(v2_clients, 0), clients);
+  cfg.tgs = std::min(std::max(tgs, 1), clients);
+  cfg.first_tg = std::max(first_tg, 1);
+  cfg.talkers = (talkers < 0) ? cfg.tgs : talkers;
+  cfg.frame_size = std::max(frame_size, 1);
+  cfg.connect_rate = std::max(connect_rate, 1.0);
+  cfg.connect_timeout = connect_timeout;
+  cfg.warmup = warmup;
+  cfg.duration = duration;
+  if (reflector_pid > 0)
+  {
+    cfg.reflector_pid = std::to_string(reflector_pid);
+  }
+
+  if (print_users)
+  {
+      // Print configuration to add to svxreflector.conf for the simulated
+      // clients to be able to log in
+    std::cout << "[USERS]" << std::endl;
+    for (unsigned i=0; i<cfg.clients; ++i)
+    {
+      std::cout << LoadGenerator::callsign(cfg.callsign_prefix, i)
+                << "=SvxReflectorBench" << std::endl;
+    }
+    std::cout << std::endl << "[PASSWORDS]" << std::endl;
+    std::cout << "SvxReflectorBench=\"" << cfg.client.auth_key << "\""
+              << std::endl;
+    return 0;
+  }
+
+  if (cfg.client.auth_key.empty())
+  {
+    std::cerr << "*** ERROR: An authentication key must be given using the "
+                 "--auth_key option" << std::endl;
+    exit(1);
+  }
+
+    // Each client use one TCP and one UDP socket
+  raise_fd_limit(2 * cfg.clients + 64);
+
+  CppApplication app;
+
+  Async::SslContext ssl_ctx;
+  Async::SslKeypair keypair;
+  if (cfg.v2_clients < cfg.clients)
+  {
+    std::cerr << "Generating client key pair" << std::endl;
+    if (!keypair.generate(2048))
+    {
+      std::cerr << "*** ERROR: Failed to generate a key pair" << std::endl;
+      exit(1);
+    }
+  }
+  cfg.client.ssl_ctx = &ssl_ctx;
+  cfg.client.keypair = &keypair;
+
+  LoadGenerator gen(cfg);
+  gen.start();
+  app.exec();
+
+  Json::StreamWriterBuilder builder;
+  builder["commentStyle"] = "None";
+  builder["indentation"] = "  ";
+  std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
+  if (output != NULL)
+  {
+    std::ofstream ofs(output);
+    writer->write(gen.result(), &ofs);
+    ofs << std::endl;
+    if (!ofs)
+    {
+      std::cerr << "*** ERROR: Could not write the result to \"" << output
+                << "\"" << std::endl;
+      exit(1);
+    }
+  }
+  else
+  {
+    writer->write(gen.result(), &std::cout);
+    std::cout << std::endl;
+  }
+
+  return gen.succeeded() ? 0 : 1;
+} /* main */
+
+
+
+/****************************************************************************
+ *
+ * Functions
+ *
+ ****************************************************************************/
+
+/*
+ *----------------------------------------------------------------------------
+ * Function:  parse_arguments
+ * Purpose:   Parse the command line arguments.
+ * Input:     argc  - Number of arguments in the command line
+ *    	      argv  - Array of strings with the arguments
+ * Output:    Returns 0 if all is ok, otherwise -1.
+ * Author:    Tobias Blomberg, SM0SVX
+ * Created:   2026-10-17
+ * Remarks:
+ * Bugs:
+ *----------------------------------------------------------------------------
+ */
+static void parse_arguments(int argc, const char **argv)
+{
+  int print_version = 0;
+
+  poptContext optCon;
+  const struct poptOption optionsTable[] =
+  {
+    POPT_AUTOHELP
+    {"host", 0, POPT_ARG_STRING, &host, 0,
+            "The reflector host to connect to (default 127.0.0.1)", "<host>"},
+    {"port", 0, POPT_ARG_INT, &port, 0,
+            "The reflector port to connect to (default 5300)", "<port>"},
+    {"clients", 0, POPT_ARG_INT, &clients, 0,
+            "The number of clients to simulate (default 100)", "<count>"},
+    {"v2_clients", 0, POPT_ARG_INT, &v2_clients, 0,
+            "How many of the clients that use protocol V2 (default 0)",
+            "<count>"},
+    {"tgs", 0, POPT_ARG_INT, &tgs, 0,
+            "The number of talk groups to spread the clients over "
+            "(default 1)", "<count>"},
+    {"first_tg", 0, POPT_ARG_INT, &first_tg, 0,
+            "The first talk group to use (default 1000)", "<tg>"},
+    {"talkers", 0, POPT_ARG_INT, &talkers, 0,
+            "The number of talk groups with a talker (default all)",
+            "<count>"},
+    {"frame_size", 0, POPT_ARG_INT, &frame_size, 0,
+            "The size of each 20ms audio frame (default 80)", "<bytes>"},
+    {"connect_rate", 0, POPT_ARG_DOUBLE, &connect_rate, 0,
+            "New connections per second (default 200)", "<rate>"},
+    {"connect_timeout", 0, POPT_ARG_DOUBLE, &connect_timeout, 0,
+            "Max time to wait for all clients to log in (default 60)",
+            "<seconds>"},
+    {"warmup", 0, POPT_ARG_DOUBLE, &warmup, 0,
+            "Time to send audio before measuring (default 2)", "<seconds>"},
+    {"duration", 0, POPT_ARG_DOUBLE, &duration, 0,
+            "The length of the measurement (default 10)", "<seconds>"},
+    {"auth_key", 0, POPT_ARG_STRING, &auth_key, 0,
+            "The authentication key for the clients", "<key>"},
+    {"callsign_prefix", 0, POPT_ARG_STRING, &callsign_prefix, 0,
+            "The prefix of the client callsigns (default XX0BNC)",
+            "<prefix>"},
+    {"reflector_pid", 0, POPT_ARG_INT, &reflector_pid, 0,
+            "Measure CPU and memory usage for this reflector process",
+            "<pid>"},
+    {"output", 0, POPT_ARG_STRING, &output, 0,
+            "Write the JSON result to this file instead of stdout",
+            "<filename>"},
+    {"print_users", 0, POPT_ARG_NONE, &print_users, 0,
+            "Print the USERS and PASSWORDS configuration for the clients",
+            NULL},
+    {"version", 0, POPT_ARG_NONE, &print_version, 0,
+            "Print the application version string", NULL},
+    {NULL, 0, 0, NULL, 0}
+  };
+  int err;
+
+  optCon = poptGetContext(PROGRAM_NAME, argc, argv, optionsTable, 0);
+  poptReadDefaultConfig(optCon, 0);
+
+  err = poptGetNextOpt(optCon);
+  if (err != -1)
+  {
+    fprintf(stderr, "\t%s: %s\n",
+            poptBadOption(optCon, POPT_BADOPTION_NOALIAS),
+            poptStrerror(err));
+    exit(1);
+  }
+
+  poptFreeContext(optCon);
+
+  if (print_version)
+  {
+    std::cout << SVXREFLECTOR_VERSION << std::endl;
+    exit(0);
+  }
+
+  if ((clients < 1) || (clients > 36*36*36))
+  {
+    std::cerr << "*** ERROR: The number of clients must be between 1 and "
+              << 36*36*36 << std::endl;
+    exit(1);
+  }
+} /* parse_arguments */
+
+
+static void raise_fd_limit(rlim_t needed)
+{
+  struct rlimit rl;
+  if (getrlimit(RLIMIT_NOFILE, &rl) != 0)
+  {
+    return;
+  }
+  if (rl.rlim_cur < needed)
+  {
+    rl.rlim_cur = std::min(needed, rl.rlim_max);
+    if ((setrlimit(RLIMIT_NOFILE, &rl) != 0) || (rl.rlim_cur < needed))
+    {
+      std::cerr << "*** WARNING: The open file limit is " << rl.rlim_cur
+                << " but " << needed << " file descriptors are needed. "
+                   "Some clients will fail to connect." << std::endl;
+    }
+  }
+} /* raise_fd_limit */
+
+
+/*
+ * This file has not been truncated
+ */
@@ -47,11 +47,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <AsyncTimer.h>
-#include <AsyncAudioEncoder.h>
-#include <AsyncAudioDecoder.h>
 #include <AsyncSslCertSigningReq.h>
 #include <AsyncEncryptedUdpSocket.h>
-#include <common.h>
 
 
 /****************************************************************************
@@ -202,47 +199,22 @@ ReflectorClient::ReflectorClient(Reflector *ref, Async::FramedTcpConnection *con
       sigc::mem_fun(*this, &ReflectorClient::onSslConnectionReady));
   m_con->frameReceived.connect(
       sigc::mem_fun(*this, &ReflectorClient::onFrameReceived));
+  m_disc_timer.setTag("ReflectorClient");
+  m_disc_timer.setCoarse(true);
   m_disc_timer.expired.connect(
       sigc::mem_fun(*this, &ReflectorClient::onDiscTimeout));
+  m_heartbeat_timer.setTag("ReflectorClient");
+  m_heartbeat_timer.setCoarse(true);
+  m_heartbeat_timer.reset();
   m_heartbeat_timer.expired.connect(
       sigc::mem_fun(*this, &ReflectorClient::handleHeartbeat));
   m_renew_cert_timer.expired.connect(sigc::hide(
       sigc::mem_fun(*this, &ReflectorClient::renewClientCertificate)));
-
-  string codecs;
-  if (m_cfg->getValue("GLOBAL", "CODECS", codecs))
-  {
-    SvxLink::splitStr(m_supported_codecs, codecs, ",");
-  }
-  if (m_supported_codecs.size() > 1)
-  {
-    m_supported_codecs.erase(m_supported_codecs.begin()+1,
-                             m_supported_codecs.end());
-    cout << "*** WARNING: The GLOBAL/CODECS configuration "
-            "variable can only take one codec at the moment. Using the first "
-            "one: \"" << m_supported_codecs.front() << "\"" << endl;
-  }
-  else if (m_supported_codecs.empty())
-  {
-    string codec = "GSM";
-    if (AudioDecoder::isAvailable("OPUS") &&
-        AudioEncoder::isAvailable("OPUS"))
-    {
-      codec = "OPUS";
-    }
-    else if (AudioDecoder::isAvailable("SPEEX") &&
-             AudioEncoder::isAvailable("SPEEX"))
-    {
-      codec = "SPEEX";
-    }
-    m_supported_codecs.push_back(codec);
-  }
 } /* ReflectorClient::ReflectorClient */
 
 
 ReflectorClient::~ReflectorClient(void)
 {
-  m_status = nullptr;
   auto client_it = client_map.find(m_client_id);
   assert(client_it != client_map.end());
   client_map.erase(client_it);
@@ -267,32 +239,52 @@ void ReflectorClient::setRemoteUdpSource(const ReflectorClient::ClientSrc& src)
 } /* ReflectorClient::setRemoteUdpSource */
 
 
+Async::FramedTcpConnection::Frame ReflectorClient::packMsg(
+    const ReflectorMsg& msg)
+{
+  ReflectorMsg header(msg.type());
+  std::vector<char> buf(header.packedSize() + msg.packedSize());
+  Async::MsgBufWriter w(buf.data(), buf.size());
+  if (!header.pack(w) || !msg.pack(w))
+  {
+    cerr << "*** ERROR: Failed to pack TCP message\n";
+    return Async::FramedTcpConnection::Frame();
+  }
+  return Async::FramedTcpConnection::Frame(buf.data(), w.size());
+} /* ReflectorClient::packMsg */
+
+
 int ReflectorClient::sendMsg(const ReflectorMsg& msg)
+{
+  if (((m_con_state != STATE_CONNECTED) && (msg.type() >= 100)) ||
+      !m_con->isConnected())
+  {
+    return sendMsg(msg.type(), Async::FramedTcpConnection::Frame());
+  }
+  return sendMsg(msg.type(), packMsg(msg));
+} /* ReflectorClient::sendMsg */
+
+
+int ReflectorClient::sendMsg(uint16_t type,
+                             const Async::FramedTcpConnection::Frame& frame)
 {
   errno = 0;
 
-  if (((m_con_state != STATE_CONNECTED) && (msg.type() >= 100)) ||
+  if (((m_con_state != STATE_CONNECTED) && (type >= 100)) ||
       !m_con->isConnected())
   {
     errno = ENOTCONN;
   }
-
-  ostringstream ss;
-  if (errno == 0)
+  else if (!frame.isValid())
   {
-    m_heartbeat_tx_cnt = HEARTBEAT_TX_CNT_RESET;
-
-    ReflectorMsg header(msg.type());
-    if (!header.pack(ss) || !msg.pack(ss))
-    {
-      cerr << "*** ERROR: Failed to pack TCP message\n";
-      errno = EBADMSG;
-    }
+    errno = EBADMSG;
   }
 
   if (errno == 0)
   {
-    auto ret = m_con->write(ss.str().data(), ss.str().size());
+    m_heartbeat_tx_cnt = HEARTBEAT_TX_CNT_RESET;
+
+    auto ret = m_con->write(frame);
     if (ret >= 0)
     {
       return ret;
@@ -300,7 +292,7 @@ int ReflectorClient::sendMsg(const ReflectorMsg& msg)
   }
   std::cerr << "*** ERROR[" << m_con->remoteHost() << ":"
             << m_con->remotePort() << "]: Write to client failed due to '"
-            << strerror(errno) << "'. Message type=" << msg.type() << "."
+            << strerror(errno) << "'. Message type=" << type << "."
             << std::endl;
   disconnect();
   return -1;
@@ -349,17 +341,151 @@ void ReflectorClient::setBlock(unsigned blocktime)
 
 void ReflectorClient::updateIsTalker(void)
 {
-  if (m_status != nullptr)
+  auto talker = TGHandler::instance()->talkerForTG(m_current_tg);
+  const bool is_talker = TGHandler::instance()->showActivity(m_current_tg) &&
+                         (talker == this);
+  if (is_talker != m_is_talker)
   {
-    auto talker = TGHandler::instance()->talkerForTG(m_current_tg);
-    (*m_status)["isTalker"] = (
-        TGHandler::instance()->showActivity(m_current_tg) &&
-        (talker == this)
-        );
+    m_is_talker = is_talker;
+    tgStatusChanged();
   }
 } /* ReflectorClient:;updateIsTalker */
 
 
+void ReflectorClient::setRxStatus(const MsgSignalStrengthValuesBase::Rx& rx)
+{
+  auto it = m_rx_status.find(rx.id());
+  if (it == m_rx_status.end())
+  {
+    return;
+  }
+  RxStatus rx_status;
+  rx_status.siglev = rx.siglev();
+  rx_status.enabled = rx.enabled();
+  rx_status.sql_open = rx.sqlOpen();
+  rx_status.active = rx.active();
+  if (rx_status == it->second)
+  {
+    return;
+  }
+  it->second = rx_status;
+  m_status_gen += 1;
+  m_reflector->nodeRxStatusUpdated(this, rx.id());
+} /* ReflectorClient::setRxStatus */
+
+
+void ReflectorClient::setTxTransmit(char id, bool transmit)
+{
+  auto it = m_tx_status.find(id);
+  if ((it == m_tx_status.end()) || (it->second == transmit))
+  {
+    return;
+  }
+  it->second = transmit;
+  m_status_gen += 1;
+  m_reflector->nodeTxStatusUpdated(this, id, transmit);
+} /* ReflectorClient::setTxTransmit */
+
+
+Json::Value ReflectorClient::status(void) const
+{
+  Json::Value status(m_node_info.isObject()
+      ? m_node_info : Json::Value(Json::objectValue));
+  status["protoVer"]["majorVer"] = protoVer().majorVer();
+  status["protoVer"]["minorVer"] = protoVer().minorVer();
+  const Json::Value tg_status(tgStatus());
+  for (const auto& name : tg_status.getMemberNames())
+  {
+    status[name] = tg_status[name];
+  }
+  if (!status.isMember("qth") || !status["qth"].isArray())
+  {
+    return status;
+  }
+  Json::Value& qths(status["qth"]);
+  for (Json::Value::ArrayIndex i=0; i<qths.size(); ++i)
+  {
+    Json::Value& qth(qths[i]);
+    if (!qth.isObject())
+    {
+      continue;
+    }
+    if (qth.isMember("rx") && qth["rx"].isObject())
+    {
+      for (const auto& rx_id_str : qth["rx"].getMemberNames())
+      {
+        Json::Value& rx(qth["rx"][rx_id_str]);
+        auto it = (rx_id_str.size() == 1)
+          ? m_rx_status.find(rx_id_str[0]) : m_rx_status.end();
+        if (rx.isObject() && (it != m_rx_status.end()))
+        {
+          rx["siglev"] = it->second.siglev;
+          rx["enabled"] = it->second.enabled;
+          rx["sql_open"] = it->second.sql_open;
+          rx["active"] = it->second.active;
+        }
+      }
+    }
+    if (qth.isMember("tx") && qth["tx"].isObject())
+    {
+      for (const auto& tx_id_str : qth["tx"].getMemberNames())
+      {
+        Json::Value& tx(qth["tx"][tx_id_str]);
+        auto it = (tx_id_str.size() == 1)
+          ? m_tx_status.find(tx_id_str[0]) : m_tx_status.end();
+        if (tx.isObject() && (it != m_tx_status.end()))
+        {
+          tx["transmit"] = it->second;
+        }
+      }
+    }
+  }
+  return status;
+} /* ReflectorClient::status */
+
+
+const std::string& ReflectorClient::statusJson(void) const
+{
+  if (m_status_json_gen != m_status_gen)
+  {
+    m_status_json = Reflector::jsonString(status());
+    m_status_json_gen = m_status_gen;
+  }
+  return m_status_json;
+} /* ReflectorClient::statusJson */
+
+
+Json::Value ReflectorClient::rxStatus(char id) const
+{
+  Json::Value rx;
+  auto it = m_rx_status.find(id);
+  if (it != m_rx_status.end())
+  {
+    rx["siglev"] = it->second.siglev;
+    rx["enabled"] = it->second.enabled;
+    rx["sql_open"] = it->second.sql_open;
+    rx["active"] = it->second.active;
+  }
+  return rx;
+} /* ReflectorClient::rxStatus */
+
+
+Json::Value ReflectorClient::tgStatus(void) const
+{
+  Json::Value status(Json::objectValue);
+  status["tg"] = m_status_tg;
+  status["restrictedTG"] = m_status_restricted_tg;
+  status["isTalker"] = m_is_talker;
+  Json::Value monitored_tgs(Json::arrayValue);
+  for (const auto& tg : m_monitored_tgs)
+  {
+    monitored_tgs.append(tg);
+  }
+  status["monitoredTGs"] = monitored_tgs;
+  return status;
+} /* ReflectorClient::tgStatus */
+
+
 std::vector<uint8_t> ReflectorClient::udpCipherIV(void) const
 {
   return UdpCipher::IV{udpCipherIVRand(), 0, m_udp_cipher_iv_cntr};
@@ -865,10 +991,8 @@ void ReflectorClient::handleSelectTG(std::istream& is)
     auto talker = TGHandler::instance()->talkerForTG(m_current_tg);
     if (talker == this)
     {
-      m_reflector->broadcastUdpMsg(MsgUdpFlushSamples(),
-          mkAndFilter(
-            TgFilter(m_current_tg),
-            ExceptFilter(this)));
+      m_reflector->broadcastUdpMsgToTG(m_current_tg, MsgUdpFlushSamples(),
+          ExceptFilter(this));
     }
     else if (talker != 0)
     {
@@ -947,63 +1071,36 @@ void ReflectorClient::handleNodeInfo(std::istream& is)
     }
     jsonstr = msg.json();
   }
+  Json::Value node_info(Json::objectValue);
+  m_rx_status.clear();
+  m_tx_status.clear();
   try
   {
-    m_json_rx_map.clear();
-    m_json_tx_map.clear();
-    m_status = &(m_reflector->clientStatus(m_callsign));
-    auto& status = *m_status;
-    status.clear();
     std::istringstream is(jsonstr);
-    is >> status;
-
-    status["protoVer"]["majorVer"] = protoVer().majorVer();
-    status["protoVer"]["minorVer"] = protoVer().minorVer();
-    setMonitoredTGs(m_monitored_tgs);
-    setTg(m_current_tg);
-    if (status.isMember("qth") && status["qth"].isArray())
+    is >> node_info;
+    if (node_info.isMember("qth") && node_info["qth"].isArray())
     {
-      //std::cout << "### Found qth" << std::endl;
-      Json::Value& qths(status["qth"]);
+      const Json::Value& qths(node_info["qth"]);
       for (Json::Value::ArrayIndex i=0; i<qths.size(); ++i)
       {
-        Json::Value& qth(qths[i]);
+        const Json::Value& qth(qths[i]);
         if (qth.isMember("rx") && qth["rx"].isObject())
         {
-          //std::cout << "### Found rx" << std::endl;
           for (const auto& rx_id_str : qth["rx"].getMemberNames())
           {
-            //std::cout << "### member=" << *it << std::endl;
-            if (rx_id_str.size() == 1)
+            if ((rx_id_str.size() == 1) && qth["rx"][rx_id_str].isObject())
             {
-              char rx_id(rx_id_str[0]);
-              Json::Value& rx(qth["rx"][rx_id_str]);
-              if (rx.isObject())
-              {
-                m_json_rx_map.emplace(rx_id, rx);
-                setRxSiglev(rx_id, 0);
-                setRxEnabled(rx_id, false);
-                setRxSqlOpen(rx_id, false);
-                setRxActive(rx_id, false);
-              }
+              m_rx_status[rx_id_str[0]] = RxStatus();
             }
           }
         }
         if (qth.isMember("tx") && qth["tx"].isObject())
         {
-          //std::cout << "### Found tx" << std::endl;
           for (const auto& tx_id_str : qth["tx"].getMemberNames())
           {
-            //std::cout << "### member=" << *it << std::endl;
-            if (tx_id_str.size() == 1)
+            if ((tx_id_str.size() == 1) && qth["tx"][tx_id_str].isObject())
             {
-              char tx_id(tx_id_str[0]);
-              Json::Value& tx(qth["tx"][tx_id_str]);
-              if (tx.isObject())
-              {
-                m_json_tx_map.emplace(tx_id, tx);
-                setTxTransmit(tx_id, false);
-              }
+              m_tx_status[tx_id_str[0]] = false;
             }
           }
         }
@@ -1016,6 +1113,13 @@ void ReflectorClient::handleNodeInfo(std::istream& is)
               << "]: Failed to parse MsgNodeInfo JSON object: "
               << e.what() << std::endl;
   }
+  m_node_info = std::move(node_info);
+  if (!m_node_info.isObject())
+  {
+    m_node_info = Json::Value(Json::objectValue);
+  }
+  m_status_gen += 1;
+  m_reflector->nodeInfoUpdated(this);
 } /* ReflectorClient::handleNodeInfo */
 
 
@@ -1040,10 +1144,7 @@ void ReflectorClient::handleMsgSignalStrengthValues(std::istream& is)
     //  << " sql_open=" << rx.sqlOpen()
     //  << " active=" << rx.active()
     //  << std::endl;
-    setRxSiglev(rx.id(), rx.siglev());
-    setRxEnabled(rx.id(), rx.enabled());
-    setRxSqlOpen(rx.id(), rx.sqlOpen());
-    setRxActive(rx.id(), rx.active());
+    setRxStatus(rx);
   }
 } /* ReflectorClient::handleMsgSignalStrengthValues */
 
@@ -1335,7 +1436,7 @@ void ReflectorClient::connectionAuthenticated(const std::string& callsign)
     assert(client_callsign_map.find(m_callsign) == client_callsign_map.end());
     client_callsign_map[m_callsign] = this;
 
-    MsgServerInfo msg_srv_info(m_client_id, m_supported_codecs);
+    MsgServerInfo msg_srv_info(m_client_id, m_reflector->supportedCodecs());
     m_reflector->nodeList(msg_srv_info.nodes());
     sendMsg(msg_srv_info);
 
@@ -1412,21 +1513,12 @@ void ReflectorClient::renewClientCertificate(void)
 
 void ReflectorClient::setMonitoredTGs(const std::set<uint32_t>& tgs)
 {
+  const bool changed = (tgs != m_monitored_tgs);
   m_monitored_tgs = tgs;
-
-  if (m_status != nullptr)
+  TGHandler::instance()->setMonitoredTGs(this, tgs);
+  if (changed)
   {
-    if (!m_status->isMember("monitoredTGs") ||
-        !(*m_status)["monitoredTGs"].isArray())
-    {
-      (*m_status)["monitoredTGs"] = Json::Value(Json::arrayValue);
-    }
-    Json::Value& monitored_tgs = (*m_status)["monitoredTGs"];
-    monitored_tgs.clear();
-    for (const auto& tg : tgs)
-    {
-      monitored_tgs.append(tg);
-    }
+    tgStatusChanged();
   }
 } /* ReflectorClient::setMonitoredTGs */
 
@@ -1450,20 +1542,32 @@ void ReflectorClient::setTg(uint32_t tg)
     m_current_tg = tg;
   }
 
-  if (m_status != nullptr)
+  if (!TGHandler::instance()->showActivity(tg))
   {
-    if (!TGHandler::instance()->showActivity(tg))
-    {
-      tg = 0;
-    }
-    (*m_status)["tg"] = tg;
-    (*m_status)["restrictedTG"] = TGHandler::instance()->isRestricted(tg);
+    tg = 0;
+  }
+  const bool restricted_tg = TGHandler::instance()->isRestricted(tg);
+  if ((tg != m_status_tg) || (restricted_tg != m_status_restricted_tg))
+  {
+    m_status_tg = tg;
+    m_status_restricted_tg = restricted_tg;
+    tgStatusChanged();
   }
 
   updateIsTalker();
 } /* ReflectorClient::setTg */
 
 
+void ReflectorClient::tgStatusChanged(void)
+{
+  m_status_gen += 1;
+  if (hasStatus())
+  {
+    m_reflector->nodeTgStatusUpdated(this);
+  }
+} /* ReflectorClient::tgStatusChanged */
+
+
 
 /*
  * This file has not been truncated
@@ -62,6 +62,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "ReflectorMsg.h"
 #include "ProtoVer.h"
+#include "UdpSealer.h"
 
 
 /****************************************************************************
@@ -130,6 +131,23 @@ class ReflectorClient : public sigc::trackable
       STATE_CONNECTED
     } ConState;
 
+    /**
+     * @brief   The status of a receiver, as reported by the node
+     */
+    struct RxStatus
+    {
+      uint8_t siglev    = 0;
+      bool    enabled   = false;
+      bool    sql_open  = false;
+      bool    active    = false;
+
+      bool operator==(const RxStatus& other) const
+      {
+        return (siglev == other.siglev) && (enabled == other.enabled) &&
+               (sql_open == other.sql_open) && (active == other.active);
+      }
+    };
+
     class Filter
     {
       public:
@@ -395,6 +413,24 @@ class ReflectorClient : public sigc::trackable
      */
     int sendMsg(const ReflectorMsg& msg);
 
+    /**
+     * @brief   Send a previously packed TCP message to the remote end
+     * @param   type  The type of the message
+     * @param   frame The packed message, created using packMsg
+     * @return  On success 0 is returned or else -1
+     *
+     * Use this function when sending the same message to many clients so
+     * that the message only have to be packed once.
+     */
+    int sendMsg(uint16_t type, const Async::FramedTcpConnection::Frame& frame);
+
+    /**
+     * @brief   Pack a TCP message into a frame
+     * @param   msg The message to pack
+     * @return  Returns the frame, which is invalid if packing failed
+     */
+    static Async::FramedTcpConnection::Frame packMsg(const ReflectorMsg& msg);
+
     /**
      * @brief   Handle a received UDP message
      * @param   The received UDP message
@@ -456,28 +492,67 @@ class ReflectorClient : public sigc::trackable
     std::vector<char> rxIdList(void) const
     {
       std::vector<char> ids;
-      ids.reserve(m_json_rx_map.size());
-      for (const auto& rx : m_json_rx_map)
+      ids.reserve(m_rx_status.size());
+      for (const auto& rx : m_rx_status)
       {
         ids.push_back(rx.first);
       }
       return ids;
     }
-    void setRxSiglev(char id, uint8_t siglev)
-    {
-      setRxParam(id, "siglev", siglev);
-    }
-    void setRxEnabled(char id, bool enab) { setRxParam(id, "enabled", enab); }
-    void setRxSqlOpen(char id, bool open) { setRxParam(id, "sql_open", open); }
-    void setRxActive(char id, bool active) { setRxParam(id, "active", active); }
 
-    void setTxTransmit(char id, bool transmit)
-    {
-      setTxParam(id, "transmit", transmit);
-    }
+    /**
+     * @brief   Update the status of one of the receivers of the node
+     * @param   rx  The receiver status from a signal strength message
+     *
+     * Receivers not announced in the node info are ignored.
+     */
+    void setRxStatus(const MsgSignalStrengthValuesBase::Rx& rx);
+
+    /**
+     * @brief   Update the status of one of the transmitters of the node
+     * @param   id        The transmitter id
+     * @param   transmit  Set to \em true if the transmitter is transmitting
+     *
+     * Transmitters not announced in the node info are ignored.
+     */
+    void setTxTransmit(char id, bool transmit);
 
     void updateIsTalker(void);
 
+    /**
+     * @brief   Check if the node has status to show
+     * @return  Returns \em true if node info has been received
+     */
+    bool hasStatus(void) const { return !m_node_info.isNull(); }
+
+    /**
+     * @brief   Get the status of the node as a JSON object
+     * @return  Returns the node info amended with the current node status
+     */
+    Json::Value status(void) const;
+
+    /**
+     * @brief   Get the status of the node as a serialized JSON object
+     * @return  Returns the serialized version of what status() return
+     *
+     * The serialized object is cached until the status of the node change so
+     * it is cheap to call this function many times.
+     */
+    const std::string& statusJson(void) const;
+
+    /**
+     * @brief   Get the status of a receiver as a JSON object
+     * @param   id  The receiver id
+     * @return  Returns a JSON object or null if the receiver is unknown
+     */
+    Json::Value rxStatus(char id) const;
+
+    /**
+     * @brief   Get the part of the status that is not from the node info
+     * @return  Returns a JSON object with tg, monitored TGs and talker status
+     */
+    Json::Value tgStatus(void) const;
+
     uint32_t udpCipherIVCntrNext() { return m_udp_cipher_iv_cntr++; }
     std::vector<uint8_t> udpCipherIV(void) const;
 
@@ -485,7 +560,7 @@ class ReflectorClient : public sigc::trackable
     {
       m_udp_cipher_iv_rand = iv_rand;
     }
-    std::vector<uint8_t> udpCipherIVRand(void) const
+    const std::vector<uint8_t>& udpCipherIVRand(void) const
     {
       return m_udp_cipher_iv_rand;
     }
@@ -494,7 +569,12 @@ class ReflectorClient : public sigc::trackable
     {
       m_udp_cipher_key = key;
     }
-    std::vector<uint8_t> udpCipherKey(void) const { return m_udp_cipher_key; }
+    const std::vector<uint8_t>& udpCipherKey(void) const
+    {
+      return m_udp_cipher_key;
+    }
+
+    UdpSealer& udpSealer(void) { return m_udp_sealer; }
 
     void certificateUpdated(Async::SslX509& cert);
 
@@ -503,8 +583,8 @@ class ReflectorClient : public sigc::trackable
     using ClientMap           = std::map<ClientId, ReflectorClient*>;
     using ClientSrcMap        = std::map<ClientSrc, ReflectorClient*>;
     using ClientCallsignMap   = std::map<std::string, ReflectorClient*>;
-    using JsonRxMap           = std::map<char, Json::Value&>;
-    using JsonTxMap           = std::map<char, Json::Value&>;
+    using RxStatusMap         = std::map<char, RxStatus>;
+    using TxStatusMap         = std::map<char, bool>;
 
     static const uint16_t MIN_MAJOR_VER = 0;
     static const uint16_t MIN_MINOR_VER = 6;
@@ -542,16 +622,22 @@ class ReflectorClient : public sigc::trackable
     unsigned                    m_blocktime;
     unsigned                    m_remaining_blocktime;
     ProtoVer                    m_client_proto_ver;
-    std::vector<std::string>    m_supported_codecs;
     uint32_t                    m_current_tg;
     std::set<uint32_t>          m_monitored_tgs;
-    JsonRxMap                   m_json_rx_map;
-    JsonTxMap                   m_json_tx_map;
+    Json::Value                 m_node_info;
+    RxStatusMap                 m_rx_status;
+    TxStatusMap                 m_tx_status;
+    uint32_t                    m_status_tg             {0};
+    bool                        m_status_restricted_tg  {false};
+    bool                        m_is_talker             {false};
+    uint64_t                    m_status_gen            {1};
+    mutable uint64_t            m_status_json_gen       {0};
+    mutable std::string         m_status_json;
     std::vector<uint8_t>        m_udp_cipher_iv_rand;
     std::vector<uint8_t>        m_udp_cipher_key;
     UdpCipher::IVCntr           m_udp_cipher_iv_cntr;
+    UdpSealer                   m_udp_sealer;
     Async::AtTimer              m_renew_cert_timer;
-    Json::Value*                m_status                {nullptr};
 
     static ClientId newClientId(ReflectorClient* client);
 
@@ -584,26 +670,7 @@ class ReflectorClient : public sigc::trackable
     void renewClientCertificate(void);
     void setMonitoredTGs(const std::set<uint32_t>& tgs);
     void setTg(uint32_t tg);
-
-    template <typename T>
-    void setRxParam(char id, const std::string& name, const T& value)
-    {
-      auto it = m_json_rx_map.find(id);
-      if (it != m_json_rx_map.end())
-      {
-        (it->second)[name] = value;
-      }
-    }
-
-    template <typename T>
-    void setTxParam(char id, const std::string& name, const T& value)
-    {
-      auto it = m_json_tx_map.find(id);
-      if (it != m_json_tx_map.end())
-      {
-        (it->second)[name] = value;
-      }
-    }
+    void tgStatusChanged(void);
 
 };  /* class ReflectorClient */
 
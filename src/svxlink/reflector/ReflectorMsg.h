@@ -1540,46 +1540,22 @@ namespace UdpCipher
 
       operator std::vector<uint8_t>(void) const
       {
-        std::vector<uint8_t> iv;
-        iv.reserve(IVLEN);
-        push_ostreambuf<decltype(iv)> posbuf(iv);
-        std::ostream pos(&posbuf);
-        pack(pos);
+        std::vector<uint8_t> iv(IVLEN);
+        Async::MsgBufWriter w(iv.data(), iv.size());
+        pack(w);
         return iv;
       }
 
       ASYNC_MSG_MEMBERS(m_rand, m_client_id, m_cntr)
 
     private:
-      template <typename Container>
-      struct push_ostreambuf : public std::streambuf
-      {
-          push_ostreambuf(Container& ctr) : m_ctr(ctr) {}
-
-        protected:
-          std::streamsize xsputn(const char_type* s, std::streamsize n) override
-          {
-            for (std::streamsize i=0; i<n; ++i)
-            {
-              m_ctr.push_back(s[i]);
-            }
-            return n;
-          }
-
-          int_type overflow(int_type ch) override
-          {
-            m_ctr.push_back(ch);
-            return 1;
-          }
-
-        private:
-          Container& m_ctr;
-      };
-
       uint8_t   m_rand[IVRANDLEN] = {0};
       ClientId  m_client_id       = 0;
       IVCntr    m_cntr            = 0;
   }; /* IV */
+
+  static_assert(AAD::fixedPackedSize() == AADLEN, "Unexpected AAD size");
+  static_assert(IV::fixedPackedSize() == IVLEN, "Unexpected IV size");
 }; /* namespace UdpCipher */
 
 
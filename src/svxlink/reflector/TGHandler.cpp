@@ -113,6 +113,7 @@ TGHandler::TGHandler(void)
   : m_cfg(0), m_timeout_timer(1000, Async::Timer::TYPE_PERIODIC),
     m_sql_timeout(0), m_sql_timeout_blocktime(60)
 {
+  m_timeout_timer.setTag("TGHandler");
   m_timeout_timer.expired.connect(
       mem_fun(*this, &TGHandler::checkTimers));
 } /* TGHandler::TGHandler */
@@ -128,6 +129,14 @@ TGHandler::~TGHandler(void)
 } /* TGHandler::~TGHandler */
 
 
+void TGHandler::setConfig(Async::Config* cfg)
+{
+  m_cfg = cfg;
+  m_tg_cfg_map.clear();
+  m_cfg->valueUpdated.connect(sigc::mem_fun(*this, &TGHandler::cfgUpdated));
+} /* TGHandler::setConfig */
+
+
 void TGHandler::setSqlTimeoutBlocktime(unsigned sql_timeout_blocktime)
 {
   m_sql_timeout_blocktime = std::max(sql_timeout_blocktime, 1U);
@@ -163,13 +172,12 @@ bool TGHandler::switchTo(ReflectorClient *client, uint32_t tg)
     else
     {
       tg_info = new TGInfo(tg);
-      std::ostringstream ss;
-      ss << "TG#" << tg;
-      m_cfg->getValue(ss.str(), "AUTO_QSY_AFTER", tg_info->auto_qsy_after_s);
+      tg_info->auto_qsy_after_s = tgConfig(tg).auto_qsy_after_s;
       m_id_map[tg] = tg_info;
     }
     tg_info->clients.insert(client);
     m_client_map[client] = tg_info;
+    m_listener_map[tg].selected.push_back(client);
   }
 
   //printTGStatus();
@@ -180,6 +188,8 @@ bool TGHandler::switchTo(ReflectorClient *client, uint32_t tg)
 
 void TGHandler::removeClient(ReflectorClient* client)
 {
+  setMonitoredTGs(client, std::set<uint32_t>());
+
   ClientMap::iterator client_map_it = m_client_map.find(client);
   if (client_map_it != m_client_map.end())
   {
@@ -206,6 +216,70 @@ const TGHandler::ClientSet& TGHandler::clientsForTG(uint32_t tg) const
 } /* TGHandler::clientsForTG */
 
 
+const TGHandler::ClientList& TGHandler::selectedClientsForTG(uint32_t tg) const
+{
+  static const TGHandler::ClientList empty_list;
+  ListenerMap::const_iterator it = m_listener_map.find(tg);
+  if (it == m_listener_map.end())
+  {
+    return empty_list;
+  }
+  return it->second.selected;
+} /* TGHandler::selectedClientsForTG */
+
+
+const TGHandler::ClientList& TGHandler::monitoringClientsForTG(
+    uint32_t tg) const
+{
+  static const TGHandler::ClientList empty_list;
+  ListenerMap::const_iterator it = m_listener_map.find(tg);
+  if (it == m_listener_map.end())
+  {
+    return empty_list;
+  }
+  return it->second.monitoring;
+} /* TGHandler::monitoringClientsForTG */
+
+
+void TGHandler::setMonitoredTGs(ReflectorClient* client,
+                                const std::set<uint32_t>& tgs)
+{
+  MonitorMap::iterator it = m_monitor_map.find(client);
+  if (it != m_monitor_map.end())
+  {
+    for (uint32_t tg : it->second)
+    {
+      if (tgs.count(tg) == 0)
+      {
+        removeListener(tg, &Listeners::monitoring, client);
+      }
+    }
+  }
+  else if (tgs.empty())
+  {
+    return;
+  }
+
+  std::set<uint32_t>& old_tgs = m_monitor_map[client];
+  for (uint32_t tg : tgs)
+  {
+    if (old_tgs.count(tg) == 0)
+    {
+      m_listener_map[tg].monitoring.push_back(client);
+    }
+  }
+
+  if (tgs.empty())
+  {
+    m_monitor_map.erase(client);
+  }
+  else
+  {
+    old_tgs = tgs;
+  }
+} /* TGHandler::setMonitoredTGs */
+
+
 void TGHandler::setTalkerForTG(uint32_t tg, ReflectorClient* new_talker)
 {
   IdMap::const_iterator id_map_it = m_id_map.find(tg);
@@ -265,27 +339,18 @@ uint32_t TGHandler::TGForClient(ReflectorClient* client)
 
 bool TGHandler::allowTgSelection(ReflectorClient *client, uint32_t tg)
 {
-  std::ostringstream ss;
-  ss << "TG#" << tg;
-  try
+  const TGConfig& tg_cfg = tgConfig(tg);
+  if (!tg_cfg.allow_ok)
   {
-    std::string allow;
-    if (m_cfg->getValue(ss.str(), "ALLOW", allow))
-    {
-      if (!std::regex_match(client->callsign(), std::regex(allow)))
-      {
-        return false;
-      }
-      //std::cout << "### " << client->callsign() << " Match!" << std::endl;
-    }
-    return true;
+    return false;
   }
-  catch (std::regex_error& e)
+  if (tg_cfg.is_restricted &&
+      !std::regex_match(client->callsign(), tg_cfg.allow))
   {
-    std::cerr << "*** WARNING: Regular expression parsing error in "
-              << ss.str() << "/ALLOW: " << e.what() << std::endl;
+    return false;
   }
-  return false;
+  //std::cout << "### " << client->callsign() << " Match!" << std::endl;
+  return true;
 } /* TGHandler::allowTgSelection */
 
 
@@ -296,45 +361,29 @@ bool TGHandler::allowTgMonitoring(ReflectorClient *client, uint32_t tg)
     return false;
   }
 
-  std::ostringstream ss;
-  ss << "TG#" << tg;
-  try
+  const TGConfig& tg_cfg = tgConfig(tg);
+  if (!tg_cfg.allow_monitor_ok)
   {
-    std::string allow;
-    if (m_cfg->getValue(ss.str(), "ALLOW_MONITOR", allow))
-    {
-      if (!std::regex_match(client->callsign(), std::regex(allow)))
-      {
-        return false;
-      }
-    }
-    return true;
+    return false;
   }
-  catch (std::regex_error& e)
+  if (tg_cfg.has_allow_monitor &&
+      !std::regex_match(client->callsign(), tg_cfg.allow_monitor))
   {
-    std::cerr << "*** WARNING: Regular expression parsing error in "
-              << ss.str() << "/ALLOW_MONITOR: " << e.what() << std::endl;
+    return false;
   }
-  return false;
+  return true;
 } /* TGHandler::allowTgMonitoring */
 
 
 bool TGHandler::showActivity(uint32_t tg) const
 {
-  std::ostringstream ss;
-  ss << "TG#" << tg;
-  bool show_activity = true;
-  m_cfg->getValue(ss.str(), "SHOW_ACTIVITY", show_activity);
-  return show_activity;
+  return tgConfig(tg).show_activity;
 } /* TGHandler::showActivity */
 
 
 bool TGHandler::isRestricted(uint32_t tg) const
 {
-  std::ostringstream ss;
-  ss << "TG#" << tg;
-  std::string allow;
-  return m_cfg->getValue(ss.str(), "ALLOW", allow);
+  return tgConfig(tg).is_restricted;
 } /* TGHandler::isRestricted */
 
 
@@ -393,6 +442,7 @@ void TGHandler::removeClientP(TGInfo *tg_info, ReflectorClient* client)
   }
   tg_info->clients.erase(client);
   m_client_map.erase(client);
+  removeListener(tg_info->id, &Listeners::selected, client);
   if (tg_info->clients.empty())
   {
     m_id_map.erase(tg_info->id);
@@ -401,6 +451,32 @@ void TGHandler::removeClientP(TGInfo *tg_info, ReflectorClient* client)
 } /* TGHandler::removeClientP */
 
 
+void TGHandler::removeListener(uint32_t tg, ClientList Listeners::*list,
+                               ReflectorClient* client)
+{
+  ListenerMap::iterator it = m_listener_map.find(tg);
+  if (it == m_listener_map.end())
+  {
+    return;
+  }
+  Listeners& listeners = it->second;
+  ClientList& clients = listeners.*list;
+  ClientList::iterator client_it =
+    std::find(clients.begin(), clients.end(), client);
+  if (client_it != clients.end())
+  {
+      // The order is not important so just move the last client into the
+      // hole to avoid moving the rest of the list
+    *client_it = clients.back();
+    clients.pop_back();
+  }
+  if (listeners.selected.empty() && listeners.monitoring.empty())
+  {
+    m_listener_map.erase(it);
+  }
+} /* TGHandler::removeListener */
+
+
 void TGHandler::printTGStatus(void)
 {
   std::cout << "### ----------- BEGIN ----------------" << std::endl;
@@ -425,6 +501,83 @@ void TGHandler::printTGStatus(void)
 } /* TGHandler::printTGStatus */
 
 
+const TGHandler::TGConfig& TGHandler::tgConfig(uint32_t tg) const
+{
+  TGConfigMap::const_iterator it = m_tg_cfg_map.find(tg);
+  if (it != m_tg_cfg_map.end())
+  {
+    return it->second;
+  }
+
+    // Talk groups without a configuration section share the default
+    // configuration. The talk group ids are chosen by the clients so only
+    // configured talk groups may be added to the cache.
+  static const TGConfig default_tg_cfg;
+  if (m_cfg == 0)
+  {
+    return default_tg_cfg;
+  }
+  Async::ConfigSnapshot::Ptr snap = m_cfg->snapshot();
+  std::ostringstream ss;
+  ss << "TG#" << tg;
+  const std::string section = ss.str();
+  if (!snap->hasSection(section))
+  {
+    return default_tg_cfg;
+  }
+
+    // Parse the configuration for the talk group once and then keep it
+    // until a configuration variable in a TG# section is updated
+  TGConfig& tg_cfg = m_tg_cfg_map[tg];
+
+  const std::string* allow = snap->find(section, "ALLOW");
+  if (allow != nullptr)
+  {
+    tg_cfg.is_restricted = true;
+    try
+    {
+      tg_cfg.allow = std::regex(*allow);
+    }
+    catch (std::regex_error& e)
+    {
+      std::cerr << "*** WARNING: Regular expression parsing error in "
+                << section << "/ALLOW: " << e.what() << std::endl;
+      tg_cfg.allow_ok = false;
+    }
+  }
+
+  const std::string* allow_monitor = snap->find(section, "ALLOW_MONITOR");
+  if (allow_monitor != nullptr)
+  {
+    tg_cfg.has_allow_monitor = true;
+    try
+    {
+      tg_cfg.allow_monitor = std::regex(*allow_monitor);
+    }
+    catch (std::regex_error& e)
+    {
+      std::cerr << "*** WARNING: Regular expression parsing error in "
+                << section << "/ALLOW_MONITOR: " << e.what() << std::endl;
+      tg_cfg.allow_monitor_ok = false;
+    }
+  }
+
+  snap->getValue(section, "SHOW_ACTIVITY", tg_cfg.show_activity);
+  snap->getValue(section, "AUTO_QSY_AFTER", tg_cfg.auto_qsy_after_s);
+
+  return tg_cfg;
+} /* TGHandler::tgConfig */
+
+
+void TGHandler::cfgUpdated(const std::string& section, const std::string& tag)
+{
+  if (section.compare(0, 3, "TG#") == 0)
+  {
+    m_tg_cfg_map.clear();
+  }
+} /* TGHandler::cfgUpdated */
+
+
 /*
  * This file has not been truncated
  */
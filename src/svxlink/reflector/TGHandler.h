@@ -36,6 +36,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <map>
 #include <set>
+#include <vector>
+#include <unordered_map>
+#include <regex>
 #include <sigc++/sigc++.h>
 #include <sys/time.h>
 
@@ -117,7 +120,8 @@ the system.
 class TGHandler : public sigc::trackable
 {
   public:
-    typedef std::set<ReflectorClient*> ClientSet;
+    typedef std::set<ReflectorClient*>    ClientSet;
+    typedef std::vector<ReflectorClient*> ClientList;
 
     static TGHandler* instance(void)
     {
@@ -140,7 +144,7 @@ class TGHandler : public sigc::trackable
      * @param   param1 Description_of_param1
      * @return  Return_value_of_this_member_function
      */
-    void setConfig(const Async::Config* cfg) { m_cfg = cfg; }
+    void setConfig(Async::Config* cfg);
 
     unsigned sqlTimeout(void) const { return m_sql_timeout; }
     void setSqlTimeout(unsigned sql_timeout) { m_sql_timeout = sql_timeout; }
@@ -157,6 +161,35 @@ class TGHandler : public sigc::trackable
 
     const ClientSet& clientsForTG(uint32_t tg) const;
 
+    /**
+     * @brief   Get the clients that have selected the given talk group
+     * @param   tg The talk group
+     * @return  Returns the list of clients, in no particular order
+     *
+     * This list is kept up to date as clients switch talk group or
+     * disconnect so that audio can be sent to the clients on a talk group
+     * without looking at every connected client.
+     */
+    const ClientList& selectedClientsForTG(uint32_t tg) const;
+
+    /**
+     * @brief   Get the clients that monitor the given talk group
+     * @param   tg The talk group
+     * @return  Returns the list of clients, in no particular order
+     *
+     * A client that both monitor and have selected a talk group will be
+     * found in this list as well as in the list of selected clients.
+     */
+    const ClientList& monitoringClientsForTG(uint32_t tg) const;
+
+    /**
+     * @brief   Set the talk groups monitored by a client
+     * @param   client The client
+     * @param   tgs The talk groups that the client monitor
+     */
+    void setMonitoredTGs(ReflectorClient* client,
+                         const std::set<uint32_t>& tgs);
+
     void setTalkerForTG(uint32_t tg, ReflectorClient* client);
 
     ReflectorClient* talkerForTG(uint32_t tg) const;
@@ -196,12 +229,34 @@ class TGHandler : public sigc::trackable
         timerclear(&last_talker_timestamp);
       }
     };
+    struct TGConfig
+    {
+      bool        is_restricted     = false;
+      bool        allow_ok          = true;
+      std::regex  allow;
+      bool        has_allow_monitor = false;
+      bool        allow_monitor_ok  = true;
+      std::regex  allow_monitor;
+      bool        show_activity     = true;
+      time_t      auto_qsy_after_s  = 0;
+    };
     typedef std::map<uint32_t, TGInfo*>               IdMap;
     typedef std::map<const ReflectorClient*, TGInfo*> ClientMap;
+    typedef std::map<uint32_t, TGConfig>              TGConfigMap;
+    struct Listeners
+    {
+      ClientList  selected;
+      ClientList  monitoring;
+    };
+    typedef std::unordered_map<uint32_t, Listeners>   ListenerMap;
+    typedef std::map<const ReflectorClient*, std::set<uint32_t>> MonitorMap;
 
-    const Async::Config*  m_cfg;
+    Async::Config*        m_cfg;
+    mutable TGConfigMap   m_tg_cfg_map;
     IdMap                 m_id_map;
     ClientMap             m_client_map;
+    ListenerMap           m_listener_map;
+    MonitorMap            m_monitor_map;
     Async::Timer          m_timeout_timer;
     unsigned              m_sql_timeout;
     unsigned              m_sql_timeout_blocktime;
@@ -210,7 +265,11 @@ class TGHandler : public sigc::trackable
     TGHandler& operator=(const TGHandler&);
     void checkTimers(Async::Timer *t);
     void removeClientP(TGInfo *tg_info, ReflectorClient* client);
+    void removeListener(uint32_t tg, ClientList Listeners::*list,
+                        ReflectorClient* client);
     void printTGStatus(void);
+    const TGConfig& tgConfig(uint32_t tg) const;
+    void cfgUpdated(const std::string& section, const std::string& tag);
 };  /* class TGHandler */
 
 
@@ -0,0 +1,276 @@
+/**
+@file   UdpFanoutBench.cpp
+@brief  Microbenchmark for the encryption of UDP audio sent to many clients
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+Measure how many received audio frames per second the reflector can encrypt
+for a given number of listeners, without any network I/O. Two methods are
+compared. The "rekey" method is how Async::EncryptedUdpSocket work: the
+message is packed for every client and the key and IV are set up in a shared
+cipher context before each encryption. The "sealer" method pack the message
+once per frame and use a pre-keyed UdpSealer per client so that only the IV
+is set up before each encryption.
+
+\verbatim
+Usage: UdpFanoutBench [-l listeners,...] [-d seconds] [-p payload bytes]
+\endverbatim
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#include <stdint.h>
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#include <unistd.h>
+#include <openssl/rand.h>
+
+#include <AsyncMsg.h>
+
+#include "ReflectorMsg.h"
+#include "UdpSealer.h"
+
+using namespace std;
+
+
+namespace {
+  struct Listener
+  {
+    std::vector<uint8_t>  key;
+    std::vector<uint8_t>  iv_rand;
+    UdpCipher::IVCntr     iv_cntr = 0;
+    UdpSealer             sealer;
+  };
+
+  using Clock = std::chrono::steady_clock;
+
+  const EVP_CIPHER* cipher = nullptr;
+  volatile size_t sink = 0;
+
+  bool sealRekey(EVP_CIPHER_CTX* ctx, Listener& l, const MsgUdpAudio& msg,
+                 std::vector<uint8_t>& plain, std::vector<uint8_t>& out)
+  {
+    ReflectorUdpMsg header(msg.type());
+    Async::MsgBufWriter w(plain.data(), plain.size());
+    if (!header.pack(w) || !msg.pack(w))
+    {
+      return false;
+    }
+    std::vector<uint8_t> iv = UdpCipher::IV{l.iv_rand, 0, l.iv_cntr};
+    UdpCipher::AAD aad{l.iv_cntr++};
+    char aad_buf[UdpCipher::AAD::fixedPackedSize()];
+    Async::MsgBufWriter aadw(aad_buf, sizeof(aad_buf));
+    if (!aad.pack(aadw) ||
+        !EVP_EncryptInit_ex(ctx, NULL, NULL, l.key.data(), iv.data()))
+    {
+      return false;
+    }
+    int outlen = 0;
+    std::memcpy(out.data(), aad_buf, UdpCipher::AADLEN);
+    if (!EVP_EncryptUpdate(ctx, nullptr, &outlen,
+                           reinterpret_cast<uint8_t*>(aad_buf),
+                           UdpCipher::AADLEN))
+    {
+      return false;
+    }
+    uint8_t* outp = out.data() + UdpCipher::AADLEN + UdpCipher::TAGLEN;
+    int totlen = UdpCipher::AADLEN + UdpCipher::TAGLEN;
+    if (!EVP_EncryptUpdate(ctx, outp, &outlen, plain.data(), w.size()))
+    {
+      return false;
+    }
+    totlen += outlen;
+    if (!EVP_EncryptFinal_ex(ctx, outp + outlen, &outlen) ||
+        !EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG, UdpCipher::TAGLEN,
+                             out.data() + UdpCipher::AADLEN))
+    {
+      return false;
+    }
+    sink += totlen + outlen;
+    return true;
+  }
+
+  double runRekey(std::vector<Listener>& listeners, const MsgUdpAudio& msg,
+                  double duration)
+  {
+    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+    EVP_EncryptInit_ex(ctx, cipher, NULL, NULL, NULL);
+    ReflectorUdpMsg header(msg.type());
+    std::vector<uint8_t> plain(header.packedSize() + msg.packedSize());
+    std::vector<uint8_t> out(UdpSealer::maxSealedSize(plain.size()));
+    uint64_t frames = 0;
+    auto start = Clock::now();
+    std::chrono::duration<double> elapsed(0);
+    do
+    {
+      for (auto& l : listeners)
+      {
+        if (!sealRekey(ctx, l, msg, plain, out))
+        {
+          std::cerr << "*** ERROR: Encryption failed" << std::endl;
+          exit(1);
+        }
+      }
+      ++frames;
+      elapsed = Clock::now() - start;
+    } while (elapsed.count() < duration);
+    EVP_CIPHER_CTX_free(ctx);
+    return frames / elapsed.count();
+  }
+
+  double runSealer(std::vector<Listener>& listeners, const MsgUdpAudio& msg,
+                   double duration)
+  {
+    ReflectorUdpMsg header(msg.type());
+    std::vector<uint8_t> plain(header.packedSize() + msg.packedSize());
+    std::vector<uint8_t> out(UdpSealer::maxSealedSize(plain.size()));
+    uint64_t frames = 0;
+    auto start = Clock::now();
+    std::chrono::duration<double> elapsed(0);
+    do
+    {
+      Async::MsgBufWriter w(plain.data(), plain.size());
+      if (!header.pack(w) || !msg.pack(w))
+      {
+        std::cerr << "*** ERROR: Packing failed" << std::endl;
+        exit(1);
+      }
+      for (auto& l : listeners)
+      {
+        if (!l.sealer.setKey(cipher, l.key.data(), l.key.size()))
+        {
+          std::cerr << "*** ERROR: Setting the key failed" << std::endl;
+          exit(1);
+        }
+        int len = l.sealer.seal(l.iv_rand.data(), l.iv_cntr++,
+                                plain.data(), w.size(), out.data());
+        if (len < 0)
+        {
+          std::cerr << "*** ERROR: Encryption failed" << std::endl;
+          exit(1);
+        }
+        sink += len;
+      }
+      ++frames;
+      elapsed = Clock::now() - start;
+    } while (elapsed.count() < duration);
+    return frames / elapsed.count();
+  }
+
+  void usage(const char* prog)
+  {
+    std::cerr << "Usage: " << prog
+              << " [-l listeners,...] [-d seconds] [-p payload bytes]"
+              << std::endl;
+  }
+};
+
+
+int main(int argc, char **argv)
+{
+  std::vector<unsigned> listener_counts{1, 10, 50, 100, 250, 500, 1000};
+  double duration = 1.0;
+  size_t payload_size = 80;   // About one 20ms OPUS frame
+
+  int opt;
+  while ((opt = getopt(argc, argv, "l:d:p:h")) != -1)
+  {
+    switch (opt)
+    {
+      case 'l':
+      {
+        listener_counts.clear();
+        std::istringstream is(optarg);
+        std::string cnt;
+        while (std::getline(is, cnt, ','))
+        {
+          listener_counts.push_back(std::atoi(cnt.c_str()));
+        }
+        break;
+      }
+      case 'd':
+        duration = std::atof(optarg);
+        break;
+      case 'p':
+        payload_size = std::atoi(optarg);
+        break;
+      default:
+        usage(argv[0]);
+        return (opt == 'h') ? 0 : 1;
+    }
+  }
+
+  cipher = EVP_get_cipherbyname(UdpCipher::NAME);
+  if (cipher == nullptr)
+  {
+    std::cerr << "*** ERROR: Cipher " << UdpCipher::NAME << " not available"
+              << std::endl;
+    return 1;
+  }
+
+  std::vector<uint8_t> audio(payload_size);
+  for (size_t i=0; i<audio.size(); ++i)
+  {
+    audio[i] = i;
+  }
+  MsgUdpAudio msg(audio.data(), audio.size());
+
+  std::cout << "# cipher=" << UdpCipher::NAME
+            << " payload=" << payload_size
+            << " duration=" << duration << "s" << std::endl;
+  std::cout << std::setw(10) << "listeners"
+            << std::setw(16) << "rekey_frames/s"
+            << std::setw(17) << "sealer_frames/s"
+            << std::setw(10) << "speedup" << std::endl;
+  for (unsigned cnt : listener_counts)
+  {
+    if (cnt == 0)
+    {
+      continue;
+    }
+    std::vector<Listener> listeners(cnt);
+    for (auto& l : listeners)
+    {
+      l.key.resize(EVP_CIPHER_key_length(cipher));
+      l.iv_rand.resize(UdpCipher::IVRANDLEN);
+      RAND_bytes(l.key.data(), l.key.size());
+      RAND_bytes(l.iv_rand.data(), l.iv_rand.size());
+    }
+    double rekey = runRekey(listeners, msg, duration);
+    double sealer = runSealer(listeners, msg, duration);
+    std::cout << std::fixed << std::setprecision(0)
+              << std::setw(10) << cnt
+              << std::setw(16) << rekey
+              << std::setw(17) << sealer
+              << std::setw(10) << std::setprecision(2) << (sealer / rekey)
+              << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,233 @@
+/**
+@file   UdpSealer.cpp
+@brief  Encrypt UDP datagrams for one client using a pre-keyed context
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <endian.h>
+
+#include <cstring>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "UdpSealer.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+UdpSealer::UdpSealer(void)
+{
+  std::memset(m_key, 0, sizeof(m_key));
+} /* UdpSealer::UdpSealer */
+
+
+UdpSealer::~UdpSealer(void)
+{
+  EVP_CIPHER_CTX_free(m_ctx);
+} /* UdpSealer::~UdpSealer */
+
+
+bool UdpSealer::setKey(const EVP_CIPHER* cipher, const uint8_t* key,
+                       size_t key_len)
+{
+  if ((cipher == m_cipher) && (key_len == m_key_len) &&
+      (std::memcmp(key, m_key, key_len) == 0))
+  {
+    return true;
+  }
+
+  m_cipher = nullptr;
+  if ((cipher == nullptr) || (key_len > sizeof(m_key)) ||
+      (static_cast<int>(key_len) != EVP_CIPHER_key_length(cipher)) ||
+      (EVP_CIPHER_iv_length(cipher) != UdpCipher::IVLEN))
+  {
+    return false;
+  }
+
+  if (m_ctx == nullptr)
+  {
+    m_ctx = EVP_CIPHER_CTX_new();
+    if (m_ctx == nullptr)
+    {
+      return false;
+    }
+  }
+
+    // Set up the cipher and expand the key once. Only the IV is set for
+    // each datagram after this.
+  if (!EVP_EncryptInit_ex(m_ctx, cipher, NULL, key, NULL))
+  {
+    return false;
+  }
+  m_cipher = cipher;
+  m_key_len = key_len;
+  std::memcpy(m_key, key, key_len);
+  return true;
+} /* UdpSealer::setKey */
+
+
+int UdpSealer::seal(const uint8_t* iv_rand, UdpCipher::IVCntr iv_cntr,
+                    const uint8_t* payload, size_t payload_len,
+                    uint8_t* outbuf)
+{
+  if (m_cipher == nullptr)
+  {
+    return -1;
+  }
+
+    // The IV is the random part, a client ID which is always zero for
+    // datagrams sent by the reflector, and the counter in network order
+  uint8_t iv[UdpCipher::IVLEN];
+  std::memcpy(iv, iv_rand, UdpCipher::IVRANDLEN);
+  const ReflectorUdpMsg::ClientId iv_client_id = 0;
+  std::memcpy(iv + UdpCipher::IVRANDLEN, &iv_client_id,
+              sizeof(iv_client_id));
+  const uint32_t be_cntr = htobe32(iv_cntr);
+  std::memcpy(iv + UdpCipher::IVRANDLEN + sizeof(iv_client_id), &be_cntr,
+              sizeof(be_cntr));
+  if (!EVP_EncryptInit_ex(m_ctx, NULL, NULL, NULL, iv))
+  {
+    return -1;
+  }
+
+  uint8_t* aad = outbuf;
+  std::memcpy(aad, &be_cntr, UdpCipher::AADLEN);
+  int outlen = 0;
+  if (!EVP_EncryptUpdate(m_ctx, nullptr, &outlen, aad, UdpCipher::AADLEN))
+  {
+    return -1;
+  }
+  uint8_t* outbufp = outbuf + UdpCipher::AADLEN + UdpCipher::TAGLEN;
+  int totoutlen = UdpCipher::AADLEN + UdpCipher::TAGLEN;
+  if (!EVP_EncryptUpdate(m_ctx, outbufp, &outlen, payload, payload_len))
+  {
+    return -1;
+  }
+  outbufp += outlen;
+  totoutlen += outlen;
+  if (!EVP_EncryptFinal_ex(m_ctx, outbufp, &outlen))
+  {
+    return -1;
+  }
+  totoutlen += outlen;
+  if (!EVP_CIPHER_CTX_ctrl(m_ctx, EVP_CTRL_AEAD_GET_TAG, UdpCipher::TAGLEN,
+                           outbuf + UdpCipher::AADLEN))
+  {
+    return -1;
+  }
+  return totoutlen;
+} /* UdpSealer::seal */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+
+
+/*
+ * This file has not been truncated
+ */
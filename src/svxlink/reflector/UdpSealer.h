@@ -0,0 +1,202 @@
+/**
+@file   UdpSealer.h
+@brief  Encrypt UDP datagrams for one client using a pre-keyed context
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef UDP_SEALER_INCLUDED
+#define UDP_SEALER_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <openssl/evp.h>
+
+#include <cstddef>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "ReflectorMsg.h"
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief  Encrypt UDP datagrams for one client using a pre-keyed context
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+Async::EncryptedUdpSocket use one cipher context for all peers so the key,
+and thereby the expanded key schedule, have to be set up again for every
+datagram sent to a new peer. An object of this class instead keep a cipher
+context for one client. The key is only set up when it change so sealing a
+datagram just set the IV and run one AEAD encryption.
+
+The sealed datagram have the same layout as the one produced by
+Async::EncryptedUdpSocket::write: AAD (the IV counter), tag and ciphertext.
+
+An object is not thread safe but different objects may be used from
+different threads at the same time.
+*/
+class UdpSealer
+{
+  public:
+    /**
+     * @brief   Find out how large the output buffer must be
+     * @param   payload_len The length of the plaintext payload
+     * @return  Returns the largest possible size of a sealed datagram
+     */
+    static size_t maxSealedSize(size_t payload_len)
+    {
+      return UdpCipher::AADLEN + UdpCipher::TAGLEN + payload_len +
+             EVP_MAX_BLOCK_LENGTH;
+    }
+
+    /**
+     * @brief   Default constructor
+     */
+    UdpSealer(void);
+
+    /**
+     * @brief   Disallow copy construction
+     */
+    UdpSealer(const UdpSealer&) = delete;
+
+    /**
+     * @brief   Disallow copy assignment
+     */
+    UdpSealer& operator=(const UdpSealer&) = delete;
+
+    /**
+     * @brief   Destructor
+     */
+    ~UdpSealer(void);
+
+    /**
+     * @brief   Set the cipher and key to use
+     * @param   cipher  The cipher to use
+     * @param   key     The cipher key
+     * @param   key_len The length of the key
+     * @return  Returns \em true on success or else \em false
+     *
+     * Nothing is done if the cipher and key are the same as the last time
+     * this function was called so it is cheap to call it before every seal.
+     */
+    bool setKey(const EVP_CIPHER* cipher, const uint8_t* key, size_t key_len);
+
+    /**
+     * @brief   Encrypt a datagram
+     * @param   iv_rand     The random part of the IV, UdpCipher::IVRANDLEN
+     * @param   iv_cntr     The IV counter to use for this datagram
+     * @param   payload     The plaintext payload
+     * @param   payload_len The length of the payload
+     * @param   outbuf      Where to store the sealed datagram
+     * @return  Returns the size of the sealed datagram or -1 on error
+     *
+     * The output buffer must be at least maxSealedSize(payload_len) bytes.
+     */
+    int seal(const uint8_t* iv_rand, UdpCipher::IVCntr iv_cntr,
+             const uint8_t* payload, size_t payload_len, uint8_t* outbuf);
+
+  protected:
+
+  private:
+    EVP_CIPHER_CTX*   m_ctx     = nullptr;
+    const EVP_CIPHER* m_cipher  = nullptr;
+    size_t            m_key_len = 0;
+    uint8_t           m_key[EVP_MAX_KEY_LENGTH];
+
+};  /* class UdpSealer */
+
+
+//} /* namespace */
+
+#endif /* UDP_SEALER_INCLUDED */
+
+/*
+ * This file has not been truncated
+ */
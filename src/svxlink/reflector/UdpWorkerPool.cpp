@@ -0,0 +1,531 @@
+/**
+@file   UdpWorkerPool.cpp
+@brief  A pool of threads used to encrypt and send UDP datagrams
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <errno.h>
+#include <openssl/evp.h>
+
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cassert>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncEncryptedUdpSocket.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "UdpWorkerPool.h"
+#include "UdpSealer.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+class UdpWorkerPool::Worker
+{
+  public:
+    struct Datagram
+    {
+      PayloadPtr          payload;
+      struct sockaddr_in  addr;
+      ClientId            client_id;
+      UdpCipher::IVCntr   iv_cntr;
+      uint8_t             iv_rand[UdpCipher::IVRANDLEN];
+      uint8_t             key[EVP_MAX_KEY_LENGTH];
+    };
+
+    Worker(int sock_fd, const EVP_CIPHER* cipher, size_t key_len,
+           size_t queue_size, DropPolicy drop_policy)
+      : m_sock_fd(sock_fd), m_cipher(cipher), m_key_len(key_len),
+        m_queue_size(queue_size), m_drop_policy(drop_policy)
+    {
+    }
+
+    ~Worker(void)
+    {
+      {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+      }
+      m_cond.notify_one();
+      if (m_thread.joinable())
+      {
+        m_thread.join();
+      }
+    }
+
+    void start(void)
+    {
+      m_thread = std::thread(&Worker::run, this);
+    }
+
+    Datagram& newDatagram(void)
+    {
+      m_pending.emplace_back();
+      return m_pending.back();
+    }
+
+    void flush(void)
+    {
+      if (m_pending.empty())
+      {
+        return;
+      }
+      size_t dropped = 0;
+      {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.insert(m_queue.end(),
+            std::make_move_iterator(m_pending.begin()),
+            std::make_move_iterator(m_pending.end()));
+          // Drop datagrams if the worker cannot keep up. By default the
+          // oldest are dropped since old audio is worth less than new audio.
+        if (m_queue.size() > m_queue_size)
+        {
+          dropped = m_queue.size() - m_queue_size;
+          if (m_drop_policy == Async::UdpSocket::SEND_QUEUE_DROP_OLDEST)
+          {
+            m_queue.erase(m_queue.begin(), m_queue.begin() + dropped);
+          }
+          else
+          {
+            m_queue.erase(m_queue.end() - dropped, m_queue.end());
+          }
+        }
+        const size_t depth = m_queue.size() + m_in_progress;
+        if (depth > m_max_queue_depth)
+        {
+          m_max_queue_depth = depth;
+        }
+      }
+      m_pending.clear();
+      m_dropped += dropped;
+      m_handovers += 1;
+      m_cond.notify_one();
+    }
+
+    void forget(ClientId client_id)
+    {
+      {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        m_forget.push_back(client_id);
+      }
+      m_cond.notify_one();
+    }
+
+    void addStats(Stats& stats) const
+    {
+      stats.datagrams += m_datagrams;
+      stats.syscalls += m_syscalls;
+      stats.dropped += m_dropped;
+      stats.handovers += m_handovers;
+      stats.busy_ns += m_busy_ns;
+      const std::lock_guard<std::mutex> lock(m_mutex);
+      stats.queue_depth += m_queue.size() + m_in_progress;
+      stats.max_queue_depth = std::max(stats.max_queue_depth,
+                                       m_max_queue_depth);
+    }
+
+  private:
+    static constexpr size_t BATCH_SIZE      = 64;
+    static constexpr int    SEND_TIMEOUT_MS = 20;
+
+    using SealerMap = std::unordered_map<ClientId, UdpSealer>;
+
+    const int                 m_sock_fd;
+    const EVP_CIPHER*         m_cipher;
+    const size_t              m_key_len;
+    const size_t              m_queue_size;
+    const DropPolicy          m_drop_policy;
+    std::thread               m_thread;
+    std::vector<Datagram>     m_pending;
+    mutable std::mutex        m_mutex;
+    std::condition_variable   m_cond;
+    std::vector<Datagram>     m_queue;
+    std::vector<ClientId>     m_forget;
+    bool                      m_stop      = false;
+    size_t                    m_in_progress     = 0;
+    size_t                    m_max_queue_depth = 0;
+    SealerMap                 m_sealer_map;
+    std::vector<uint8_t>      m_bufs[BATCH_SIZE];
+    std::atomic<uint64_t>     m_datagrams {0};
+    std::atomic<uint64_t>     m_syscalls  {0};
+    std::atomic<uint64_t>     m_dropped   {0};
+    std::atomic<uint64_t>     m_handovers {0};
+    std::atomic<uint64_t>     m_busy_ns   {0};
+
+    void run(void)
+    {
+      std::vector<Datagram> work;
+      std::vector<ClientId> forget;
+      for (;;)
+      {
+        {
+          std::unique_lock<std::mutex> lock(m_mutex);
+          m_cond.wait(lock, [this]{
+              return m_stop || !m_queue.empty() || !m_forget.empty();
+            });
+          if (m_stop)
+          {
+            break;
+          }
+          work.swap(m_queue);
+          forget.swap(m_forget);
+          m_in_progress = work.size();
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (const auto& client_id : forget)
+        {
+          m_sealer_map.erase(client_id);
+        }
+        forget.clear();
+
+        for (size_t pos=0; pos<work.size(); pos+=BATCH_SIZE)
+        {
+          const size_t cnt = std::min(size_t(BATCH_SIZE), work.size()-pos);
+          sendBatch(&work[pos], cnt);
+          const std::lock_guard<std::mutex> lock(m_mutex);
+          m_in_progress -= cnt;
+        }
+        work.clear();
+        m_busy_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+      }
+    }
+
+    int encrypt(const Datagram& dgram, uint8_t* outbuf)
+    {
+      UdpSealer& sealer = m_sealer_map[dgram.client_id];
+      if (!sealer.setKey(m_cipher, dgram.key, m_key_len))
+      {
+        return -1;
+      }
+      const Payload& payload = *dgram.payload;
+      return sealer.seal(dgram.iv_rand, dgram.iv_cntr, payload.data(),
+                         payload.size(), outbuf);
+    }
+
+    bool waitWritable(void)
+    {
+      struct pollfd pfd;
+      pfd.fd = m_sock_fd;
+      pfd.events = POLLOUT;
+      pfd.revents = 0;
+      return (poll(&pfd, 1, SEND_TIMEOUT_MS) > 0);
+    }
+
+    void sendBatch(const Datagram* dgrams, size_t cnt)
+    {
+      const struct sockaddr_in* addrs[BATCH_SIZE];
+      size_t len = 0;
+      for (size_t i=0; i<cnt; ++i)
+      {
+        const Datagram& dgram = dgrams[i];
+        std::vector<uint8_t>& buf = m_bufs[len];
+        buf.resize(UdpSealer::maxSealedSize(dgram.payload->size()));
+        const int outlen = encrypt(dgram, buf.data());
+        if (outlen < 0)
+        {
+          m_dropped += 1;
+          continue;
+        }
+        buf.resize(outlen);
+        addrs[len++] = &dgram.addr;
+      }
+
+#ifdef HAS_MMSG_SUPPORT
+      struct mmsghdr msgs[BATCH_SIZE];
+      struct iovec iovs[BATCH_SIZE];
+      for (size_t i=0; i<len; ++i)
+      {
+        iovs[i].iov_base = m_bufs[i].data();
+        iovs[i].iov_len = m_bufs[i].size();
+        std::memset(&msgs[i], 0, sizeof(msgs[i]));
+        msgs[i].msg_hdr.msg_name = const_cast<struct sockaddr_in*>(addrs[i]);
+        msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+      }
+#endif
+
+      size_t sent = 0;
+      while (sent < len)
+      {
+#ifdef HAS_MMSG_SUPPORT
+        int ret = sendmmsg(m_sock_fd, &msgs[sent], len-sent, 0);
+#else
+        const struct sockaddr* addr =
+          reinterpret_cast<const struct sockaddr*>(addrs[sent]);
+        int ret = sendto(m_sock_fd, m_bufs[sent].data(), m_bufs[sent].size(),
+                         0, addr, sizeof(struct sockaddr_in));
+        if (ret >= 0)
+        {
+          ret = 1;
+        }
+#endif
+        m_syscalls += 1;
+        if (ret > 0)
+        {
+          sent += ret;
+          m_datagrams += ret;
+        }
+        else if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+        {
+            // The socket send buffer is full. Wait a short while for it to
+            // drain and give up on the rest of the batch if it does not.
+          if (!waitWritable())
+          {
+            m_dropped += len - sent;
+            return;
+          }
+        }
+        else if (errno != EINTR)
+        {
+            // Skip the datagram that caused the error
+          sent += 1;
+          m_dropped += 1;
+        }
+      }
+    }
+};
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+UdpWorkerPool::UdpWorkerPool(void)
+  : m_key_len(0)
+{
+} /* UdpWorkerPool::UdpWorkerPool */
+
+
+UdpWorkerPool::~UdpWorkerPool(void)
+{
+  for (auto& worker : m_workers)
+  {
+    delete worker;
+  }
+  m_workers.clear();
+} /* UdpWorkerPool::~UdpWorkerPool */
+
+
+bool UdpWorkerPool::initialize(int sock_fd, const std::string& cipher_name,
+                               unsigned thread_cnt, size_t queue_size,
+                               DropPolicy drop_policy)
+{
+  assert(m_workers.empty());
+
+  const EVP_CIPHER* cipher = EncryptedUdpSocket::fetchCipher(cipher_name);
+  if (cipher == nullptr)
+  {
+    std::cerr << "*** ERROR: Unsupported UDP cipher " << cipher_name
+              << std::endl;
+    return false;
+  }
+  if ((EVP_CIPHER_iv_length(cipher) != UdpCipher::IVLEN) ||
+      (EVP_CIPHER_key_length(cipher) > EVP_MAX_KEY_LENGTH))
+  {
+    std::cerr << "*** ERROR: Cipher " << cipher_name
+              << " cannot be used by the UDP worker threads" << std::endl;
+    return false;
+  }
+  m_key_len = EVP_CIPHER_key_length(cipher);
+
+  for (unsigned i=0; i<thread_cnt; ++i)
+  {
+    Worker* worker = new Worker(sock_fd, cipher, m_key_len,
+                                std::max(queue_size, size_t(1)), drop_policy);
+    worker->start();
+    m_workers.push_back(worker);
+  }
+
+  return true;
+} /* UdpWorkerPool::initialize */
+
+
+bool UdpWorkerPool::queueDatagram(const PayloadPtr& payload,
+    ClientId client_id, const IpAddress& addr, uint16_t port,
+    const std::vector<uint8_t>& iv_rand, const std::vector<uint8_t>& key,
+    UdpCipher::IVCntr iv_cntr)
+{
+  assert(!m_workers.empty());
+  if ((payload == nullptr) || (key.size() != m_key_len))
+  {
+    return false;
+  }
+
+  Worker::Datagram& dgram = workerForClient(client_id)->newDatagram();
+  dgram.payload = payload;
+  std::memset(&dgram.addr, 0, sizeof(dgram.addr));
+  dgram.addr.sin_family = AF_INET;
+  dgram.addr.sin_port = htons(port);
+  dgram.addr.sin_addr = addr.ip4Addr();
+  dgram.client_id = client_id;
+  dgram.iv_cntr = iv_cntr;
+  for (size_t i=0; i<sizeof(dgram.iv_rand); ++i)
+  {
+    dgram.iv_rand[i] = (i < iv_rand.size()) ? iv_rand[i] : 0;
+  }
+  std::memcpy(dgram.key, key.data(), m_key_len);
+
+  return true;
+} /* UdpWorkerPool::queueDatagram */
+
+
+void UdpWorkerPool::flush(void)
+{
+  for (auto& worker : m_workers)
+  {
+    worker->flush();
+  }
+} /* UdpWorkerPool::flush */
+
+
+void UdpWorkerPool::forgetClient(ClientId client_id)
+{
+  if (!m_workers.empty())
+  {
+    workerForClient(client_id)->forget(client_id);
+  }
+} /* UdpWorkerPool::forgetClient */
+
+
+UdpWorkerPool::Stats UdpWorkerPool::stats(void) const
+{
+  Stats stats;
+  for (const auto& worker : m_workers)
+  {
+    worker->addStats(stats);
+  }
+  return stats;
+} /* UdpWorkerPool::stats */
+
+
+UdpWorkerPool::Stats UdpWorkerPool::workerStats(unsigned idx) const
+{
+  assert(idx < m_workers.size());
+  Stats stats;
+  m_workers[idx]->addStats(stats);
+  return stats;
+} /* UdpWorkerPool::workerStats */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,281 @@
+/**
+@file   UdpWorkerPool.h
+@brief  A pool of threads used to encrypt and send UDP datagrams
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef UDP_WORKER_POOL_INCLUDED
+#define UDP_WORKER_POOL_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncIpAddress.h>
+#include <AsyncUdpSocket.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "ReflectorMsg.h"
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief  A pool of threads used to encrypt and send UDP datagrams
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-17
+
+Encrypting and sending one datagram per client is where most of the CPU time
+goes in a busy reflector since each received audio frame is sent to all
+clients in the talk group. This class spread that work over a number of
+worker threads, each running its own loop, so that more than one CPU core
+can be used.
+
+Clients are sharded over the workers by client ID. All datagrams to a client
+are handled by the same worker so the order of the datagrams is preserved.
+Each worker keep its own cipher context per client so that the cipher key
+does not have to be expanded for every datagram. Everything else, like the
+TCP connections, the talk group handling and the decision on which clients
+should receive a datagram, stay in the main thread. The main thread hand
+over the plaintext payload, the recipient address and the cipher parameters
+to the worker, including the IV counter so that the sequence numbers are
+still allocated by the main thread.
+
+The workers write directly to the file descriptor of the UDP socket owned by
+the main thread. Sending datagrams on the same socket from multiple threads
+is safe.
+
+The queueDatagram function only put the datagram in a local list. Call the
+flush function to hand all queued datagrams over to the workers.
+*/
+class UdpWorkerPool
+{
+  public:
+    using ClientId    = ReflectorUdpMsg::ClientId;
+    using Payload     = std::vector<uint8_t>;
+    using PayloadPtr  = std::shared_ptr<const Payload>;
+    using DropPolicy  = Async::UdpSocket::SendQueueDropPolicy;
+
+    /**
+     * @brief Statistics for one worker or summed over all workers
+     *
+     * The queue depth is the number of datagrams handed over to a worker
+     * that have not yet been sent. When summing over all workers the queue
+     * depths are added up while the max queue depth is the max of all
+     * workers.
+     */
+    struct Stats
+    {
+      uint64_t datagrams        = 0;  ///< Number of datagrams sent
+      uint64_t syscalls         = 0;  ///< Number of send system calls
+      uint64_t dropped          = 0;  ///< Dropped (queue full or error)
+      uint64_t handovers        = 0;  ///< Number of flushes to the worker
+      uint64_t busy_ns          = 0;  ///< Time spent encrypting and sending
+      size_t   queue_depth      = 0;  ///< Current queue depth
+      size_t   max_queue_depth  = 0;  ///< Max queue depth seen
+    };
+
+    /**
+     * @brief   Default constructor
+     */
+    UdpWorkerPool(void);
+
+    /**
+     * @brief   Disallow copy construction
+     */
+    UdpWorkerPool(const UdpWorkerPool&) = delete;
+
+    /**
+     * @brief   Disallow copy assignment
+     */
+    UdpWorkerPool& operator=(const UdpWorkerPool&) = delete;
+
+    /**
+     * @brief   Destructor
+     *
+     * All worker threads are stopped before the destructor return. Datagrams
+     * that have not yet been sent are discarded.
+     */
+    ~UdpWorkerPool(void);
+
+    /**
+     * @brief   Initialize the pool and start the worker threads
+     * @param   sock_fd     The file descriptor of the UDP socket to send on
+     * @param   cipher_name The name of the cipher to use, e.g. AES-128-GCM
+     * @param   thread_cnt  The number of worker threads to start
+     * @param   queue_size  Max number of queued datagrams per worker
+     * @param   drop_policy Which datagrams to drop when a queue is full
+     * @return  Returns \em true on success or else \em false
+     */
+    bool initialize(int sock_fd, const std::string& cipher_name,
+                    unsigned thread_cnt, size_t queue_size,
+                    DropPolicy drop_policy=
+                      Async::UdpSocket::SEND_QUEUE_DROP_OLDEST);
+
+    /**
+     * @brief   Get the number of worker threads
+     * @return  Returns the number of running worker threads
+     */
+    unsigned threadCount(void) const { return m_workers.size(); }
+
+    /**
+     * @brief   Queue a datagram for encryption and sending
+     * @param   payload   The plaintext payload, may be shared by many calls
+     * @param   client_id The ID of the receiving client
+     * @param   addr      The IP address of the client
+     * @param   port      The UDP port of the client
+     * @param   iv_rand   The random part of the IV
+     * @param   key       The cipher key to use
+     * @param   iv_cntr   The IV counter to use for this datagram
+     * @return  Returns \em true on success or else \em false
+     *
+     * The datagram is not handed over to the worker until the flush
+     * function is called.
+     */
+    bool queueDatagram(const PayloadPtr& payload, ClientId client_id,
+                       const Async::IpAddress& addr, uint16_t port,
+                       const std::vector<uint8_t>& iv_rand,
+                       const std::vector<uint8_t>& key,
+                       UdpCipher::IVCntr iv_cntr);
+
+    /**
+     * @brief   Hand over all queued datagrams to the workers
+     */
+    void flush(void);
+
+    /**
+     * @brief   Release all resources associated with a client
+     * @param   client_id The ID of the client
+     */
+    void forgetClient(ClientId client_id);
+
+    /**
+     * @brief   Get statistics for the pool
+     * @return  Returns the statistics summed over all workers
+     */
+    Stats stats(void) const;
+
+    /**
+     * @brief   Get statistics for a single worker
+     * @param   idx The index of the worker, 0 to threadCount()-1
+     * @return  Returns the statistics for the given worker
+     *
+     * Looking at the queue depth of each worker is a good way to find out if
+     * more threads are needed. A worker that is constantly behind will have
+     * a max queue depth close to the configured queue size and will start to
+     * drop datagrams. Since clients are sharded by client ID, one worker
+     * may also be more loaded than the others.
+     */
+    Stats workerStats(unsigned idx) const;
+
+  protected:
+
+  private:
+    class Worker;
+
+    std::vector<Worker*>  m_workers;
+    size_t                m_key_len;
+
+    Worker* workerForClient(ClientId client_id) const
+    {
+      return m_workers[client_id % m_workers.size()];
+    }
+
+};  /* class UdpWorkerPool */
+
+
+//} /* namespace */
+
+#endif /* UDP_WORKER_POOL_INCLUDED */
+
+/*
+ * This file has not been truncated
+ */
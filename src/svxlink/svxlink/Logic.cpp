@@ -46,7 +46,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <algorithm>
 #include <cctype>
 #include <cassert>
+#include <cmath>
 #include <sstream>
+#include <fstream>
 #include <map>
 #include <list>
 #include <vector>
@@ -60,11 +62,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <AsyncConfig.h>
 #include <AsyncTimer.h>
+#include <AsyncLoopProfiler.h>
 #include <Rx.h>
 #include <Tx.h>
 #include <AsyncAudioPassthrough.h>
 #include <AsyncAudioMixer.h>
-#include <AsyncAudioAmp.h>
 #include <AsyncAudioSelector.h>
 #include <AsyncAudioSplitter.h>
 #include <AsyncAudioValve.h>
@@ -73,6 +75,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncAudioPacer.h>
 #include <AsyncAudioDebugger.h>
 #include <AsyncAudioRecorder.h>
+#include <AsyncAudioBlockPool.h>
+#include <AsyncAudioProfiler.h>
 #include <common.h>
 #include <config.h>
 
@@ -158,7 +162,7 @@ Logic::Logic(void)
     exec_cmd_on_sql_close_timer(-1),        rgr_sound_timer(-1),
     report_ctcss(0.0f),                     event_handler(0),
     recorder(0),                            tx_audio_mixer(0),
-    fx_gain_ctrl(0),                        tx_audio_selector(0),
+    tx_audio_selector(0),
     rx_splitter(0),                         rx_valve(0),
     rpt_valve(0),                           audio_from_module_selector(0),
     audio_to_module_splitter(0),            audio_to_module_selector(0),
@@ -186,6 +190,8 @@ bool Logic::initialize(Async::Config& cfgobj, const std::string& logic_name)
     return false;
   }
 
+  Async::AudioProfiler::OwnerScope profiler_owner("Logic:" + name());
+
   if (cfg().getValue(name(), "ONLINE_CMD", online_cmd))
   {
     OnlineCmd *cmd = new OnlineCmd(&cmd_parser, this, online_cmd);
@@ -502,7 +508,9 @@ bool Logic::initialize(Async::Config& cfgobj, const std::string& logic_name)
   tx_audio_selector->addSource(logic_con_in_idle_det);
   tx_audio_selector->enableAutoSelect(logic_con_in_idle_det, 10);
 
-    // Create a selector and a splitter to handle audio from modules
+    // Create a selector and a splitter to handle audio from modules. The
+    // splitter branches are written in lockstep so that a module playing
+    // back audio faster than real time is throttled by the TX.
   audio_from_module_selector = new AudioSelector;
   AudioSplitter *audio_from_module_splitter = new AudioSplitter;
   audio_from_module_selector->registerSink(audio_from_module_splitter, true);
@@ -579,9 +587,12 @@ bool Logic::initialize(Async::Config& cfgobj, const std::string& logic_name)
   prev_tx_src->registerSink(tx_fifo, true);
   prev_tx_src = tx_fifo;
 
-    // Create the TX audio mixer
+    // Create the TX audio mixer. Effects and announcements are reduced in
+    // volume when mixed with normal audio.
   tx_audio_mixer = new AudioMixer;
+  tx_audio_mixer->setSynchronousOutput(true);
   tx_audio_mixer->addSource(prev_tx_src);
+  tx_audio_mixer->setSourceDucking(prev_tx_src, fx_gain_low - fx_gain_normal);
   prev_tx_src = tx_audio_mixer;
 
     // Create the TX object
@@ -606,18 +617,12 @@ bool Logic::initialize(Async::Config& cfgobj, const std::string& logic_name)
   msg_handler->allMsgsWritten.connect(mem_fun(*this, &Logic::allMsgsWritten));
   prev_tx_src = msg_handler;
 
-    // This gain control is used to reduce the audio volume of effects
-    // and announcements when mixed with normal audio
-  fx_gain_ctrl = new AudioAmp;
-  fx_gain_ctrl->setGain(fx_gain_normal);
-  prev_tx_src->registerSink(fx_gain_ctrl, true);
-  prev_tx_src = fx_gain_ctrl;
-
     // Pace the audio so that we don't fill up the audio output pipe.
   AudioPacer *msg_pacer = new AudioPacer(INTERNAL_SAMPLE_RATE,
       	      	      	      	      	 256 * INTERNAL_SAMPLE_RATE / 8000, 0);
   prev_tx_src->registerSink(msg_pacer, true);
   tx_audio_mixer->addSource(msg_pacer);
+  tx_audio_mixer->setSourceGain(msg_pacer, fx_gain_normal);
   prev_tx_src = 0;
 
   event_handler = new EventHandler(event_handler_str, name());
@@ -1204,16 +1209,105 @@ void Logic::commandPtyCmdReceived(const void *buf, size_t count)
       processEvent(event);
     }
   }
+  else if (cmd == "PROFILE")
+  {
+    std::string subcmd("SHOW");
+    ss >> subcmd;
+    std::transform(subcmd.begin(), subcmd.end(), subcmd.begin(), ::toupper);
+    Async::LoopProfiler& profiler = Async::LoopProfiler::instance();
+    if (subcmd == "ON")
+    {
+      profiler.setEnabled(true);
+    }
+    else if (subcmd == "OFF")
+    {
+      profiler.setEnabled(false);
+    }
+    else if (subcmd == "RESET")
+    {
+      profiler.reset();
+    }
+    else if (subcmd == "SHOW")
+    {
+      profiler.snapshot().print(std::cout);
+    }
+    else if (subcmd == "POOL")
+    {
+      Async::AudioBlockPool::printStats(std::cout);
+    }
+    else if (subcmd == "AUDIO")
+    {
+      profileAudioCmd(ss, cmdline);
+    }
+    else
+    {
+      std::cerr << "*** ERROR: Invalid PTY command in logic "
+                << name() << ": \"" << cmdline << "\". "
+                << "Usage: PROFILE [ON|OFF|RESET|SHOW|POOL|AUDIO]"
+                << std::endl;
+    }
+  }
   else
   {
     std::cerr << "*** ERROR: Unknown PTY command in logic "
               << name() << ": \"" << cmdline << "\". "
-              << "Valid commands are: CFG, EVENT"
+              << "Valid commands are: CFG, EVENT, PROFILE"
               << std::endl;
   }
 } /* Logic::commandPtyCmdReceived */
 
 
+void Logic::profileAudioCmd(std::istream& is, const std::string& cmdline)
+{
+  std::string subcmd("DOT");
+  std::string filename;
+  is >> subcmd >> filename;
+  std::transform(subcmd.begin(), subcmd.end(), subcmd.begin(), ::toupper);
+  if (subcmd == "ON")
+  {
+    Async::AudioProfiler::setEnabled(true);
+  }
+  else if (subcmd == "OFF")
+  {
+    Async::AudioProfiler::setEnabled(false);
+  }
+  else if (subcmd == "RESET")
+  {
+    Async::AudioProfiler::reset();
+  }
+  else if ((subcmd == "DOT") || (subcmd == "JSON"))
+  {
+    std::ofstream file;
+    if (!filename.empty())
+    {
+      file.open(filename);
+      if (!file)
+      {
+        std::cerr << "*** ERROR: Could not open audio profile file \""
+                  << filename << "\" in logic " << name() << std::endl;
+        return;
+      }
+    }
+    std::ostream& os = filename.empty() ? std::cout : file;
+    if (subcmd == "DOT")
+    {
+      Async::AudioProfiler::printDot(os);
+    }
+    else
+    {
+      Async::AudioProfiler::printJson(os);
+    }
+  }
+  else
+  {
+    std::cerr << "*** ERROR: Invalid PTY command in logic "
+              << name() << ": \"" << cmdline << "\". "
+              << "Usage: PROFILE AUDIO [ON|OFF|RESET|DOT|JSON] [file]"
+              << std::endl;
+  }
+} /* Logic::profileAudioCmd */
+
+
 void Logic::clearPendingSamples(void)
 {
   msg_handler->clear();
@@ -1425,7 +1519,12 @@ void Logic::loadModule(const string& module_cfg_name)
     return;
   }
 
-  if (!module->initialize())
+  bool module_initialized = false;
+  {
+    Async::AudioProfiler::OwnerScope profiler_owner("Module:" + module_cfg_name);
+    module_initialized = module->initialize();
+  }
+  if (!module_initialized)
   {
     cerr << "*** ERROR: Initialization failed for module "
       	 << module_cfg_name.c_str() << " in logic " << name() << endl;
@@ -1738,15 +1837,6 @@ void Logic::dtmfDigitDetectedP(char digit, int duration)
 
 void Logic::audioStreamStateChange(bool is_active, bool is_idle)
 {
-  if (is_active)
-  {
-    fx_gain_ctrl->setGain(fx_gain_low);
-  }
-  else
-  {
-    fx_gain_ctrl->setGain(fx_gain_normal);
-  }
-
   checkIdle();
 } /* Logic::audioStreamStateChange */
 
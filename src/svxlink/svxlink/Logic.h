@@ -40,6 +40,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <string>
+#include <istream>
 #include <list>
 #include <map>
 #include <vector>
@@ -81,7 +82,6 @@ namespace Async
 {
   class Config;
   class AudioMixer;
-  class AudioAmp;
   class AudioSelector;
   class AudioSplitter;
   class AudioValve;
@@ -263,7 +263,6 @@ class Logic : public LogicBase
     Async::AtTimer      	    every_second_timer;
     Async::AudioRecorder  	    *recorder;
     Async::AudioMixer	      	    *tx_audio_mixer;
-    Async::AudioAmp   	      	    *fx_gain_ctrl;
     Async::AudioSelector      	    *tx_audio_selector;
     Async::AudioSplitter      	    *rx_splitter;
     Async::AudioValve 	      	    *rx_valve;
@@ -317,6 +316,7 @@ class Logic : public LogicBase
     bool getConfigValue(const std::string& section, const std::string& tag,
                         std::string& value);
     void signalLevelUpdated(float siglev);
+    void profileAudioCmd(std::istream& is, const std::string& cmdline);
 
 };  /* class Logic */
 
@@ -61,6 +61,7 @@ extern "C" {
  *
  ****************************************************************************/
 
+#include <AsyncAudioBlockPool.h>
 
 
 /****************************************************************************
@@ -80,6 +81,7 @@ extern "C" {
  ****************************************************************************/
 
 using namespace std;
+using namespace Async;
 
 
 
@@ -110,6 +112,17 @@ class QueueItem
     virtual void unreadSamples(int len) = 0;
     
     bool idleMarked(void) const { return idle_marked; }
+
+      // Queue items are created and deleted for every queued sound so take
+      // them from the audio block pool instead of the general heap
+    static void *operator new(size_t size)
+    {
+      return AudioBlockPool::allocate(size);
+    }
+    static void operator delete(void *ptr, size_t size)
+    {
+      AudioBlockPool::deallocate(ptr, size);
+    }
   
   private:
     bool  idle_marked;
@@ -172,6 +172,7 @@ ReflectorLogic::ReflectorLogic(void)
     m_reconnect_timer(60000, Timer::TYPE_ONESHOT, false),
     /*m_next_udp_tx_seq(0),*/ m_next_udp_rx_seq(0),
     m_heartbeat_timer(1000, Timer::TYPE_PERIODIC, false), m_dec(0),
+    m_jitter_fifo(0),
     m_flush_timeout_timer(3000, Timer::TYPE_ONESHOT, false),
     m_udp_heartbeat_tx_cnt_reset(DEFAULT_UDP_HEARTBEAT_TX_CNT_RESET),
     m_udp_heartbeat_tx_cnt(0), m_udp_heartbeat_rx_cnt(0),
@@ -189,20 +190,28 @@ ReflectorLogic::ReflectorLogic(void)
     m_tmp_monitor_timeout(DEFAULT_TMP_MONITOR_TIMEOUT), m_use_prio(true),
     m_qsy_pending_timer(-1), m_verbose(true)
 {
+  m_reconnect_timer.setTag("ReflectorLogic");
   m_reconnect_timer.expired.connect(
       sigc::hide(mem_fun(*this, &ReflectorLogic::reconnect)));
+  m_heartbeat_timer.setTag("ReflectorLogic");
+  m_heartbeat_timer.setCoarse(true);
   m_heartbeat_timer.expired.connect(
       mem_fun(*this, &ReflectorLogic::handleTimerTick));
+  m_flush_timeout_timer.setTag("ReflectorLogic");
   m_flush_timeout_timer.expired.connect(
       mem_fun(*this, &ReflectorLogic::flushTimeout));
   timerclear(&m_last_talker_timestamp);
 
+  m_tg_select_timer.setTag("ReflectorLogic");
   m_tg_select_timer.expired.connect(sigc::hide(
         sigc::mem_fun(*this, &ReflectorLogic::tgSelectTimerExpired)));
+  m_report_tg_timer.setTag("ReflectorLogic");
   m_report_tg_timer.expired.connect(sigc::hide(
         sigc::mem_fun(*this, &ReflectorLogic::processTgSelectionEvent)));
+  m_tmp_monitor_timer.setTag("ReflectorLogic");
   m_tmp_monitor_timer.expired.connect(sigc::hide(
         sigc::mem_fun(*this, &ReflectorLogic::checkTmpMonitorTimeout)));
+  m_qsy_pending_timer.setTag("ReflectorLogic");
   m_qsy_pending_timer.expired.connect(sigc::hide(
         sigc::mem_fun(*this, &ReflectorLogic::qsyPendingTimeout)));
 
@@ -523,14 +532,30 @@ bool ReflectorLogic::initialize(Async::Config& cfgobj, const std::string& logic_
   prev_src = m_dec;
 
     // Create jitter buffer
-  AudioFifo *fifo = new Async::AudioFifo(2*INTERNAL_SAMPLE_RATE);
-  prev_src->registerSink(fifo, true);
-  prev_src = fifo;
   unsigned jitter_buffer_delay = 0;
   cfg().getValue(name(), "JITTER_BUFFER_DELAY", jitter_buffer_delay);
-  if (jitter_buffer_delay > 0)
+  bool adaptive_jitter_buffer = false;
+  cfg().getValue(name(), "ADAPTIVE_JITTER_BUFFER", adaptive_jitter_buffer);
+  if (adaptive_jitter_buffer)
+  {
+    unsigned jitter_buffer_max_delay = 500;
+    cfg().getValue(name(), "JITTER_BUFFER_MAX_DELAY", jitter_buffer_max_delay);
+    m_jitter_fifo = new Async::AudioAdaptiveJitterFifo;
+    m_jitter_fifo->setDelayLimits(jitter_buffer_delay,
+                                  jitter_buffer_max_delay);
+    prev_src->registerSink(m_jitter_fifo, true);
+    prev_src = m_jitter_fifo;
+  }
+  else
   {
-    fifo->setPrebufSamples(jitter_buffer_delay * INTERNAL_SAMPLE_RATE / 1000);
+    AudioFifo *fifo = new Async::AudioFifo(2*INTERNAL_SAMPLE_RATE);
+    prev_src->registerSink(fifo, true);
+    prev_src = fifo;
+    if (jitter_buffer_delay > 0)
+    {
+      fifo->setPrebufSamples(
+          jitter_buffer_delay * INTERNAL_SAMPLE_RATE / 1000);
+    }
   }
 
   prev_src->registerSink(m_logic_con_out, true);
@@ -2075,9 +2100,8 @@ bool ReflectorLogic::udpCipherDataReceived(const IpAddress& addr, uint16_t port,
     //             "short to hold associated data" << std::endl;
     return true;
   }
-  stringstream ss;
-  ss.write(reinterpret_cast<const char *>(buf), UdpCipher::AADLEN);
-  if (!m_aad.unpack(ss))
+  Async::MsgBufReader r(buf, UdpCipher::AADLEN);
+  if (!m_aad.unpack(r))
   {
     std::cerr << "*** WARNING: Unpacking associated data failed for UDP "
                  "datagram from " << addr << ":" << port << std::endl;
@@ -2120,11 +2144,10 @@ void ReflectorLogic::udpDatagramReceived(const IpAddress& addr, uint16_t port,
     return;
   }
 
-  stringstream ss;
-  ss.write(reinterpret_cast<const char *>(buf), count);
+  Async::MsgBufReader r(buf, count);
 
   ReflectorUdpMsg header;
-  if (!header.unpack(ss))
+  if (!header.unpack(r))
   {
     cerr << "*** WARNING[" << name()
          << "]: Unpacking failed for UDP message header" << endl;
@@ -2154,6 +2177,10 @@ void ReflectorLogic::udpDatagramReceived(const IpAddress& addr, uint16_t port,
               << " but received " << m_aad.iv_cntr
               << ". Resetting next expected sequence number to "
               << (m_aad.iv_cntr + 1) << std::endl;
+    if (m_jitter_fifo != 0)
+    {
+      m_jitter_fifo->markLost(m_aad.iv_cntr - m_next_udp_rx_seq);
+    }
   }
   m_next_udp_rx_seq = m_aad.iv_cntr + 1;
 
@@ -2194,7 +2221,7 @@ void ReflectorLogic::udpDatagramReceived(const IpAddress& addr, uint16_t port,
     case MsgUdpAudio::TYPE:
     {
       MsgUdpAudio msg;
-      if (!msg.unpack(ss))
+      if (!msg.unpack(r))
       {
         std::cerr << "*** WARNING[" << name()
                   << "]: Could not unpack MsgUdpAudio" << std::endl;
@@ -2240,8 +2267,13 @@ void ReflectorLogic::sendUdpMsg(const UdpCipher::AAD& aad,
   }
 
   ReflectorUdpMsg header(msg.type());
-  ostringstream ss;
-  if (!header.pack(ss) || !msg.pack(ss))
+  const size_t len = header.packedSize() + msg.packedSize();
+  if (m_udp_tx_buf.size() < len)
+  {
+    m_udp_tx_buf.resize(len);
+  }
+  Async::MsgBufWriter w(m_udp_tx_buf.data(), len);
+  if (!header.pack(w) || !msg.pack(w))
   {
     std::cerr << "*** ERROR[" << name()
               << "]: Failed to pack reflector UDP message" << std::endl;
@@ -2249,8 +2281,10 @@ void ReflectorLogic::sendUdpMsg(const UdpCipher::AAD& aad,
   }
   m_udp_sock->setCipherIV(UdpCipher::IV{m_udp_cipher_iv_rand, m_client_id,
                                         aad.iv_cntr});
-  std::ostringstream adss;
-  if (!aad.pack(adss))
+    // The initial AAD is the largest associated data variant
+  char aad_buf[UdpCipher::InitialAAD::fixedPackedSize()];
+  Async::MsgBufWriter aadw(aad_buf, sizeof(aad_buf));
+  if (!aad.pack(aadw))
   {
     std::cerr << "*** WARNING: Packing associated data failed for UDP "
                  "datagram to " << m_con.remoteHost() << ":"
@@ -2258,8 +2292,7 @@ void ReflectorLogic::sendUdpMsg(const UdpCipher::AAD& aad,
     return;
   }
   m_udp_sock->write(m_con.remoteHost(), m_con.remotePort(),
-                    adss.str().data(), adss.str().size(),
-                    ss.str().data(), ss.str().size());
+                    aad_buf, aadw.size(), m_udp_tx_buf.data(), w.size());
 } /* ReflectorLogic::sendUdpMsg */
 
 
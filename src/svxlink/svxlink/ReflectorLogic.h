@@ -51,6 +51,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncFramedTcpConnection.h>
 #include <AsyncTimer.h>
 #include <AsyncAudioFifo.h>
+#include <AsyncAudioAdaptiveJitterFifo.h>
 #include <AsyncAudioStreamStateDetector.h>
 
 
@@ -237,6 +238,7 @@ class ReflectorLogic : public LogicBase
     UdpCipher::IVCntr                 m_next_udp_rx_seq;
     Async::Timer                      m_heartbeat_timer;
     Async::AudioDecoder*              m_dec;
+    Async::AudioAdaptiveJitterFifo*   m_jitter_fifo;
     Async::Timer                      m_flush_timeout_timer;
     unsigned                          m_udp_heartbeat_tx_cnt_reset;
     unsigned                          m_udp_heartbeat_tx_cnt;
@@ -281,6 +283,7 @@ class ReflectorLogic : public LogicBase
     std::vector<uint8_t>              m_udp_cipher_iv_rand;
     UdpCipher::IVCntr                 m_udp_cipher_iv_cntr;
     UdpCipher::AAD                    m_aad;
+    std::vector<char>                 m_udp_tx_buf;
     bool                              m_download_ca_bundle = true;
 
     ReflectorLogic(const ReflectorLogic&);
@@ -60,6 +60,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <AsyncConfig.h>
 #include <AsyncAudioSource.h>
+#include <AsyncAudioFirKernel.h>
 #include <AsyncTcpClient.h>
 
 
@@ -105,84 +106,35 @@ namespace {
   class Decimator
   {
     public:
-      Decimator(void) : dec_fact(0), p_Z(0), taps(0) {}
+      Decimator(void) {}
 
       Decimator(int dec_fact, const float *coeff, int taps)
-        : dec_fact(dec_fact), p_Z(0), taps(taps)
+        : fir(dec_fact, coeff, taps)
       {
-        setDecimatorParams(dec_fact, coeff, taps);
       }
 
-      ~Decimator(void)
-      {
-        delete [] p_Z;
-      }
-
-      int decFact(void) const { return dec_fact; }
+      int decFact(void) const { return fir.factor(); }
 
       void setDecimatorParams(int dec_fact, const float *coeff, int taps)
       {
-        assert(taps >= dec_fact);
-
-        set_coeff.assign(coeff, coeff + taps);
-        this->dec_fact = dec_fact;
-        this->coeff = set_coeff;
-        this->taps = taps;
-
-        delete [] p_Z;
-        p_Z = new T[taps]();
+        fir.setParams(dec_fact, coeff, taps);
       }
 
       void setGain(double gain_adjust)
       {
-        coeff = set_coeff;
-        for (vector<float>::iterator it=coeff.begin(); it!=coeff.end(); ++it)
-        {
-          *it *= pow(10.0, gain_adjust / 20.0);
-        }
+        fir.setGain(pow(10.0, gain_adjust / 20.0));
       }
 
       void decimate(vector<T> &out, const vector<T> &in)
       {
-        int orig_count = in.size();
-
           // this implementation assumes in.size() is a multiple of factor_M
-        assert(in.size() % dec_fact == 0);
-
-        int num_out = 0;
-        typename vector<T>::const_iterator src = in.begin();
-        out.clear();
-        out.reserve(in.size() / dec_fact);
-        while (src != in.end())
-        {
-            // shift Z delay line up to make room for next samples
-          memmove(p_Z + dec_fact, p_Z, (taps - dec_fact) * sizeof(T));
-
-            // copy next samples from input buffer to bottom of Z delay line
-          for (int tap = dec_fact - 1; tap >= 0; tap--)
-          {
-            assert(src != in.end());
-            p_Z[tap] = *src++;
-          }
-
-            // calculate FIR sum
-          T sum(0);
-          for (int tap = 0; tap < taps; tap++)
-          {
-            sum += coeff[tap] * p_Z[tap];
-          }
-          out.push_back(sum);     /* store sum */
-          num_out++;
-        }
-        assert(num_out == orig_count / dec_fact);
+        assert(in.size() % fir.factor() == 0);
+        out.resize(in.size() / fir.factor());
+        fir.process(out.data(), in.data(), in.size());
       }
 
     private:
-      int             dec_fact;
-      T               *p_Z;
-      int             taps;
-      vector<float>   set_coeff;
-      vector<float>   coeff;
+      FirDecimator<T> fir;
   };
 
   template <class T>
@@ -244,13 +196,13 @@ namespace {
       virtual int decFact(void) const { return d1.decFact() * d2.decFact(); }
       virtual void decimate(vector<T> &out, const vector<T> &in)
       {
-        vector<T> dec_samp1;
         d1.decimate(dec_samp1, in);
         d2.decimate(out, dec_samp1);
       }
 
     private:
       Decimator<T> &d1, &d2;
+      vector<T> dec_samp1;
   };
 
   template <class T>
@@ -266,7 +218,6 @@ namespace {
       }
       virtual void decimate(vector<T> &out, const vector<T> &in)
       {
-        vector<T> dec_samp1, dec_samp2;
         d1.decimate(dec_samp1, in);
         d2.decimate(dec_samp2, dec_samp1);
         d3.decimate(out, dec_samp2);
@@ -274,6 +225,7 @@ namespace {
 
     private:
       Decimator<T> &d1, &d2, &d3;
+      vector<T> dec_samp1, dec_samp2;
   };
 
   template <class T>
@@ -290,7 +242,6 @@ namespace {
       }
       virtual void decimate(vector<T> &out, const vector<T> &in)
       {
-        vector<T> dec_samp1, dec_samp2, dec_samp3;
         d1.decimate(dec_samp1, in);
         d2.decimate(dec_samp2, dec_samp1);
         d3.decimate(dec_samp3, dec_samp2);
@@ -299,6 +250,7 @@ namespace {
 
     private:
       Decimator<T> &d1, &d2, &d3, &d4;
+      vector<T> dec_samp1, dec_samp2, dec_samp3;
   };
 
   template <class T>
@@ -316,7 +268,6 @@ namespace {
       }
       virtual void decimate(vector<T> &out, const vector<T> &in)
       {
-        vector<T> dec_samp1, dec_samp2, dec_samp3, dec_samp4;
         d1.decimate(dec_samp1, in);
         d2.decimate(dec_samp2, dec_samp1);
         d3.decimate(dec_samp3, dec_samp2);
@@ -326,6 +277,7 @@ namespace {
 
     private:
       Decimator<T> &d1, &d2, &d3, &d4, &d5;
+      vector<T> dec_samp1, dec_samp2, dec_samp3, dec_samp4;
   };
 
 
@@ -473,7 +425,7 @@ namespace {
     public:
       virtual ~Demodulator(void) {}
 
-      virtual void iq_received(vector<WbRxRtlSdr::Sample> samples) = 0;
+      virtual void iq_received(const vector<WbRxRtlSdr::Sample> &samples) = 0;
 
       /**
        * @brief Resume audio output to the sink
@@ -553,7 +505,7 @@ namespace {
         dec->setGain(adj_db);
       }
 
-      void iq_received(vector<WbRxRtlSdr::Sample> samples)
+      void iq_received(const vector<WbRxRtlSdr::Sample> &samples)
       {
           // From article-sdr-is-qs.pdf: Watch your Is and Qs:
           //   FM = (Qn.In-1 - In.Qn-1)/(In.In-1 + Qn.Qn-1)
@@ -561,7 +513,8 @@ namespace {
           // A more indepth report:
           //   Implementation of FM demodulator algorithms on a
           //   high performance digital signal processor
-        vector<float> audio;
+        audio.clear();
+        audio.reserve(samples.size());
         for (size_t idx=0; idx<samples.size(); ++idx)
         {
           complex<float> samp = samples[idx];
@@ -578,7 +531,6 @@ namespace {
 
           audio.push_back(demod);
         }
-        vector<float> dec_audio;
         dec->decimate(dec_audio, audio);
         sinkWriteSamples(&dec_audio[0], dec_audio.size());
       }
@@ -586,6 +538,8 @@ namespace {
     private:
       float iold;
       float qold;
+      vector<float> audio;
+      vector<float> dec_audio;
       Decimator<float> audio_dec_wb;
       Decimator<float> audio_dec;
       DecimatorMS<float> *dec;
@@ -602,12 +556,12 @@ namespace {
         agc.setReference(1);
       }
 
-      void iq_received(vector<WbRxRtlSdr::Sample> samples)
+      void iq_received(const vector<WbRxRtlSdr::Sample> &samples)
       {
-        vector<WbRxRtlSdr::Sample> gain_adjusted;
         agc.iq_received(gain_adjusted, samples);
 
-        vector<float> audio;
+        audio.clear();
+        audio.reserve(gain_adjusted.size());
         for (size_t idx=0; idx<gain_adjusted.size(); ++idx)
         {
           complex<float> samp = gain_adjusted[idx];
@@ -618,7 +572,9 @@ namespace {
       }
 
     private:
-      AGC              agc;
+      AGC                         agc;
+      vector<WbRxRtlSdr::Sample>  gain_adjusted;
+      vector<float>               audio;
   };
 
 
@@ -639,9 +595,9 @@ namespace {
         use_lsb = use;
       }
 
-      void iq_received(vector<WbRxRtlSdr::Sample> samples)
+      void iq_received(const vector<WbRxRtlSdr::Sample> &samples)
       {
-        vector<float> Q, Qh, audio;
+        Q.clear();
         Q.reserve(samples.size());
         for (vector<WbRxRtlSdr::Sample>::const_iterator it = samples.begin();
              it != samples.end();
@@ -651,6 +607,7 @@ namespace {
           Q.push_back(it->imag());
         }
         hilbert.decimate(Qh, Q);
+        audio.clear();
         audio.reserve(Qh.size());
         for (size_t idx=0; idx<Qh.size(); ++idx)
         {
@@ -673,6 +630,7 @@ namespace {
       deque<float>      I;
       Decimator<float>  hilbert;
       bool              use_lsb;
+      vector<float>     Q, Qh, audio;
   };
 
 #else
@@ -690,16 +648,13 @@ namespace {
         trans.setOffset(lsb ? 2000 : -2000);
       }
 
-      void iq_received(vector<WbRxRtlSdr::Sample> samples)
+      void iq_received(const vector<WbRxRtlSdr::Sample> &samples)
       {
-        vector<WbRxRtlSdr::Sample> gain_adjusted;
         agc.iq_received(gain_adjusted, samples);
-
-        vector<WbRxRtlSdr::Sample> translated;
         trans.iq_received(translated, gain_adjusted);
 
-        vector<float> audio;
-        audio.reserve(gain_adjusted.size());
+        audio.clear();
+        audio.reserve(translated.size());
         for (vector<WbRxRtlSdr::Sample>::const_iterator it = translated.begin();
              it != translated.end();
              ++it)
@@ -711,8 +666,11 @@ namespace {
       }
 
     private:
-      Translate         trans;
-      AGC               agc;
+      Translate                   trans;
+      AGC                         agc;
+      vector<WbRxRtlSdr::Sample>  gain_adjusted;
+      vector<WbRxRtlSdr::Sample>  translated;
+      vector<float>               audio;
   };
 #endif
 
@@ -728,14 +686,12 @@ namespace {
         agc.setReference(0.05);
       }
 
-      void iq_received(vector<WbRxRtlSdr::Sample> samples)
+      void iq_received(const vector<WbRxRtlSdr::Sample> &samples)
       {
-        vector<WbRxRtlSdr::Sample> gain_adjusted;
         agc.iq_received(gain_adjusted, samples);
-
-        vector<WbRxRtlSdr::Sample> translated;
         trans.iq_received(translated, gain_adjusted);
-        vector<float> audio;
+
+        audio.clear();
         audio.reserve(translated.size());
         for (vector<WbRxRtlSdr::Sample>::const_iterator it = translated.begin();
              it != translated.end();
@@ -748,8 +704,11 @@ namespace {
       }
 
     private:
-      Translate         trans;
-      AGC               agc;
+      Translate                   trans;
+      AGC                         agc;
+      vector<WbRxRtlSdr::Sample>  gain_adjusted;
+      vector<WbRxRtlSdr::Sample>  translated;
+      vector<float>               audio;
   };
 
 
@@ -1076,11 +1035,10 @@ class Ddr::Channel : public sigc::trackable, public Async::AudioSource
       return channelizer->chSampRate();
     }
 
-    void iq_received(vector<WbRxRtlSdr::Sample> samples)
+    void iq_received(const vector<WbRxRtlSdr::Sample> &samples)
     {
       if (enabled)
       {
-        vector<WbRxRtlSdr::Sample> translated, channelized;
         trans.iq_received(translated, samples);
         channelizer->iq_received(channelized, translated);
         demod->iq_received(channelized);
@@ -1113,6 +1071,8 @@ class Ddr::Channel : public sigc::trackable, public Async::AudioSource
     bool enabled;
     int ch_offset;
     int fq_offset;
+    vector<WbRxRtlSdr::Sample> translated;
+    vector<WbRxRtlSdr::Sample> channelized;
 }; /* Channel */
 
 
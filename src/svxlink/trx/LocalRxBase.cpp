@@ -62,6 +62,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncAudioFifo.h>
 #include <AsyncAudioStreamStateDetector.h>
 #include <AsyncAudioFsf.h>
+#include <AsyncAudioProcessorChain.h>
+#include <AsyncAudioProfiler.h>
 #include <AsyncUdpSocket.h>
 #include <common.h>
 
@@ -261,6 +263,8 @@ bool LocalRxBase::initialize(void)
   {
     return false;
   }
+
+  Async::AudioProfiler::OwnerScope profiler_owner("Rx:" + name());
   
   bool deemphasis = false;
   cfg().getValue(name(), "DEEMPHASIS", deemphasis);
@@ -304,6 +308,7 @@ bool LocalRxBase::initialize(void)
   if (cfg().getValue(name(), "RAW_AUDIO_UDP_DEST", raw_audio_fwd_dest))
   {
     AudioSplitter *raw_audio_splitter = new AudioSplitter;
+    raw_audio_splitter->setIndependentBranches(true);
     prev_src->registerSink(raw_audio_splitter, true);
     AudioPassthrough *pass = new AudioPassthrough;
     raw_audio_splitter->addSink(pass, true);
@@ -348,6 +353,7 @@ bool LocalRxBase::initialize(void)
 
   AudioSplitter *siglevdet_splitter = 0;
   siglevdet_splitter = new AudioSplitter;
+  siglevdet_splitter->setIndependentBranches(true);
   prev_src->registerSink(siglevdet_splitter, true);
   prev_src = 0;
 
@@ -369,6 +375,10 @@ bool LocalRxBase::initialize(void)
   siglevdet_splitter->addSink(siglevdet_splitter_pass, true);
   prev_src = siglevdet_splitter_pass;
 
+    // The decimator and deemphasis filter are run as one fused processing
+    // block
+  AudioProcessorChain *fullband_chain = new AudioProcessorChain;
+
 #if (INTERNAL_SAMPLE_RATE != 16000)
     // If the sound card sample rate is higher than 8kHz (16 or 48kHz assumed)
     // decimate it down to 8kHz.
@@ -376,8 +386,7 @@ bool LocalRxBase::initialize(void)
   if (audioSampleRate() > 8000)
   {
     AudioDecimator *d2 = new AudioDecimator(2, coeff_16_8, coeff_16_8_taps);
-    prev_src->registerSink(d2, true);
-    prev_src = d2;
+    fullband_chain->addStage(d2, true, "decimator");
   }
 #endif
 
@@ -392,12 +401,24 @@ bool LocalRxBase::initialize(void)
     //deemph_filt->setOutputGain(7.0f);
 
     DeemphasisFilter *deemph_filt = new DeemphasisFilter;
-    prev_src->registerSink(deemph_filt, true);
-    prev_src = deemph_filt;
+    fullband_chain->addStage(deemph_filt, true, "deemphasis");
+  }
+
+  if (!fullband_chain->empty())
+  {
+    prev_src->registerSink(fullband_chain, true);
+    prev_src = fullband_chain;
+  }
+  else
+  {
+    delete fullband_chain;
   }
   
-    // Create a splitter to distribute full bandwidth audio to all consumers
+    // Create a splitter to distribute full bandwidth audio to all consumers.
+    // The receiver audio is real time so a slow consumer must not stall the
+    // other consumers.
   fullband_splitter = new AudioSplitter;
+  fullband_splitter->setIndependentBranches(true);
   prev_src->registerSink(fullband_splitter, true);
   prev_src = fullband_splitter;
 
@@ -519,6 +540,7 @@ bool LocalRxBase::initialize(void)
 
     // Create a new audio splitter to handle tone detectors
   tone_dets = new AudioSplitter;
+  tone_dets->setIndependentBranches(true);
   prev_src->registerSink(tone_dets, true);
   prev_src = tone_dets;
 
@@ -535,6 +557,7 @@ bool LocalRxBase::initialize(void)
     // Create an audio splitter to distribute the voiceband audio to all
     // other consumers
   AudioSplitter *voiceband_splitter = new AudioSplitter;
+  voiceband_splitter->setIndependentBranches(true);
   prev_src->registerSink(voiceband_splitter, true);
   prev_src = voiceband_splitter;
 
@@ -618,6 +641,10 @@ bool LocalRxBase::initialize(void)
     prev_src = ladspa_plug_loader.chainSource();
   }
 
+    // The limiter, clipper and splatter filter are run as one fused
+    // processing block
+  AudioProcessorChain *output_chain = new AudioProcessorChain;
+
     // Add a limiter to smoothly limit the audio before hard clipping it
   double limiter_thresh = DEFAULT_LIMITER_THRESH;
   cfg().getValue(name(), "LIMITER_THRESH", limiter_thresh);
@@ -629,15 +656,13 @@ bool LocalRxBase::initialize(void)
     limit->setAttack(2);
     limit->setDecay(20);
     limit->setOutputGain(1);
-    prev_src->registerSink(limit, true);
-    prev_src = limit;
+    output_chain->addStage(limit, true, "limiter");
   }
 
     // Clip audio to limit its amplitude
   AudioClipper *clipper = new AudioClipper;
   clipper->setClipLevel(0.98);
-  prev_src->registerSink(clipper, true);
-  prev_src = clipper;
+  output_chain->addStage(clipper, true, "clipper");
 
     // Remove high frequencies generated by the previous clipping
 #if (INTERNAL_SAMPLE_RATE == 16000)
@@ -645,8 +670,9 @@ bool LocalRxBase::initialize(void)
 #else
   AudioFilter *splatter_filter = new AudioFilter("LpCh9/-0.05/3500");
 #endif
-  prev_src->registerSink(splatter_filter, true);
-  prev_src = splatter_filter;
+  output_chain->addStage(splatter_filter, true, "splatter");
+  prev_src->registerSink(output_chain, true);
+  prev_src = output_chain;
   
     // Set the previous audio pipe object to handle audio distribution for
     // the LocalRxBase class
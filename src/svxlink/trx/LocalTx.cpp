@@ -71,6 +71,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncAudioMixer.h>
 #include <AsyncAudioDebugger.h>
 #include <AsyncAudioPacer.h>
+#include <AsyncAudioProfiler.h>
 #include <common.h>
 #include <HdlcFramer.h>
 #include <AfskModulator.h>
@@ -281,6 +282,8 @@ LocalTx::~LocalTx(void)
 
 bool LocalTx::initialize(void)
 {
+  Async::AudioProfiler::OwnerScope profiler_owner("Tx:" + name());
+
   string value;
 
   char tx_id = '\0';
@@ -594,6 +597,7 @@ bool LocalTx::initialize(void)
 
       // Create a mixer so that we can mix other audio with the voice audio
     mixer = new AudioMixer;
+    mixer->setSynchronousOutput(true);
     mixer->addSource(prev_src);
     prev_src = mixer;
 
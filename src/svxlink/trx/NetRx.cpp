@@ -47,6 +47,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <AsyncConfig.h>
 #include <AsyncAudioDecoder.h>
+#include <AsyncAudioAdaptiveJitterFifo.h>
 
 
 /****************************************************************************
@@ -135,7 +136,8 @@ NetRx::NetRx(Config &cfg, const string& name)
   : Rx(cfg, name), cfg(cfg), tcp_con(0),
     log_disconnects_once(false), log_disconnect(true),
     last_signal_strength(0.0), last_sql_rx_id(Rx::ID_UNKNOWN),
-    unflushed_samples(false), sql_is_open(false), audio_dec(0), fq(0),
+    unflushed_samples(false), sql_is_open(false), audio_dec(0),
+    jitter_fifo(0), fq(0),
     modulation(Modulation::MOD_UNKNOWN)
 {
 } /* NetRx::NetRx */
@@ -144,6 +146,7 @@ NetRx::NetRx(Config &cfg, const string& name)
 NetRx::~NetRx(void)
 {
   clearHandler();
+  delete jitter_fifo;
   delete audio_dec;
   
   tcp_con->deleteInstance();
@@ -214,7 +217,24 @@ bool NetRx::initialize(void)
     }
   }
   audio_dec->printCodecParams();
-  setHandler(audio_dec);
+
+  bool adaptive_jitter_buffer = false;
+  cfg.getValue(name(), "ADAPTIVE_JITTER_BUFFER", adaptive_jitter_buffer);
+  if (adaptive_jitter_buffer)
+  {
+    unsigned jitter_buffer_delay = 20;
+    cfg.getValue(name(), "JITTER_BUFFER_DELAY", jitter_buffer_delay);
+    unsigned jitter_buffer_max_delay = 500;
+    cfg.getValue(name(), "JITTER_BUFFER_MAX_DELAY", jitter_buffer_max_delay);
+    jitter_fifo = new AudioAdaptiveJitterFifo;
+    jitter_fifo->setDelayLimits(jitter_buffer_delay, jitter_buffer_max_delay);
+    audio_dec->registerSink(jitter_fifo);
+    setHandler(jitter_fifo);
+  }
+  else
+  {
+    setHandler(audio_dec);
+  }
   
   tcp_con = NetTrxTcpClient::instance(host, atoi(tcp_port.c_str()));
   if (tcp_con == 0)
@@ -73,6 +73,7 @@ namespace NetTrxMsg
 namespace Async
 {
   class AudioDecoder;
+  class AudioAdaptiveJitterFifo;
 };
 
 /****************************************************************************
@@ -212,6 +213,7 @@ class NetRx : public Rx
     bool      	      	unflushed_samples;
     bool      	      	sql_is_open;
     Async::AudioDecoder *audio_dec;
+    Async::AudioAdaptiveJitterFifo *jitter_fifo;
     unsigned            fq;
     Modulation::Type    modulation;
     std::string         last_sql_activity_info;
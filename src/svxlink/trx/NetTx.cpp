@@ -171,6 +171,7 @@ bool NetTx::initialize(void)
   cfg.getValue(name(), "AUTH_KEY", auth_key);
   
   pacer = new AudioPacer(INTERNAL_SAMPLE_RATE, 512, 50);
+  pacer->setPacingMode(AudioPacer::PACING_DEADLINE);
   setHandler(pacer);
   
   audio_enc = AudioEncoder::create(audio_enc_name);
@@ -0,0 +1,847 @@
+/**
+@file	 TrxDspBench.cpp
+@brief   Offline throughput benchmark for the SvxLink receiver/transmitter DSP
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-17
+
+Feed audio, read from a WAV file or synthesized, through real SvxLink audio
+chains as fast as the CPU allows. No audio devices are opened and the main
+loop is never run so the figures only reflect the signal processing. For each
+stage the throughput is printed in JSON or CSV format so that runs can be
+compared between builds.
+
+\verbatim
+Usage: TrxDspBench [-i file.wav] [-d seconds] [-b block size] [-r repeats]
+                   [-s stage substring] [-f json|csv]
+\endverbatim
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#include <stdint.h>
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <complex>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+#include <json/json.h>
+
+#include <AsyncCppApplication.h>
+#include <AsyncConfig.h>
+#include <AsyncAudioSink.h>
+#include <AsyncAudioPassthrough.h>
+#include <AsyncAudioDevice.h>
+#include <AsyncAudioDeviceFactory.h>
+#include <AsyncAudioEncoder.h>
+#include <AsyncAudioDecoder.h>
+
+#include "LocalRxBase.h"
+#include "LocalTx.h"
+#include "Ddr.h"
+#include "WbRxRtlSdr.h"
+#include "DtmfDecoder.h"
+#include "ToneDetector.h"
+#include "SigLevDetNoise.h"
+
+using namespace std;
+using namespace Async;
+
+
+namespace Async
+{
+  /**
+   * An audio device that consume all samples as soon as they are written.
+   * Used as the output of the LocalTx chain. Registered as "bench".
+   */
+  class AudioDeviceBench : public AudioDevice
+  {
+    public:
+      explicit AudioDeviceBench(const string& dev_name)
+        : AudioDevice(dev_name), samples_written(0) {}
+
+      virtual size_t readBlocksize(void) { return block_size_hint; }
+      virtual size_t writeBlocksize(void) { return block_size_hint; }
+      virtual bool isFullDuplexCapable(void) { return true; }
+      virtual void flushSamples(void) { audioToWriteAvailable(); }
+      virtual int samplesToWrite(void) const { return 0; }
+
+      virtual void audioToWriteAvailable(void)
+      {
+        const size_t block_cnt = 4;
+        buf.resize(block_cnt * block_size_hint * channels);
+        size_t blocks;
+        while ((blocks = getBlocks(&buf[0], block_cnt)) > 0)
+        {
+          samples_written += blocks * block_size_hint;
+        }
+      }
+
+      uint64_t samples_written;
+
+    protected:
+      virtual bool openDevice(Mode mode) { return true; }
+      virtual void closeDevice(void) {}
+
+    private:
+      vector<int16_t> buf;
+  };
+
+  REGISTER_AUDIO_DEVICE_TYPE("bench", AudioDeviceBench);
+};
+
+
+namespace {
+  const int SAMPLE_RATE = INTERNAL_SAMPLE_RATE;
+  const unsigned DDR_SAMPLE_RATE = 960000;
+  const unsigned DDR_CENTER_FQ = 435000000;
+  const unsigned DDR_CHANNELS = 4;
+  const int DDR_FM_DEV = 5000;
+
+  class NullSink : public AudioSink
+  {
+    public:
+      NullSink(void) : samples(0) {}
+      virtual int writeSamples(const float *s, int count)
+      {
+        samples += count;
+        return count;
+      }
+      virtual void flushSamples(void) { sourceAllSamplesFlushed(); }
+      uint64_t samples;
+  };
+
+
+  /**
+   * A benchmark stage. The prepare function is called for each block of
+   * input samples before the run function but is not included in the
+   * timing.
+   */
+  class Stage
+  {
+    public:
+      Stage(const string& name) : dropped(0), m_name(name) {}
+      virtual ~Stage(void) {}
+      const string& name(void) const { return m_name; }
+      virtual bool setup(Config& cfg) = 0;
+      virtual void prepare(const float *samples, int count) {}
+      virtual void run(const float *samples, int count) = 0;
+      virtual void finish(void) {}
+      virtual void addInfo(Json::Value& info) {}
+      uint64_t dropped;
+
+    protected:
+        // Write to a sink that may not accept all samples. There is no main
+        // loop to resume the output so samples not accepted are counted as
+        // dropped.
+      void writeAll(AudioSink *sink, const float *samples, int count)
+      {
+        while (count > 0)
+        {
+          int ret = sink->writeSamples(samples, count);
+          if (ret <= 0)
+          {
+            dropped += count;
+            return;
+          }
+          samples += ret;
+          count -= ret;
+        }
+      }
+
+    private:
+      string m_name;
+  };
+
+
+  class BenchRx : public LocalRxBase
+  {
+    public:
+      BenchRx(Config& cfg, const string& name) : LocalRxBase(cfg, name) {}
+      AudioPassthrough input;
+
+    protected:
+      virtual bool audioOpen(void) { return true; }
+      virtual void audioClose(void) {}
+      virtual int audioSampleRate(void) { return SAMPLE_RATE; }
+      virtual AudioSource *audioSource(void) { return &input; }
+  };
+
+
+  class RxChainStage : public Stage
+  {
+    public:
+      RxChainStage(void) : Stage("rx_chain"), rx(0) {}
+      ~RxChainStage(void) { delete rx; }
+      bool setup(Config& cfg)
+      {
+        cfg.setValue("BenchRx", "SQL_DET", "OPEN");
+        cfg.setValue("BenchRx", "DEEMPHASIS", "1");
+        cfg.setValue("BenchRx", "DTMF_DEC_TYPE", "INTERNAL");
+        cfg.setValue("BenchRx", "DTMF_MUTING", "1");
+        cfg.setValue("BenchRx", "1750_MUTING", "1");
+        cfg.setValue("BenchRx", "SIGLEV_DET", "NOISE");
+        rx = new BenchRx(cfg, "BenchRx");
+        if (!rx->initialize())
+        {
+          return false;
+        }
+        rx->registerSink(&sink);
+        rx->setMuteState(Rx::MUTE_NONE);
+        return true;
+      }
+      void run(const float *samples, int count)
+      {
+        writeAll(&rx->input, samples, count);
+      }
+      void addInfo(Json::Value& info)
+      {
+        info["output_samples"] = Json::UInt64(sink.samples);
+      }
+
+    private:
+      BenchRx   *rx;
+      NullSink  sink;
+  };
+
+
+  class TxChainStage : public Stage
+  {
+    public:
+      TxChainStage(void) : Stage("tx_chain"), tx(0) {}
+      ~TxChainStage(void) { delete tx; }
+      bool setup(Config& cfg)
+      {
+        cfg.setValue("BenchTx", "AUDIO_DEV", "bench:tx");
+        cfg.setValue("BenchTx", "AUDIO_CHANNEL", "0");
+        cfg.setValue("BenchTx", "PTT_TYPE", "NONE");
+        cfg.setValue("BenchTx", "PREEMPHASIS", "1");
+        tx = new LocalTx(cfg, "BenchTx");
+        if (!tx->initialize())
+        {
+          return false;
+        }
+        tx->setTxCtrlMode(Tx::TX_ON);
+        return true;
+      }
+      void run(const float *samples, int count)
+      {
+        writeAll(tx, samples, count);
+      }
+
+    private:
+      LocalTx *tx;
+  };
+
+
+  class DtmfDecoderStage : public Stage
+  {
+    public:
+      DtmfDecoderStage(const string& type)
+        : Stage("dtmf_" + type), type(type), dec(0), digits(0) {}
+      ~DtmfDecoderStage(void) { delete dec; }
+      bool setup(Config& cfg)
+      {
+        string section = "BenchDtmf" + type;
+        cfg.setValue(section, "DTMF_DEC_TYPE", type);
+        dec = DtmfDecoder::create(0, cfg, section);
+        if ((dec == 0) || !dec->initialize())
+        {
+          return false;
+        }
+        dec->digitDeactivated.connect(
+            [this](char, int) { digits += 1; });
+        return true;
+      }
+      void run(const float *samples, int count)
+      {
+        writeAll(dec, samples, count);
+      }
+      void addInfo(Json::Value& info)
+      {
+        info["digits"] = digits;
+      }
+
+    private:
+      string        type;
+      DtmfDecoder   *dec;
+      unsigned      digits;
+  };
+
+
+  class ToneDetectorBankStage : public Stage
+  {
+    public:
+      ToneDetectorBankStage(void) : Stage("tone_detector_bank") {}
+      ~ToneDetectorBankStage(void)
+      {
+        for (auto det : dets)
+        {
+          delete det;
+        }
+      }
+      bool setup(Config& cfg)
+      {
+          // A CTCSS scanning bank and a 1750Hz tone burst detector, like
+          // the ones set up by the squelch and the repeater logic
+        static const float ctcss_fqs[] = {
+          67.0, 71.9, 77.0, 82.5, 88.5, 94.8, 100.0, 103.5, 107.2, 110.9,
+          114.8, 118.8, 123.0, 127.3, 131.8, 136.5
+        };
+        for (float fq : ctcss_fqs)
+        {
+          ToneDetector *det = new ToneDetector(fq, 8.0f, 0);
+          det->setDetectSnrThresh(15.0f, 300.0f);
+          dets.push_back(det);
+        }
+        dets.push_back(new ToneDetector(1750, 50, 0));
+        return true;
+      }
+      void run(const float *samples, int count)
+      {
+        for (auto det : dets)
+        {
+          writeAll(det, samples, count);
+        }
+      }
+      void addInfo(Json::Value& info)
+      {
+        info["detectors"] = static_cast<unsigned>(dets.size());
+      }
+
+    private:
+      vector<ToneDetector*> dets;
+  };
+
+
+  class SigLevDetNoiseStage : public Stage
+  {
+    public:
+      SigLevDetNoiseStage(void) : Stage("siglevdet_noise"), det(0) {}
+      ~SigLevDetNoiseStage(void) { delete det; }
+      bool setup(Config& cfg)
+      {
+        det = new SigLevDetNoise;
+        return det->initialize(cfg, "BenchSigLev", SAMPLE_RATE);
+      }
+      void run(const float *samples, int count)
+      {
+        writeAll(det, samples, count);
+      }
+
+    private:
+      SigLevDetNoise *det;
+  };
+
+
+  /**
+   * A number of DDR channels on one wideband receiver. The input audio is
+   * FM modulated onto one carrier per channel. The IQ samples are generated
+   * in the prepare function so only the channelizers, demodulators and the
+   * receiver audio chains are timed.
+   */
+  class DdrStage : public Stage
+  {
+    public:
+      DdrStage(void)
+        : Stage("ddr_fm_x" + to_string(DDR_CHANNELS)), wbrx(0),
+          phase(DDR_CHANNELS, 0.0)
+      {
+      }
+      ~DdrStage(void)
+      {
+        for (auto ddr : ddrs)
+        {
+          delete ddr;
+        }
+      }
+      bool setup(Config& cfg)
+      {
+        cfg.setValue("BenchWbRx", "TYPE", "RtlTcp");
+        cfg.setValue("BenchWbRx", "HOST", "127.0.0.1");
+        cfg.setValue("BenchWbRx", "SAMPLE_RATE", to_string(DDR_SAMPLE_RATE));
+        cfg.setValue("BenchWbRx", "CENTER_FQ", to_string(DDR_CENTER_FQ));
+        for (unsigned ch=0; ch<DDR_CHANNELS; ++ch)
+        {
+          string section = "BenchDdr" + to_string(ch);
+          cfg.setValue(section, "WBRX", "BenchWbRx");
+          cfg.setValue(section, "FQ", to_string(DDR_CENTER_FQ + offset(ch)));
+          cfg.setValue(section, "MODULATION", "FM");
+          cfg.setValue(section, "SQL_DET", "OPEN");
+          Ddr *ddr = new Ddr(cfg, section);
+          if (!ddr->initialize())
+          {
+            delete ddr;
+            return false;
+          }
+          ddr->registerSink(&sink);
+          ddr->setMuteState(Rx::MUTE_NONE);
+          ddrs.push_back(ddr);
+        }
+        wbrx = WbRxRtlSdr::instance(cfg, "BenchWbRx");
+        return true;
+      }
+      void prepare(const float *samples, int count)
+      {
+        const unsigned ratio = DDR_SAMPLE_RATE / SAMPLE_RATE;
+        iq.assign(count * ratio, WbRxRtlSdr::Sample(0.0f, 0.0f));
+        for (unsigned ch=0; ch<DDR_CHANNELS; ++ch)
+        {
+          double ph = phase[ch];
+          for (int i=0; i<count; ++i)
+          {
+            double fq = offset(ch) + DDR_FM_DEV * samples[i];
+            double inc = 2.0 * M_PI * fq / DDR_SAMPLE_RATE;
+            for (unsigned j=0; j<ratio; ++j)
+            {
+              ph += inc;
+              iq[i*ratio+j] += WbRxRtlSdr::Sample(0.2f * cos(ph),
+                                                  0.2f * sin(ph));
+            }
+          }
+          phase[ch] = fmod(ph, 2.0 * M_PI);
+        }
+      }
+      void run(const float *samples, int count)
+      {
+        wbrx->iqReceived(iq);
+      }
+      void addInfo(Json::Value& info)
+      {
+        info["channels"] = DDR_CHANNELS;
+        info["iq_sample_rate"] = DDR_SAMPLE_RATE;
+        info["output_samples"] = Json::UInt64(sink.samples);
+      }
+
+    private:
+      WbRxRtlSdr                    *wbrx;
+      vector<Ddr*>                  ddrs;
+      vector<double>                phase;
+      vector<WbRxRtlSdr::Sample>    iq;
+      NullSink                      sink;
+
+      static int offset(unsigned ch)
+      {
+        return -300000 + 200000 * static_cast<int>(ch);
+      }
+  };
+
+
+  class CodecStage : public Stage
+  {
+    public:
+      CodecStage(const string& codec)
+        : Stage("codec_" + codec), codec(codec), enc(0), dec(0),
+          encoded_bytes(0)
+      {
+      }
+      ~CodecStage(void)
+      {
+        delete enc;
+        delete dec;
+      }
+      bool setup(Config& cfg)
+      {
+        enc = AudioEncoder::create(codec);
+        dec = AudioDecoder::create(codec);
+        if ((enc == 0) || (dec == 0))
+        {
+          return false;
+        }
+        enc->writeEncodedSamples.connect(
+            [this](const void *buf, int size)
+            {
+              encoded_bytes += size;
+              dec->writeEncodedSamples(const_cast<void*>(buf), size);
+            });
+        dec->registerSink(&sink);
+        return true;
+      }
+      void run(const float *samples, int count)
+      {
+        writeAll(enc, samples, count);
+      }
+      void finish(void)
+      {
+        enc->flushSamples();
+      }
+      void addInfo(Json::Value& info)
+      {
+        info["encoded_bytes"] = Json::UInt64(encoded_bytes);
+        info["output_samples"] = Json::UInt64(sink.samples);
+      }
+
+    private:
+      string        codec;
+      AudioEncoder  *enc;
+      AudioDecoder  *dec;
+      NullSink      sink;
+      uint64_t      encoded_bytes;
+  };
+
+
+  struct Result
+  {
+    string      name;
+    bool        ok;
+    double      seconds;
+    Json::Value info;
+    uint64_t    dropped;
+  };
+
+
+  uint32_t le32(const char *p)
+  {
+    const unsigned char *u = reinterpret_cast<const unsigned char*>(p);
+    return u[0] | (u[1] << 8) | (u[2] << 16) | (uint32_t(u[3]) << 24);
+  }
+
+  uint16_t le16(const char *p)
+  {
+    const unsigned char *u = reinterpret_cast<const unsigned char*>(p);
+    return u[0] | (u[1] << 8);
+  }
+
+
+    // Read a 16 bit mono PCM WAV file with the internal sample rate
+  bool readWav(const string& path, vector<float>& samples)
+  {
+    ifstream ifs(path.c_str(), ios::in | ios::binary);
+    if (!ifs)
+    {
+      cerr << "*** ERROR: Could not open input file " << path << endl;
+      return false;
+    }
+    char hdr[12];
+    if (!ifs.read(hdr, sizeof(hdr)) || (memcmp(hdr, "RIFF", 4) != 0) ||
+        (memcmp(hdr + 8, "WAVE", 4) != 0))
+    {
+      cerr << "*** ERROR: Not a WAV file: " << path << endl;
+      return false;
+    }
+    bool fmt_ok = false;
+    char chunk[8];
+    while (ifs.read(chunk, sizeof(chunk)))
+    {
+      uint32_t size = le32(chunk + 4);
+      if (memcmp(chunk, "fmt ", 4) == 0)
+      {
+        vector<char> fmt(size);
+        if ((size < 16) || !ifs.read(&fmt[0], size))
+        {
+          break;
+        }
+        fmt_ok = (le16(&fmt[0]) == 1) && (le16(&fmt[2]) == 1) &&
+                 (le32(&fmt[4]) == uint32_t(SAMPLE_RATE)) &&
+                 (le16(&fmt[14]) == 16);
+      }
+      else if (memcmp(chunk, "data", 4) == 0)
+      {
+        if (!fmt_ok)
+        {
+          break;
+        }
+        vector<int16_t> pcm(size / sizeof(int16_t));
+        ifs.read(reinterpret_cast<char*>(pcm.data()),
+                 pcm.size() * sizeof(int16_t));
+        pcm.resize(ifs.gcount() / sizeof(int16_t));
+        samples.resize(pcm.size());
+        for (size_t i=0; i<pcm.size(); ++i)
+        {
+          samples[i] = le16(reinterpret_cast<const char*>(&pcm[i])) /
+                       32768.0f;
+        }
+        return true;
+      }
+      else
+      {
+        ifs.seekg(size + (size & 1), ios::cur);
+      }
+    }
+    cerr << "*** ERROR: Only 16 bit mono PCM WAV files with a sample rate of "
+         << SAMPLE_RATE << "Hz are supported: " << path << endl;
+    return false;
+  }
+
+
+    // Synthesize a voice like signal with noise, a subaudible tone and DTMF
+    // digits at regular intervals
+  void synthesize(vector<float>& samples, unsigned seconds)
+  {
+    static const float row_fqs[] = { 697, 770, 852, 941 };
+    static const float col_fqs[] = { 1209, 1336, 1477, 1633 };
+    samples.resize(seconds * SAMPLE_RATE);
+    srand(1);
+    double voice_phi = 0.0;
+    for (size_t i=0; i<samples.size(); ++i)
+    {
+      double t = double(i) / SAMPLE_RATE;
+      double pitch = 150.0 + 50.0 * sin(2.0 * M_PI * 0.7 * t);
+      voice_phi += 2.0 * M_PI * pitch / SAMPLE_RATE;
+      double env = 0.5 * (1.0 + sin(2.0 * M_PI * 3.0 * t));
+      double s = 0.0;
+      for (int h=1; h<=10; ++h)
+      {
+        s += sin(h * voice_phi) / h;
+      }
+      s *= 0.15 * env;
+      s += 0.05 * sin(2.0 * M_PI * 88.5 * t);
+      s += 0.01 * (2.0 * rand() / RAND_MAX - 1.0);
+
+        // 100ms DTMF digit every two seconds
+      size_t pos = i % (2 * SAMPLE_RATE);
+      if (pos < SAMPLE_RATE / 10)
+      {
+        unsigned digit = (i / (2 * SAMPLE_RATE)) % 16;
+        s = 0.25 * sin(2.0 * M_PI * row_fqs[digit / 4] * t) +
+            0.25 * sin(2.0 * M_PI * col_fqs[digit % 4] * t);
+      }
+      samples[i] = s;
+    }
+  }
+
+
+  vector<unique_ptr<Stage> > createStages(void)
+  {
+    vector<unique_ptr<Stage> > stages;
+    stages.emplace_back(new RxChainStage);
+    stages.emplace_back(new TxChainStage);
+    for (const char *type : { "INTERNAL", "S54S", "DH1DM" })
+    {
+      stages.emplace_back(new DtmfDecoderStage(type));
+    }
+    stages.emplace_back(new ToneDetectorBankStage);
+    stages.emplace_back(new SigLevDetNoiseStage);
+    stages.emplace_back(new DdrStage);
+    for (const char *codec : { "RAW", "S16", "GSM", "SPEEX", "OPUS" })
+    {
+      if (AudioEncoder::isAvailable(codec) && AudioDecoder::isAvailable(codec))
+      {
+        stages.emplace_back(new CodecStage(codec));
+      }
+    }
+    return stages;
+  }
+
+
+  Result runStage(Stage& stage, const vector<float>& in, int block_size)
+  {
+    Config cfg;
+    Result res;
+    res.name = stage.name();
+    res.seconds = 0.0;
+    res.ok = stage.setup(cfg);
+    if (!res.ok)
+    {
+      res.dropped = 0;
+      return res;
+    }
+    chrono::steady_clock::duration elapsed(0);
+    for (size_t pos=0; pos<in.size(); pos+=block_size)
+    {
+      int count = min(size_t(block_size), in.size() - pos);
+      stage.prepare(&in[pos], count);
+      auto start = chrono::steady_clock::now();
+      stage.run(&in[pos], count);
+      elapsed += chrono::steady_clock::now() - start;
+    }
+    auto start = chrono::steady_clock::now();
+    stage.finish();
+    elapsed += chrono::steady_clock::now() - start;
+    res.seconds = chrono::duration<double>(elapsed).count();
+    stage.addInfo(res.info);
+    res.dropped = stage.dropped;
+    return res;
+  }
+
+
+  void usage(const char *prog)
+  {
+    cerr << "Usage: " << prog << " [-i file.wav] [-d seconds] [-b block size] "
+            "[-r repeats] [-s stage substring] [-f json|csv]\n";
+  }
+};
+
+
+int main(int argc, const char **argv)
+{
+  string input_file;
+  unsigned seconds = 30;
+  int block_size = 256;
+  unsigned repeats = 1;
+  string stage_filter;
+  string format("json");
+  for (int i=1; i<argc; ++i)
+  {
+    string arg(argv[i]);
+    if ((i + 1 >= argc) || (arg.size() != 2) || (arg[0] != '-'))
+    {
+      usage(argv[0]);
+      return 1;
+    }
+    string val(argv[++i]);
+    switch (arg[1])
+    {
+      case 'i': input_file = val; break;
+      case 'd': seconds = atoi(val.c_str()); break;
+      case 'b': block_size = atoi(val.c_str()); break;
+      case 'r': repeats = atoi(val.c_str()); break;
+      case 's': stage_filter = val; break;
+      case 'f': format = val; break;
+      default:
+        usage(argv[0]);
+        return 1;
+    }
+  }
+  if ((block_size <= 0) || (repeats == 0) ||
+      ((format != "json") && (format != "csv")))
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+    // Timers and file descriptor watches need an application object but the
+    // main loop is never run
+  CppApplication app;
+
+  vector<float> in;
+  if (!input_file.empty())
+  {
+    if (!readWav(input_file, in))
+    {
+      return 1;
+    }
+  }
+  else
+  {
+    synthesize(in, seconds);
+  }
+  if (in.empty())
+  {
+    cerr << "*** ERROR: No input samples\n";
+    return 1;
+  }
+
+    // Stages print status messages during setup. Send them to stderr so that
+    // stdout only contain the result.
+  streambuf *cout_buf = cout.rdbuf(cerr.rdbuf());
+
+  vector<Result> results;
+  auto stages = createStages();
+  for (auto& proto : stages)
+  {
+    if (proto->name().find(stage_filter) == string::npos)
+    {
+      continue;
+    }
+    Result best;
+    best.ok = false;
+    for (unsigned r=0; r<repeats; ++r)
+    {
+        // Each repetition use a newly created stage
+      unique_ptr<Stage> stage;
+      for (auto& s : createStages())
+      {
+        if (s->name() == proto->name())
+        {
+          stage = move(s);
+        }
+      }
+      Result res = runStage(*stage, in, block_size);
+      if (!res.ok)
+      {
+        cerr << "*** WARNING: Could not set up stage " << res.name << endl;
+        best = res;
+        break;
+      }
+      if (!best.ok || (res.seconds < best.seconds))
+      {
+        best = res;
+      }
+    }
+    results.push_back(best);
+  }
+
+  cout.rdbuf(cout_buf);
+
+  if (format == "csv")
+  {
+    cout << "stage,samples,seconds,samples_per_sec,ns_per_sample,"
+            "realtime_factor,dropped_samples\n";
+  }
+  Json::Value root(Json::objectValue);
+  root["sample_rate"] = SAMPLE_RATE;
+  root["block_size"] = block_size;
+  root["repeats"] = repeats;
+  root["input"] = input_file.empty() ? "synthetic" : input_file;
+  root["input_samples"] = Json::UInt64(in.size());
+  root["stages"] = Json::Value(Json::arrayValue);
+  for (const auto& res : results)
+  {
+    if (!res.ok)
+    {
+      continue;
+    }
+    double sps = (res.seconds > 0.0) ? in.size() / res.seconds : 0.0;
+    double ns = 1e9 * res.seconds / in.size();
+    if (format == "csv")
+    {
+      cout << res.name << "," << in.size() << "," << res.seconds << ","
+           << fixed << setprecision(0) << sps << ","
+           << setprecision(2) << ns << "," << (sps / SAMPLE_RATE) << ","
+           << res.dropped << "\n";
+      cout.unsetf(ios::floatfield);
+      cout << setprecision(6);
+      continue;
+    }
+    Json::Value stage(res.info);
+    if (stage.isNull())
+    {
+      stage = Json::Value(Json::objectValue);
+    }
+    stage["name"] = res.name;
+    stage["samples"] = Json::UInt64(in.size());
+    stage["seconds"] = res.seconds;
+    stage["samples_per_sec"] = sps;
+    stage["ns_per_sample"] = ns;
+    stage["realtime_factor"] = sps / SAMPLE_RATE;
+    stage["dropped_samples"] = Json::UInt64(res.dropped);
+    root["stages"].append(stage);
+  }
+  if (format == "json")
+  {
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "  ";
+    unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
+    writer->write(root, &cout);
+    cout << endl;
+  }
+
+  return 0;
+}
+